@@ -9,6 +9,7 @@
 
 **********************************************************************/
 #include "BassTrebleBase.h"
+#include "Biquad.h"
 #include "ShuttleAutomation.h"
 
 const EffectParameterMethods& BassTrebleBase::Parameters() const
@@ -136,20 +137,27 @@ size_t BassTrebleBase::Instance::InstanceProcess(
 
    // Compute coefficients of the low shelf biquand IIR filter
    if (data.bass != oldBass)
-      Coefficients(
-         data.hzBass, data.slope, ms.mBass, data.samplerate, kBass, data.a0Bass,
-         data.a1Bass, data.a2Bass, data.b0Bass, data.b1Bass, data.b2Bass);
+   {
+      data.filter.SetSection(
+         0, ShelfFilter(
+               data.hzBass, data.slope, ms.mBass, data.samplerate, kBass));
+      data.bass = oldBass;
+   }
 
    // Compute coefficients of the high shelf biquand IIR filter
    if (data.treble != oldTreble)
-      Coefficients(
-         data.hzTreble, data.slope, ms.mTreble, data.samplerate, kTreble,
-         data.a0Treble, data.a1Treble, data.a2Treble, data.b0Treble,
-         data.b1Treble, data.b2Treble);
+   {
+      data.filter.SetSection(
+         1, ShelfFilter(
+               data.hzTreble, data.slope, ms.mTreble, data.samplerate,
+               kTreble));
+      data.treble = oldTreble;
+   }
 
+   data.filter.Process(ibuf, obuf, blockLen);
    for (decltype(blockLen) i = 0; i < blockLen; i++)
    {
-      obuf[i] = DoFilter(data, ibuf[i]) * data.gain;
+      obuf[i] *= data.gain;
    }
 
    return blockLen;
@@ -183,30 +191,18 @@ void BassTrebleBase::Instance::Coefficients(
    }
 }
 
-float BassTrebleBase::Instance::DoFilter(BassTrebleState& data, float in)
+Biquad BassTrebleBase::Instance::ShelfFilter(
+   double hz, double slope, double gain, double samplerate, int type)
 {
-   // Bass filter
-   float out = (data.b0Bass * in + data.b1Bass * data.xn1Bass +
-                data.b2Bass * data.xn2Bass - data.a1Bass * data.yn1Bass -
-                data.a2Bass * data.yn2Bass) /
-               data.a0Bass;
-   data.xn2Bass = data.xn1Bass;
-   data.xn1Bass = in;
-   data.yn2Bass = data.yn1Bass;
-   data.yn1Bass = out;
-
-   // Treble filter
-   in = out;
-   out = (data.b0Treble * in + data.b1Treble * data.xn1Treble +
-          data.b2Treble * data.xn2Treble - data.a1Treble * data.yn1Treble -
-          data.a2Treble * data.yn2Treble) /
-         data.a0Treble;
-   data.xn2Treble = data.xn1Treble;
-   data.xn1Treble = in;
-   data.yn2Treble = data.yn1Treble;
-   data.yn1Treble = out;
-
-   return out;
+   double a0, a1, a2, b0, b1, b2;
+   Coefficients(hz, slope, gain, samplerate, type, a0, a1, a2, b0, b1, b2);
+   Biquad result;
+   result.fNumerCoeffs[Biquad::B0] = b0 / a0;
+   result.fNumerCoeffs[Biquad::B1] = b1 / a0;
+   result.fNumerCoeffs[Biquad::B2] = b2 / a0;
+   result.fDenomCoeffs[Biquad::A1] = a1 / a0;
+   result.fDenomCoeffs[Biquad::A2] = a2 / a0;
+   return result;
 }
 
 void BassTrebleBase::Instance::InstanceInit(
@@ -219,29 +215,7 @@ void BassTrebleBase::Instance::InstanceInit(
    data.hzBass = 250.0f;    // could be tunable in a more advanced version
    data.hzTreble = 4000.0f; // could be tunable in a more advanced version
 
-   data.a0Bass = 1;
-   data.a1Bass = 0;
-   data.a2Bass = 0;
-   data.b0Bass = 0;
-   data.b1Bass = 0;
-   data.b2Bass = 0;
-
-   data.a0Treble = 1;
-   data.a1Treble = 0;
-   data.a2Treble = 0;
-   data.b0Treble = 0;
-   data.b1Treble = 0;
-   data.b2Treble = 0;
-
-   data.xn1Bass = 0;
-   data.xn2Bass = 0;
-   data.yn1Bass = 0;
-   data.yn2Bass = 0;
-
-   data.xn1Treble = 0;
-   data.xn2Treble = 0;
-   data.yn1Treble = 0;
-   data.yn2Treble = 0;
+   data.filter.Reset();
 
    data.bass = -1;
    data.treble = -1;
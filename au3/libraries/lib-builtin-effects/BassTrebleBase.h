@@ -10,6 +10,7 @@
 **********************************************************************/
 #pragma once
 
+#include "BiquadCascade.h"
 #include "PerTrackEffect.h"
 #include "SettingsVisitor.h"
 
@@ -28,10 +29,8 @@ public:
    double bass;
    double gain;
    double slope, hzBass, hzTreble;
-   double a0Bass, a1Bass, a2Bass, b0Bass, b1Bass, b2Bass;
-   double a0Treble, a1Treble, a2Treble, b0Treble, b1Treble, b2Treble;
-   double xn1Bass, xn2Bass, yn1Bass, yn2Bass;
-   double xn1Treble, xn2Treble, yn1Treble, yn2Treble;
+   //! Bass shelf, then treble shelf
+   BiquadCascade filter { 1, 2 };
 };
 
 struct BassTrebleSettings
@@ -115,7 +114,8 @@ public:
          double& a0, double& a1, double& a2, double& b0, double& b1,
          double& b2);
 
-      static float DoFilter(BassTrebleState& data, float in);
+      static Biquad ShelfFilter(
+         double hz, double slope, double gain, double samplerate, int type);
 
       BassTrebleState mState;
       std::vector<BassTrebleBase::Instance> mSlaves;
@@ -10,6 +10,7 @@
 **********************************************************************/
 #include "CompressorInstance.h"
 #include "CompressorProcessor.h"
+#include "DynamicRangeProcessorOutputPacketQueue.h"
 #include "MathApprox.h"
 #include <numeric>
 
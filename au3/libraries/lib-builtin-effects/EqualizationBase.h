@@ -2,6 +2,7 @@
 
 #include "EqualizationCurvesList.h"
 #include "EqualizationFilter.h"
+#include "PartitionedConvolver.h"
 #include "SampleFormat.h"
 #include "StatefulEffect.h"
 #include "WaveTrack.h"
@@ -52,13 +53,19 @@ protected:
 
    struct Task
    {
-      Task(size_t M, size_t idealBlockLen, WaveChannel& channel)
-          : buffer { idealBlockLen }
+      Task(
+         const EqualizationFilter& filter, size_t idealBlockLen,
+         WaveChannel& channel)
+          : convolver { filter.mImpulseResponse.data(),
+                        filter.mImpulseResponse.size(), convolverBlockSize,
+                        convolverMaxBlockSize }
+          , buffer { idealBlockLen }
           , idealBlockLen { idealBlockLen }
           , output { channel }
-          , leftTailRemaining { (M - 1) / 2 }
+          // The convolver delays, and the filter is centred
+          , leftTailRemaining { convolver.GetLatency() +
+                                (filter.mImpulseResponse.size() - 1) / 2 }
       {
-         memset(lastWindow, 0, windowSize * sizeof(float));
       }
 
       void AccumulateSamples(constSamplePtr buffer, size_t len)
@@ -70,17 +77,14 @@ protected:
          output.Append(buffer, floatSample, len);
       }
 
-      static constexpr auto windowSize = EqualizationFilter::windowSize;
-      Floats window1 { windowSize };
-      Floats window2 { windowSize };
+      // Offline, latency doesn't matter, but small blocks cost more.
+      static constexpr size_t convolverBlockSize = 1024;
+      static constexpr size_t convolverMaxBlockSize = 8192;
+      PartitionedConvolver convolver;
 
       Floats buffer;
       const size_t idealBlockLen;
 
-      // These pointers are swapped after each FFT window
-      float* thisWindow { window1.get() };
-      float* lastWindow { window2.get() };
-
       // a new WaveChannel to hold all of the output,
       // including 'tails' each end
       WaveChannel& output;
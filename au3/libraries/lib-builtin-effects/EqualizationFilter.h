@@ -16,7 +16,8 @@
 
 #include "EqualizationParameters.h" // base class
 #include "Envelope.h" // member
-#include "RealFFTf.h" // member
+#include "MemoryX.h"
+#include <vector>
 using Floats = ArrayOf<float>;
 
 //! Extend EqualizationParameters with frequency domain coefficients computed
@@ -38,10 +39,6 @@ struct BUILTIN_EFFECTS_API EqualizationFilter : EqualizationParameters
    //! domain
    bool CalcFilter();
 
-   //! Transform a given buffer of time domain signal, which should be zero
-   //! padded left and right for the tails
-   void Filter(size_t len, float *buffer) const;
-
    const Envelope &ChooseEnvelope() const
    { return mLin ? mLinEnvelope : mLogEnvelope; }
    Envelope &ChooseEnvelope()
@@ -52,9 +49,9 @@ struct BUILTIN_EFFECTS_API EqualizationFilter : EqualizationParameters
    { return IsLinear() ? mLinEnvelope : mLogEnvelope; }
 
    Envelope mLinEnvelope, mLogEnvelope;
-   HFFT hFFT{ GetFFT(windowSize) };
-   Floats mFFTBuffer{ windowSize };
    Floats mFilterFuncR{ windowSize }, mFilterFuncI{ windowSize };
+   //! The mM taps of the filter, centred on the middle one
+   std::vector<float> mImpulseResponse;
    double mLoFreq{ loFreqI };
    double mHiFreq{ mLoFreq };
    size_t mWindowSize{ windowSize };
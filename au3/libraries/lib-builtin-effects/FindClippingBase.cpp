@@ -141,6 +141,7 @@ bool FindClippingBase::ProcessOne(
    decltype(len) s = 0, startrun = 0, stoprun = 0, samps = 0;
    decltype(blockSize) block = 0;
    double startTime = -1.0;
+   LabelArray labels;
 
    while (s < len)
    {
@@ -177,7 +178,7 @@ bool FindClippingBase::ProcessOne(
             samps++;
             if (stoprun >= mStop)
             {
-               lt.AddLabel(
+               labels.emplace_back(
                   SelectedRegion(
                      startTime, wt.LongSamplesToTime(start + s - mStop)),
                   /*!
@@ -201,5 +202,6 @@ bool FindClippingBase::ProcessOne(
       s++;
       block--;
    }
+   lt.AddLabels(std::move(labels));
    return bGoodResult;
 }
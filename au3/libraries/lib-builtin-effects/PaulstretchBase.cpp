@@ -16,13 +16,23 @@
 #include "BasicUI.h"
 #include "EffectOutputTracks.h"
 #include "FFT.h"
+#include "MemoryX.h"
 #include "Prefs.h"
 #include "SyncLock.h"
 #include "TimeWarper.h"
 #include "WaveTrack.h"
+#include "concurrency/ThreadPool.h"
 #include <algorithm>
+#include <atomic>
+#include <cassert>
 #include <cfloat> // FLT_MAX
+#include <chrono>
 #include <cmath>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <random>
+#include <vector>
 
 const ComponentInterfaceSymbol PaulstretchBase::Symbol { XO("Paulstretch") };
 
@@ -37,7 +47,8 @@ const EffectParameterMethods& PaulstretchBase::Parameters() const
 class PaulStretch
 {
 public:
-   PaulStretch(float rap_, size_t in_bufsize_, float samplerate_);
+   PaulStretch(
+      float rap_, size_t in_bufsize_, float samplerate_, unsigned seed = 0);
    // in_bufsize is also a half of a FFT buffer (in samples)
    virtual ~PaulStretch();
 
@@ -73,6 +84,9 @@ private:
 
    double remained_samples; // how many fraction of samples has remained (0..1)
 
+   // Of the phases; not rand(), so that instances may run on several threads
+   std::mt19937 random_phases;
+
    const Floats fft_smps, fft_c, fft_s, fft_freq, fft_tmp;
 };
 
@@ -273,82 +287,187 @@ bool PaulstretchBase::ProcessOne(
    try
    {
       // This encloses all the allocations of buffers, including those in
-      // the constructor of the PaulStretch object
-
-      PaulStretch stretch(amount, stretch_buf_size, rate);
-
-      auto nget = stretch.get_nsamples_for_fill();
-
-      auto bufsize = stretch.poolsize;
-      Floats buffer0 { bufsize };
-      float* bufferptr0 = buffer0.get();
-      bool first_time = true;
+      // the constructor of the PaulStretch objects
+
+      // Enough to make the work worth sharing
+      const auto framesPerSegment = std::max<size_t>(
+         8, (1 << 18) / std::max<size_t>(8, stretch_buf_size));
+      // Segments, and channels, have phases of their own
+      const unsigned seed = rand();
+      if (!Stretch(
+             amount, stretch_buf_size, rate, len, framesPerSegment, seed,
+             [&](float* buffer, sampleCount s, size_t numSamples) {
+                track.GetFloats(buffer, start + s, numSamples);
+             },
+             [&](const float* buffer, size_t numSamples) {
+                outputTrack.Append(
+                   (constSamplePtr)buffer, floatSample, numSamples);
+             },
+             [&](double fraction) { return !TrackProgress(count, fraction); }))
+         return false;
+
+      return !TrackProgress(count, 1.0);
+   }
+   catch (const std::bad_alloc&)
+   {
+      BasicUI::ShowMessageBox(badAllocMessage);
+   }
+   return false;
+};
 
-      const auto fade_len = std::min<size_t>(100, bufsize / 2 - 1);
-      bool cancelled = false;
+bool PaulstretchBase::Stretch(
+   float amount, size_t bufferSize, double rate, sampleCount numSamples,
+   size_t framesPerSegment, unsigned seed, const ReadFunction& read,
+   const AppendFunction& append, const PollFunction& poll)
+{
+   assert(framesPerSegment > 0);
 
+   // Each output frame is made from a window of poolsize input samples,
+   // whose end advances by get_nsamples() from one frame to the next. Find
+   // where all the windows end.
+   std::vector<sampleCount> windowEnds;
+   {
+      PaulStretch planner(amount, bufferSize, rate);
+      windowEnds.push_back(planner.get_nsamples_for_fill());
+      while (windowEnds.back() < numSamples)
+         windowEnds.push_back(windowEnds.back() + planner.get_nsamples());
+   }
+   const auto numFrames = windowEnds.size();
+
+   const auto poolsize = 2 * bufferSize;
+   const auto out_bufsize = std::max<size_t>(8, bufferSize);
+   const auto fade_len = std::min<size_t>(100, poolsize / 2 - 1);
+
+   // Frames are independent but for the overlap with the previous one, so
+   // segments of consecutive frames are rendered on several threads. Each
+   // segment but the first also renders the last frame of the previous
+   // segment, with other random phases, and the two are crossfaded.
+   const auto numSegments =
+      (numFrames + framesPerSegment - 1) / framesPerSegment;
+
+   std::atomic<size_t> framesDone { 0 };
+   // Segments rendered and not yet appended
+   std::mutex renderedMutex;
+   std::map<size_t, std::vector<float>> rendered;
+   // The next segment to append, guarded by renderedMutex
+   size_t nextSegment = 0;
+   std::condition_variable appended;
+   // Workers render no further ahead of the appending, so that `rendered`
+   // holds fewer segments than there are workers. None waits for ever: the
+   // next segment to append is always allowed, and was taken before any that
+   // waits.
+   using namespace audacity::concurrency;
+   const auto maxAhead = ThreadPool::Get().GetNumThreads();
+
+   const auto render = [&](size_t segment, const std::atomic<bool>& cancelled) {
       {
-         Floats fade_track_smps { fade_len };
-         decltype(len) s = 0;
-
-         while (s < len)
+         std::unique_lock<std::mutex> lock { renderedMutex };
+         using namespace std::chrono_literals;
+         while (!(cancelled || segment < nextSegment + maxAhead))
+            // No notification comes with `cancelled`: look again now and then
+            appended.wait_for(lock, 50ms);
+         if (cancelled)
+            return;
+      }
+      const auto firstFrame =
+         segment == 0 ? 0 : segment * framesPerSegment - 1;
+      // At the start of the input, the first frame overlaps itself
+      const auto warmUpFrame = std::max<size_t>(firstFrame, 1) - 1;
+      const auto endFrame =
+         std::min(numFrames, (segment + 1) * framesPerSegment);
+      const auto inputStart = windowEnds[warmUpFrame] - poolsize;
+      const auto numInput =
+         (windowEnds[endFrame - 1] - inputStart).as_size_t();
+      Floats input { numInput };
+      read(input.get(), inputStart, numInput);
+      const auto window = [&](size_t frame) {
+         const auto offset = windowEnds[frame] - poolsize - inputStart;
+         return input.get() + offset.as_size_t();
+      };
+
+      PaulStretch stretch(
+         amount, bufferSize, rate, seed + static_cast<unsigned>(segment));
+      std::vector<float> output;
+      output.reserve((endFrame - firstFrame) * out_bufsize);
+      stretch.process(window(warmUpFrame), poolsize);
+      for (auto frame = firstFrame; frame < endFrame; ++frame)
+      {
+         if (cancelled)
+            return;
+         stretch.process(window(frame), poolsize);
+         output.insert(
+            output.end(), stretch.out_buf.get(),
+            stretch.out_buf.get() + out_bufsize);
+         ++framesDone;
+      }
+      std::lock_guard<std::mutex> lock { renderedMutex };
+      rendered.emplace(segment, std::move(output));
+   };
+
+   Floats fade_track_smps { fade_len };
+   // The last frame rendered, held back to crossfade with the next segment
+   std::vector<float> last;
+   const auto appendRendered = [&] {
+      while (true)
+      {
+         std::vector<float> output;
+         size_t segment;
          {
-            track.GetFloats(bufferptr0, start + s, nget);
-            stretch.process(buffer0.get(), nget);
-
-            if (first_time)
+            std::lock_guard<std::mutex> lock { renderedMutex };
+            segment = nextSegment;
+            const auto it = rendered.find(segment);
+            if (it == rendered.end())
+               break;
+            output = std::move(it->second);
+            rendered.erase(it);
+         }
+         if (segment == 0)
+         { // blend the start of the selection
+            read(fade_track_smps.get(), 0, fade_len);
+            for (size_t i = 0; i < fade_len; i++)
             {
-               stretch.process(buffer0.get(), 0);
-            };
-
-            s += nget;
-
-            if (first_time)
-            { // blend the start of the selection
-               track.GetFloats(fade_track_smps.get(), start, fade_len);
-               first_time = false;
-               for (size_t i = 0; i < fade_len; i++)
-               {
-                  float fi = (float)i / (float)fade_len;
-                  stretch.out_buf[i] =
-                     stretch.out_buf[i] * fi + (1.0 - fi) * fade_track_smps[i];
-               }
-            }
-            if (s >= len)
-            { // blend the end of the selection
-               track.GetFloats(fade_track_smps.get(), end - fade_len, fade_len);
-               for (size_t i = 0; i < fade_len; i++)
-               {
-                  float fi = (float)i / (float)fade_len;
-                  auto i2 = bufsize / 2 - 1 - i;
-                  stretch.out_buf[i2] =
-                     stretch.out_buf[i2] * fi +
-                     (1.0 - fi) * fade_track_smps[fade_len - 1 - i];
-               }
+               float fi = (float)i / (float)fade_len;
+               output[i] = output[i] * fi + (1.0 - fi) * fade_track_smps[i];
             }
-
-            outputTrack.Append(
-               (samplePtr)stretch.out_buf.get(), floatSample,
-               stretch.out_bufsize);
-
-            nget = stretch.get_nsamples();
-            if (TrackProgress(count, s.as_double() / len.as_double()))
+         }
+         else
+         {
+            // Equal power, the phases of the two frames being unrelated
+            for (size_t i = 0; i < out_bufsize; i++)
             {
-               cancelled = true;
-               break;
+               double angle = M_PI / 2 * i / out_bufsize;
+               output[i] = last[i] * cos(angle) + output[i] * sin(angle);
             }
          }
+         const auto lastFrame = output.end() - out_bufsize;
+         last.assign(lastFrame, output.end());
+         append(output.data(), output.size() - out_bufsize);
+         {
+            std::lock_guard<std::mutex> lock { renderedMutex };
+            ++nextSegment;
+         }
+         appended.notify_all();
       }
+      return poll(double(framesDone) / numFrames);
+   };
 
-      if (!cancelled)
-         return true;
-   }
-   catch (const std::bad_alloc&)
-   {
-      BasicUI::ShowMessageBox(badAllocMessage);
+   if (!RenderInParallel(numSegments, render, appendRendered))
+      return false;
+   assert(nextSegment == numSegments);
+
+   { // blend the end of the selection
+      read(fade_track_smps.get(), numSamples - fade_len, fade_len);
+      for (size_t i = 0; i < fade_len; i++)
+      {
+         float fi = (float)i / (float)fade_len;
+         auto i2 = out_bufsize - 1 - i;
+         last[i2] =
+            last[i2] * fi + (1.0 - fi) * fade_track_smps[fade_len - 1 - i];
+      }
    }
-   return false;
-};
+   append(last.data(), out_bufsize);
+   return true;
+}
 
 size_t PaulstretchBase::GetBufferSize(double rate) const
 {
@@ -370,7 +489,8 @@ size_t PaulstretchBase::GetBufferSize(double rate) const
 
 /*************************************************************/
 
-PaulStretch::PaulStretch(float rap_, size_t in_bufsize_, float samplerate_)
+PaulStretch::PaulStretch(
+   float rap_, size_t in_bufsize_, float samplerate_, unsigned seed)
     : samplerate { samplerate_ }
     , rap { std::max(1.0f, rap_) }
     , in_bufsize { in_bufsize_ }
@@ -380,6 +500,7 @@ PaulStretch::PaulStretch(float rap_, size_t in_bufsize_, float samplerate_)
     , poolsize { in_bufsize_ * 2 }
     , in_pool { poolsize, true }
     , remained_samples { 0.0 }
+    , random_phases { seed }
     , fft_smps { poolsize, true }
     , fft_c { poolsize, true }
     , fft_s { poolsize, true }
@@ -427,7 +548,7 @@ void PaulStretch::process(float* smps, size_t nsmps)
    float inv_2p15_2pi = 1.0 / 16384.0 * (float)M_PI;
    for (size_t i = 1; i < poolsize / 2; i++)
    {
-      unsigned int random = (rand()) & 0x7fff;
+      unsigned int random = random_phases() & 0x7fff;
       float phase = random * inv_2p15_2pi;
       float s = fft_freq[i] * sin(phase);
       float c = fft_freq[i] * cos(phase);
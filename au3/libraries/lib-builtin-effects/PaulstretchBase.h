@@ -8,9 +8,11 @@
  **********************************************************************/
 #pragma once
 
+#include "SampleCount.h"
 #include "ShuttleAutomation.h"
 #include "StatefulEffect.h"
 #include <cfloat>
+#include <functional>
 
 class WaveChannel;
 
@@ -43,6 +45,34 @@ public:
       const EffectSettings& settings, double previewLength) const override;
    bool Process(EffectInstance& instance, EffectSettings& settings) override;
 
+   //! Called from worker threads, possibly several at once. May be asked for
+   //! samples after the end of the input.
+   using ReadFunction =
+      std::function<void(float* buffer, sampleCount start, size_t numSamples)>;
+   using AppendFunction =
+      std::function<void(const float* buffer, size_t numSamples)>;
+   //! Returns false to cancel
+   using PollFunction = std::function<bool(double fraction)>;
+
+   /*!
+    * @brief Stretches `numSamples` samples by `amount`, rendering segments of
+    * `framesPerSegment` frames of `bufferSize` samples on the shared thread
+    * pool
+    *
+    * @details The calling thread gives the output to `append` in order, and
+    * calls `poll` about every 50 ms. Segments have their own random phases,
+    * from `seed`, and the length of the output doesn't depend on them.
+    * Doesn't return before the workers stopped, and rethrows what they threw.
+    *
+    * @pre `numSamples > 2 * bufferSize`
+    * @pre `framesPerSegment > 0`
+    * @return false if `poll` did
+    */
+   static bool Stretch(
+      float amount, size_t bufferSize, double rate, sampleCount numSamples,
+      size_t framesPerSegment, unsigned seed, const ReadFunction& read,
+      const AppendFunction& append, const PollFunction& poll);
+
 protected:
    // PaulstretchBase implementation
 
@@ -10,11 +10,14 @@
 **********************************************************************/
 #include "PlotSpectrumBase.h"
 #include "BasicUI.h"
+#include "MemoryX.h"
 #include "Prefs.h"
 #include "SampleFormat.h"
 #include "ViewInfo.h"
 #include "WaveTrack.h"
 
+#include <algorithm>
+
 PlotSpectrumBase::PlotSpectrumBase(AudacityProject& project)
     : mProject { &project }
     , mAnalyst(std::make_unique<SpectrumAnalyst>())
@@ -35,86 +38,70 @@ PlotSpectrumBase::PlotSpectrumBase(AudacityProject& project)
 
 bool PlotSpectrumBase::GetAudio()
 {
-   mData.reset();
+   mTracks.clear();
    mDataLen = 0;
 
-   int selcount = 0;
-   bool warning = false;
+   auto& selectedRegion = ViewInfo::Get(*mProject).selectedRegion;
+   const auto t0 = selectedRegion.t0();
+   const auto t1 = selectedRegion.t1();
    for (auto track : TrackList::Get(*mProject).Selected<const WaveTrack>())
    {
-      auto& selectedRegion = ViewInfo::Get(*mProject).selectedRegion;
-      auto start = track->TimeToLongSamples(selectedRegion.t0());
-      if (selcount == 0)
+      if (mTracks.empty())
       {
          mRate = track->GetRate();
-         auto end = track->TimeToLongSamples(selectedRegion.t1());
-         auto dataLen = end - start;
-         // Permit approximately 46.60 minutes of selected samples at
-         // a sampling frequency of 48 kHz (11.65 minutes at 192 kHz).
-         auto maxDataLen = size_t(2) << 26;
-         if (dataLen > maxDataLen)
-         {
-            warning = true;
-            mDataLen = maxDataLen;
-         }
-         else
-            mDataLen = dataLen.as_size_t();
-         mData = Floats { mDataLen };
+         mStart = track->TimeToLongSamples(t0);
+         mDataLen = (track->TimeToLongSamples(t1) - mStart).as_size_t();
       }
-      const auto nChannels = track->NChannels();
-      if (track->GetRate() != mRate)
+      else if (track->GetRate() != mRate)
       {
          using namespace BasicUI;
          ShowMessageBox(
             XO("To plot the spectrum, all selected tracks must have the same sample rate."),
             MessageBoxOptions {}.Caption(XO("Error")).IconStyle(Icon::Error));
-         mData.reset();
+         mTracks.clear();
          mDataLen = 0;
          return false;
       }
-      Floats buffer1 { mDataLen };
-      Floats buffer2 { mDataLen };
-      float* const buffers[] { buffer1.get(), buffer2.get() };
+      // GetFloats fails on these
+      for (const auto& clip : track->Intervals())
+         if (clip->IntersectsPlayRegion(t0, t1) && clip->HasPitchOrSpeed())
+         {
+            using namespace BasicUI;
+            ShowMessageBox(
+               XO("Audio could not be analyzed. This may be due to a stretched or pitch-shifted clip.\nTry resetting any stretched clips, or mixing and rendering the tracks before analyzing"),
+               MessageBoxOptions {}.Caption(XO("Error")).IconStyle(Icon::Error));
+            mTracks.clear();
+            mDataLen = 0;
+            return false;
+         }
+      // Cheap, and unaffected by later edits
+      mTracks.push_back(
+         std::static_pointer_cast<const WaveTrack>(track->Duplicate()));
+   }
+
+   return !mTracks.empty();
+}
+
+bool PlotSpectrumBase::ReadAudio(float* buffer, size_t start, size_t len) const
+{
+   Floats buffer1 { len };
+   Floats buffer2 { len };
+   float* const buffers[] { buffer1.get(), buffer2.get() };
+   std::fill(buffer, buffer + len, 0.f);
+   for (const auto& track : mTracks)
+   {
+      const auto nChannels = track->NChannels();
       // Don't allow throw for bad reads
       if (!track->GetFloats(
-             0, nChannels, buffers, start, mDataLen, false,
+             0, nChannels, buffers, mStart + start, len, false,
              FillFormat::fillZero, false))
-      {
-         using namespace BasicUI;
-         ShowMessageBox(
-            XO("Audio could not be analyzed. This may be due to a stretched or pitch-shifted clip.\nTry resetting any stretched clips, or mixing and rendering the tracks before analyzing"),
-            MessageBoxOptions {}.Caption(XO("Error")).IconStyle(Icon::Error));
-         mData.reset();
-         mDataLen = 0;
          return false;
-      }
-      size_t iChannel = 0;
-      if (selcount == 0)
+      for (size_t iChannel = 0; iChannel < nChannels; ++iChannel)
       {
-         // First channel -- assign into mData
-         for (size_t i = 0; i < mDataLen; i++)
-            mData[i] = buffers[0][i];
-         ++iChannel;
+         const auto channel = buffers[iChannel];
+         for (size_t i = 0; i < len; i++)
+            buffer[i] += channel[i];
       }
-      // Later channels -- accumulate
-      for (; iChannel < nChannels; ++iChannel)
-      {
-         const auto buffer = buffers[iChannel];
-         for (size_t i = 0; i < mDataLen; i++)
-            mData[i] += buffer[i];
-      }
-      ++selcount;
-   }
-
-   if (selcount == 0)
-      return false;
-
-   if (warning)
-   {
-      auto msg =
-         XO("Too much audio was selected. Only the first %.1f seconds of audio will be analyzed.")
-            .Format(mDataLen / mRate);
-      BasicUI::ShowMessageBox(msg);
    }
    return true;
 }
@@ -10,11 +10,13 @@
 **********************************************************************/
 #pragma once
 
-#include "MemoryX.h"
+#include "SampleCount.h"
 #include "SpectrumAnalyst.h"
 #include <memory>
+#include <vector>
 
 class AudacityProject;
+class WaveTrack;
 
 class BUILTIN_EFFECTS_API PlotSpectrumBase
 {
@@ -22,8 +24,13 @@ public:
    PlotSpectrumBase(AudacityProject& project);
 
 protected:
+   //! Takes the selection, which is then read by ReadAudio
    bool GetAudio();
 
+   //! Sum of the channels of the selected tracks, `start` samples after the
+   //! beginning of the selection; suits SpectrumAnalyst::ReadFn
+   bool ReadAudio(float* buffer, size_t start, size_t len) const;
+
    AudacityProject* mProject;
    std::unique_ptr<SpectrumAnalyst> mAnalyst;
 
@@ -35,6 +42,9 @@ protected:
    int dBRange;
    double mRate;
    size_t mDataLen;
-   ArrayOf<float> mData;
+   //! Copies of the selected tracks as of GetAudio, sharing their sample
+   //! blocks, so that memory doesn't depend on the length of the selection
+   std::vector<std::shared_ptr<const WaveTrack>> mTracks;
+   sampleCount mStart;
    size_t mWindowSize;
 };
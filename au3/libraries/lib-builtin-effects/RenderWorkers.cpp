@@ -0,0 +1,53 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  RenderWorkers.cpp
+
+**********************************************************************/
+#include "RenderWorkers.h"
+
+#include "WaveTrack.h"
+
+#include <cassert>
+
+RenderedSamples::RenderedSamples(size_t numChannels)
+    : mNumChannels { numChannels }
+{
+}
+
+size_t RenderedSamples::GetNumChannels() const
+{
+   return mNumChannels;
+}
+
+void RenderedSamples::Put(
+   const float* interleaved, size_t stride, size_t numFrames)
+{
+   assert(stride >= mNumChannels);
+   std::lock_guard<std::mutex> lock { mMutex };
+   const auto size = mPut.size();
+   mPut.resize(size + numFrames * mNumChannels);
+   auto out = mPut.data() + size;
+   for (size_t i = 0; i < numFrames; ++i)
+      for (size_t c = 0; c < mNumChannels; ++c)
+         *out++ = interleaved[i * stride + c];
+}
+
+void RenderedSamples::AppendTo(WaveTrack& track)
+{
+   assert(track.NChannels() == mNumChannels);
+   {
+      // Keeps the capacities of both, for the next calls
+      std::lock_guard<std::mutex> lock { mMutex };
+      mAppending.swap(mPut);
+      mPut.clear();
+   }
+   const auto numFrames = mAppending.size() / mNumChannels;
+   if (numFrames > 0)
+      for (size_t c = 0; c < mNumChannels; ++c)
+         track.Append(
+            c, reinterpret_cast<constSamplePtr>(mAppending.data() + c),
+            floatSample, numFrames, mNumChannels);
+}
@@ -0,0 +1,44 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  RenderWorkers.h
+
+**********************************************************************/
+#pragma once
+
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+class WaveTrack;
+
+/*!
+ * @brief Samples rendered by a worker thread, which the thread owning the
+ * tracks appends: several threads may read tracks, but only one may write
+ * them.
+ */
+class BUILTIN_EFFECTS_API RenderedSamples final
+{
+public:
+   explicit RenderedSamples(size_t numChannels);
+
+   size_t GetNumChannels() const;
+
+   //! Called by the worker. Channel `c` of frame `i` is
+   //! `interleaved[i * stride + c]`.
+   //! @pre `stride >= GetNumChannels()`
+   void Put(const float* interleaved, size_t stride, size_t numFrames);
+
+   //! Called by the owner. Appends what was put since the last call.
+   //! @pre `track.NChannels() == GetNumChannels()`
+   void AppendTo(WaveTrack& track);
+
+private:
+   const size_t mNumChannels;
+   std::mutex mMutex;
+   // Interleaved
+   std::vector<float> mPut;
+   std::vector<float> mAppending;
+};
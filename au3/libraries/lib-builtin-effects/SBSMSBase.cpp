@@ -17,12 +17,16 @@ effect that uses SBSMS to do its processing (TimeScale)
 #include <math.h>
 
 #include "LabelTrack.h"
+#include "RenderWorkers.h"
+#include "concurrency/ThreadPool.h"
 #include "SyncLock.h"
 #include "WaveClip.h"
 #include "WaveTrack.h"
 #include "TimeWarper.h"
 
+#include <atomic>
 #include <cassert>
+#include <deque>
 
 enum {
   SBSMSOutBlockSize = 512
@@ -59,13 +63,30 @@ public:
    // Not required by callbacks, but makes for easier cleanup
    std::unique_ptr<Resampler> resampler;
    std::unique_ptr<SBSMSQuality> quality;
-   WaveTrack *outputTrack{};
-   WaveChannel *outputLeftChannel{};
-   WaveChannel *outputRightChannel{};
 
    std::exception_ptr mpException {};
 };
 
+namespace
+{
+//! A selected wave track, whose channels go through one SBSMS together
+struct TrackJob
+{
+   TrackJob(WaveTrack &track, sampleCount start, sampleCount end)
+      : track{ track }, start{ start }, end{ end }
+      , outputTrack{ track.EmptyCopy() }
+      , output{ track.NChannels() }
+   {}
+
+   WaveTrack &track;
+   const sampleCount start;
+   const sampleCount end;
+   const WaveTrack::Holder outputTrack;
+   RenderedSamples output;
+   std::atomic<double> progress{ 0.0 };
+};
+} // namespace
+
 class SBSMSEffectInterface final : public SBSMSInterfaceSliding {
 public:
    SBSMSEffectInterface(Resampler *resampler,
@@ -230,13 +251,16 @@ bool SBSMSBase::Process(EffectInstance &, EffectSettings &)
    //Iterate over each track
    //all needed because this effect needs to introduce silence in the group tracks to keep sync
    EffectOutputTracks outputs { *mTracks, GetType(), { { mT0, mT1 } }, true };
-   mCurTrackNum = 0;
 
-   double maxDuration = 0.0;
+   mTotalStretch = Slide(rateSlideType,rateStart,rateEnd).getTotalStretch();
+
+   // Duration in track time
+   const double duration = (mT1 - mT0) * mTotalStretch;
+   const auto warper = createTimeWarper(
+      mT0, mT1, duration, rateStart, rateEnd, rateSlideType);
 
-   Slide rateSlide(rateSlideType,rateStart,rateEnd);
-   Slide pitchSlide(pitchSlideType,pitchStart,pitchEnd);
-   mTotalStretch = rateSlide.getTotalStretch();
+   // Wave tracks are processed after the visit, on several threads
+   std::deque<TrackJob> jobs;
 
    outputs.Get().Any().VisitWhile(bGoodResult,
       [&](auto &&fallthrough){ return [&](LabelTrack &lt) {
@@ -253,164 +277,8 @@ bool SBSMSBase::Process(EffectInstance &, EffectSettings &)
          if (mT1 > mT0) {
             const auto start = track.TimeToLongSamples(mT0);
             const auto end = track.TimeToLongSamples(mT1);
-
-            // TODO: more-than-two-channels
-            auto channels = track.Channels();
-            const auto leftTrack = (*channels.begin()).get();
-            const auto rightTrack = (channels.size() > 1)
-               ? (* ++ channels.first).get()
-               : nullptr;
-            if (rightTrack)
-               mCurTrackNum++; // Increment for rightTrack, too.
-
-            // SBSMS has a fixed sample rate - we just convert to its sample
-            // rate and then convert back
-            const float srTrack = track.GetRate();
-            const float srProcess = bLinkRatePitch ? srTrack : 44100.0;
-
-            // the resampler needs a callback to supply its samples
-            ResampleBuf rb;
-            const auto maxBlockSize = track.GetMaxBlockSize();
-            rb.blockSize = maxBlockSize;
-            rb.buf.reinit(rb.blockSize, true);
-            rb.leftTrack = leftTrack;
-            rb.rightTrack = rightTrack ? rightTrack : leftTrack;
-            rb.leftBuffer.reinit(maxBlockSize, true);
-            rb.rightBuffer.reinit(maxBlockSize, true);
-
-            // Samples in selection
-            const auto samplesIn = end - start;
-
-            // Samples for SBSMS to process after resampling
-            const auto samplesToProcess = static_cast<sampleCount>(
-               samplesIn.as_float() * (srProcess/srTrack));
-
-            SlideType outSlideType;
-            SBSMSResampleCB outResampleCB;
-
-            if (bLinkRatePitch) {
-              rb.bPitch = true;
-              outSlideType = rateSlideType;
-              outResampleCB = resampleCB;
-              rb.offset = start;
-              rb.end = end;
-               // Third party library has its own type alias, check it
-               static_assert(sizeof(sampleCount::type) <=
-                 sizeof(_sbsms_::SampleCountType),
-"Type _sbsms_::SampleCountType is too narrow to hold a sampleCount");
-              rb.iface = std::make_unique<SBSMSInterfaceSliding>(
-                  &rateSlide, &pitchSlide, bPitchReferenceInput,
-                  static_cast<_sbsms_::SampleCountType>(
-                     samplesToProcess.as_long_long()),
-                  0, nullptr);
-            }
-            else {
-               rb.bPitch = false;
-               outSlideType =
-                  (srProcess == srTrack ? SlideIdentity : SlideConstant);
-               outResampleCB = postResampleCB;
-               rb.ratio = srProcess/srTrack;
-               rb.quality = std::make_unique<SBSMSQuality>(&SBSMSQualityStandard);
-               rb.resampler = std::make_unique<Resampler>(resampleCB, &rb,
-                  srProcess == srTrack ? SlideIdentity : SlideConstant);
-               rb.sbsms = std::make_unique<SBSMS>(
-                  rightTrack ? 2 : 1, rb.quality.get(), true);
-               rb.SBSMSBlockSize = rb.sbsms->getInputFrameSize();
-               rb.SBSMSBuf.reinit(static_cast<size_t>(rb.SBSMSBlockSize), true);
-               rb.offset = start;
-               rb.end = end;
-               rb.iface = std::make_unique<SBSMSEffectInterface>(
-                  rb.resampler.get(), &rateSlide, &pitchSlide,
-                  bPitchReferenceInput,
-                  static_cast<_sbsms_::SampleCountType>(
-                     samplesToProcess.as_long_long()),
-                  0,
-                  rb.quality.get());
-            }
-
-            Resampler resampler(outResampleCB, &rb, outSlideType);
-
-            audio outBuf[SBSMSOutBlockSize];
-            float outBufLeft[2 * SBSMSOutBlockSize];
-            float outBufRight[2 * SBSMSOutBlockSize];
-
-            // Samples in output after SBSMS
-            const sampleCount samplesToOutput = rb.iface->getSamplesToOutput();
-
-            // Samples in output after resampling back
-            const auto samplesOut = static_cast<sampleCount>(
-               samplesToOutput.as_float() * (srTrack / srProcess));
-
-            // Duration in track time
-            const double duration = (mT1 - mT0) * mTotalStretch;
-
-            if (duration > maxDuration)
-               maxDuration = duration;
-
-            const auto warper = createTimeWarper(
-               mT0, mT1, maxDuration, rateStart, rateEnd, rateSlideType);
-
-            WaveTrack::Holder outputTrack = track.EmptyCopy();
-            auto iter = outputTrack->Channels().begin();
-            rb.outputTrack = outputTrack.get();
-            rb.outputLeftChannel = (*iter++).get();
-            if (rightTrack)
-               rb.outputRightChannel = (*iter).get();
-
-            long pos = 0;
-            long outputCount = -1;
-
-            // process
-            while (pos < samplesOut && outputCount) {
-               const auto frames =
-                  limitSampleBufferSize(SBSMSOutBlockSize, samplesOut - pos);
-
-               outputCount = resampler.read(outBuf, frames);
-               for (int i = 0; i < outputCount; ++i) {
-                  outBufLeft[i] = outBuf[i][0];
-                  if (rightTrack)
-                     outBufRight[i] = outBuf[i][1];
-               }
-               pos += outputCount;
-               rb.outputLeftChannel->Append(
-                  (samplePtr)outBufLeft, floatSample, outputCount);
-               if (rightTrack)
-                  rb.outputRightChannel->Append(
-                     (samplePtr)outBufRight, floatSample, outputCount);
-
-               double frac = static_cast<double>(pos) / samplesOut.as_double();
-               int nWhichTrack = mCurTrackNum;
-               if (rightTrack) {
-                  nWhichTrack = 2 * (mCurTrackNum / 2);
-                  if (frac < 0.5)
-                     // Show twice as far for each track,
-                     // because we're doing 2 at once.
-                     frac *= 2.0;
-                  else {
-                     nWhichTrack++;
-                     frac -= 0.5;
-                     // Show twice as far for each track,
-                     // because we're doing 2 at once.
-                     frac *= 2.0;
-                  }
-               }
-               if (TrackProgress(nWhichTrack, frac)) {
-                  bGoodResult = false;
-                  return;
-               }
-            }
-
-            {
-               auto pException = rb.mpException;
-               rb.mpException = {};
-               if (pException)
-                  std::rethrow_exception(pException);
-            }
-
-            rb.outputTrack->Flush();
-            Finalize(track, *outputTrack, *warper);
+            jobs.emplace_back(track, start, end);
          }
-         mCurTrackNum++;
       }; },
       [&](Track &t) {
          if (SyncLock::IsSyncLockSelected(t))
@@ -418,6 +286,153 @@ bool SBSMSBase::Process(EffectInstance &, EffectSettings &)
       }
    );
 
+   // Called from a worker thread
+   const auto render = [&](TrackJob &job, const std::atomic<bool> &cancelled) {
+      auto &track = job.track;
+      const auto start = job.start;
+      const auto end = job.end;
+
+      // TODO: more-than-two-channels
+      auto channels = track.Channels();
+      const auto leftTrack = (*channels.begin()).get();
+      const auto rightTrack = (channels.size() > 1)
+         ? (* ++ channels.first).get()
+         : nullptr;
+
+      // Slides may have state, so each job has its own
+      Slide rateSlide(rateSlideType,rateStart,rateEnd);
+      Slide pitchSlide(pitchSlideType,pitchStart,pitchEnd);
+
+      // SBSMS has a fixed sample rate - we just convert to its sample
+      // rate and then convert back
+      const float srTrack = track.GetRate();
+      const float srProcess = bLinkRatePitch ? srTrack : 44100.0;
+
+      // the resampler needs a callback to supply its samples
+      ResampleBuf rb;
+      const auto maxBlockSize = track.GetMaxBlockSize();
+      rb.blockSize = maxBlockSize;
+      rb.buf.reinit(rb.blockSize, true);
+      rb.leftTrack = leftTrack;
+      rb.rightTrack = rightTrack ? rightTrack : leftTrack;
+      rb.leftBuffer.reinit(maxBlockSize, true);
+      rb.rightBuffer.reinit(maxBlockSize, true);
+
+      // Samples in selection
+      const auto samplesIn = end - start;
+
+      // Samples for SBSMS to process after resampling
+      const auto samplesToProcess = static_cast<sampleCount>(
+         samplesIn.as_float() * (srProcess/srTrack));
+
+      SlideType outSlideType;
+      SBSMSResampleCB outResampleCB;
+
+      if (bLinkRatePitch) {
+        rb.bPitch = true;
+        outSlideType = rateSlideType;
+        outResampleCB = resampleCB;
+        rb.offset = start;
+        rb.end = end;
+         // Third party library has its own type alias, check it
+         static_assert(sizeof(sampleCount::type) <=
+           sizeof(_sbsms_::SampleCountType),
+"Type _sbsms_::SampleCountType is too narrow to hold a sampleCount");
+        rb.iface = std::make_unique<SBSMSInterfaceSliding>(
+            &rateSlide, &pitchSlide, bPitchReferenceInput,
+            static_cast<_sbsms_::SampleCountType>(
+               samplesToProcess.as_long_long()),
+            0, nullptr);
+      }
+      else {
+         rb.bPitch = false;
+         outSlideType =
+            (srProcess == srTrack ? SlideIdentity : SlideConstant);
+         outResampleCB = postResampleCB;
+         rb.ratio = srProcess/srTrack;
+         rb.quality = std::make_unique<SBSMSQuality>(&SBSMSQualityStandard);
+         rb.resampler = std::make_unique<Resampler>(resampleCB, &rb,
+            srProcess == srTrack ? SlideIdentity : SlideConstant);
+         rb.sbsms = std::make_unique<SBSMS>(
+            rightTrack ? 2 : 1, rb.quality.get(), true);
+         rb.SBSMSBlockSize = rb.sbsms->getInputFrameSize();
+         rb.SBSMSBuf.reinit(static_cast<size_t>(rb.SBSMSBlockSize), true);
+         rb.offset = start;
+         rb.end = end;
+         rb.iface = std::make_unique<SBSMSEffectInterface>(
+            rb.resampler.get(), &rateSlide, &pitchSlide,
+            bPitchReferenceInput,
+            static_cast<_sbsms_::SampleCountType>(
+               samplesToProcess.as_long_long()),
+            0,
+            rb.quality.get());
+      }
+
+      Resampler resampler(outResampleCB, &rb, outSlideType);
+
+      audio outBuf[SBSMSOutBlockSize];
+      float outBufLeft[2 * SBSMSOutBlockSize];
+      float outBufRight[2 * SBSMSOutBlockSize];
+
+      // Samples in output after SBSMS
+      const sampleCount samplesToOutput = rb.iface->getSamplesToOutput();
+
+      // Samples in output after resampling back
+      const auto samplesOut = static_cast<sampleCount>(
+         samplesToOutput.as_float() * (srTrack / srProcess));
+
+      long pos = 0;
+      long outputCount = -1;
+
+      // process
+      while (pos < samplesOut && outputCount) {
+         if (cancelled)
+            return;
+
+         const auto frames =
+            limitSampleBufferSize(SBSMSOutBlockSize, samplesOut - pos);
+
+         outputCount = resampler.read(outBuf, frames);
+         job.output.Put(
+            outBuf[0], sizeof(audio) / sizeof(float), outputCount);
+         pos += outputCount;
+         job.progress =
+            static_cast<double>(pos) / samplesOut.as_double();
+      }
+
+      {
+         auto pException = rb.mpException;
+         rb.mpException = {};
+         if (pException)
+            std::rethrow_exception(pException);
+      }
+   };
+
+   if (bGoodResult && !jobs.empty()) {
+      // Workers only read the tracks; this thread appends what they render
+      double totalLength = 0;
+      for (const auto &job : jobs)
+         totalLength += (job.end - job.start).as_double();
+      bGoodResult = audacity::concurrency::RenderInParallel(jobs.size(),
+         [&](size_t iJob, const std::atomic<bool> &cancelled) {
+            render(jobs[iJob], cancelled);
+         },
+         [&]{
+            double done = 0;
+            for (auto &job : jobs) {
+               job.output.AppendTo(*job.outputTrack);
+               done += job.progress * (job.end - job.start).as_double();
+            }
+            return !TotalProgress(totalLength > 0 ? done / totalLength : 1.0);
+         });
+   }
+
+   if (bGoodResult)
+      for (auto &job : jobs) {
+         job.outputTrack->Flush();
+         Finalize(job.track, *job.outputTrack, *warper);
+      }
+
    if (bGoodResult)
       outputs.Commit();
 
@@ -135,8 +135,10 @@ unsigned ScienFilterBase::GetAudioOutCount() const
 bool ScienFilterBase::ProcessInitialize(
    EffectSettings&, double, ChannelNames chanMap)
 {
-   for (int iPair = 0; iPair < (mOrder + 1) / 2; iPair++)
-      mpBiquad[iPair].Reset();
+   const auto numPairs = (mOrder + 1) / 2;
+   mCascade.emplace(1, numPairs);
+   for (int iPair = 0; iPair < numPairs; iPair++)
+      mCascade->SetSection(iPair, mpBiquad[iPair]);
    return true;
 }
 
@@ -144,13 +146,7 @@ size_t ScienFilterBase::ProcessBlock(
    EffectSettings&, const float* const* inBlock, float* const* outBlock,
    size_t blockLen)
 {
-   const float* ibuf = inBlock[0];
-   for (int iPair = 0; iPair < (mOrder + 1) / 2; iPair++)
-   {
-      mpBiquad[iPair].Process(ibuf, outBlock[0], blockLen);
-      ibuf = outBlock[0];
-   }
-
+   mCascade->Process(inBlock[0], outBlock[0], blockLen);
    return blockLen;
 }
 
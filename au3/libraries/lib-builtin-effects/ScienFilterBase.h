@@ -12,9 +12,11 @@ Vaughan Johnson (Preview)
 #pragma once
 
 #include "Biquad.h"
+#include "BiquadCascade.h"
 #include "ShuttleAutomation.h"
 #include "StatefulPerTrackEffect.h"
 #include <cfloat> // for FLT_MAX
+#include <optional>
 
 class BUILTIN_EFFECTS_API ScienFilterBase : public StatefulPerTrackEffect
 {
@@ -66,6 +68,8 @@ protected:
    int mOrder;
    int mOrderIndex;
    ArrayOf<Biquad> mpBiquad;
+   //! mpBiquad, as filtered by ProcessBlock
+   std::optional<BiquadCascade> mCascade;
 
    double mdBMax;
    double mdBMin;
@@ -21,6 +21,8 @@ effect that uses SoundTouch to do its processing (ChangeTempo
 #include <math.h>
 
 #include "LabelTrack.h"
+#include "RenderWorkers.h"
+#include "concurrency/ThreadPool.h"
 #include "SyncLock.h"
 #include "WaveClip.h"
 #include "WaveTrack.h"
@@ -41,6 +43,95 @@ effect that uses SoundTouch to do its processing (ChangeTempo
 #undef VERSION
 #include "SoundTouch.h"
 
+#include <algorithm>
+#include <atomic>
+#include <deque>
+
+namespace
+{
+//! A selected wave track, whose channels go through one SoundTouch together
+struct TrackJob
+{
+   TrackJob(WaveTrack &orig, sampleCount start, sampleCount end)
+      : orig{ orig }, start{ start }, end{ end }
+      , out{ orig.EmptyCopy() }
+      , output{ orig.NChannels() }
+   {}
+
+   WaveTrack &orig;
+   const sampleCount start;
+   const sampleCount end;
+   const WaveTrack::Holder out;
+   std::unique_ptr<soundtouch::SoundTouch> pSoundTouch;
+   RenderedSamples output;
+   std::atomic<double> progress{ 0.0 };
+};
+
+//! Called from a worker thread
+void Render(TrackJob &job, const std::atomic<bool> &cancelled)
+{
+   const auto &orig = job.orig;
+   const auto pSoundTouch = job.pSoundTouch.get();
+   const auto numChannels = orig.NChannels();
+
+   //Get the length of the buffer (as double). len is
+   //used simple to calculate a progress meter, so it is easier
+   //to make it a double now than it is to do it later
+   const auto len = (job.end - job.start).as_double();
+
+   //Initiate a processing buffer.  This buffer will (most likely)
+   //be shorter than the length of the track being processed.
+   // Make soundTouchBuffer numChannels times as big, because Soundtouch
+   // wants the channels interleaved.
+   const auto maxBlockSize = orig.GetMaxBlockSize();
+   Floats buffer{ maxBlockSize };
+   Floats soundTouchBuffer{ maxBlockSize * numChannels };
+
+   const auto receive = [&]{
+      //Get back samples from SoundTouch
+      const unsigned int outputCount = pSoundTouch->numSamples();
+      if (outputCount > 0) {
+         Floats outputBuffer{ outputCount * numChannels };
+         pSoundTouch->receiveSamples(outputBuffer.get(), outputCount);
+         job.output.Put(outputBuffer.get(), numChannels, outputCount);
+      }
+   };
+
+   //Go through the track one buffer at a time. s counts which
+   //sample the current buffer starts at.
+   auto s = job.start;
+   while (s < job.end) {
+      if (cancelled)
+         return;
+
+      //Get a block of samples (smaller than the size of the buffer)
+      const auto block = std::min<size_t>(8192,
+         limitSampleBufferSize(orig.GetBestBlockSize(s), job.end - s));
+
+      //Get the samples from the track and interleave them
+      size_t iChannel = 0;
+      for (const auto pChannel : orig.Channels()) {
+         pChannel->GetFloats(buffer.get(), s, block);
+         for (size_t index = 0; index < block; ++index)
+            soundTouchBuffer[index * numChannels + iChannel] = buffer[index];
+         ++iChannel;
+      }
+
+      //Add samples to SoundTouch
+      pSoundTouch->putSamples(soundTouchBuffer.get(), block);
+      receive();
+
+      //Increment s one blockfull of samples
+      s += block;
+      job.progress = (s - job.start).as_double() / len;
+   }
+
+   // Tell SoundTouch to finish processing any remaining samples
+   pSoundTouch->flush();   // this should only be used for changeTempo - it dumps data otherwise with pRateTransposer->clear();
+   receive();
+}
+} // namespace
+
 #ifdef USE_MIDI
 SoundTouchBase::SoundTouchBase()
 {
@@ -91,9 +182,11 @@ bool SoundTouchBase::ProcessWithTimeWarper(InitFunction initer,
    bool bGoodResult = true;
 
    mPreserveLength = preserveLength;
-   mCurTrackNum = 0;
    m_maxNewLength = 0.0;
 
+   // Wave tracks are processed after the visit, on several threads
+   std::deque<TrackJob> jobs;
+
    outputs.Get().Any().VisitWhile(bGoodResult,
       [&](auto &&fallthrough){ return [&](LabelTrack &lt) {
          if ( !(lt.GetSelected() ||
@@ -121,36 +214,13 @@ bool SoundTouchBase::ProcessWithTimeWarper(InitFunction initer,
             const auto start = orig.TimeToLongSamples(mT0);
             const auto end = orig.TimeToLongSamples(mT1);
 
-            const auto tempTrack = orig.EmptyCopy();
-            auto &out = *tempTrack;
-
-            const auto pSoundTouch = std::make_unique<soundtouch::SoundTouch>();
-            initer(pSoundTouch.get());
-
-            // TODO: more-than-two-channels
-            auto channels = orig.Channels();
-            if (channels.size() > 1) {
-
-               //Inform soundtouch there's 2 channels
-               pSoundTouch->setChannels(2);
-
-               //ProcessStereo() (implemented below) processes a stereo track
-               if (!ProcessStereo(pSoundTouch.get(),
-                  orig, out, start, end, warper))
-                  bGoodResult = false;
-               mCurTrackNum++; // Increment for rightTrack, too.
-            } else {
-               //Inform soundtouch there's a single channel
-               pSoundTouch->setChannels(1);
-
-               //ProcessOne() (implemented below) processes a single track
-               if (!ProcessOne(pSoundTouch.get(), **channels.begin(),
-                     out, start, end, warper))
-                  bGoodResult = false;
-            }
-            // pSoundTouch is destroyed here
+            auto &job = jobs.emplace_back(orig, start, end);
+            job.pSoundTouch = std::make_unique<soundtouch::SoundTouch>();
+            initer(job.pSoundTouch.get());
+            job.pSoundTouch->setChannels(orig.NChannels());
+            job.pSoundTouch->setSampleRate(
+               static_cast<unsigned int>(orig.GetRate() + 0.5));
          }
-         mCurTrackNum++;
       }; },
       [&](Track &t) {
          if (mustSync && SyncLock::IsSyncLockSelected(t))
@@ -158,214 +228,41 @@ bool SoundTouchBase::ProcessWithTimeWarper(InitFunction initer,
       }
    );
 
-   if (bGoodResult)
-      outputs.Commit();
-
-   return bGoodResult;
-}
-
-//ProcessOne() takes a track, transforms it to bunch of buffer-blocks,
-//and executes ProcessSoundTouch on these blocks
-bool SoundTouchBase::ProcessOne(soundtouch::SoundTouch *pSoundTouch,
-   WaveChannel &orig, WaveTrack &out,
-   sampleCount start, sampleCount end,
-   const TimeWarper &warper)
-{
-   // ProcessStereo handles the stereo case instead.  This is a precondition
-   // for Append:
-   assert(out.NChannels() == 1);
-
-   pSoundTouch->setSampleRate(
-      static_cast<unsigned int>((orig.GetRate() + 0.5)));
-
-   //Get the length of the buffer (as double). len is
-   //used simple to calculate a progress meter, so it is easier
-   //to make it a double now than it is to do it later
-   auto len = (end - start).as_double();
-
-   {
-      //Initiate a processing buffer.  This buffer will (most likely)
-      //be shorter than the length of the track being processed.
-      Floats buffer{ orig.GetMaxBlockSize() };
-
-      //Go through the track one buffer at a time. s counts which
-      //sample the current buffer starts at.
-      auto s = start;
-      while (s < end) {
-         //Get a block of samples (smaller than the size of the buffer)
-         const auto block = std::min<size_t>(8192,
-            limitSampleBufferSize(orig.GetBestBlockSize(s), end - s));
-
-         //Get the samples from the track and put them in the buffer
-         orig.GetFloats(buffer.get(), s, block);
-
-         //Add samples to SoundTouch
-         pSoundTouch->putSamples(buffer.get(), block);
-
-         //Get back samples from SoundTouch
-         unsigned int outputCount = pSoundTouch->numSamples();
-         if (outputCount > 0) {
-            Floats buffer2{ outputCount };
-            pSoundTouch->receiveSamples(buffer2.get(), outputCount);
-            out.Append(0, (samplePtr)buffer2.get(), floatSample, outputCount);
-         }
-
-         //Increment s one blockfull of samples
-         s += block;
-
-         //Update the Progress meter
-         if (TrackProgress(mCurTrackNum, (s - start).as_double() / len))
-            return false;
-      }
-
-      // Tell SoundTouch to finish processing any remaining samples
-      pSoundTouch->flush();   // this should only be used for changeTempo - it dumps data otherwise with pRateTransposer->clear();
-
-      unsigned int outputCount = pSoundTouch->numSamples();
-      if (outputCount > 0) {
-         Floats buffer2{ outputCount };
-         pSoundTouch->receiveSamples(buffer2.get(), outputCount);
-         out.Append(0, (samplePtr)buffer2.get(), floatSample, outputCount);
-      }
-
-      out.Flush();
+   if (bGoodResult && !jobs.empty()) {
+      // Workers only read the tracks; this thread appends what they render
+      double totalLength = 0;
+      for (const auto &job : jobs)
+         totalLength += (job.end - job.start).as_double();
+      bGoodResult = audacity::concurrency::RenderInParallel(jobs.size(),
+         [&](size_t iJob, const std::atomic<bool> &cancelled) {
+            Render(jobs[iJob], cancelled);
+         },
+         [&]{
+            double done = 0;
+            for (auto &job : jobs) {
+               job.output.AppendTo(*job.out);
+               done += job.progress * (job.end - job.start).as_double();
+            }
+            return !TotalProgress(totalLength > 0 ? done / totalLength : 1.0);
+         });
    }
 
-   // Transfer output samples to the original
-   Finalize(orig.GetTrack(), out, warper);
-
-   double newLength = out.GetEndTime();
-   m_maxNewLength = std::max(m_maxNewLength, newLength);
-
-   //Return true because the effect processing succeeded.
-   return true;
-}
-
-bool SoundTouchBase::ProcessStereo(soundtouch::SoundTouch *pSoundTouch,
-   WaveTrack &orig, WaveTrack &outputTrack,
-   sampleCount start, sampleCount end, const TimeWarper &warper)
-{
-   pSoundTouch->setSampleRate(
-      static_cast<unsigned int>(orig.GetRate() + 0.5));
-
-   auto channels = orig.Channels();
-   auto &leftTrack = **channels.first++;
-   auto &rightTrack = **channels.first;
-
-   auto newChannels = outputTrack.Channels();
-   auto &outputLeftTrack = **newChannels.first++;
-   auto &outputRightTrack = **newChannels.first;
+   if (bGoodResult)
+      for (auto &job : jobs) {
+         job.out->Flush();
 
-   //Get the length of the buffer (as double). len is
-   //used simple to calculate a progress meter, so it is easier
-   //to make it a double now than it is to do it later
-   double len = (end - start).as_double();
+         // Transfer output samples to the original
+         Finalize(job.orig, *job.out, warper);
 
-   //Initiate a processing buffer.  This buffer will (most likely)
-   //be shorter than the length of the track being processed.
-   // Make soundTouchBuffer twice as big as MaxBlockSize for each channel,
-   // because Soundtouch wants them interleaved, i.e., each
-   // Soundtouch sample is left-right pair.
-   auto maxBlockSize = orig.GetMaxBlockSize();
-   {
-      Floats leftBuffer{ maxBlockSize };
-      Floats rightBuffer{ maxBlockSize };
-      Floats soundTouchBuffer{ maxBlockSize * 2 };
-
-      // Go through the track one stereo buffer at a time.
-      // sourceSampleCount counts the sample at which the current buffer starts,
-      // per channel.
-      auto sourceSampleCount = start;
-      while (sourceSampleCount < end) {
-         auto blockSize = limitSampleBufferSize(
-            orig.GetBestBlockSize(sourceSampleCount),
-            end - sourceSampleCount
-         );
-
-         // Get the samples from the tracks and put them in the buffers.
-         leftTrack.GetFloats((leftBuffer.get()), sourceSampleCount, blockSize);
-         rightTrack
-            .GetFloats((rightBuffer.get()), sourceSampleCount, blockSize);
-
-         // Interleave into soundTouchBuffer.
-         for (decltype(blockSize) index = 0; index < blockSize; index++) {
-            soundTouchBuffer[index * 2] = leftBuffer[index];
-            soundTouchBuffer[(index * 2) + 1] = rightBuffer[index];
-         }
-
-         //Add samples to SoundTouch
-         pSoundTouch->putSamples(soundTouchBuffer.get(), blockSize);
-
-         //Get back samples from SoundTouch
-         unsigned int outputCount = pSoundTouch->numSamples();
-         if (outputCount > 0)
-            this->ProcessStereoResults(pSoundTouch,
-               outputCount, outputLeftTrack, outputRightTrack);
-
-         //Increment sourceSampleCount one blockfull of samples
-         sourceSampleCount += blockSize;
-
-         //Update the Progress meter
-         // mCurTrackNum is left track. Include right track.
-         int nWhichTrack = mCurTrackNum;
-         double frac = (sourceSampleCount - start).as_double() / len;
-         if (frac < 0.5)
-            frac *= 2.0; // Show twice as far for each track, because we're doing 2 at once.
-         else
-         {
-            nWhichTrack++;
-            frac -= 0.5;
-            frac *= 2.0; // Show twice as far for each track, because we're doing 2 at once.
-         }
-         if (TrackProgress(nWhichTrack, frac))
-            return false;
+         // Track the longest result length
+         double newLength = job.out->GetEndTime();
+         m_maxNewLength = std::max(m_maxNewLength, newLength);
       }
 
-      // Tell SoundTouch to finish processing any remaining samples
-      pSoundTouch->flush();
-
-      unsigned int outputCount = pSoundTouch->numSamples();
-      if (outputCount > 0)
-         this->ProcessStereoResults(pSoundTouch,
-            outputCount, outputLeftTrack, outputRightTrack);
-
-      outputTrack.Flush();
-   }
-
-   // Transfer output samples to the original
-   Finalize(orig, outputTrack, warper);
-
-
-   // Track the longest result length
-   double newLength = outputTrack.GetEndTime();
-   m_maxNewLength = std::max(m_maxNewLength, newLength);
-
-   //Return true because the effect processing succeeded.
-   return true;
-}
-
-bool SoundTouchBase::ProcessStereoResults(soundtouch::SoundTouch *pSoundTouch,
-   const size_t outputCount,
-   WaveChannel &outputLeftTrack,
-   WaveChannel &outputRightTrack)
-{
-   Floats outputSoundTouchBuffer{ outputCount * 2 };
-   pSoundTouch->receiveSamples(outputSoundTouchBuffer.get(), outputCount);
-
-   // Dis-interleave outputSoundTouchBuffer into separate track buffers.
-   Floats outputLeftBuffer{ outputCount };
-   Floats outputRightBuffer{ outputCount };
-   for (unsigned int index = 0; index < outputCount; ++index) {
-      outputLeftBuffer[index] = outputSoundTouchBuffer[index * 2];
-      outputRightBuffer[index] = outputSoundTouchBuffer[(index * 2) + 1];
-   }
-
-   outputLeftTrack.Append(
-      (samplePtr)outputLeftBuffer.get(), floatSample, outputCount);
-   outputRightTrack.Append(
-      (samplePtr)outputRightBuffer.get(), floatSample, outputCount);
+   if (bGoodResult)
+      outputs.Commit();
 
-   return true;
+   return bGoodResult;
 }
 
 void SoundTouchBase::Finalize(
@@ -27,7 +27,6 @@ namespace soundtouch { class SoundTouch; }
 class TimeWarper;
 class LabelTrack;
 class NoteTrack;
-class WaveChannel;
 class WaveTrack;
 
 class BUILTIN_EFFECTS_API SoundTouchBase /* not final */ : public StatefulEffect
@@ -55,17 +54,6 @@ private:
 #ifdef USE_MIDI
    bool ProcessNoteTrack(NoteTrack *track, const TimeWarper &warper);
 #endif
-   bool ProcessOne(soundtouch::SoundTouch *pSoundTouch,
-      WaveChannel &orig, WaveTrack &out, sampleCount start, sampleCount end,
-      const TimeWarper &warper);
-   bool ProcessStereo(soundtouch::SoundTouch *pSoundTouch,
-      WaveTrack &orig, WaveTrack &out,
-      sampleCount start, sampleCount end,
-      const TimeWarper &warper);
-   bool ProcessStereoResults(soundtouch::SoundTouch *pSoundTouch,
-      const size_t outputCount,
-      WaveChannel &outputLeftTrack,
-      WaveChannel &outputRightTrack);
    /*!
     @pre `out.NChannels() == orig.NChannels()`
     */
@@ -73,8 +61,6 @@ private:
 
    bool   mPreserveLength;
 
-   int    mCurTrackNum;
-
    double m_maxNewLength;
 };
 
@@ -0,0 +1,113 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  PaulstretchBaseTests.cpp
+
+**********************************************************************/
+#include "PaulstretchBase.h"
+#include "concurrency/ThreadPool.h"
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace
+{
+constexpr auto rate = 44100.0;
+constexpr size_t bufferSize = 1024;
+constexpr auto numSamples = 44100;
+
+//! A sine, and silence after the end of the input
+void ReadSine(float* buffer, sampleCount start, size_t length)
+{
+   for (size_t i = 0; i < length; ++i)
+   {
+      const auto sample = (start + i).as_long_long();
+      buffer[i] = sample < numSamples ? std::sin(0.05 * sample) : 0.f;
+   }
+}
+
+bool Continue(double)
+{
+   return true;
+}
+} // namespace
+
+TEST_CASE("PaulstretchBase::Stretch")
+{
+   SECTION("the number of segments doesn't change the length of the output")
+   {
+      std::vector<size_t> lengths;
+      for (size_t framesPerSegment : { 1, 3, 8, 1000 })
+      {
+         size_t length = 0;
+         REQUIRE(PaulstretchBase::Stretch(
+            4, bufferSize, rate, numSamples, framesPerSegment, 0, ReadSine,
+            [&](const float*, size_t numAppended) { length += numAppended; },
+            Continue));
+         lengths.push_back(length);
+      }
+      REQUIRE(lengths[0] > 3 * numSamples);
+      REQUIRE(lengths[0] % bufferSize == 0);
+      REQUIRE(std::all_of(lengths.begin(), lengths.end(), [&](size_t length) {
+         return length == lengths[0];
+      }));
+   }
+
+   SECTION("cancelling waits for the workers")
+   {
+      std::atomic<int> numReading { 0 };
+      std::atomic<int> numReads { 0 };
+      const auto slowRead = [&](float* buffer, sampleCount start, size_t length) {
+         ++numReading;
+         ++numReads;
+         std::this_thread::sleep_for(std::chrono::milliseconds(10));
+         ReadSine(buffer, start, length);
+         --numReading;
+      };
+      REQUIRE(!PaulstretchBase::Stretch(
+         4, bufferSize, rate, numSamples, 1, 0, slowRead,
+         [](const float*, size_t) {}, [](double) { return false; }));
+      REQUIRE(numReading == 0);
+
+      // Nothing goes on reading either
+      const int numReadsBefore = numReads;
+      std::this_thread::sleep_for(std::chrono::milliseconds(50));
+      REQUIRE(numReads == numReadsBefore);
+   }
+
+   SECTION("workers don't run ahead of a slow append")
+   {
+      std::mutex mutex;
+      auto numReads = 0;
+      auto maxAhead = 0;
+      std::atomic<int> numAppends { 0 };
+      const auto countingRead =
+         [&](float* buffer, sampleCount start, size_t length) {
+            {
+               std::lock_guard<std::mutex> lock { mutex };
+               maxAhead = std::max(maxAhead, ++numReads - numAppends);
+            }
+            ReadSine(buffer, start, length);
+         };
+      REQUIRE(PaulstretchBase::Stretch(
+         4, bufferSize, rate, numSamples, 1, 0, countingRead,
+         [&](const float*, size_t) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            ++numAppends;
+         },
+         Continue));
+      // Each segment reads once, and the start of the selection once more
+      const auto numThreads = static_cast<int>(
+         audacity::concurrency::ThreadPool::Get().GetNumThreads());
+      REQUIRE(maxAhead <= numThreads + 1);
+   }
+}
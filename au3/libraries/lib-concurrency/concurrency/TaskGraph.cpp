@@ -0,0 +1,189 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ * SPDX-FileName: TaskGraph.cpp
+ */
+
+#include "TaskGraph.h"
+
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+
+#include "ICancellable.h"
+
+namespace audacity::concurrency
+{
+struct TaskGraph::State final :
+    ICancellable,
+    std::enable_shared_from_this<State>
+{
+   struct Node final
+   {
+      Task task;
+      std::vector<TaskId> dependents;
+      size_t numDependencies = 0;
+      std::atomic<size_t> remaining { 0 };
+   };
+
+   State(ThreadPool& pool, TaskPriority priority)
+       : pool { pool }
+       , priority { priority }
+   {
+   }
+
+   void Cancel() override
+   {
+      cancelled = true;
+   }
+
+   bool IsDone()
+   {
+      std::lock_guard<std::mutex> lock { mutex };
+      return numEnded == nodes.size();
+   }
+
+   void Schedule(TaskId id)
+   {
+      pool.Submit([self = shared_from_this(), id] { self->Run(id); }, priority);
+   }
+
+   void Run(TaskId id)
+   {
+      auto& node = *nodes[id];
+      if (!cancelled)
+      {
+         try
+         {
+            node.task();
+         }
+         catch (...)
+         {
+            {
+               std::lock_guard<std::mutex> lock { mutex };
+               if (!error)
+                  error = std::current_exception();
+            }
+            cancelled = true;
+         }
+      }
+      // Release what the task captured as soon as possible
+      node.task = nullptr;
+
+      // Skipped tasks end too, so that Wait() returns.
+      for (auto dependent : node.dependents)
+         if (--nodes[dependent]->remaining == 0)
+            Schedule(dependent);
+
+      std::lock_guard<std::mutex> lock { mutex };
+      if (++numEnded == nodes.size())
+         ended.notify_all();
+   }
+
+   ThreadPool& pool;
+   const TaskPriority priority;
+   std::vector<std::unique_ptr<Node>> nodes;
+   std::atomic<bool> cancelled { false };
+
+   std::mutex mutex;
+   std::condition_variable ended;
+   size_t numEnded = 0;
+   std::exception_ptr error;
+};
+
+TaskGraph::TaskGraph(
+   ThreadPool& pool, TaskPriority priority,
+   CancellationContextPtr cancellationContext)
+    : mState { std::make_shared<State>(pool, priority) }
+{
+   if (cancellationContext)
+      cancellationContext->OnCancelled(mState);
+}
+
+TaskGraph::~TaskGraph()
+{
+   if (!mStarted || mWaited)
+      return;
+   Cancel();
+   try
+   {
+      Wait();
+   }
+   catch (...)
+   {
+   }
+}
+
+TaskGraph::TaskId TaskGraph::Add(Task task, std::vector<TaskId> dependencies)
+{
+   assert(!mStarted);
+   auto& nodes = mState->nodes;
+   const auto id = nodes.size();
+   auto node = std::make_unique<State::Node>();
+   node->task = std::move(task);
+   node->numDependencies = dependencies.size();
+   for (auto dependency : dependencies)
+   {
+      assert(dependency < id);
+      nodes[dependency]->dependents.push_back(id);
+   }
+   nodes.push_back(std::move(node));
+   return id;
+}
+
+TaskGraph::TaskId TaskGraph::Then(TaskId task, Task continuation)
+{
+   return Add(std::move(continuation), { task });
+}
+
+void TaskGraph::Start()
+{
+   assert(!mStarted);
+   mStarted = true;
+   auto& nodes = mState->nodes;
+   // All counts are set before any task can end and decrement one
+   for (auto& node : nodes)
+      node->remaining = node->numDependencies;
+   for (TaskId id = 0; id < nodes.size(); ++id)
+      if (nodes[id]->numDependencies == 0)
+         mState->Schedule(id);
+}
+
+void TaskGraph::Wait()
+{
+   assert(mStarted);
+   mWaited = true;
+   auto& state = *mState;
+   const auto isWorker = state.pool.IsWorkerThread();
+   while (!state.IsDone())
+   {
+      // Blocking a worker could leave nobody to run the tasks: help instead.
+      if (isWorker && state.pool.RunOne(state.priority))
+         continue;
+
+      std::unique_lock<std::mutex> lock { state.mutex };
+      const auto isDone = [&] { return state.numEnded == state.nodes.size(); };
+      if (isWorker)
+         // Tasks of the graph may become ready to help with meanwhile.
+         state.ended.wait_for(lock, std::chrono::milliseconds { 1 }, isDone);
+      else
+         state.ended.wait(lock, isDone);
+   }
+
+   std::lock_guard<std::mutex> lock { state.mutex };
+   if (state.error)
+      std::rethrow_exception(state.error);
+}
+
+void TaskGraph::Cancel()
+{
+   mState->Cancel();
+}
+
+bool TaskGraph::IsCancelled() const
+{
+   return mState->cancelled;
+}
+} // namespace audacity::concurrency
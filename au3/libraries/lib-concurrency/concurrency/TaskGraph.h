@@ -0,0 +1,70 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ * SPDX-FileName: TaskGraph.h
+ */
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "CancellationContext.h"
+#include "ThreadPool.h"
+
+namespace audacity::concurrency
+{
+/*!
+ * @brief Tasks run on a ThreadPool, each after those it depends on.
+ *
+ * @details Tasks are added, then the graph starts and cannot change. A task
+ * starts as soon as all its dependencies ended, e.g. a diamond of four tasks
+ * runs the two in the middle at the same time.
+ *
+ * Once cancelled, tasks not started yet are skipped; those that run may check
+ * IsCancelled() to return early. A task throwing cancels the graph, and Wait()
+ * rethrows.
+ */
+class CONCURRENCY_API TaskGraph final
+{
+public:
+   using TaskId = size_t;
+   using Task = std::function<void()>;
+
+   //! @param cancellationContext if not null, cancels the graph too
+   explicit TaskGraph(
+      ThreadPool& pool = ThreadPool::Get(),
+      TaskPriority priority = TaskPriority::Interactive,
+      CancellationContextPtr cancellationContext = {});
+
+   //! Cancels and waits, if started and not waited
+   ~TaskGraph();
+
+   TaskGraph(const TaskGraph&)            = delete;
+   TaskGraph& operator=(const TaskGraph&) = delete;
+
+   //! @pre not started
+   //! @pre each of `dependencies` was returned by this graph
+   TaskId Add(Task task, std::vector<TaskId> dependencies = {});
+
+   //! Same as `Add(std::move(continuation), { task })`
+   TaskId Then(TaskId task, Task continuation);
+
+   void Start();
+
+   //! Waits until all tasks ended or were skipped, then rethrows the first
+   //! exception of a task, if any. On a worker of the pool, runs other tasks
+   //! meanwhile, so that graphs may nest.
+   //! @pre started
+   void Wait();
+
+   void Cancel();
+   bool IsCancelled() const;
+
+private:
+   struct State;
+   const std::shared_ptr<State> mState;
+   bool mStarted = false;
+   bool mWaited = false;
+};
+} // namespace audacity::concurrency
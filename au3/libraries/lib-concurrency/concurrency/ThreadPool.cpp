@@ -0,0 +1,344 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ * SPDX-FileName: ThreadPool.cpp
+ */
+
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+namespace audacity::concurrency
+{
+namespace
+{
+// The pool of which the calling thread is a worker, if any, and its index
+thread_local const ThreadPool* tlsPool = nullptr;
+thread_local size_t tlsWorkerIndex = 0;
+
+size_t GetDefaultNumThreads()
+{
+   return std::max(1u, std::thread::hardware_concurrency());
+}
+
+constexpr auto backgroundPriority =
+   static_cast<size_t>(TaskPriority::Background);
+} // namespace
+
+ThreadPool::ThreadPool(size_t numThreads)
+    : mNumThreads { numThreads > 0 ? numThreads : GetDefaultNumThreads() }
+    , mMaxBackground { std::max<size_t>(1, mNumThreads - 1) }
+{
+   mWorkers.reserve(mNumThreads);
+   for (size_t i = 0; i < mNumThreads; ++i)
+      mWorkers.push_back(std::make_unique<Worker>());
+
+   mThreads.reserve(mNumThreads);
+   for (size_t i = 0; i < mNumThreads; ++i)
+      mThreads.emplace_back([this, i] { Work(i); });
+}
+
+ThreadPool::~ThreadPool()
+{
+   mStop = true;
+   {
+      std::lock_guard<std::mutex> lock { mWakeMutex };
+   }
+   mWakeCondition.notify_all();
+   for (auto& thread : mThreads)
+      thread.join();
+}
+
+ThreadPool& ThreadPool::Get()
+{
+   static ThreadPool pool;
+   return pool;
+}
+
+size_t ThreadPool::GetNumThreads() const
+{
+   return mNumThreads;
+}
+
+void ThreadPool::Submit(Task task, TaskPriority priority)
+{
+   const auto p = static_cast<size_t>(priority);
+   Item item { std::move(task), Clock::now() };
+   // The depth changes while the queue is locked, so that it never counts
+   // less than what the queues hold.
+   if (IsWorkerThread())
+   {
+      auto& worker = *mWorkers[tlsWorkerIndex];
+      std::lock_guard<std::mutex> lock { worker.mutex };
+      worker.queues[p].push_back(std::move(item));
+      ++mStats[p].queueDepth;
+   }
+   else
+   {
+      std::lock_guard<std::mutex> lock { mSharedMutex };
+      mSharedQueues[p].push_back(std::move(item));
+      ++mStats[p].queueDepth;
+   }
+   Wake();
+}
+
+bool ThreadPool::IsWorkerThread() const
+{
+   return tlsPool == this;
+}
+
+bool ThreadPool::RunOne(TaskPriority lowest)
+{
+   const auto workerIndex = IsWorkerThread() ? tlsWorkerIndex : mNumThreads;
+   Item item;
+   size_t priority;
+   if (!TakeTask(workerIndex, lowest, true, item, priority))
+      return false;
+   Run(item, priority);
+   return true;
+}
+
+ThreadPoolStats ThreadPool::GetStats() const
+{
+   ThreadPoolStats stats;
+   stats.numThreads = mNumThreads;
+   stats.numStolen = mNumStolen;
+   for (size_t p = 0; p < NumTaskPriorities; ++p)
+   {
+      auto& from = mStats[p];
+      auto& to = stats.priorities[p];
+      to.queueDepth = from.queueDepth;
+      to.numStarted = from.numStarted;
+      to.totalLatency = std::chrono::nanoseconds { from.totalLatency.load() };
+      to.maxLatency = std::chrono::nanoseconds { from.maxLatency.load() };
+   }
+   return stats;
+}
+
+size_t ThreadPool::GetQueueDepth() const
+{
+   size_t depth = 0;
+   for (auto& stats : mStats)
+      depth += stats.queueDepth;
+   return depth;
+}
+
+bool ThreadPool::HasStartableTask() const
+{
+   for (size_t p = 0; p < NumTaskPriorities; ++p)
+      if (
+         mStats[p].queueDepth > 0 &&
+         (p != backgroundPriority || mRunningBackground < mMaxBackground))
+         return true;
+   return false;
+}
+
+bool ThreadPool::TakeTask(size_t workerIndex, size_t priority, Item& item)
+{
+   const auto take = [&](std::mutex& mutex, Queues& queues, bool back) {
+      std::lock_guard<std::mutex> lock { mutex };
+      auto& queue = queues[priority];
+      if (queue.empty())
+         return false;
+      if (back)
+      {
+         item = std::move(queue.back());
+         queue.pop_back();
+      }
+      else
+      {
+         item = std::move(queue.front());
+         queue.pop_front();
+      }
+      --mStats[priority].queueDepth;
+      return true;
+   };
+
+   // The last task submitted by this worker is the likeliest to find its
+   // data in the cache.
+   if (workerIndex < mNumThreads)
+   {
+      auto& worker = *mWorkers[workerIndex];
+      if (take(worker.mutex, worker.queues, true))
+         return true;
+   }
+
+   if (take(mSharedMutex, mSharedQueues, false))
+      return true;
+
+   // Steal the oldest task of another worker, likely the root of more work
+   for (size_t i = 1; i <= mNumThreads; ++i)
+   {
+      const auto other = (workerIndex + i) % (mNumThreads + 1);
+      if (other == workerIndex || other == mNumThreads)
+         continue;
+      auto& worker = *mWorkers[other];
+      if (take(worker.mutex, worker.queues, false))
+      {
+         ++mNumStolen;
+         return true;
+      }
+   }
+   return false;
+}
+
+bool ThreadPool::TakeTask(
+   size_t workerIndex, TaskPriority lowest, bool helping, Item& item,
+   size_t& priority)
+{
+   for (size_t p = 0; p <= static_cast<size_t>(lowest); ++p)
+   {
+      if (mStats[p].queueDepth == 0)
+         continue;
+
+      if (p == backgroundPriority)
+      {
+         // Reserve a place among the background tasks first
+         auto running = mRunningBackground.load();
+         do
+            if (!helping && running >= mMaxBackground)
+               return false;
+         while (!mRunningBackground.compare_exchange_weak(running, running + 1));
+      }
+
+      if (TakeTask(workerIndex, p, item))
+      {
+         priority = p;
+         return true;
+      }
+
+      if (p == backgroundPriority)
+         --mRunningBackground;
+   }
+   return false;
+}
+
+void ThreadPool::Run(Item& item, size_t priority)
+{
+   auto& stats = mStats[priority];
+   const int64_t latency = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                              Clock::now() - item.submitted)
+                              .count();
+   ++stats.numStarted;
+   stats.totalLatency += latency;
+   auto maxLatency = stats.maxLatency.load();
+   while (maxLatency < latency &&
+          !stats.maxLatency.compare_exchange_weak(maxLatency, latency))
+      ;
+
+   try
+   {
+      item.task();
+   }
+   catch (...)
+   {
+      // Submit() says they are lost; Async and TaskGraph catch them before.
+   }
+   item.task = nullptr;
+
+   if (priority == backgroundPriority)
+   {
+      --mRunningBackground;
+      // A worker may be waiting for the place this task took.
+      if (stats.queueDepth > 0)
+         Wake();
+   }
+}
+
+void ThreadPool::Work(size_t workerIndex)
+{
+   tlsPool = this;
+   tlsWorkerIndex = workerIndex;
+
+   while (true)
+   {
+      Item item;
+      size_t priority;
+      if (TakeTask(
+             workerIndex, TaskPriority::Background, false, item, priority))
+      {
+         Run(item, priority);
+         continue;
+      }
+
+      std::unique_lock<std::mutex> lock { mWakeMutex };
+      mWakeCondition.wait(lock, [this] {
+         return HasStartableTask() || (mStop && GetQueueDepth() == 0);
+      });
+      if (mStop && GetQueueDepth() == 0)
+      {
+         // Others may wait for tasks that were not startable until now.
+         mWakeCondition.notify_all();
+         return;
+      }
+   }
+}
+
+void ThreadPool::Wake()
+{
+   // Locking orders this with the check of a worker about to wait, so that
+   // the notification can't get lost in between.
+   {
+      std::lock_guard<std::mutex> lock { mWakeMutex };
+   }
+   mWakeCondition.notify_one();
+}
+
+bool RenderInParallel(
+   size_t numJobs,
+   const std::function<void(size_t job, const std::atomic<bool>& cancelled)>&
+      render,
+   const std::function<bool()>& poll, ThreadPool& pool)
+{
+   std::atomic<size_t> nextJob { 0 };
+   std::atomic<bool> cancelled { false };
+
+   const auto work = [&] {
+      size_t job;
+      while (!cancelled && (job = nextJob++) < numJobs)
+      {
+         try
+         {
+            render(job, cancelled);
+         }
+         catch (...)
+         {
+            // Let the other workers stop too
+            cancelled = true;
+            throw;
+         }
+      }
+   };
+
+   const auto numWorkers = std::min(pool.GetNumThreads(), numJobs);
+   std::vector<std::future<void>> workers;
+   workers.reserve(numWorkers);
+
+   // The workers use the state above: stop and wait for them before leaving,
+   // including when `poll` throws
+   struct Joiner final
+   {
+      ~Joiner()
+      {
+         cancelled = true;
+         for (auto& worker : workers)
+            if (worker.valid())
+               worker.wait();
+      }
+      std::atomic<bool>& cancelled;
+      std::vector<std::future<void>>& workers;
+   } joiner { cancelled, workers };
+
+   for (size_t i = 0; i < numWorkers; ++i)
+      workers.emplace_back(pool.Async(work, TaskPriority::Interactive));
+
+   using namespace std::chrono_literals;
+   for (auto& worker : workers)
+      while (worker.wait_for(50ms) != std::future_status::ready)
+         if (!poll())
+            return false;
+   for (auto& worker : workers)
+      worker.get();
+
+   return poll();
+}
+} // namespace audacity::concurrency
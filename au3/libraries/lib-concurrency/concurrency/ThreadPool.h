@@ -0,0 +1,193 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ * SPDX-FileName: ThreadPool.h
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace audacity::concurrency
+{
+//! Tasks of a higher priority start before any task of a lower one
+enum class TaskPriority
+{
+   //! Feeds something running in real time, e.g. prefetching for playback
+   RealtimeAdjacent,
+   //! Somebody waits for the result, e.g. rendering an effect
+   Interactive,
+   //! Nobody waits, e.g. computing caches ahead of time
+   Background,
+};
+
+constexpr size_t NumTaskPriorities = 3;
+
+struct CONCURRENCY_API ThreadPoolStats final
+{
+   struct Priority final
+   {
+      //! Tasks submitted but not started
+      size_t queueDepth = 0;
+      uint64_t numStarted = 0;
+      //! From submission to start
+      std::chrono::nanoseconds totalLatency {};
+      std::chrono::nanoseconds maxLatency {};
+   };
+
+   size_t numThreads = 0;
+   //! Tasks that a worker took from the queue of another
+   uint64_t numStolen = 0;
+   //! Indexed by TaskPriority
+   std::array<Priority, NumTaskPriorities> priorities;
+};
+
+/*!
+ * @brief A fixed set of worker threads that run tasks.
+ *
+ * @details Each worker has a queue of its own, where go the tasks submitted
+ * from that worker, and which it runs last in, first out. Tasks submitted
+ * from other threads go to a queue shared by all workers. A worker without
+ * any task takes the oldest task from the queue of another.
+ *
+ * Background tasks never occupy all workers when there are several, so that
+ * other tasks can start without waiting for a long background task to end.
+ *
+ * Get() gives the pool shared by the whole application: parallel features
+ * using it share the cores, instead of each starting a thread per core.
+ */
+class CONCURRENCY_API ThreadPool final
+{
+public:
+   using Task = std::function<void()>;
+
+   //! @param numThreads 0 for one per hardware thread
+   explicit ThreadPool(size_t numThreads = 0);
+
+   //! Runs the tasks submitted so far, then stops the workers
+   ~ThreadPool();
+
+   ThreadPool(const ThreadPool&)            = delete;
+   ThreadPool& operator=(const ThreadPool&) = delete;
+
+   static ThreadPool& Get();
+
+   size_t GetNumThreads() const;
+
+   //! Exceptions escaping `task` are lost: see Async and TaskGraph
+   void Submit(Task task, TaskPriority priority = TaskPriority::Interactive);
+
+   //! Runs `f` on a worker; the future holds its result or exception.
+   template <typename F>
+   auto Async(F&& f, TaskPriority priority = TaskPriority::Interactive)
+   {
+      using Result = std::invoke_result_t<std::decay_t<F>>;
+      // std::function needs a copyable callable
+      auto task =
+         std::make_shared<std::packaged_task<Result()>>(std::forward<F>(f));
+      auto future = task->get_future();
+      Submit([task] { (*task)(); }, priority);
+      return future;
+   }
+
+   //! Whether the calling thread is one of the workers of this pool
+   bool IsWorkerThread() const;
+
+   //! Runs one of the tasks waiting, of priority `lowest` or higher, on the
+   //! calling thread: for a worker waiting for other tasks to keep busy
+   //! rather than block, which could leave nobody to run them.
+   //! @return whether there was such a task
+   bool RunOne(TaskPriority lowest = TaskPriority::Background);
+
+   ThreadPoolStats GetStats() const;
+
+private:
+   using Clock = std::chrono::steady_clock;
+
+   struct Item final
+   {
+      Task task;
+      Clock::time_point submitted;
+   };
+
+   using Queues = std::array<std::deque<Item>, NumTaskPriorities>;
+
+   struct Worker final
+   {
+      std::mutex mutex;
+      Queues queues;
+   };
+
+   struct PriorityStats final
+   {
+      std::atomic<size_t> queueDepth { 0 };
+      std::atomic<uint64_t> numStarted { 0 };
+      std::atomic<int64_t> totalLatency { 0 };
+      std::atomic<int64_t> maxLatency { 0 };
+   };
+
+   size_t GetQueueDepth() const;
+   // Whether a worker may start a task now
+   bool HasStartableTask() const;
+   // workerIndex is that of the calling thread, or GetNumThreads() for other
+   // threads
+   bool TakeTask(size_t workerIndex, size_t priority, Item& item);
+   // A helping thread is busy anyway: it may exceed the limit of background
+   // tasks, which might else be reached by tasks waiting for the one it takes.
+   bool TakeTask(
+      size_t workerIndex, TaskPriority lowest, bool helping, Item& item,
+      size_t& priority);
+   void Run(Item& item, size_t priority);
+   void Work(size_t workerIndex);
+   void Wake();
+
+   const size_t mNumThreads;
+   const size_t mMaxBackground;
+
+   std::vector<std::unique_ptr<Worker>> mWorkers;
+   std::mutex mSharedMutex;
+   Queues mSharedQueues;
+
+   std::mutex mWakeMutex;
+   std::condition_variable mWakeCondition;
+   std::atomic<bool> mStop { false };
+   std::atomic<size_t> mRunningBackground { 0 };
+
+   std::array<PriorityStats, NumTaskPriorities> mStats;
+   std::atomic<uint64_t> mNumStolen { 0 };
+
+   std::vector<std::thread> mThreads;
+};
+
+/*!
+ * @brief Calls `render(job, cancelled)` for each job below `numJobs`, on
+ * the workers of `pool`.
+ *
+ * Meanwhile, the calling thread calls `poll()` about every 50 ms, and once
+ * more when all jobs are done, e.g. to consume their output and report the
+ * progress. If `poll` returns false, `cancelled` becomes true, for `render` to
+ * return early, and no other job starts.
+ *
+ * Doesn't return before the workers stopped, even if `poll` throws. Rethrows
+ * what `render` threw, after the other workers stopped.
+ *
+ * @pre not called from a worker of `pool`
+ * @return false if `poll` did
+ */
+CONCURRENCY_API bool RenderInParallel(
+   size_t numJobs,
+   const std::function<void(size_t job, const std::atomic<bool>& cancelled)>&
+      render,
+   const std::function<bool()>& poll, ThreadPool& pool = ThreadPool::Get());
+} // namespace audacity::concurrency
@@ -0,0 +1,98 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ * SPDX-FileName: TaskGraphTests.cpp
+ */
+
+#include "concurrency/TaskGraph.h"
+
+#include <catch2/catch.hpp>
+
+#include <atomic>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+
+using namespace audacity::concurrency;
+
+TEST_CASE("TaskGraph")
+{
+   ThreadPool pool { 4 };
+
+   SECTION("tasks run after their dependencies")
+   {
+      std::mutex mutex;
+      std::string log;
+      const auto append = [&](char c) {
+         return [&, c] {
+            std::lock_guard<std::mutex> lock { mutex };
+            log += c;
+         };
+      };
+
+      TaskGraph sut { pool };
+      const auto a = sut.Add(append('a'));
+      const auto b = sut.Then(a, append('b'));
+      const auto c = sut.Then(a, append('c'));
+      sut.Add(append('d'), { b, c });
+      sut.Start();
+      sut.Wait();
+
+      REQUIRE(log.size() == 4);
+      REQUIRE(log.front() == 'a');
+      REQUIRE(log.back() == 'd');
+   }
+
+   SECTION("an empty graph ends at once")
+   {
+      TaskGraph sut { pool };
+      sut.Start();
+      sut.Wait();
+   }
+
+   SECTION("an exception cancels and is rethrown")
+   {
+      auto ranAfter = false;
+      TaskGraph sut { pool };
+      const auto failing = sut.Add([] { throw std::runtime_error("x"); });
+      sut.Then(failing, [&] { ranAfter = true; });
+      sut.Start();
+      REQUIRE_THROWS_AS(sut.Wait(), std::runtime_error);
+      REQUIRE(sut.IsCancelled());
+      REQUIRE(!ranAfter);
+   }
+
+   SECTION("the cancellation context skips tasks not started")
+   {
+      const auto context = CancellationContext::Create();
+      std::atomic<int> count { 0 };
+      TaskGraph sut { pool, TaskPriority::Background, context };
+      auto previous = sut.Add([&] {
+         ++count;
+         context->Cancel();
+      });
+      for (auto i = 0; i < 10; ++i)
+         previous = sut.Then(previous, [&] { ++count; });
+      sut.Start();
+      sut.Wait();
+      REQUIRE(sut.IsCancelled());
+      REQUIRE(count == 1);
+   }
+
+   SECTION("graphs nest without blocking the workers")
+   {
+      // More nested graphs than workers, each waiting for its tasks
+      std::atomic<int> count { 0 };
+      TaskGraph sut { pool };
+      for (auto i = 0; i < 16; ++i)
+         sut.Add([&] {
+            TaskGraph inner { pool };
+            for (auto j = 0; j < 16; ++j)
+               inner.Add([&] { ++count; });
+            inner.Start();
+            inner.Wait();
+         });
+      sut.Start();
+      sut.Wait();
+      REQUIRE(count == 16 * 16);
+   }
+}
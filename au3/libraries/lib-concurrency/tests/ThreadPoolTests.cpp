@@ -0,0 +1,179 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ * SPDX-FileName: ThreadPoolTests.cpp
+ */
+
+#include "concurrency/ThreadPool.h"
+
+#include <catch2/catch.hpp>
+
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace audacity::concurrency;
+
+TEST_CASE("ThreadPool")
+{
+   SECTION("Async gives the result or the exception")
+   {
+      ThreadPool sut { 2 };
+      auto value = sut.Async([] { return 42; });
+      auto error = sut.Async([]() -> int { throw std::runtime_error("x"); });
+      REQUIRE(value.get() == 42);
+      REQUIRE_THROWS_AS(error.get(), std::runtime_error);
+   }
+
+   SECTION("all tasks run, also submitted by workers")
+   {
+      constexpr auto numTasks = 1000;
+      std::atomic<int> count { 0 };
+      std::atomic<bool> onWorkers { true };
+      {
+         ThreadPool sut { 4 };
+         for (auto i = 0; i < numTasks; ++i)
+            sut.Submit(
+               [&] {
+                  // Not REQUIRE, which isn't for worker threads
+                  if (!sut.IsWorkerThread())
+                     onWorkers = false;
+                  sut.Submit([&] { ++count; }, TaskPriority::Background);
+               });
+         REQUIRE(!sut.IsWorkerThread());
+         // The destructor runs the tasks.
+      }
+      REQUIRE(onWorkers);
+      REQUIRE(count == numTasks);
+   }
+
+   SECTION("stats")
+   {
+      ThreadPool sut { 3 };
+      std::vector<std::future<void>> futures;
+      for (auto i = 0; i < 100; ++i)
+         futures.push_back(sut.Async([] {}, TaskPriority::RealtimeAdjacent));
+      for (auto& future : futures)
+         future.get();
+
+      const auto stats = sut.GetStats();
+      REQUIRE(stats.numThreads == 3);
+      const auto& realtime = stats.priorities[0];
+      REQUIRE(realtime.queueDepth == 0);
+      REQUIRE(realtime.numStarted == 100);
+      REQUIRE(realtime.maxLatency <= realtime.totalLatency);
+      REQUIRE(stats.priorities[1].numStarted == 0);
+   }
+
+   SECTION("higher priorities start first")
+   {
+      ThreadPool sut { 1 };
+      std::promise<void> release;
+      // Occupy the only worker until everything is queued
+      auto blocker = sut.Async([released = release.get_future()] {
+         released.wait();
+      });
+
+      std::vector<TaskPriority> order;
+      for (auto priority :
+           { TaskPriority::Background, TaskPriority::Interactive,
+             TaskPriority::RealtimeAdjacent })
+         sut.Submit([&order, priority] { order.push_back(priority); }, priority);
+      REQUIRE(sut.GetStats().priorities[2].queueDepth == 1);
+
+      release.set_value();
+      blocker.get();
+      sut.Async([] {}, TaskPriority::Background).get();
+      REQUIRE(
+         order == std::vector<TaskPriority> { TaskPriority::RealtimeAdjacent,
+                                              TaskPriority::Interactive,
+                                              TaskPriority::Background });
+   }
+
+   SECTION("background tasks leave a worker to the others")
+   {
+      ThreadPool sut { 2 };
+      std::promise<void> release;
+      auto released = release.get_future().share();
+      std::vector<std::future<void>> background;
+      for (auto i = 0; i < 2; ++i)
+         background.push_back(sut.Async(
+            [released] { released.wait(); }, TaskPriority::Background));
+      // Would wait forever if both background tasks had started
+      sut.Async([] {}).get();
+      release.set_value();
+      for (auto& future : background)
+         future.get();
+   }
+
+   SECTION("RunOne from another thread")
+   {
+      ThreadPool sut { 1 };
+      std::promise<void> started;
+      std::promise<void> release;
+      auto blocker = sut.Async(
+         [&started, released = release.get_future()] {
+            started.set_value();
+            released.wait();
+         });
+      // Else RunOne could take this task
+      started.get_future().wait();
+      auto ran = false;
+      sut.Submit([&] { ran = true; });
+      REQUIRE(sut.RunOne());
+      REQUIRE(ran);
+      REQUIRE(!sut.RunOne());
+      release.set_value();
+      blocker.get();
+   }
+}
+
+TEST_CASE("RenderInParallel")
+{
+   ThreadPool sut { 2 };
+
+   SECTION("renders every job once")
+   {
+      constexpr size_t numJobs = 100;
+      std::vector<std::atomic<int>> counts(numJobs);
+      auto numPolls = 0;
+      REQUIRE(RenderInParallel(
+         numJobs,
+         [&](size_t job, const std::atomic<bool>&) { ++counts[job]; },
+         [&] {
+            ++numPolls;
+            return true;
+         },
+         sut));
+      for (const auto& count : counts)
+         REQUIRE(count == 1);
+      REQUIRE(numPolls >= 1);
+   }
+
+   SECTION("stops when poll returns false")
+   {
+      std::atomic<bool> sawCancel { false };
+      REQUIRE(!RenderInParallel(
+         1000,
+         [&](size_t, const std::atomic<bool>& cancelled) {
+            while (!cancelled)
+               std::this_thread::yield();
+            sawCancel = true;
+         },
+         [] { return false; }, sut));
+      REQUIRE(sawCancel);
+   }
+
+   SECTION("rethrows what a job threw")
+   {
+      REQUIRE_THROWS_AS(
+         RenderInParallel(
+            10,
+            [](size_t job, const std::atomic<bool>&) {
+               if (job == 3)
+                  throw std::runtime_error("x");
+            },
+            [] { return true; }, sut),
+         std::runtime_error);
+   }
+}
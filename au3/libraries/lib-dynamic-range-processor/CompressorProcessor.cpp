@@ -146,20 +146,16 @@ float CompressorProcessor::EvaluateTransferFunction(float inputDb) const
 
 void CompressorProcessor::UpdateEnvelope(const float* const* in, int blockLen)
 {
-   // Fill mEnvelope with max of all in channels;
-   for (auto i = 0; i < blockLen; ++i)
+   // Fill mEnvelope with max of all in channels, a channel at a time so that
+   // the loops vectorize.
+   std::fill(mEnvelope.begin(), mEnvelope.begin() + blockLen, 0.f);
+   for (auto j = 0; j < mNumChannels; ++j)
    {
-      auto max = 0.f;
-      for (auto j = 0; j < mNumChannels; ++j)
-      {
-         const auto x = std::abs(in[j][i]);
-         if (x > max)
-            max = x;
-      }
-      mEnvelope[i] = max;
+      const auto channel = in[j];
+      for (auto i = 0; i < blockLen; ++i)
+         mEnvelope[i] = std::max(mEnvelope[i], std::abs(channel[i]));
    }
 
-   // TODO: uses std::log10 ; use log2 optimization instead.
    mGainReductionComputer->computeGainInDecibelsFromSidechainSignal(
       mEnvelope.data(), mEnvelope.data(), blockLen);
 
@@ -184,11 +180,20 @@ void CompressorProcessor::ApplyEnvelope(
 {
    const auto makeupGainDb = mGainReductionComputer->getMakeUpGain();
    const auto d = mLookAheadGainReduction->getDelayInSamples();
+
+   // The gain is the same for all channels: convert it once, without calling
+   // std::pow sample by sample.
+   std::array<float, maxBlockSize> gain;
+   for (auto j = 0; j < blockLen; ++j)
+      gain[j] = FastExp2(dbToLog2 * (mEnvelope[j] + makeupGainDb));
+
    std::array<float, 2> chanAbsMax { 0.f, 0.f };
    std::array<int, 2> chanAbsMaxIndex { 0, 0 };
    for (auto i = 0; i < mNumChannels; ++i)
    {
       const auto in = mDelayedInput[i].data();
+      for (auto j = 0; j < blockLen; ++j)
+         out[i][j] = in[j] * gain[j];
       for (auto j = 0; j < blockLen; ++j)
       {
          if (std::abs(in[j]) > chanAbsMax[i])
@@ -196,8 +201,6 @@ void CompressorProcessor::ApplyEnvelope(
             chanAbsMax[i] = std::abs(in[j]);
             chanAbsMaxIndex[i] = j;
          }
-         out[i][j] =
-            in[j] * std::pow(10.f, 0.05f * (mEnvelope[j] + makeupGainDb));
       }
       std::move(in + blockLen, in + blockLen + d, in);
    }
@@ -0,0 +1,95 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  DynamicRangeProcessorOutputPacketQueue.cpp
+
+**********************************************************************/
+#include "DynamicRangeProcessorOutputPacketQueue.h"
+#include <algorithm>
+
+namespace
+{
+size_t RoundUpToPowerOfTwo(size_t size)
+{
+   size_t result = 1;
+   while (result < size)
+      result <<= 1;
+   return result;
+}
+
+void Merge(
+   DynamicRangeProcessorOutputPacket& packet,
+   const DynamicRangeProcessorOutputPacket& next)
+{
+   packet.numSamples += next.numSamples;
+   // Compression values are gains in dB, negative when compressing.
+   packet.targetCompressionDb =
+      std::min(packet.targetCompressionDb, next.targetCompressionDb);
+   packet.actualCompressionDb =
+      std::min(packet.actualCompressionDb, next.actualCompressionDb);
+   packet.inputDb = std::max(packet.inputDb, next.inputDb);
+   packet.outputDb = std::max(packet.outputDb, next.outputDb);
+}
+} // namespace
+
+DynamicRangeProcessorOutputPacketQueue::DynamicRangeProcessorOutputPacketQueue(
+   size_t capacity)
+    : mMask { RoundUpToPowerOfTwo(std::max<size_t>(capacity, 1)) - 1 }
+    , mBuffer(mMask + 1)
+{
+}
+
+bool DynamicRangeProcessorOutputPacketQueue::Put(
+   const DynamicRangeProcessorOutputPacket& packet) noexcept
+{
+   const auto write = mWrite.load(std::memory_order_relaxed);
+   const auto read = mRead.load(std::memory_order_acquire);
+   if (write - read > mMask)
+   {
+      mNumDropped.fetch_add(1, std::memory_order_relaxed);
+      return false;
+   }
+   mBuffer[write & mMask] = packet;
+   mWrite.store(write + 1, std::memory_order_release);
+   return true;
+}
+
+void DynamicRangeProcessorOutputPacketQueue::Drain(
+   std::vector<DynamicRangeProcessorOutputPacket>& packets,
+   int minSamplesPerPacket)
+{
+   const auto read = mRead.load(std::memory_order_relaxed);
+   const auto write = mWrite.load(std::memory_order_acquire);
+   const auto first = packets.size();
+   for (auto i = read; i != write; ++i)
+   {
+      const auto& packet = mBuffer[i & mMask];
+      if (packets.size() > first)
+      {
+         auto& last = packets.back();
+         const auto isContiguous =
+            last.indexOfFirstSample + last.numSamples ==
+            packet.indexOfFirstSample;
+         if (isContiguous && last.numSamples < minSamplesPerPacket)
+         {
+            Merge(last, packet);
+            continue;
+         }
+      }
+      packets.push_back(packet);
+   }
+   // All at once, rather than packet by packet
+   mRead.store(write, std::memory_order_release);
+}
+
+size_t DynamicRangeProcessorOutputPacketQueue::GetCapacity() const noexcept
+{
+   return mMask + 1;
+}
+
+size_t DynamicRangeProcessorOutputPacketQueue::GetNumDropped() const noexcept
+{
+   return mNumDropped.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,63 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  DynamicRangeProcessorOutputPacketQueue.h
+
+**********************************************************************/
+#pragma once
+
+#include "DynamicRangeProcessorTypes.h"
+#include "MemoryX.h"
+#include <atomic>
+#include <vector>
+
+/*!
+ * @brief Carries the output packets of a compressor or limiter from the audio
+ * thread, which puts one per processed block, to the history display, which
+ * drains them all at display rate.
+ *
+ * @details Single-producer, single-consumer ring buffer of fixed capacity.
+ * All memory is allocated on construction, and the indices only grow, so that
+ * wrapping around is a mask rather than a division.
+ */
+class DYNAMIC_RANGE_PROCESSOR_API DynamicRangeProcessorOutputPacketQueue final
+    : public SharedNonInterfering<DynamicRangeProcessorOutputPacketQueue>
+{
+public:
+   //! Allocates room for at least `capacity` packets, rounded up to a power of
+   //! two.
+   explicit DynamicRangeProcessorOutputPacketQueue(size_t capacity);
+
+   //! To be called from the audio thread. Wait-free and doesn't allocate.
+   //! @return false if the queue was full, in which case the packet is dropped.
+   //! The consumer then sees a gap in the sample indices, and the history
+   //! begins a new segment.
+   bool Put(const DynamicRangeProcessorOutputPacket& packet) noexcept;
+
+   //! To be called from the consumer thread. Appends all pending packets to
+   //! `packets`, merging contiguous ones until each spans at least
+   //! `minSamplesPerPacket` samples. A merged packet keeps the strongest
+   //! compression and the loudest levels of its parts, so that decimation
+   //! doesn't hide peaks. Packets separated by a gap are never merged.
+   //! Doesn't allocate if `packets` has capacity for `GetCapacity()` more.
+   void Drain(
+      std::vector<DynamicRangeProcessorOutputPacket>& packets,
+      int minSamplesPerPacket = 0);
+
+   size_t GetCapacity() const noexcept;
+
+   //! How many packets `Put` dropped since construction.
+   size_t GetNumDropped() const noexcept;
+
+private:
+   // mRead is written only by the consumer, mWrite and mNumDropped by the
+   // producer
+   NonInterfering<std::atomic<size_t>> mRead { 0 };
+   NonInterfering<std::atomic<size_t>> mWrite { 0 };
+   std::atomic<size_t> mNumDropped { 0 };
+
+   const size_t mMask;
+   std::vector<DynamicRangeProcessorOutputPacket> mBuffer;
+};
@@ -26,8 +26,7 @@ struct DynamicRangeProcessorOutputPacket
    float outputDb = 0;
 };
 
-using DynamicRangeProcessorOutputPacketQueue =
-   LockFreeQueue<DynamicRangeProcessorOutputPacket>;
+class DynamicRangeProcessorOutputPacketQueue;
 
 struct MeterValues
 {
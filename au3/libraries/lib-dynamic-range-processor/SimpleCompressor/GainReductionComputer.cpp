@@ -18,6 +18,7 @@
 
 #include "GainReductionComputer.h"
 #include "MathApprox.h"
+#include <algorithm>
 
 namespace DanielRudrich {
 namespace
@@ -118,42 +119,47 @@ float GainReductionComputer::applyCharacteristicToOverShoot(
 
 void GainReductionComputer::computeGainInDecibelsFromSidechainSignal (const float* sideChainSignal, float* destination, const int numSamples)
 {
-    maxInputLevel = -std::numeric_limits<float>::infinity();
-    maxGainReduction = 0.0f;
-
+    // First pass, without dependencies between samples and without branches,
+    // so that it vectorizes: levels in decibels, and the static
+    // characteristic. sideChainSignal and destination may be the same.
+    const float kneeFactor = knee > 0.0f ? 0.5f * slope / knee : 0.0f;
+    float maxLevel = -std::numeric_limits<float>::infinity();
     for (int i = 0; i < numSamples; ++i)
     {
-        // convert sample to decibels
         const float levelInDecibels =
            log2ToDb * FastLog2(std::abs(sideChainSignal[i]));
+        maxLevel = std::max(maxLevel, levelInDecibels);
 
-        if (levelInDecibels > maxInputLevel)
-            maxInputLevel = levelInDecibels;
-
-        // calculate overshoot and apply knee and ratio
         const float overShoot = levelInDecibels - threshold;
-        const float gainReduction = applyCharacteristicToOverShoot (overShoot);
-
-        // apply ballistics
-        const float diff = gainReduction - state;
-        if (diff < 0.0f) // wanted gain reduction is below state -> attack phase
-            state += alphaAttack * diff;
-        else // release phase
-            state += alphaRelease * diff;
-
-        // write back gain reduction
-        destination[i] = state;
+        const float inKnee = kneeFactor * (overShoot + kneeHalf) * (overShoot + kneeHalf);
+        destination[i] = overShoot <= -kneeHalf ? 0.0f :
+                         overShoot <= kneeHalf ? inKnee : slope * overShoot;
+    }
 
-        if (state < maxGainReduction)
-            maxGainReduction = state;
+    // Second pass: the ballistics, a recurrence that has to go sample by
+    // sample.
+    float minState = 0.0f;
+    float s = state;
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const float diff = destination[i] - s;
+        // wanted gain reduction below state -> attack phase, else release
+        s += (diff < 0.0f ? alphaAttack : alphaRelease) * diff;
+        destination[i] = s;
+        minState = std::min(minState, s);
     }
+    state = s;
+
+    // Other threads may read these: write them once per block only
+    maxInputLevel = maxLevel;
+    maxGainReduction = minState;
 }
 
 void GainReductionComputer::computeLinearGainFromSidechainSignal (const float* sideChainSignal, float* destination, const int numSamples)
 {
     computeGainInDecibelsFromSidechainSignal (sideChainSignal, destination, numSamples);
     for (int i = 0; i < numSamples; ++i)
-        destination[i] = std::pow (10.0f, 0.05f * (destination[i] + makeUpGain));
+        destination[i] = FastExp2 (dbToLog2 * (destination[i] + makeUpGain));
 }
 
 
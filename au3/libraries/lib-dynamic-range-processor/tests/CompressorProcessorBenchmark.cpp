@@ -0,0 +1,96 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  CompressorProcessorBenchmark.cpp
+
+**********************************************************************/
+#include "CompressorProcessor.h"
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <vector>
+
+namespace
+{
+// Benchmarks are not meant to be run on CI. Set to `true` to run locally.
+constexpr auto runLocally = false;
+} // namespace
+
+TEST_CASE("CompressorProcessorBenchmark")
+{
+   // `CompressorProcessor::Process` runs once per block on the audio thread,
+   // for every instance of the compressor or the limiter. Prints the mean,
+   // 99.9th-percentile and worst per-block cost, and how the latter compare
+   // with the duration of a block.
+   if (!runLocally)
+      return;
+
+   constexpr auto sampleRate = 44100;
+   constexpr auto numChannels = 2;
+   constexpr auto blockSize = 512;
+   constexpr auto blockDuration = static_cast<double>(blockSize) / sampleRate;
+   constexpr auto numBlocks = 100000;
+
+   std::mt19937 gen { 0 };
+   std::uniform_real_distribution<float> noise { -1.f, 1.f };
+   std::vector<std::vector<float>> input(numChannels);
+   for (auto& channel : input)
+   {
+      channel.resize(sampleRate);
+      std::generate(channel.begin(), channel.end(), [&] { return noise(gen); });
+   }
+
+   std::vector<std::vector<float>> block(
+      numChannels, std::vector<float>(blockSize));
+   std::vector<float*> pointers(numChannels);
+   std::transform(
+      block.begin(), block.end(), pointers.begin(),
+      [](std::vector<float>& v) { return v.data(); });
+
+   std::vector<double> durations(numBlocks);
+   for (const auto& [name, settings] :
+        { std::pair { "compressor",
+                      DynamicRangeProcessorSettings { CompressorSettings {} } },
+          std::pair { "limiter",
+                      DynamicRangeProcessorSettings { LimiterSettings {} } } })
+   {
+      CompressorProcessor sut;
+      sut.Init(sampleRate, numChannels, blockSize);
+      sut.ApplySettingsIfNeeded(settings);
+
+      auto position = 0;
+      for (auto i = 0; i < numBlocks; ++i)
+      {
+         if (position + blockSize > sampleRate)
+            position = 0;
+         for (auto j = 0; j < numChannels; ++j)
+            std::copy(
+               input[j].begin() + position,
+               input[j].begin() + position + blockSize, block[j].begin());
+         position += blockSize;
+
+         const auto start = std::chrono::steady_clock::now();
+         sut.Process(pointers.data(), pointers.data(), blockSize);
+         const std::chrono::duration<double> elapsed =
+            std::chrono::steady_clock::now() - start;
+         durations[i] = elapsed.count();
+      }
+      const auto mean =
+         std::accumulate(durations.begin(), durations.end(), 0.) / numBlocks;
+      const auto percentile = durations.begin() + numBlocks * 999 / 1000;
+      std::nth_element(durations.begin(), percentile, durations.end());
+      const auto worst = *std::max_element(percentile, durations.end());
+      std::cout << name << ": mean " << mean * 1e6 << "us, 99.9% "
+                << *percentile * 1e6 << "us ("
+                << 100 * *percentile / blockDuration
+                << "% of a block), worst " << worst * 1e6 << "us ("
+                << 100 * worst / blockDuration << "% of a block)\n";
+   }
+}
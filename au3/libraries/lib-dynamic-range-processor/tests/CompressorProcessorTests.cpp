@@ -11,7 +11,10 @@
 #pragma once
 
 #include "CompressorProcessor.h"
+#include "MathApprox.h"
 #include <catch2/catch.hpp>
+#include <cmath>
+#include <random>
 
 TEST_CASE("GetMaxCompressionDb", "simple test")
 {
@@ -71,3 +74,108 @@ TEST_CASE("CompressorProcessor", "smoke test")
       progress += toProcess;
    }
 }
+
+namespace
+{
+// What CompressorProcessor computes when there is no look-ahead, written
+// sample by sample, as it was before the gain computation was vectorized.
+std::vector<std::vector<float>> ProcessReference(
+   const DynamicRangeProcessorSettings& settings, int sampleRate,
+   const std::vector<std::vector<float>>& in)
+{
+   const float threshold = settings.inCompressionThreshDb;
+   const float knee = settings.kneeWidthDb;
+   const float kneeHalf = knee / 2;
+   const float slope = 1 / settings.compressionRatio - 1;
+   const float makeUpGain = CompressorProcessor::GetMakeupGainDb(settings);
+   const auto alpha = [&](double ms) {
+      return 1.0f - std::exp(-1.0f / (static_cast<float>(sampleRate) *
+                                      static_cast<float>(ms / 1000)));
+   };
+   const auto alphaAttack = alpha(settings.attackMs);
+   const auto alphaRelease = alpha(settings.releaseMs);
+
+   auto out = in;
+   auto state = 0.f;
+   for (size_t i = 0; i < in[0].size(); ++i)
+   {
+      auto max = 0.f;
+      for (const auto& channel : in)
+         max = std::max(max, std::abs(channel[i]));
+      const float level = log2ToDb * FastLog2(max);
+      const float overShoot = level - threshold;
+      float gainReduction;
+      if (overShoot <= -kneeHalf)
+         gainReduction = 0.0f;
+      else if (overShoot <= kneeHalf)
+         gainReduction = 0.5f * slope * (overShoot + kneeHalf) *
+                         (overShoot + kneeHalf) / knee;
+      else
+         gainReduction = slope * overShoot;
+      const float diff = gainReduction - state;
+      if (diff < 0.0f)
+         state += alphaAttack * diff;
+      else
+         state += alphaRelease * diff;
+      const auto gain = std::pow(10.f, 0.05f * (state + makeUpGain));
+      for (auto& channel : out)
+         channel[i] *= gain;
+   }
+   return out;
+}
+} // namespace
+
+TEST_CASE("CompressorProcessor matches the scalar reference")
+{
+   constexpr auto sampleRate = 44100;
+   constexpr auto numChannels = 2;
+   constexpr auto blockSize = 512;
+   constexpr auto signalSize = sampleRate;
+
+   // Noise with an amplitude that swells and fades, to go through attack,
+   // release and the knee.
+   std::mt19937 gen { 0 };
+   std::uniform_real_distribution<float> noise { -1.f, 1.f };
+   std::vector<std::vector<float>> in(numChannels);
+   for (auto& channel : in)
+   {
+      channel.resize(signalSize);
+      for (auto i = 0; i < signalSize; ++i)
+         channel[i] =
+            noise(gen) * (0.5f + 0.5f * std::sin(2 * M_PI * 3 * i / sampleRate));
+   }
+
+   CompressorSettings compressorSettings;
+   compressorSettings.thresholdDb = -20;
+   compressorSettings.makeupGainDb = 6;
+   compressorSettings.lookaheadMs = 0;
+   LimiterSettings limiterSettings;
+   limiterSettings.lookaheadMs = 0;
+
+   for (const DynamicRangeProcessorSettings settings :
+        { DynamicRangeProcessorSettings { compressorSettings },
+          DynamicRangeProcessorSettings { limiterSettings } })
+   {
+      CompressorProcessor sut;
+      sut.Init(sampleRate, numChannels, blockSize);
+      sut.ApplySettingsIfNeeded(settings);
+
+      auto out = in;
+      std::vector<float*> pointers(numChannels);
+      for (auto progress = 0; progress < signalSize; progress += blockSize)
+      {
+         const auto toProcess = std::min(signalSize - progress, blockSize);
+         for (auto i = 0; i < numChannels; ++i)
+            pointers[i] = out[i].data() + progress;
+         sut.Process(pointers.data(), pointers.data(), toProcess);
+      }
+
+      const auto expected = ProcessReference(settings, sampleRate, in);
+      auto maxError = 0.f;
+      for (auto i = 0; i < numChannels; ++i)
+         for (auto j = 0; j < signalSize; ++j)
+            maxError =
+               std::max(maxError, std::abs(out[i][j] - expected[i][j]));
+      REQUIRE(maxError < 1e-5f);
+   }
+}
@@ -0,0 +1,120 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  DynamicRangeProcessorOutputPacketQueueTests.cpp
+
+**********************************************************************/
+#include "DynamicRangeProcessorOutputPacketQueue.h"
+#include <catch2/catch.hpp>
+#include <thread>
+
+namespace
+{
+DynamicRangeProcessorOutputPacket
+MakePacket(long long indexOfFirstSample, int numSamples, float db = 0.f)
+{
+   return { indexOfFirstSample, numSamples, db, db, db, db };
+}
+} // namespace
+
+TEST_CASE("DynamicRangeProcessorOutputPacketQueue")
+{
+   DynamicRangeProcessorOutputPacketQueue sut { 3 };
+   REQUIRE(sut.GetCapacity() == 4);
+
+   std::vector<DynamicRangeProcessorOutputPacket> packets;
+   packets.reserve(sut.GetCapacity());
+
+   SECTION("packets come out in order")
+   {
+      REQUIRE(sut.Put(MakePacket(0, 10)));
+      REQUIRE(sut.Put(MakePacket(10, 10)));
+      sut.Drain(packets);
+      REQUIRE(packets.size() == 2);
+      REQUIRE(packets[0].indexOfFirstSample == 0);
+      REQUIRE(packets[1].indexOfFirstSample == 10);
+
+      packets.clear();
+      sut.Drain(packets);
+      REQUIRE(packets.empty());
+   }
+
+   SECTION("overrun drops the newest packets")
+   {
+      for (auto i = 0; i < 4; ++i)
+         REQUIRE(sut.Put(MakePacket(i * 10, 10)));
+      REQUIRE(!sut.Put(MakePacket(40, 10)));
+      REQUIRE(sut.GetNumDropped() == 1);
+
+      sut.Drain(packets);
+      REQUIRE(packets.size() == 4);
+      REQUIRE(packets.back().indexOfFirstSample == 30);
+
+      // Room again, and the consumer sees the gap.
+      REQUIRE(sut.Put(MakePacket(50, 10)));
+      sut.Drain(packets);
+      REQUIRE(packets.size() == 5);
+      REQUIRE(packets.back().indexOfFirstSample == 50);
+   }
+
+   SECTION("decimation merges contiguous packets only")
+   {
+      sut.Put(MakePacket(0, 10, -1.f));
+      sut.Put(MakePacket(10, 10, -3.f));
+      sut.Put(MakePacket(20, 10, -2.f));
+      sut.Put(MakePacket(40, 10, -4.f));
+      sut.Drain(packets, 20);
+      REQUIRE(packets.size() == 3);
+
+      REQUIRE(packets[0].indexOfFirstSample == 0);
+      REQUIRE(packets[0].numSamples == 20);
+      // Strongest compression, loudest levels.
+      REQUIRE(packets[0].targetCompressionDb == -3.f);
+      REQUIRE(packets[0].actualCompressionDb == -3.f);
+      REQUIRE(packets[0].inputDb == -1.f);
+      REQUIRE(packets[0].outputDb == -1.f);
+
+      REQUIRE(packets[1].indexOfFirstSample == 20);
+      REQUIRE(packets[1].numSamples == 10);
+      REQUIRE(packets[2].indexOfFirstSample == 40);
+   }
+}
+
+TEST_CASE("DynamicRangeProcessorOutputPacketQueue across threads")
+{
+   constexpr auto numPackets = 100000;
+   constexpr auto packetSize = 64;
+   DynamicRangeProcessorOutputPacketQueue sut { 64 };
+
+   std::thread producer { [&] {
+      for (auto i = 0; i < numPackets; ++i)
+         sut.Put(MakePacket(static_cast<long long>(i) * packetSize, packetSize));
+   } };
+
+   std::vector<DynamicRangeProcessorOutputPacket> packets;
+   auto numReceived = 0;
+   auto previousIndex = -1ll;
+   auto inOrder = true;
+   while (true)
+   {
+      const auto done = numReceived + sut.GetNumDropped() == numPackets;
+      packets.clear();
+      sut.Drain(packets);
+      for (const auto& packet : packets)
+      {
+         inOrder = inOrder && packet.indexOfFirstSample > previousIndex &&
+                   packet.indexOfFirstSample % packetSize == 0;
+         previousIndex = packet.indexOfFirstSample;
+      }
+      numReceived += packets.size();
+      if (done)
+         break;
+      std::this_thread::yield();
+   }
+   producer.join();
+
+   REQUIRE(inOrder);
+   REQUIRE(numReceived + sut.GetNumDropped() == numPackets);
+}
@@ -47,16 +47,13 @@
 #include <wx/wxcrtvararg.h>
 #include <stdlib.h>
 #include <math.h>
+#include <mutex>
 
 #include "RealFFTf.h"
 
 using Floats = ArrayOf<float>;
-static ArraysOf<int> gFFTBitTable;
 static const size_t MaxFastBits = 16;
 
-/* Declare Static functions */
-static void InitFFT();
-
 static bool IsPowerOfTwo(size_t x)
 {
    if (x < 2)
@@ -94,30 +91,36 @@ int ReverseBits(size_t index, size_t NumBits)
    return rev;
 }
 
-void InitFFT()
+// FFT may be called from several threads at once: the table is made once,
+// by the first call, and only read after
+static const ArraysOf<int> &GetFFTBitTable()
 {
-   gFFTBitTable.reinit(MaxFastBits);
-
-   size_t len = 2;
-   for (size_t b = 1; b <= MaxFastBits; b++) {
-      auto &array = gFFTBitTable[b - 1];
-      array.reinit(len);
-      for (size_t i = 0; i < len; i++)
-         array[i] = ReverseBits(i, b);
-
-      len <<= 1;
-   }
+   static ArraysOf<int> table{ MaxFastBits };
+   static std::once_flag made;
+   std::call_once(made, []{
+      size_t len = 2;
+      for (size_t b = 1; b <= MaxFastBits; b++) {
+         auto &array = table[b - 1];
+         array.reinit(len);
+         for (size_t i = 0; i < len; i++)
+            array[i] = ReverseBits(i, b);
+
+         len <<= 1;
+      }
+   });
+   return table;
 }
 
 void DeinitFFT()
 {
-   gFFTBitTable.reset();
+   // The table is freed at exit
 }
 
-static inline size_t FastReverseBits(size_t i, size_t NumBits)
+static inline size_t FastReverseBits(
+   const ArraysOf<int> &table, size_t i, size_t NumBits)
 {
    if (NumBits <= MaxFastBits)
-      return gFFTBitTable[NumBits - 1][i];
+      return table[NumBits - 1][i];
    else
       return ReverseBits(i, NumBits);
 }
@@ -139,8 +142,7 @@ void FFT(size_t NumSamples,
       exit(1);
    }
 
-   if (!gFFTBitTable)
-      InitFFT();
+   const auto &table = GetFFTBitTable();
 
    if (!InverseTransform)
       angle_numerator = -angle_numerator;
@@ -153,7 +155,7 @@ void FFT(size_t NumSamples,
     */
 
    for (size_t i = 0; i < NumSamples; i++) {
-      auto j = FastReverseBits(i, NumBits);
+      auto j = FastReverseBits(table, i, NumBits);
       RealOut[j] = RealIn[i];
       ImagOut[j] = (ImagIn == NULL) ? 0.0 : ImagIn[i];
    }
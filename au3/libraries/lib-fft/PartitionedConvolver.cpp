@@ -0,0 +1,191 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  PartitionedConvolver.cpp
+
+**********************************************************************/
+#include "PartitionedConvolver.h"
+
+#include <algorithm>
+#include <cassert>
+#include <pffft.h>
+
+namespace
+{
+// Partitions of each length but the longest; four suffice for the next
+// group, four times as long, to begin no earlier than its own length.
+constexpr size_t partitionsPerGroup = 4;
+constexpr size_t growth = 4;
+
+bool IsPowerOfTwo(size_t n)
+{
+   return n > 0 && (n & (n - 1)) == 0;
+}
+
+size_t NextPowerOfTwo(size_t n)
+{
+   size_t result = 1;
+   while (result < n)
+      result *= 2;
+   return result;
+}
+} // namespace
+
+PartitionedConvolver::Group::Group(
+   const float* impulseResponse, size_t blockSize, size_t offset,
+   size_t numPartitions)
+    : blockSize { blockSize }
+    , offset { offset }
+    , numPartitions { numPartitions }
+    , setup { pffft_new_setup(2 * blockSize, PFFFT_REAL) }
+    , responses(numPartitions * 2 * blockSize)
+    , inputs(numPartitions * 2 * blockSize)
+    , buffer(2 * blockSize)
+    , accumulator(2 * blockSize)
+    , work(2 * blockSize)
+{
+   // Each partition, zero-padded to twice its length
+   const auto fftSize = 2 * blockSize;
+   for (size_t partition = 0; partition < numPartitions; ++partition)
+   {
+      const auto* const taps = impulseResponse + partition * blockSize;
+      std::copy(taps, taps + blockSize, buffer.begin());
+      std::fill(buffer.begin() + blockSize, buffer.end(), 0.f);
+      pffft_transform(
+         setup.get(), buffer.data(),
+         responses.aligned(PffftAlignedCount { fftSize }, partition).get(),
+         work.data(), PFFFT_FORWARD);
+   }
+}
+
+void PartitionedConvolver::Group::Reset()
+{
+   std::fill(inputs.begin(), inputs.end(), 0.f);
+   newest = 0;
+}
+
+void PartitionedConvolver::Group::Process(
+   const float* input, size_t inputMask, size_t end, float* output,
+   size_t outputMask)
+{
+   const auto fftSize = 2 * blockSize;
+   const PffftAlignedCount rowSize { fftSize };
+
+   for (size_t i = 0; i < fftSize; ++i)
+      buffer[i] = input[(end - fftSize + i) & inputMask];
+   newest = (newest + numPartitions - 1) % numPartitions;
+   pffft_transform(
+      setup.get(), buffer.data(), inputs.aligned(rowSize, newest).get(),
+      work.data(), PFFFT_FORWARD);
+
+   // Partition p filters the input of p blocks ago.
+   std::fill(accumulator.begin(), accumulator.end(), 0.f);
+   const auto scaling = 1.f / fftSize;
+   for (size_t partition = 0; partition < numPartitions; ++partition)
+      pffft_zconvolve_accumulate(
+         setup.get(),
+         inputs.aligned(rowSize, (newest + partition) % numPartitions).get(),
+         responses.aligned(rowSize, partition).get(), accumulator.data(),
+         scaling);
+   pffft_transform(
+      setup.get(), accumulator.data(), buffer.data(), work.data(),
+      PFFFT_BACKWARD);
+
+   // Overlap-save: the second half is the convolution of the input from
+   // `end - blockSize`, due `offset` samples later.
+   const auto start = end - blockSize + offset;
+   for (size_t i = 0; i < blockSize; ++i)
+      output[(start + i) & outputMask] += buffer[blockSize + i];
+}
+
+PartitionedConvolver::PartitionedConvolver(
+   const float* impulseResponse, size_t numTaps, size_t blockSize,
+   size_t maxBlockSize)
+    : mBlockSize { blockSize }
+{
+   assert(IsPowerOfTwo(blockSize) && blockSize >= 32);
+   assert(IsPowerOfTwo(maxBlockSize) && maxBlockSize >= blockSize);
+
+   std::vector<float> padded(impulseResponse, impulseResponse + numTaps);
+   size_t offset = 0;
+   auto size = blockSize;
+   mGroups.reserve(8);
+   while (offset < numTaps)
+   {
+      const auto remaining = numTaps - offset;
+      const auto last =
+         size == maxBlockSize || remaining <= partitionsPerGroup * size;
+      const auto numPartitions =
+         last ? (remaining + size - 1) / size : partitionsPerGroup;
+      if (last)
+         // Zero-pads the last partition
+         padded.resize(offset + numPartitions * size, 0.f);
+      mGroups.emplace_back(padded.data() + offset, size, offset, numPartitions);
+      offset += numPartitions * size;
+      size = std::min(size * growth, maxBlockSize);
+   }
+
+   const auto longest = mGroups.empty() ? blockSize : mGroups.back().blockSize;
+   mInput.resize(2 * longest);
+   // A group writes up to its offset ahead of the samples not yet output, the
+   // last `blockSize` of them.
+   const auto ahead = mGroups.empty() ? 0 : mGroups.back().offset;
+   mOutput.resize(NextPowerOfTwo(ahead + 2 * blockSize));
+}
+
+PartitionedConvolver::~PartitionedConvolver() = default;
+
+PartitionedConvolver::PartitionedConvolver(PartitionedConvolver&&) = default;
+
+size_t PartitionedConvolver::GetLatency() const
+{
+   return mBlockSize;
+}
+
+void PartitionedConvolver::Reset()
+{
+   std::fill(mInput.begin(), mInput.end(), 0.f);
+   std::fill(mOutput.begin(), mOutput.end(), 0.f);
+   for (auto& group : mGroups)
+      group.Reset();
+   mCount = 0;
+}
+
+void PartitionedConvolver::Process(
+   const float* in, float* out, size_t numSamples)
+{
+   const auto inputMask = mInput.size() - 1;
+   const auto outputMask = mOutput.size() - 1;
+   while (numSamples > 0)
+   {
+      const auto len =
+         std::min(numSamples, mBlockSize - mCount % mBlockSize);
+      for (size_t i = 0; i < len; ++i)
+      {
+         const auto t = mCount + i;
+         // Read before writing, in case in and out are the same
+         mInput[t & inputMask] = in[i];
+         auto& output = mOutput[(t - mBlockSize) & outputMask];
+         out[i] = output;
+         output = 0.f;
+      }
+      mCount += len;
+      in += len;
+      out += len;
+      numSamples -= len;
+      if (mCount % mBlockSize == 0)
+         ProcessBlock();
+   }
+}
+
+void PartitionedConvolver::ProcessBlock()
+{
+   // Each group when a block of its own length is complete
+   for (auto& group : mGroups)
+      if (mCount % group.blockSize == 0)
+         group.Process(
+            mInput.data(), mInput.size() - 1, mCount, mOutput.data(),
+            mOutput.size() - 1);
+}
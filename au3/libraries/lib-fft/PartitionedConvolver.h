@@ -0,0 +1,97 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  PartitionedConvolver.h
+
+**********************************************************************/
+#pragma once
+
+#include "PowerSpectrumGetter.h"
+
+#include <cstddef>
+#include <vector>
+
+/*!
+ * @brief Convolves a stream of samples with a fixed impulse response, by
+ * partitioned overlap-save FFT convolution.
+ *
+ * @details The impulse response is cut into partitions. The first ones are
+ * `blockSize` long, which is also the latency. Later partitions may be longer:
+ * each group of partitions is four times as long as the one before, up to
+ * `maxBlockSize`. Longer partitions are computed less often, with bigger FFTs,
+ * so long responses cost little more than short ones. A longer partition
+ * always begins no earlier than its own length into the response, so its
+ * output is ready in time.
+ *
+ * Each group keeps the spectra of its past input blocks, so that each
+ * partition of the response is transformed only once, at construction. Each
+ * block then costs one forward and one inverse transform per group, and one
+ * complex multiply-accumulate per partition, which pffft vectorizes.
+ *
+ * With `maxBlockSize == blockSize`, partitioning is uniform.
+ */
+class FFT_API PartitionedConvolver final
+{
+public:
+   /*!
+    * @param blockSize a power of two, at least 32
+    * @param maxBlockSize a power of two, at least `blockSize`
+    */
+   PartitionedConvolver(
+      const float* impulseResponse, size_t numTaps, size_t blockSize = 256,
+      size_t maxBlockSize = 8192);
+   ~PartitionedConvolver();
+
+   PartitionedConvolver(PartitionedConvolver&&);
+
+   //! Samples by which the output lags the input, `blockSize`
+   size_t GetLatency() const;
+
+   //! Forgets past input
+   void Reset();
+
+   //! Takes any number of samples. `in` and `out` may be the same.
+   void Process(const float* in, float* out, size_t numSamples);
+
+private:
+   //! Partitions of one length
+   struct Group
+   {
+      Group(
+         const float* impulseResponse, size_t blockSize, size_t offset,
+         size_t numPartitions);
+
+      //! Filters the last `2 * blockSize` samples of input
+      void Process(
+         const float* input, size_t inputMask, size_t end, float* output,
+         size_t outputMask);
+      void Reset();
+
+      const size_t blockSize;
+      //! Of the first tap
+      const size_t offset;
+      const size_t numPartitions;
+      PffftSetupHolder setup;
+      //! Spectra of the partitions of the response, one after the other
+      PffftFloatVector responses;
+      //! Spectra of the last `numPartitions` blocks of input, in a ring
+      PffftFloatVector inputs;
+      size_t newest = 0;
+      PffftFloatVector buffer;
+      PffftFloatVector accumulator;
+      PffftFloatVector work;
+   };
+
+   void ProcessBlock();
+
+   const size_t mBlockSize;
+   std::vector<Group> mGroups;
+
+   //! Rings of past input and of future output, sized in powers of two
+   std::vector<float> mInput;
+   std::vector<float> mOutput;
+   //! Samples taken since construction or Reset
+   size_t mCount = 0;
+};
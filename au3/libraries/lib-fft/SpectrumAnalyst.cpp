@@ -25,6 +25,98 @@ and in the spectrogram spectral selection.
 #include "SpectrumAnalyst.h"
 #include "FFT.h"
 #include "MemoryX.h"
+#include "concurrency/ThreadPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <mutex>
+
+namespace {
+// Enough to make the reads efficient and the work worth sharing
+constexpr size_t segmentSamples = 1 << 18;
+
+//! Adds to `sums` the contribution of the window of `windowSize` samples at
+//! `data`, as `alg` requires.  `in`, `out` and `out2` are scratch space of
+//! `windowSize`.
+void AccumulateWindow(SpectrumAnalyst::Algorithm alg, size_t windowSize,
+   const float *win, const float *data,
+   float *in, float *out, float *out2, float *sums)
+{
+   const auto half = windowSize / 2;
+   for (size_t i = 0; i < windowSize; i++)
+      in[i] = win[i] * data[i];
+
+   switch (alg) {
+      case SpectrumAnalyst::Spectrum:
+         PowerSpectrum(windowSize, in, out);
+
+         for (size_t i = 0; i < half; i++)
+            sums[i] += out[i];
+         break;
+
+      case SpectrumAnalyst::Autocorrelation:
+      case SpectrumAnalyst::CubeRootAutocorrelation:
+      case SpectrumAnalyst::EnhancedAutocorrelation:
+
+         // Take FFT
+         RealFFT(windowSize, in, out, out2);
+         // Compute power
+         for (size_t i = 0; i < windowSize; i++)
+            in[i] = (out[i] * out[i]) + (out2[i] * out2[i]);
+
+         if (alg == SpectrumAnalyst::Autocorrelation) {
+            for (size_t i = 0; i < windowSize; i++)
+               in[i] = sqrt(in[i]);
+         }
+         if (alg == SpectrumAnalyst::CubeRootAutocorrelation ||
+             alg == SpectrumAnalyst::EnhancedAutocorrelation) {
+            // Tolonen and Karjalainen recommend taking the cube root
+            // of the power, instead of the square root
+
+            for (size_t i = 0; i < windowSize; i++)
+               in[i] = pow(in[i], 1.0f / 3.0f);
+         }
+         // Take FFT
+         RealFFT(windowSize, in, out, out2);
+
+         // Take real part of result
+         for (size_t i = 0; i < half; i++)
+            sums[i] += out[i];
+         break;
+
+      case SpectrumAnalyst::Cepstrum:
+         RealFFT(windowSize, in, out, out2);
+
+         // Compute log power
+         // Set a sane lower limit assuming maximum time amplitude of 1.0
+         {
+            float power;
+            float minpower = 1e-20*windowSize*windowSize;
+            for (size_t i = 0; i < windowSize; i++)
+            {
+               power = (out[i] * out[i]) + (out2[i] * out2[i]);
+               if(power < minpower)
+                  in[i] = log(minpower);
+               else
+                  in[i] = log(power);
+            }
+            // Take IFFT
+            InverseRealFFT(windowSize, in, NULL, out);
+
+            // Take real part of result
+            for (size_t i = 0; i < half; i++)
+               sums[i] += out[i];
+         }
+
+         break;
+
+      default:
+         wxASSERT(false);
+         break;
+   }                         //switch
+}
+}
 
 SpectrumAnalyst::SpectrumAnalyst()
 : mAlg(Spectrum)
@@ -42,6 +134,20 @@ bool SpectrumAnalyst::Calculate(Algorithm alg, int windowFunc,
                                 const float *data, size_t dataLen,
                                 float *pYMin, float *pYMax,
                                 ProgressFn progress)
+{
+   const auto read = [data](float *buffer, size_t start, size_t len) {
+      std::copy(data + start, data + start + len, buffer);
+      return true;
+   };
+   return Calculate(alg, windowFunc, windowSize, rate, read, dataLen,
+      pYMin, pYMax, std::move(progress));
+}
+
+bool SpectrumAnalyst::Calculate(Algorithm alg, int windowFunc,
+                                size_t windowSize, double rate,
+                                const ReadFn &read, size_t dataLen,
+                                float *pYMin, float *pYMax,
+                                ProgressFn progress)
 {
    // Wipe old data
    mProcessed.resize(0);
@@ -70,9 +176,6 @@ bool SpectrumAnalyst::Calculate(Algorithm alg, int windowFunc,
    auto half = mWindowSize / 2;
    mProcessed.resize(mWindowSize);
 
-   ArrayOf<float> in{ mWindowSize };
-   ArrayOf<float> out{ mWindowSize };
-   ArrayOf<float> out2{ mWindowSize };
    ArrayOf<float> win{ mWindowSize };
 
    for (size_t i = 0; i < mWindowSize; i++) {
@@ -92,89 +195,71 @@ bool SpectrumAnalyst::Calculate(Algorithm alg, int windowFunc,
    else
       wss = 1.0;
 
-   size_t start = 0;
-   int windows = 0;
-   while (start + mWindowSize <= dataLen) {
-      for (size_t i = 0; i < mWindowSize; i++)
-         in[i] = win[i] * data[start + i];
-
-      switch (alg) {
-         case Spectrum:
-            PowerSpectrum(mWindowSize, in.get(), out.get());
-
-            for (size_t i = 0; i < half; i++)
-               mProcessed[i] += out[i];
-            break;
-
-         case Autocorrelation:
-         case CubeRootAutocorrelation:
-         case EnhancedAutocorrelation:
-
-            // Take FFT
-            RealFFT(mWindowSize, in.get(), out.get(), out2.get());
-            // Compute power
-            for (size_t i = 0; i < mWindowSize; i++)
-               in[i] = (out[i] * out[i]) + (out2[i] * out2[i]);
-
-            if (alg == Autocorrelation) {
-               for (size_t i = 0; i < mWindowSize; i++)
-                  in[i] = sqrt(in[i]);
-            }
-            if (alg == CubeRootAutocorrelation ||
-                alg == EnhancedAutocorrelation) {
-               // Tolonen and Karjalainen recommend taking the cube root
-               // of the power, instead of the square root
-
-               for (size_t i = 0; i < mWindowSize; i++)
-                  in[i] = pow(in[i], 1.0f / 3.0f);
-            }
-            // Take FFT
-            RealFFT(mWindowSize, in.get(), out.get(), out2.get());
-
-            // Take real part of result
-            for (size_t i = 0; i < half; i++)
-               mProcessed[i] += out[i];
-            break;
-
-         case Cepstrum:
-            RealFFT(mWindowSize, in.get(), out.get(), out2.get());
-
-            // Compute log power
-            // Set a sane lower limit assuming maximum time amplitude of 1.0
-            {
-               float power;
-               float minpower = 1e-20*mWindowSize*mWindowSize;
-               for (size_t i = 0; i < mWindowSize; i++)
-               {
-                  power = (out[i] * out[i]) + (out2[i] * out2[i]);
-                  if(power < minpower)
-                     in[i] = log(minpower);
-                  else
-                     in[i] = log(power);
-               }
-               // Take IFFT
-               InverseRealFFT(mWindowSize, in.get(), NULL, out.get());
-
-               // Take real part of result
-               for (size_t i = 0; i < half; i++)
-                  mProcessed[i] += out[i];
-            }
-
-            break;
+   // Windows overlap by half.  Consecutive windows are grouped in segments,
+   // each read at once and summed by one of several workers, then added to
+   // the total.  Memory doesn't depend on dataLen.
+   const size_t windows = (dataLen - mWindowSize) / half + 1;
+   const size_t windowsPerSegment =
+      std::max<size_t>(1, segmentSamples / half);
+   const size_t numSegments =
+      (windows + windowsPerSegment - 1) / windowsPerSegment;
+
+   std::atomic<size_t> windowsDone{ 0 };
+   std::atomic<bool> failed{ false };
+   std::mutex readMutex;
+   std::mutex sumMutex;
+   std::vector<double> sum(half, 0.0);
+
+   const auto render = [&](size_t segment, const std::atomic<bool> &cancelled) {
+      if (cancelled)
+         return;
+      const auto first = segment * windowsPerSegment;
+      const auto count = std::min(windowsPerSegment, windows - first);
+      std::vector<float> samples((count - 1) * half + mWindowSize);
+      {
+         std::lock_guard<std::mutex> lock{ readMutex };
+         if (!read(samples.data(), first * half, samples.size())) {
+            failed = true;
+            return;
+         }
+      }
+      // Sum each segment in float, as did the serial computation, but
+      // the segments in double, so that long selections lose no
+      // precision
+      ArrayOf<float> in{ mWindowSize };
+      ArrayOf<float> out{ mWindowSize };
+      ArrayOf<float> out2{ mWindowSize };
+      std::vector<float> segmentSum(half, 0.0f);
+      for (size_t w = 0; w < count; ++w)
+         AccumulateWindow(alg, mWindowSize, win.get(),
+            samples.data() + w * half, in.get(), out.get(), out2.get(),
+            segmentSum.data());
+      {
+         std::lock_guard<std::mutex> lock{ sumMutex };
+         for (size_t i = 0; i < half; i++)
+            sum[i] += segmentSum[i];
+      }
+      windowsDone += count;
+   };
 
-         default:
-            wxASSERT(false);
-            break;
-      }                         //switch
+   const auto poll = [&] {
+      if (progress)
+         progress(std::min(windowsDone * half, dataLen), dataLen);
+      return !failed;
+   };
 
-      if (progress) {
-         progress(start, dataLen);
-      }
+   using namespace audacity::concurrency;
+   RenderInParallel(numSegments, render, poll);
 
-      start += half;
-      windows++;
+   if (failed) {
+      mProcessed.resize(0);
+      return false;
    }
 
+   for (size_t i = 0; i < half; i++)
+      mProcessed[i] += sum[i];
+
+   ArrayOf<float> out{ mWindowSize };
    float mYMin = 1000000, mYMax = -1000000;
    double scale;
    switch (alg) {
@@ -33,6 +33,9 @@ public:
    SpectrumAnalyst();
    ~SpectrumAnalyst();
 
+   //! Fills `buffer` with `len` samples from `start`; returns false on failure
+   using ReadFn = std::function<bool(float *buffer, size_t start, size_t len)>;
+
    // Return true iff successful
    bool Calculate(Algorithm alg,
       int windowFunc, // see FFT.h for values
@@ -41,6 +44,17 @@ public:
       float *pYMin = NULL, float *pYMax = NULL, // outputs
       ProgressFn progress = NULL);
 
+   //! Like the above, but with the samples read in chunks as needed, so that
+   //! memory doesn't depend on `dataLen`.  The windows are shared among
+   //! worker threads; `read` is called from those, but never by two at once.
+   //! `progress` is called from the calling thread only.
+   bool Calculate(Algorithm alg,
+      int windowFunc, // see FFT.h for values
+      size_t windowSize, double rate,
+      const ReadFn &read, size_t dataLen,
+      float *pYMin = NULL, float *pYMax = NULL, // outputs
+      ProgressFn progress = NULL);
+
    const float *GetProcessed() const;
    int GetProcessedSize() const;
 
@@ -0,0 +1,103 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  PartitionedConvolverTests.cpp
+
+**********************************************************************/
+#include "PartitionedConvolver.h"
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace
+{
+std::vector<float> MakeNoise(size_t numSamples, unsigned seed)
+{
+   std::mt19937 gen { seed };
+   std::uniform_real_distribution<float> noise { -1.f, 1.f };
+   std::vector<float> samples(numSamples);
+   for (auto& sample : samples)
+      sample = noise(gen);
+   return samples;
+}
+
+std::vector<double>
+Convolve(const std::vector<float>& signal, const std::vector<float>& response)
+{
+   std::vector<double> result(signal.size(), 0.);
+   for (size_t i = 0; i < signal.size(); ++i)
+      for (size_t j = 0; j < response.size() && j <= i; ++j)
+         result[i] += static_cast<double>(response[j]) * signal[i - j];
+   return result;
+}
+
+// Processes in irregular chunks, in place
+std::vector<float>
+Process(PartitionedConvolver& sut, const std::vector<float>& signal)
+{
+   auto output = signal;
+   size_t chunkSize = 1;
+   for (size_t start = 0; start < output.size();)
+   {
+      const auto len = std::min(chunkSize, output.size() - start);
+      sut.Process(output.data() + start, output.data() + start, len);
+      start += len;
+      chunkSize = chunkSize * 7 % 1009;
+   }
+   return output;
+}
+} // namespace
+
+TEST_CASE("PartitionedConvolver")
+{
+   constexpr size_t numSamples = 20000;
+   const auto signal = MakeNoise(numSamples, 0);
+
+   SECTION("matches direct convolution")
+   {
+      for (const auto numTaps : { 1u, 100u, 1000u, 8191u })
+         for (const auto& [blockSize, maxBlockSize] :
+              { std::pair<size_t, size_t> { 32, 32 }, { 64, 8192 },
+                { 256, 1024 } })
+         {
+            const auto response = MakeNoise(numTaps, 1);
+            PartitionedConvolver sut { response.data(), numTaps, blockSize,
+                                       maxBlockSize };
+            REQUIRE(sut.GetLatency() == blockSize);
+            const auto output = Process(sut, signal);
+            const auto expected = Convolve(signal, response);
+            // Noise in, noise out: the margin scales with the square root of
+            // the number of taps.
+            const auto margin = 1e-5 * std::sqrt(numTaps);
+            for (size_t i = 0; i < blockSize; ++i)
+               REQUIRE(output[i] == 0.f);
+            for (size_t i = blockSize; i < numSamples; ++i)
+               REQUIRE(output[i] == Approx(expected[i - blockSize]).margin(margin));
+         }
+   }
+
+   SECTION("Reset forgets the past input")
+   {
+      const auto response = MakeNoise(3000, 2);
+      PartitionedConvolver sut { response.data(), response.size(), 128, 2048 };
+      const auto first = Process(sut, signal);
+      sut.Reset();
+      const auto second = Process(sut, signal);
+      REQUIRE(first == second);
+   }
+
+   SECTION("empty response gives silence")
+   {
+      PartitionedConvolver sut { nullptr, 0, 32, 32 };
+      const auto output = Process(sut, signal);
+      REQUIRE(std::all_of(output.begin(), output.end(), [](float sample) {
+         return sample == 0.f;
+      }));
+   }
+}
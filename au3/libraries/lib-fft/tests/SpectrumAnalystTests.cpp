@@ -0,0 +1,115 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  SpectrumAnalystTests.cpp
+
+**********************************************************************/
+#include "SpectrumAnalyst.h"
+
+#include "FFT.h"
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace
+{
+constexpr auto pi = 3.141592653589793;
+
+// A sine on bin 100 of 1024, with some noise on top
+std::vector<float> MakeSignal(size_t numSamples)
+{
+   std::vector<float> signal(numSamples);
+   unsigned seed = 1;
+   for (size_t i = 0; i < numSamples; ++i)
+   {
+      seed = seed * 1103515245 + 12345;
+      const auto noise = static_cast<float>(seed >> 16) / 65536.f - .5f;
+      signal[i] = std::sin(2 * pi * 100 * i / 1024) + .1f * noise;
+   }
+   return signal;
+}
+} // namespace
+
+TEST_CASE("SpectrumAnalyst")
+{
+   constexpr size_t windowSize = 1024;
+   // Several segments, and a tail shorter than a window
+   constexpr size_t numSamples = 3000000 + 300;
+   const auto signal = MakeSignal(numSamples);
+
+   SECTION("averages all the windows, reading in chunks")
+   {
+      // Serial reference: Hann windows overlapping by half
+      std::vector<float> window(windowSize, 1.f);
+      WindowFunc(eWinFuncHann, windowSize, window.data());
+      double windowSum = 0;
+      for (const auto w : window)
+         windowSum += w;
+      std::vector<double> sum(windowSize / 2);
+      std::vector<float> in(windowSize), out(windowSize);
+      size_t numWindows = 0;
+      for (size_t start = 0; start + windowSize <= numSamples;
+           start += windowSize / 2, ++numWindows)
+      {
+         for (size_t i = 0; i < windowSize; ++i)
+            in[i] = window[i] * signal[start + i];
+         PowerSpectrum(windowSize, in.data(), out.data());
+         for (size_t i = 0; i < windowSize / 2; ++i)
+            sum[i] += out[i];
+      }
+      const auto scale = 4 / (windowSum * windowSum) / numWindows;
+
+      size_t maxRead = 0;
+      const auto read = [&](float* buffer, size_t start, size_t len) {
+         // Calls don't overlap, but they come from other threads: no REQUIRE
+         maxRead = std::max(maxRead, len);
+         if (start + len > numSamples)
+            return false;
+         std::copy(
+            signal.begin() + start, signal.begin() + start + len, buffer);
+         return true;
+      };
+      SpectrumAnalyst sut;
+      REQUIRE(sut.Calculate(
+         SpectrumAnalyst::Spectrum, eWinFuncHann, windowSize, 44100., read,
+         numSamples));
+      // Memory doesn't grow with the selection.
+      REQUIRE(maxRead < numSamples / 4);
+
+      REQUIRE(sut.GetProcessedSize() == windowSize / 2);
+      for (size_t i = 0; i < windowSize / 2; ++i)
+         REQUIRE(
+            sut.GetProcessed()[i] ==
+            Approx(10 * std::log10(sum[i] * scale)).margin(1e-3));
+   }
+
+   SECTION("finds the frequency")
+   {
+      SpectrumAnalyst sut;
+      REQUIRE(sut.Calculate(
+         SpectrumAnalyst::Spectrum, eWinFuncHann, windowSize, 44100.,
+         signal.data(), numSamples));
+      const auto processed = sut.GetProcessed();
+      const auto peak =
+         std::max_element(processed, processed + sut.GetProcessedSize()) -
+         processed;
+      REQUIRE(peak == 100);
+   }
+
+   SECTION("fails when reading fails")
+   {
+      SpectrumAnalyst sut;
+      const auto read = [&](float* buffer, size_t start, size_t len) {
+         std::fill(buffer, buffer + len, 0.f);
+         return start < numSamples / 2;
+      };
+      REQUIRE(!sut.Calculate(
+         SpectrumAnalyst::Spectrum, eWinFuncHann, windowSize, 44100., read,
+         numSamples));
+   }
+}
@@ -0,0 +1,274 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file SharedAudioChannel.cpp
+
+  Part of lib-ipc library
+
+**********************************************************************/
+
+#include "SharedAudioChannel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+#include "internal/SharedMemory.h"
+
+namespace
+{
+constexpr uint32_t Magic { 0x41554443 };
+constexpr uint32_t Version { 1 };
+
+//Positions count frames modulo 2^32, so the capacity is a power of two
+//not above 2^31, and a position modulo the capacity is an offset in the ring
+struct alignas(64) RingHeader
+{
+   //Kept on separate cache lines, as each is written by one side only
+   alignas(64) std::atomic<uint32_t> writePosition;
+   std::atomic<uint32_t> readerWaiting;
+   alignas(64) std::atomic<uint32_t> readPosition;
+   std::atomic<uint32_t> writerWaiting;
+};
+
+struct ChannelHeader
+{
+   uint32_t magic;
+   uint32_t version;
+   uint32_t channels;
+   uint32_t capacity;
+   //To the guest, then back to the host
+   RingHeader rings[2];
+};
+
+size_t RequiredSize(size_t channels, size_t capacity)
+{
+   return sizeof(ChannelHeader) + 2 * channels * capacity * sizeof(float);
+}
+
+class Ring final
+{
+   RingHeader& mHeader;
+   //Samples of each channel in turn
+   float* const mData;
+   const size_t mChannels;
+   const uint32_t mCapacity;
+
+   template<typename Ready>
+   bool Wait(std::atomic<uint32_t>& position, std::atomic<uint32_t>& waiting,
+      std::chrono::milliseconds timeout, Ready ready)
+   {
+      using namespace std::chrono;
+      const auto deadline = steady_clock::now() + timeout;
+      auto observed = position.load(std::memory_order_acquire);
+      while(!ready(observed))
+      {
+         const auto now = steady_clock::now();
+         if(now >= deadline)
+            return false;
+         //Announce the wait before checking again, so that the other side,
+         //which changes the position before checking the announcement,
+         //either wakes this side or is seen by it
+         waiting.store(1, std::memory_order_seq_cst);
+         if(position.load(std::memory_order_seq_cst) == observed)
+            WaitWhileEqual(position, observed, deadline - now);
+         waiting.store(0, std::memory_order_relaxed);
+         observed = position.load(std::memory_order_acquire);
+      }
+      return true;
+   }
+
+   static void Publish(std::atomic<uint32_t>& position, uint32_t value,
+      std::atomic<uint32_t>& waiting)
+   {
+      position.store(value, std::memory_order_seq_cst);
+      if(waiting.load(std::memory_order_seq_cst) != 0)
+         WakeAll(position);
+   }
+
+public:
+   Ring(RingHeader& header, float* data, size_t channels, uint32_t capacity)
+      : mHeader(header), mData(data), mChannels(channels), mCapacity(capacity)
+   {
+   }
+
+   bool Write(const float* const* buffers, size_t frames,
+      std::chrono::milliseconds timeout)
+   {
+      //Only this side writes the write position
+      const auto write = mHeader.writePosition.load(std::memory_order_relaxed);
+      if(!Wait(mHeader.readPosition, mHeader.writerWaiting, timeout,
+         [&](uint32_t read) { return mCapacity - (write - read) >= frames; }))
+         return false;
+
+      const auto offset = write & (mCapacity - 1);
+      const auto first = std::min<size_t>(frames, mCapacity - offset);
+      for(size_t channel = 0; channel < mChannels; ++channel)
+      {
+         const auto ring = mData + channel * mCapacity;
+         std::memcpy(ring + offset, buffers[channel], first * sizeof(float));
+         std::memcpy(ring, buffers[channel] + first, (frames - first) * sizeof(float));
+      }
+      Publish(mHeader.writePosition, write + static_cast<uint32_t>(frames),
+         mHeader.readerWaiting);
+      return true;
+   }
+
+   bool Read(float* const* buffers, size_t frames,
+      std::chrono::milliseconds timeout)
+   {
+      //Only this side writes the read position
+      const auto read = mHeader.readPosition.load(std::memory_order_relaxed);
+      if(!Wait(mHeader.writePosition, mHeader.readerWaiting, timeout,
+         [&](uint32_t write) { return write - read >= frames; }))
+         return false;
+
+      const auto offset = read & (mCapacity - 1);
+      const auto first = std::min<size_t>(frames, mCapacity - offset);
+      for(size_t channel = 0; channel < mChannels; ++channel)
+      {
+         const auto ring = mData + channel * mCapacity;
+         std::memcpy(buffers[channel], ring + offset, first * sizeof(float));
+         std::memcpy(buffers[channel] + first, ring, (frames - first) * sizeof(float));
+      }
+      Publish(mHeader.readPosition, read + static_cast<uint32_t>(frames),
+         mHeader.writerWaiting);
+      return true;
+   }
+};
+}
+
+class SharedAudioChannel::Impl
+{
+   SharedMemory mMemory;
+   ChannelHeader& mHeader;
+   Ring mOutput;
+   Ring mInput;
+
+   static ChannelHeader& Init(SharedMemory& memory, size_t channels, uint32_t capacity)
+   {
+      //The memory starts zero-filled, so the rings start empty
+      auto& header = *static_cast<ChannelHeader*>(memory.GetData());
+      header.channels = static_cast<uint32_t>(channels);
+      header.capacity = capacity;
+      header.version = Version;
+      header.magic = Magic;
+      return header;
+   }
+
+   static ChannelHeader& Check(SharedMemory& memory)
+   {
+      if(memory.GetSize() < sizeof(ChannelHeader))
+         throw std::runtime_error("not a shared audio channel");
+      auto& header = *static_cast<ChannelHeader*>(memory.GetData());
+      if(header.magic != Magic || header.version != Version ||
+         header.capacity == 0 || (header.capacity & (header.capacity - 1)) != 0 ||
+         memory.GetSize() < RequiredSize(header.channels, header.capacity))
+         throw std::runtime_error("not a shared audio channel");
+      return header;
+   }
+
+   Ring MakeRing(size_t index)
+   {
+      const auto data = reinterpret_cast<float*>(&mHeader + 1);
+      return {
+         mHeader.rings[index], data + index * mHeader.channels * mHeader.capacity,
+         mHeader.channels, mHeader.capacity
+      };
+   }
+
+public:
+   //Host side
+   Impl(size_t channels, uint32_t capacity)
+      : mMemory(RequiredSize(channels, capacity))
+      , mHeader(Init(mMemory, channels, capacity))
+      , mOutput(MakeRing(0))
+      , mInput(MakeRing(1))
+   {
+   }
+
+   //Guest side
+   explicit Impl(const std::string& name)
+      : mMemory(name)
+      , mHeader(Check(mMemory))
+      , mOutput(MakeRing(1))
+      , mInput(MakeRing(0))
+   {
+   }
+
+   const std::string& GetName() const noexcept { return mMemory.GetName(); }
+   size_t GetChannels() const noexcept { return mHeader.channels; }
+   size_t GetCapacity() const noexcept { return mHeader.capacity; }
+
+   bool Write(const float* const* buffers, size_t frames,
+      std::chrono::milliseconds timeout)
+   {
+      if(frames > mHeader.capacity)
+         throw std::invalid_argument("block exceeds shared audio channel capacity");
+      return mOutput.Write(buffers, frames, timeout);
+   }
+
+   bool Read(float* const* buffers, size_t frames,
+      std::chrono::milliseconds timeout)
+   {
+      if(frames > mHeader.capacity)
+         throw std::invalid_argument("block exceeds shared audio channel capacity");
+      return mInput.Read(buffers, frames, timeout);
+   }
+};
+
+namespace
+{
+uint32_t RoundCapacity(size_t channels, size_t capacity)
+{
+   constexpr uint32_t maxCapacity { 1u << 31 };
+   if(channels == 0 || capacity == 0 || capacity > maxCapacity)
+      throw std::invalid_argument("bad shared audio channel dimensions");
+   uint32_t result { 1 };
+   while(result < capacity)
+      result <<= 1;
+   return result;
+}
+}
+
+SharedAudioChannel::SharedAudioChannel(size_t channels, size_t capacity)
+   : mImpl(std::make_unique<Impl>(channels, RoundCapacity(channels, capacity)))
+{
+}
+
+SharedAudioChannel::SharedAudioChannel(const std::string& name)
+   : mImpl(std::make_unique<Impl>(name))
+{
+}
+
+SharedAudioChannel::~SharedAudioChannel() = default;
+
+const std::string& SharedAudioChannel::GetName() const noexcept
+{
+   return mImpl->GetName();
+}
+
+size_t SharedAudioChannel::GetChannels() const noexcept
+{
+   return mImpl->GetChannels();
+}
+
+size_t SharedAudioChannel::GetCapacity() const noexcept
+{
+   return mImpl->GetCapacity();
+}
+
+bool SharedAudioChannel::Write(const float* const* buffers, size_t frames,
+   std::chrono::milliseconds timeout)
+{
+   return mImpl->Write(buffers, frames, timeout);
+}
+
+bool SharedAudioChannel::Read(float* const* buffers, size_t frames,
+   std::chrono::milliseconds timeout)
+{
+   return mImpl->Read(buffers, frames, timeout);
+}
@@ -0,0 +1,78 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file SharedAudioChannel.h
+
+  Part of lib-ipc library
+
+**********************************************************************/
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <string>
+
+/**
+ * \brief Transports blocks of audio between a host process and a guest
+ * process, such as one hosting a plugin, through two single-producer
+ * single-consumer ring buffers in shared memory: one toward the guest and one
+ * back to the host.
+ *
+ * Samples never pass through a socket or the kernel: each side copies them
+ * in and out of the mapped memory, and sleeps only while the ring it waits
+ * on is full or empty. Waking the other side is a futex wake on Linux, and
+ * costs nothing when the other side isn't waiting.
+ *
+ * The host creates the channel and passes GetName() to the guest over a
+ * control channel (see IPCChannel), which then opens it by that name.
+ * Each side must use a channel from one thread at a time.
+ */
+class IPC_API SharedAudioChannel final
+{
+   class Impl;
+   std::unique_ptr<Impl> mImpl;
+public:
+   /**
+    * \brief Creates a channel on the host side, may fail with exception
+    * \param channels Number of audio channels of each block
+    * \param capacity Number of frames that each ring holds at least, in each channel
+    */
+   SharedAudioChannel(size_t channels, size_t capacity);
+   /**
+    * \brief Opens the channel on the guest side, may fail with exception
+    * \param name As returned by the host's SharedAudioChannel::GetName
+    */
+   explicit SharedAudioChannel(const std::string& name);
+   ~SharedAudioChannel();
+
+   ///Identifies the channel to the guest
+   const std::string& GetName() const noexcept;
+
+   size_t GetChannels() const noexcept;
+
+   ///Greatest number of frames that can be written before any are read
+   size_t GetCapacity() const noexcept;
+
+   /**
+    * \brief Writes frames to the other side, waiting for room if necessary
+    * \param buffers One pointer to `frames` samples per channel
+    * \param frames Not more than GetCapacity()
+    * \return false if there was no room before the timeout, which suggests
+    * the other side hangs or has died; nothing is written then
+    */
+   bool Write(const float* const* buffers, size_t frames,
+      std::chrono::milliseconds timeout);
+
+   /**
+    * \brief Reads frames from the other side, waiting for them if necessary
+    * \param buffers One pointer to room for `frames` samples per channel
+    * \param frames Not more than GetCapacity()
+    * \return false if the frames didn't come before the timeout, which
+    * suggests the other side hangs or has died; nothing is read then
+    */
+   bool Read(float* const* buffers, size_t frames,
+      std::chrono::milliseconds timeout);
+};
@@ -0,0 +1,202 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file SharedMemory.cpp
+
+  Part of lib-ipc library
+
+**********************************************************************/
+
+#include "SharedMemory.h"
+
+#include <stdexcept>
+#include <thread>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+#include <climits>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#endif
+
+namespace
+{
+std::string MakeUniqueName()
+{
+   static std::atomic<unsigned> counter {0};
+#ifdef _WIN32
+   const auto pid = GetCurrentProcessId();
+   std::string name { "Local\\audacity-ipc-" };
+#else
+   const auto pid = getpid();
+   std::string name { "/audacity-ipc-" };
+#endif
+   return name + std::to_string(pid) + "-" + std::to_string(counter++);
+}
+}
+
+#ifdef _WIN32
+
+SharedMemory::SharedMemory(size_t size)
+   : mName(MakeUniqueName())
+   , mSize(size)
+   , mOwner(true)
+{
+   const auto size64 = static_cast<unsigned long long>(size);
+   mHandle = CreateFileMappingA(
+      INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+      static_cast<DWORD>(size64 >> 32), static_cast<DWORD>(size64),
+      mName.c_str());
+   if(mHandle == nullptr)
+      throw std::runtime_error("cannot create shared memory");
+   mData = MapViewOfFile(mHandle, FILE_MAP_ALL_ACCESS, 0, 0, size);
+   if(mData == nullptr)
+   {
+      CloseHandle(mHandle);
+      throw std::runtime_error("cannot map shared memory");
+   }
+}
+
+SharedMemory::SharedMemory(const std::string& name)
+   : mName(name)
+{
+   mHandle = OpenFileMappingA(FILE_MAP_ALL_ACCESS, FALSE, mName.c_str());
+   if(mHandle == nullptr)
+      throw std::runtime_error("cannot open shared memory");
+   mData = MapViewOfFile(mHandle, FILE_MAP_ALL_ACCESS, 0, 0, 0);
+   MEMORY_BASIC_INFORMATION info{};
+   if(mData == nullptr || VirtualQuery(mData, &info, sizeof(info)) == 0)
+   {
+      if(mData != nullptr)
+         UnmapViewOfFile(mData);
+      CloseHandle(mHandle);
+      throw std::runtime_error("cannot map shared memory");
+   }
+   mSize = info.RegionSize;
+}
+
+SharedMemory::~SharedMemory()
+{
+   UnmapViewOfFile(mData);
+   //The mapping is destroyed with its last handle
+   CloseHandle(mHandle);
+}
+
+#else
+
+SharedMemory::SharedMemory(size_t size)
+   : mName(MakeUniqueName())
+   , mSize(size)
+   , mOwner(true)
+{
+   const auto fd = shm_open(mName.c_str(), O_CREAT | O_EXCL | O_RDWR, S_IRUSR | S_IWUSR);
+   if(fd == -1)
+      throw std::runtime_error("cannot create shared memory");
+   if(ftruncate(fd, static_cast<off_t>(size)) == -1)
+   {
+      close(fd);
+      shm_unlink(mName.c_str());
+      throw std::runtime_error("cannot resize shared memory");
+   }
+   mData = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+   //The mapping holds the memory; the descriptor is no longer needed
+   close(fd);
+   if(mData == MAP_FAILED)
+   {
+      shm_unlink(mName.c_str());
+      throw std::runtime_error("cannot map shared memory");
+   }
+}
+
+SharedMemory::SharedMemory(const std::string& name)
+   : mName(name)
+{
+   const auto fd = shm_open(mName.c_str(), O_RDWR, 0);
+   if(fd == -1)
+      throw std::runtime_error("cannot open shared memory");
+   struct stat st{};
+   if(fstat(fd, &st) == -1 || st.st_size <= 0)
+   {
+      close(fd);
+      throw std::runtime_error("cannot open shared memory");
+   }
+   mSize = static_cast<size_t>(st.st_size);
+   mData = mmap(nullptr, mSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+   close(fd);
+   if(mData == MAP_FAILED)
+      throw std::runtime_error("cannot map shared memory");
+}
+
+SharedMemory::~SharedMemory()
+{
+   munmap(mData, mSize);
+   if(mOwner)
+      shm_unlink(mName.c_str());
+}
+
+#endif
+
+#ifdef __linux__
+
+void WaitWhileEqual(
+   const std::atomic<uint32_t>& value, uint32_t expected,
+   std::chrono::nanoseconds timeout) noexcept
+{
+   if(timeout <= std::chrono::nanoseconds::zero())
+      return;
+   const auto seconds = std::chrono::duration_cast<std::chrono::seconds>(timeout);
+   timespec ts{};
+   ts.tv_sec = static_cast<time_t>(seconds.count());
+   ts.tv_nsec = static_cast<long>((timeout - seconds).count());
+   //Not FUTEX_PRIVATE_FLAG: the other side is in another process.
+   //The kernel compares the value before sleeping, so a change
+   //made since the caller looked is never missed
+   syscall(
+      SYS_futex, reinterpret_cast<const uint32_t*>(&value), FUTEX_WAIT,
+      expected, &ts, nullptr, 0);
+}
+
+void WakeAll(std::atomic<uint32_t>& value) noexcept
+{
+   syscall(
+      SYS_futex, reinterpret_cast<uint32_t*>(&value), FUTEX_WAKE, INT_MAX,
+      nullptr, nullptr, 0);
+}
+
+#else
+
+//Without a portable way to wait on an address shared between
+//processes, poll: spin briefly for low latency, then sleep
+void WaitWhileEqual(
+   const std::atomic<uint32_t>& value, uint32_t expected,
+   std::chrono::nanoseconds timeout) noexcept
+{
+   using namespace std::chrono;
+   const auto deadline = steady_clock::now() + timeout;
+   for(int i = 0; i < 1000; ++i)
+   {
+      if(value.load(std::memory_order_acquire) != expected)
+         return;
+      std::this_thread::yield();
+   }
+   while(value.load(std::memory_order_acquire) == expected &&
+      steady_clock::now() < deadline)
+      std::this_thread::sleep_for(microseconds(50));
+}
+
+void WakeAll(std::atomic<uint32_t>&) noexcept
+{
+}
+
+#endif
@@ -0,0 +1,76 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file SharedMemory.h
+
+  Part of lib-ipc library
+
+**********************************************************************/
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * \brief Named region of memory, mapped into each process that opens it.
+ * Throws std::runtime_error when the region can't be created or opened.
+ */
+class SharedMemory final
+{
+   std::string mName;
+   void* mData {nullptr};
+   size_t mSize {0};
+   bool mOwner {false};
+#ifdef _WIN32
+   void* mHandle {nullptr};
+#endif
+
+public:
+   /**
+    * \brief Creates a new zero-filled region with a unique name
+    */
+   explicit SharedMemory(size_t size);
+   /**
+    * \brief Opens a region created by another process
+    * \param name As returned by SharedMemory::GetName of the creator
+    */
+   explicit SharedMemory(const std::string& name);
+   /**
+    * \brief Unmaps the region. The creator also removes the name, though
+    * the memory lives as long as it stays mapped elsewhere.
+    */
+   ~SharedMemory();
+
+   SharedMemory(const SharedMemory&) = delete;
+   SharedMemory& operator=(const SharedMemory&) = delete;
+
+   const std::string& GetName() const noexcept { return mName; }
+   void* GetData() const noexcept { return mData; }
+   size_t GetSize() const noexcept { return mSize; }
+};
+
+static_assert(
+   std::atomic<uint32_t>::is_always_lock_free &&
+      sizeof(std::atomic<uint32_t>) == sizeof(uint32_t),
+   "Atomics in shared memory must be address-free");
+
+/**
+ * \brief Blocks while `value` equals `expected`, for no longer than
+ * `timeout`. May return early, so callers check again in a loop.
+ * Works across processes for values in SharedMemory: uses a futex on Linux,
+ * and short sleeps elsewhere.
+ */
+void WaitWhileEqual(
+   const std::atomic<uint32_t>& value, uint32_t expected,
+   std::chrono::nanoseconds timeout) noexcept;
+
+/**
+ * \brief Wakes all threads, of any process, blocked in WaitWhileEqual on
+ * `value`
+ */
+void WakeAll(std::atomic<uint32_t>& value) noexcept;
@@ -0,0 +1,113 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  SharedAudioChannelBenchmark.cpp
+
+**********************************************************************/
+#include "SharedAudioChannel.h"
+
+#include <catch2/catch.hpp>
+
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+// Benchmarks are not meant to be run on CI. Set to `true` to run locally.
+constexpr auto runLocally = false;
+
+using namespace std::chrono_literals;
+
+constexpr size_t numChannels = 2;
+constexpr size_t numBlocks = 20000;
+
+// Stands for the plugin
+void Process(float* const* buffers, size_t frames)
+{
+   for (size_t c = 0; c < numChannels; ++c)
+      for (size_t i = 0; i < frames; ++i)
+         buffers[c][i] *= .5f;
+}
+
+// Runs the guest side: reads, processes and writes back each block
+void Serve(const std::string& name, size_t blockSize)
+{
+   SharedAudioChannel guest { name };
+   std::vector<float> samples(numChannels * blockSize);
+   std::vector<float*> buffers { samples.data(), samples.data() + blockSize };
+   for (size_t i = 0; i < numBlocks; ++i)
+   {
+      if (!guest.Read(buffers.data(), blockSize, 10s))
+         return;
+      Process(buffers.data(), blockSize);
+      if (!guest.Write(buffers.data(), blockSize, 10s))
+         return;
+   }
+}
+
+// Microseconds per block
+template <typename RoundTrip> double Measure(RoundTrip roundTrip)
+{
+   const auto start = std::chrono::steady_clock::now();
+   for (size_t i = 0; i < numBlocks; ++i)
+      roundTrip();
+   const std::chrono::duration<double, std::micro> elapsed =
+      std::chrono::steady_clock::now() - start;
+   return elapsed.count() / numBlocks;
+}
+} // namespace
+
+TEST_CASE("SharedAudioChannelBenchmark")
+{
+   // Compares processing of blocks in process with their round trip to
+   // another process, where they are processed, by block size
+   if (!runLocally)
+      return;
+
+   for (const size_t blockSize : { 16, 64, 256, 1024, 4096 })
+   {
+      std::vector<float> samples(numChannels * blockSize, 1.f);
+      std::vector<float*> buffers { samples.data(), samples.data() + blockSize };
+
+      const auto inProcess =
+         Measure([&] { Process(buffers.data(), blockSize); });
+
+      SharedAudioChannel host { numChannels, blockSize };
+#ifdef _WIN32
+      // A thread of this process stands for the other process
+      std::thread remote { [&] { Serve(host.GetName(), blockSize); } };
+#else
+      const auto pid = fork();
+      REQUIRE(pid >= 0);
+      if (pid == 0)
+      {
+         Serve(host.GetName(), blockSize);
+         _exit(0);
+      }
+#endif
+      bool ok = true;
+      const auto outOfProcess = Measure([&] {
+         ok = ok && host.Write(buffers.data(), blockSize, 10s) &&
+              host.Read(buffers.data(), blockSize, 10s);
+      });
+#ifdef _WIN32
+      remote.join();
+#else
+      waitpid(pid, nullptr, 0);
+#endif
+      REQUIRE(ok);
+
+      std::cout << blockSize << " frames, " << numChannels
+                << " channels: " << inProcess << " us in process, "
+                << outOfProcess << " us with round trip to another process\n";
+   }
+}
@@ -0,0 +1,114 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  SharedAudioChannelTest.cpp
+
+**********************************************************************/
+#include "SharedAudioChannel.h"
+
+#include <catch2/catch.hpp>
+
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace
+{
+using namespace std::chrono_literals;
+
+constexpr size_t numChannels = 2;
+
+struct Buffers
+{
+   std::vector<std::vector<float>> channels;
+   std::vector<float*> pointers;
+
+   explicit Buffers(size_t frames)
+       : channels(numChannels, std::vector<float>(frames))
+   {
+      for (auto& channel : channels)
+         pointers.push_back(channel.data());
+   }
+};
+} // namespace
+
+TEST_CASE("SharedAudioChannel")
+{
+   SharedAudioChannel host { numChannels, 100 };
+   REQUIRE(host.GetChannels() == numChannels);
+   // Rounded up to a power of two
+   REQUIRE(host.GetCapacity() == 128);
+
+   SharedAudioChannel guest { host.GetName() };
+   REQUIRE(guest.GetChannels() == numChannels);
+   REQUIRE(guest.GetCapacity() == 128);
+
+   SECTION("blocks make the round trip through another thread")
+   {
+      // Odd block sizes, so that blocks wrap around the ends of the rings
+      constexpr size_t blockSize = 37;
+      constexpr size_t numBlocks = 1000;
+
+      std::thread remote { [&] {
+         Buffers block { blockSize };
+         for (size_t i = 0; i < numBlocks; ++i)
+         {
+            if (!guest.Read(block.pointers.data(), blockSize, 10s))
+               return;
+            for (auto& channel : block.channels)
+               for (auto& sample : channel)
+                  sample *= 2;
+            if (!guest.Write(block.pointers.data(), blockSize, 10s))
+               return;
+         }
+      } };
+
+      Buffers in { blockSize };
+      Buffers out { blockSize };
+      bool ok = true;
+      for (size_t i = 0; ok && i < numBlocks; ++i)
+      {
+         for (size_t c = 0; c < numChannels; ++c)
+            for (size_t j = 0; j < blockSize; ++j)
+               in.channels[c][j] = static_cast<float>(i * 1000 + c * 100 + j);
+         ok = host.Write(in.pointers.data(), blockSize, 10s) &&
+              host.Read(out.pointers.data(), blockSize, 10s);
+         for (size_t c = 0; ok && c < numChannels; ++c)
+            for (size_t j = 0; ok && j < blockSize; ++j)
+               ok = out.channels[c][j] == 2 * in.channels[c][j];
+      }
+      remote.join();
+      REQUIRE(ok);
+   }
+
+   SECTION("reading times out when the other side writes nothing")
+   {
+      Buffers block { 1 };
+      REQUIRE(!host.Read(block.pointers.data(), 1, 10ms));
+      REQUIRE(!guest.Read(block.pointers.data(), 1, 10ms));
+   }
+
+   SECTION("writing times out when the other side reads nothing")
+   {
+      Buffers block { host.GetCapacity() };
+      REQUIRE(host.Write(block.pointers.data(), host.GetCapacity(), 10ms));
+      REQUIRE(!host.Write(block.pointers.data(), 1, 10ms));
+      // But the guest can still write toward the host
+      REQUIRE(guest.Write(block.pointers.data(), 1, 10ms));
+   }
+
+   SECTION("blocks may not exceed the capacity")
+   {
+      Buffers block { host.GetCapacity() + 1 };
+      REQUIRE_THROWS_AS(
+         host.Write(block.pointers.data(), host.GetCapacity() + 1, 10ms),
+         std::invalid_argument);
+   }
+}
+
+TEST_CASE("SharedAudioChannel opens only existing channels")
+{
+   REQUIRE_THROWS(SharedAudioChannel { "/audacity-ipc-no-such-channel" });
+}
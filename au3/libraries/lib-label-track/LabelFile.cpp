@@ -0,0 +1,395 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file LabelFile.cpp
+
+**********************************************************************/
+#include "LabelFile.h"
+
+#include "FromChars.h"
+#include "Internat.h"
+#include "ToChars.h"
+
+#include <wx/convauto.h>
+#include <wx/file.h>
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <vector>
+
+namespace
+{
+#ifdef _WIN32
+constexpr std::string_view eol = "\r\n";
+#else
+constexpr std::string_view eol = "\n";
+#endif
+
+using Lines = std::vector<std::string_view>;
+
+// Splits as wxTextFile does: a line ends with \n, \r\n or \r, and there is no
+// empty line after the last line end
+Lines SplitLines(std::string_view text)
+{
+   Lines lines;
+   size_t start = 0;
+   while (start < text.size())
+   {
+      const auto end = text.find_first_of("\r\n", start);
+      if (end == std::string_view::npos)
+      {
+         lines.push_back(text.substr(start));
+         break;
+      }
+      lines.push_back(text.substr(start, end - start));
+      start = end + 1;
+      if (text[end] == '\r' && start < text.size() && text[start] == '\n')
+         ++start;
+   }
+   return lines;
+}
+
+// As wxStringTokenizer with a tab for delimiter: empty tokens are skipped, and
+// the token after the last is empty
+std::string_view NextToken(std::string_view line, size_t& pos)
+{
+   while (pos < line.size() && line[pos] == '\t')
+      ++pos;
+   const auto start = pos;
+   while (pos < line.size() && line[pos] != '\t')
+      ++pos;
+   return line.substr(start, pos - start);
+}
+
+// Respects the comma as well as the point, as Internat::CompatibleToDouble
+bool ToDouble(std::string_view token, double& value)
+{
+   if (token.find(',') != std::string_view::npos)
+   {
+      std::string copy { token };
+      std::replace(copy.begin(), copy.end(), ',', '.');
+      return ToDouble(copy, value);
+   }
+   const auto last = token.data() + token.size();
+   const auto result = FromChars(token.data(), last, value);
+   return !token.empty() && result.ec == std::errc() && result.ptr == last;
+}
+
+wxString ToWxString(std::string_view text)
+{
+   if (text.empty())
+      return {};
+   auto result = wxString::FromUTF8(text.data(), text.size());
+   if (result.empty())
+      result = wxString { text.data(), wxConvISO8859_1, text.size() };
+   return result;
+}
+
+bool IsContinuation(std::string_view line)
+{
+   return !line.empty() && line[0] == '\\';
+}
+
+//! Parses the label at index, and advances index over all of its lines even
+//! if it is bad
+bool ParseText(const Lines& lines, size_t& index, LabelArray& labels)
+{
+   const auto firstLine = lines[index++];
+
+   // Newer selection fields are written on additional lines beginning with
+   // '\'; there may also be additional continuation lines from future
+   // formats, which are ignored
+   const auto index2 = index;
+   while (index < lines.size() && IsContinuation(lines[index]))
+      ++index;
+
+   // Assume tab is an impossible character within the exported text of the
+   // label, so can be only a delimiter
+   size_t pos = 0;
+   double t0;
+   if (!ToDouble(NextToken(firstLine, pos), t0))
+      return false;
+   auto token = NextToken(firstLine, pos);
+   double t1;
+   if (!ToDouble(token, t1))
+      // This is a one-sided label
+      t1 = t0;
+   else
+      token = NextToken(firstLine, pos);
+
+   SelectedRegion sr;
+   sr.setTimes(t0, t1);
+
+   if (index2 < index)
+   {
+      const auto line = lines[index2];
+      pos = 0;
+      if (NextToken(line, pos) != "\\")
+         return false;
+      double f0, f1;
+      if (
+         !ToDouble(NextToken(line, pos), f0) ||
+         !ToDouble(NextToken(line, pos), f1))
+         return false;
+      sr.setFrequencies(f0, f1);
+   }
+
+   labels.emplace_back(sr, ToWxString(token));
+   return true;
+}
+
+// Parses 'HH:MM:SS,sss'
+bool ParseSubRipTimestamp(std::string_view ts, double& result)
+{
+   if (ts.size() != 12 || ts[2] != ':' || ts[5] != ':' || ts[8] != ',')
+      return false;
+   const auto number = [ts](size_t pos, size_t length, int& value) {
+      const auto first = ts.data() + pos;
+      const auto last = first + length;
+      const auto result = FromChars(first, last, value);
+      return result.ec == std::errc() && result.ptr == last && value >= 0;
+   };
+   int hours, minutes, seconds, milliseconds;
+   if (
+      !number(0, 2, hours) || !number(3, 2, minutes) ||
+      !number(6, 2, seconds) || !number(9, 3, milliseconds))
+      return false;
+   if (hours > 23 || minutes > 59 || seconds > 59)
+      return false;
+   result =
+      hours * 3600 + minutes * 60 + seconds + milliseconds / 1000.0;
+   return true;
+}
+
+bool ParseSubRip(const Lines& lines, size_t& index, LabelArray& labels)
+{
+   const auto firstLine = lines[index++];
+   if (lines.size() < index + 2)
+   {
+      index = lines.size();
+      return false;
+   }
+
+   // The first line should be a numeric counter; we can ignore it otherwise
+   long identifier;
+   const auto last = firstLine.data() + firstLine.size();
+   if (const auto result = FromChars(firstLine.data(), last, identifier);
+       firstLine.empty() || result.ec != std::errc() || result.ptr != last)
+      return false;
+
+   // Parsing data of the form 'HH:MM:SS,sss --> HH:MM:SS,sss'
+   // Assume that the line is in exactly that format, with no extra whitespace
+   // and less than 24 hours.
+   const auto timestamp = lines[index++];
+   double t0, t1;
+   if (
+      timestamp.size() != 29 || timestamp.substr(12, 5) != " --> " ||
+      !ParseSubRipTimestamp(timestamp.substr(0, 12), t0) ||
+      !ParseSubRipTimestamp(timestamp.substr(17, 12), t1))
+      return false;
+
+   SelectedRegion sr;
+   sr.setTimes(t0, t1);
+
+   // Assume that if there is an empty subtitle, there still is a second
+   // blank line after it
+   auto title = ToWxString(lines[index++]);
+
+   // Labels in audacity should be only one line, so join multiple lines
+   // with spaces.  This is not reversed on export.
+   while (index < lines.size() && !lines[index].empty())
+      title += " " + ToWxString(lines[index++]);
+
+   index++; // Skip over empty line
+
+   labels.emplace_back(sr, title);
+   return true;
+}
+
+void AppendUTF8(std::string& text, const wxString& string)
+{
+   const auto buffer = string.utf8_str();
+   text.append(buffer.data(), buffer.length());
+}
+
+// Fixed notation with FLT_DIG digits after the point, as
+// Internat::ToString(value, FLT_DIG) writes
+void AppendFixed(std::string& text, double value)
+{
+   static_assert(FLT_DIG == 6);
+   constexpr auto scale = 1000000ull;
+   const auto magnitude = std::abs(value) * scale;
+   if (!(magnitude < 1e18))
+   {
+      AppendUTF8(text, Internat::ToString(value, FLT_DIG));
+      return;
+   }
+   const auto scaled = static_cast<unsigned long long>(std::llround(magnitude));
+   if (std::signbit(value))
+      text += '-';
+   char buffer[24];
+   const auto result =
+      ToChars(buffer, buffer + sizeof buffer, scaled / scale);
+   text.append(buffer, result.ptr);
+   text += '.';
+   auto fraction = scaled % scale;
+   char digits[FLT_DIG];
+   for (auto i = FLT_DIG; i-- > 0; fraction /= 10)
+      digits[i] = static_cast<char>('0' + fraction % 10);
+   text.append(digits, FLT_DIG);
+}
+
+void AppendTwoDigits(std::string& text, long long value)
+{
+   text += static_cast<char>('0' + value / 10 % 10);
+   text += static_cast<char>('0' + value % 10);
+}
+
+// As formatted from wxDateTime in UTC, so that hours wrap around at a day
+void AppendSubRipTimestamp(std::string& text, double timestamp, bool webvtt)
+{
+   timestamp = std::max(timestamp, 0.0);
+   const auto seconds = static_cast<long long>(timestamp);
+   const auto milliseconds = std::llround(timestamp * 1000) % 1000;
+   AppendTwoDigits(text, seconds / 3600 % 24);
+   text += ':';
+   AppendTwoDigits(text, seconds / 60 % 60);
+   text += ':';
+   AppendTwoDigits(text, seconds % 60);
+   // Note that the SubRip format always uses the comma as its separator,
+   // while WebVTT always uses the period
+   text += webvtt ? '.' : ',';
+   text += static_cast<char>('0' + milliseconds / 100);
+   AppendTwoDigits(text, milliseconds);
+}
+} // namespace
+
+LabelArray
+LabelFile::Parse(std::string_view text, LabelFormat format, bool& error)
+{
+   error = false;
+   LabelArray labels;
+   if (format != LabelFormat::TEXT && format != LabelFormat::SUBRIP)
+   {
+      error = true;
+      return labels;
+   }
+
+   constexpr std::string_view utf8BOM = "\xEF\xBB\xBF";
+   if (text.substr(0, utf8BOM.size()) == utf8BOM)
+      text.remove_prefix(utf8BOM.size());
+
+   const auto lines = SplitLines(text);
+   labels.reserve(format == LabelFormat::TEXT ? lines.size() : lines.size() / 3);
+   const auto parse = format == LabelFormat::TEXT ? ParseText : ParseSubRip;
+   for (size_t index = 0; index < lines.size();)
+      if (!parse(lines, index, labels))
+         error = true;
+   return labels;
+}
+
+void LabelFile::Write(
+   std::string& text, const LabelArray& labels, LabelFormat format)
+{
+   switch (format)
+   {
+   case LabelFormat::TEXT:
+   default:
+   {
+      // Read once, not for each label
+      const auto standard = LabelStyleSetting.ReadEnum();
+      for (const auto& label : labels)
+      {
+         AppendFixed(text, label.getT0());
+         text += '\t';
+         AppendFixed(text, label.getT1());
+         text += '\t';
+         AppendUTF8(text, label.title);
+         text += eol;
+
+         const auto f0 = label.selectedRegion.f0();
+         const auto f1 = label.selectedRegion.f1();
+         if (
+            (f0 == SelectedRegion::UndefinedFrequency &&
+             f1 == SelectedRegion::UndefinedFrequency) ||
+            standard)
+            continue;
+
+         // Write a \ character at the start of a second line,
+         // so that earlier versions of Audacity ignore it.
+         text += "\\\t";
+         AppendFixed(text, f0);
+         text += '\t';
+         AppendFixed(text, f1);
+         text += eol;
+      }
+      break;
+   }
+   case LabelFormat::SUBRIP:
+   case LabelFormat::WEBVTT:
+   {
+      const auto webvtt = format == LabelFormat::WEBVTT;
+      if (webvtt)
+      {
+         text += "WEBVTT";
+         text += eol;
+         text += eol;
+      }
+
+      char buffer[24];
+      unsigned long long identifier = 0;
+      for (const auto& label : labels)
+      {
+         // Note that the identifier is optional in WebVTT, but required in
+         // SubRip.  We include it for both.
+         const auto result =
+            ToChars(buffer, buffer + sizeof buffer, ++identifier);
+         text.append(buffer, result.ptr);
+         text += eol;
+
+         AppendSubRipTimestamp(text, label.getT0(), webvtt);
+         text += " --> ";
+         AppendSubRipTimestamp(text, label.getT1(), webvtt);
+         text += eol;
+
+         AppendUTF8(text, label.title);
+         text += eol;
+         text += eol;
+      }
+      break;
+   }
+   }
+}
+
+bool LabelFile::Read(const wxString& fileName, std::string& text)
+{
+   wxFile file;
+   if (!file.Open(fileName))
+      return false;
+   const auto length = file.Length();
+   if (length < 0)
+      return false;
+   text.resize(static_cast<size_t>(length));
+   if (length > 0 && file.Read(text.data(), text.size()) != length)
+      return false;
+
+   const auto bom = wxConvAuto::DetectBOM(text.data(), text.size());
+   if (bom != wxBOM_Unknown && bom != wxBOM_None && bom != wxBOM_UTF8)
+   {
+      const wxString converted { text.data(), wxConvAuto {}, text.size() };
+      text.clear();
+      AppendUTF8(text, converted);
+   }
+   return true;
+}
+
+bool LabelFile::Save(const wxString& fileName, const std::string& text)
+{
+   wxFile file;
+   if (!file.Create(fileName, true))
+      return false;
+   return file.Write(text.data(), text.size()) == text.size() && file.Close();
+}
@@ -0,0 +1,43 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file LabelFile.h
+  @brief Reading and writing of whole label files at once
+
+**********************************************************************/
+#pragma once
+
+#include "LabelTrack.h"
+
+#include <string>
+#include <string_view>
+
+namespace LabelFile
+{
+//! Parses the labels of the whole text of a file, in file order
+/*!
+ Lines are viewed in place in the text, and numbers are parsed from there,
+ so only the titles are converted.  Accepts what LabelStruct::Import accepts,
+ line by line.  WebVTT is not supported.
+
+ @param text UTF-8, or Latin-1 where that is not valid UTF-8
+ @param[out] error whether some labels could not be read; the others are
+ still returned
+ */
+LABEL_TRACK_API LabelArray
+Parse(std::string_view text, LabelFormat format, bool& error);
+
+//! Appends the labels in the given format, as LabelTrack::Export writes
+//! them line by line, in UTF-8 with native line endings
+LABEL_TRACK_API void
+Write(std::string& text, const LabelArray& labels, LabelFormat format);
+
+//! Reads the whole file with one read, converting it to UTF-8 if it begins
+//! with a UTF-16 or UTF-32 byte order mark
+LABEL_TRACK_API bool Read(const wxString& fileName, std::string& text);
+
+//! Writes the whole file with one write, replacing any previous contents
+LABEL_TRACK_API bool Save(const wxString& fileName, const std::string& text);
+} // namespace LabelFile
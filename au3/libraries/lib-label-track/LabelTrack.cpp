@@ -30,8 +30,11 @@ for drawing different aspects of the label and its text box.
 
 
 #include "LabelTrack.h"
+#include "LabelFile.h"
 
 #include <algorithm>
+#include <iterator>
+#include <limits>
 #include <limits.h>
 #include <float.h>
 
@@ -63,6 +66,23 @@ EnumSetting<bool> LabelStyleSetting {
    },
 };
 
+namespace {
+bool RetainLabels()
+{
+   bool retainLabels = false;
+   gPrefs->Read(wxT("/GUI/RetainLabels"), &retainLabels);
+   return retainLabels;
+}
+
+LabelStruct::TimeRelations Relation(const LabelStruct &label,
+   double reg_t0, double reg_t1, bool retainLabels);
+
+bool StartsBefore(const LabelStruct &a, const LabelStruct &b)
+{
+   return a.getT0() < b.getT0();
+}
+}
+
 LabelTrack::Interval::~Interval() = default;
 
 double LabelTrack::Interval::Start() const
@@ -128,8 +148,10 @@ LabelTrack::LabelTrack()
 
 LabelTrack::LabelTrack(const LabelTrack &orig, ProtectedCreationArg &&a)
    : UniqueChannelTrack{ orig, std::move(a) }
+   , mMaxEnds{ orig.mMaxEnds }
    , mClipLen{ 0.0 }
 {
+   mLabels.reserve(orig.mLabels.size());
    for (auto &original: orig.mLabels) {
       LabelStruct l { original.selectedRegion, original.title };
       mLabels.push_back(l);
@@ -185,8 +207,10 @@ void LabelTrack::SetLabel( size_t iLabel, const LabelStruct &newLabel )
    if( iLabel >= mLabels.size() ) {
       wxASSERT( false );
       mLabels.resize( iLabel + 1 );
+      UpdateIndex();
    }
    mLabels[ iLabel ] = newLabel;
+   UpdateIndex(iLabel, iLabel + 1);
 }
 
 LabelTrack::~LabelTrack()
@@ -201,6 +225,7 @@ void LabelTrack::MoveTo(double origin)
       for (auto &labelStruct: mLabels) {
          labelStruct.selectedRegion.move(offset);
       }
+      UpdateIndex();
    }
 }
 
@@ -208,25 +233,29 @@ void LabelTrack::ShiftBy(double t0, double delta)
 {
    if (mLabels.empty())
    return;
-   for (auto &labelStruct: mLabels)
-   {
-      if(labelStruct.selectedRegion.t0() >= t0)
-         labelStruct.selectedRegion.move(delta);
-   }
+   // Labels are sorted, so those to shift are at the end
+   for (auto i = LowerBound(t0), len = mLabels.size(); i < len; ++i)
+      mLabels[i].selectedRegion.move(delta);
+   UpdateIndex();
 }
 
 void LabelTrack::Clear(double b, double e)
 {
-   // May DELETE labels, so use subscripts to iterate
-   for (size_t i = 0; i < mLabels.size(); ++i) {
+   const auto retainLabels = RetainLabels();
+
+   // Compact the kept labels in one pass, rather than erasing one at a time
+   std::vector<std::pair<int, wxString>> deleted;
+   size_t kept = 0;
+   for (size_t i = 0, len = mLabels.size(); i < len; ++i) {
       auto &labelStruct = mLabels[i];
       LabelStruct::TimeRelations relation =
-                        labelStruct.RegionRelation(b, e, this);
+                        Relation(labelStruct, b, e, retainLabels);
       if (relation == LabelStruct::BEFORE_LABEL)
          labelStruct.selectedRegion.move(- (e-b));
       else if (relation == LabelStruct::SURROUNDS_LABEL) {
-         DeleteLabel( i );
-         --i;
+         // Position as if the preceding deletions were already done
+         deleted.emplace_back(kept, labelStruct.title);
+         continue;
       }
       else if (relation == LabelStruct::ENDS_IN_LABEL)
          labelStruct.selectedRegion.setTimes(
@@ -236,7 +265,16 @@ void LabelTrack::Clear(double b, double e)
          labelStruct.selectedRegion.setT1(b);
       else if (relation == LabelStruct::WITHIN_LABEL)
          labelStruct.selectedRegion.moveT1( - (e-b));
+      if (kept != i)
+         mLabels[kept] = std::move(labelStruct);
+      ++kept;
    }
+   mLabels.erase(mLabels.begin() + kept, mLabels.end());
+   UpdateIndex();
+
+   for (auto &[index, title] : deleted)
+      Publish({ LabelTrackEvent::Deletion,
+         this->SharedPointer<LabelTrack>(), title, index, -1 });
 }
 
 #if 0
@@ -266,21 +304,24 @@ bool LabelTrack::SplitDelete(double b, double e)
 
 void LabelTrack::ShiftLabelsOnInsert(double length, double pt)
 {
+   const auto retainLabels = RetainLabels();
    for (auto &labelStruct: mLabels) {
       LabelStruct::TimeRelations relation =
-                        labelStruct.RegionRelation(pt, pt, this);
+                        Relation(labelStruct, pt, pt, retainLabels);
 
       if (relation == LabelStruct::BEFORE_LABEL)
          labelStruct.selectedRegion.move(length);
       else if (relation == LabelStruct::WITHIN_LABEL)
          labelStruct.selectedRegion.moveT1(length);
    }
+   UpdateIndex();
 }
 
 void LabelTrack::ChangeLabelsOnReverse(double b, double e)
 {
+   const auto retainLabels = RetainLabels();
    for (auto &labelStruct: mLabels) {
-      if (labelStruct.RegionRelation(b, e, this) ==
+      if (Relation(labelStruct, b, e, retainLabels) ==
                                     LabelStruct::SURROUNDS_LABEL)
       {
          double aux     = b + (e - labelStruct.getT1());
@@ -289,6 +330,7 @@ void LabelTrack::ChangeLabelsOnReverse(double b, double e)
             e - (labelStruct.getT0() - b));
       }
    }
+   UpdateIndex();
    SortLabels();
 }
 
@@ -299,6 +341,7 @@ void LabelTrack::ScaleLabels(double b, double e, double change)
          AdjustTimeStampOnScale(labelStruct.getT0(), b, e, change),
          AdjustTimeStampOnScale(labelStruct.getT1(), b, e, change));
    }
+   UpdateIndex();
 }
 
 double LabelTrack::AdjustTimeStampOnScale(double t, double b, double e, double change)
@@ -326,6 +369,7 @@ void LabelTrack::WarpLabels(const TimeWarper &warper) {
          warper.Warp(labelStruct.getT0()),
          warper.Warp(labelStruct.getT1()));
    }
+   UpdateIndex();
 
    // This should not be needed, assuming the warper is nondecreasing, but
    // let's not assume too much.
@@ -606,10 +650,15 @@ auto LabelStruct::RegionRelation(
       double reg_t0, double reg_t1, const LabelTrack * WXUNUSED(parent)) const
 -> TimeRelations
 {
-   bool retainLabels = false;
+   return Relation(*this, reg_t0, reg_t1, RetainLabels());
+}
 
+namespace {
+// The preference is read once by the callers that loop over labels
+LabelStruct::TimeRelations Relation(const LabelStruct &label,
+   double reg_t0, double reg_t1, bool retainLabels)
+{
    wxASSERT(reg_t0 <= reg_t1);
-   gPrefs->Read(wxT("/GUI/RetainLabels"), &retainLabels);
 
    if(retainLabels) {
 
@@ -617,21 +666,21 @@ auto LabelStruct::RegionRelation(
       // than the length of the label if the selection is within the label or
       // matching exactly a (region) label.
 
-      if (reg_t0 < getT0() && reg_t1 > getT1())
-         return SURROUNDS_LABEL;
-      else if (reg_t1 < getT0())
-         return BEFORE_LABEL;
-      else if (reg_t0 > getT1())
-         return AFTER_LABEL;
+      if (reg_t0 < label.getT0() && reg_t1 > label.getT1())
+         return LabelStruct::SURROUNDS_LABEL;
+      else if (reg_t1 < label.getT0())
+         return LabelStruct::BEFORE_LABEL;
+      else if (reg_t0 > label.getT1())
+         return LabelStruct::AFTER_LABEL;
 
-      else if (reg_t0 >= getT0() && reg_t0 <= getT1() &&
-               reg_t1 >= getT0() && reg_t1 <= getT1())
-         return WITHIN_LABEL;
+      else if (reg_t0 >= label.getT0() && reg_t0 <= label.getT1() &&
+               reg_t1 >= label.getT0() && reg_t1 <= label.getT1())
+         return LabelStruct::WITHIN_LABEL;
 
-      else if (reg_t0 >= getT0() && reg_t0 <= getT1())
-         return BEGINS_IN_LABEL;
+      else if (reg_t0 >= label.getT0() && reg_t0 <= label.getT1())
+         return LabelStruct::BEGINS_IN_LABEL;
       else
-         return ENDS_IN_LABEL;
+         return LabelStruct::ENDS_IN_LABEL;
 
    } else {
 
@@ -645,28 +694,29 @@ auto LabelStruct::RegionRelation(
       // The first test catches bordered point-labels and selected-through
       // region-labels; move it to third and selection edges become inclusive
       // WRT point-labels.
-      if (reg_t0 <= getT0() && reg_t1 >= getT1())
-         return SURROUNDS_LABEL;
-      else if (reg_t1 <= getT0())
-         return BEFORE_LABEL;
-      else if (reg_t0 >= getT1())
-         return AFTER_LABEL;
+      if (reg_t0 <= label.getT0() && reg_t1 >= label.getT1())
+         return LabelStruct::SURROUNDS_LABEL;
+      else if (reg_t1 <= label.getT0())
+         return LabelStruct::BEFORE_LABEL;
+      else if (reg_t0 >= label.getT1())
+         return LabelStruct::AFTER_LABEL;
 
       // At this point, all point labels should have returned.
 
-      else if (reg_t0 > getT0() && reg_t0 < getT1() &&
-               reg_t1 > getT0() && reg_t1 < getT1())
-         return WITHIN_LABEL;
+      else if (reg_t0 > label.getT0() && reg_t0 < label.getT1() &&
+               reg_t1 > label.getT0() && reg_t1 < label.getT1())
+         return LabelStruct::WITHIN_LABEL;
 
       // Knowing that none of the other relations match simplifies remaining
       // tests
-      else if (reg_t0 > getT0() && reg_t0 < getT1())
-         return BEGINS_IN_LABEL;
+      else if (reg_t0 > label.getT0() && reg_t0 < label.getT1())
+         return LabelStruct::BEGINS_IN_LABEL;
       else
-         return ENDS_IN_LABEL;
+         return LabelStruct::ENDS_IN_LABEL;
 
    }
 }
+}
 
 /// Export labels including label start and end-times.
 void LabelTrack::Export(wxTextFile & f, LabelFormat format) const
@@ -682,6 +732,11 @@ void LabelTrack::Export(wxTextFile & f, LabelFormat format) const
       labelStruct.Export(f, format, index++);
 }
 
+void LabelTrack::Export(std::string &text, LabelFormat format) const
+{
+   LabelFile::Write(text, mLabels, format);
+}
+
 LabelFormat LabelTrack::FormatForFileName(const wxString & fileName)
 {
    LabelFormat format = LabelFormat::TEXT;
@@ -720,7 +775,26 @@ void LabelTrack::Import(wxTextFile & in, LabelFormat format)
    }
    if (error)
       BasicUI::ShowMessageBox( XO("One or more saved labels could not be read.") );
-   SortLabels();
+   // There are no positions for listeners to update yet, so sort all at once,
+   // as SortLabels would, but without its quadratic worst case
+   std::stable_sort(mLabels.begin(), mLabels.end(), StartsBefore);
+   UpdateIndex();
+}
+
+void LabelTrack::Import(std::string_view text, LabelFormat format)
+{
+   if (format == LabelFormat::WEBVTT) {
+      BasicUI::ShowMessageBox( XO("Importing WebVTT files is not currently supported.") );
+      return;
+   }
+
+   bool error = false;
+   auto labels = LabelFile::Parse(text, format, error);
+   if (error)
+      BasicUI::ShowMessageBox( XO("One or more saved labels could not be read.") );
+   std::stable_sort(labels.begin(), labels.end(), StartsBefore);
+   mLabels = std::move(labels);
+   UpdateIndex();
 }
 
 bool LabelTrack::HandleXMLTag(const std::string_view& tag, const AttributesList &attrs)
@@ -775,6 +849,7 @@ bool LabelTrack::HandleXMLTag(const std::string_view& tag, const AttributesList
             }
             mLabels.clear();
             mLabels.reserve(nValue);
+            UpdateIndex();
          }
       }
 
@@ -784,6 +859,13 @@ bool LabelTrack::HandleXMLTag(const std::string_view& tag, const AttributesList
    return false;
 }
 
+void LabelTrack::HandleXMLEndTag(const std::string_view& tag)
+{
+   // Index the labels once they are all read
+   if (tag == "labeltrack")
+      UpdateIndex();
+}
+
 XMLTagHandler *LabelTrack::HandleXMLChild(const std::string_view& tag)
 {
    if (tag == "label")
@@ -840,9 +922,12 @@ Track::Holder LabelTrack::Copy(double t0, double t1, bool) const
    tmp->Init(*this);
    const auto lt = static_cast<LabelTrack*>(tmp.get());
 
-   for (auto &labelStruct: mLabels) {
+   // Other labels are before or after the region
+   const auto retainLabels = RetainLabels();
+   for (auto index : FindLabels(t0, t1)) {
+      auto &labelStruct = mLabels[index];
       LabelStruct::TimeRelations relation =
-                        labelStruct.RegionRelation(t0, t1, this);
+                        Relation(labelStruct, t0, t1, retainLabels);
       if (relation == LabelStruct::SURROUNDS_LABEL) {
          LabelStruct l {
             labelStruct.selectedRegion,
@@ -880,6 +965,7 @@ Track::Holder LabelTrack::Copy(double t0, double t1, bool) const
          lt->mLabels.push_back(l);
       }
    }
+   lt->UpdateIndex();
    lt->mClipLen = (t1 - t0);
 
    return tmp;
@@ -889,12 +975,10 @@ Track::Holder LabelTrack::Copy(double t0, double t1, bool) const
 bool LabelTrack::PasteOver(double t, const Track &src)
 {
    auto result = src.TypeSwitch<bool>([&](const LabelTrack &sl) {
-      int len = mLabels.size();
-      int pos = 0;
-
-      while (pos < len && mLabels[pos].getT0() < t)
-         pos++;
+      const auto pos = LowerBound(t);
 
+      LabelArray pasted;
+      pasted.reserve(sl.mLabels.size());
       for (auto &labelStruct: sl.mLabels) {
          LabelStruct l {
             labelStruct.selectedRegion,
@@ -902,8 +986,12 @@ bool LabelTrack::PasteOver(double t, const Track &src)
             labelStruct.getT1() + t,
             labelStruct.title
          };
-         mLabels.insert(mLabels.begin() + pos++, l);
+         pasted.push_back(l);
       }
+      mLabels.insert(mLabels.begin() + pos,
+         std::make_move_iterator(pasted.begin()),
+         std::make_move_iterator(pasted.end()));
+      UpdateIndex();
 
       return true;
    });
@@ -943,43 +1031,41 @@ bool LabelTrack::Repeat(double t0, double t1, int n)
    // Insert space for the repetitions
    ShiftLabelsOnInsert(tLen * n, t1);
 
-   // mLabels may resize as we iterate, so use subscripting
-   for (unsigned int i = 0; i < mLabels.size(); ++i)
+   const auto retainLabels = RetainLabels();
+   LabelArray repeated;
+   for (auto &label : mLabels)
    {
       LabelStruct::TimeRelations relation =
-                        mLabels[i].RegionRelation(t0, t1, this);
+                        Relation(label, t0, t1, retainLabels);
       if (relation == LabelStruct::SURROUNDS_LABEL)
       {
          // Label is completely inside the selection; duplicate it in each
          // repeat interval
-         unsigned int pos = i; // running label insertion position in mLabels
-
          for (int j = 1; j <= n; j++)
          {
-            const LabelStruct &label = mLabels[i];
             LabelStruct l {
                label.selectedRegion,
                label.getT0() + j * tLen,
                label.getT1() + j * tLen,
                label.title
             };
-
-            // Figure out where to insert
-            while (pos < mLabels.size() &&
-                   mLabels[pos].getT0() < l.getT0())
-               pos++;
-            mLabels.insert(mLabels.begin() + pos, l);
+            repeated.push_back(l);
          }
       }
       else if (relation == LabelStruct::BEGINS_IN_LABEL)
       {
          // Label ends inside the selection; ShiftLabelsOnInsert() hasn't touched
          // it, and we need to extend it through to the last repeat interval
-         mLabels[i].selectedRegion.moveT1(n * tLen);
+         label.selectedRegion.moveT1(n * tLen);
       }
 
       // Other cases have already been handled by ShiftLabelsOnInsert()
    }
+   UpdateIndex();
+
+   // Insert the copies all at once, where they belong
+   std::stable_sort(repeated.begin(), repeated.end(), StartsBefore);
+   MergeLabels(std::move(repeated));
 
    return true;
 }
@@ -1003,16 +1089,19 @@ void LabelTrack::SyncLockAdjust(double oldT1, double newT1)
 
 void LabelTrack::Silence(double t0, double t1, ProgressReporter)
 {
-   int len = mLabels.size();
-
-   // mLabels may resize as we iterate, so use subscripting
-   for (int i = 0; i < len; ++i) {
+   const auto retainLabels = RetainLabels();
+
+   // Rebuild the array in one pass, rather than inserting and erasing one
+   // label at a time
+   LabelArray labels;
+   labels.reserve(mLabels.size() + 1);
+   std::vector<std::pair<int, wxString>> deleted;
+   for (auto &label : mLabels) {
       LabelStruct::TimeRelations relation =
-                        mLabels[i].RegionRelation(t0, t1, this);
+                        Relation(label, t0, t1, retainLabels);
       if (relation == LabelStruct::WITHIN_LABEL)
       {
          // Split label around the selection
-         const LabelStruct &label = mLabels[i];
          LabelStruct l {
             label.selectedRegion,
             t1,
@@ -1020,29 +1109,37 @@ void LabelTrack::Silence(double t0, double t1, ProgressReporter)
             label.title
          };
 
-         mLabels[i].selectedRegion.setT1(t0);
+         label.selectedRegion.setT1(t0);
 
          // This might not be the right place to insert, but we sort at the end
-         ++i;
-         mLabels.insert(mLabels.begin() + i, l);
+         labels.push_back(std::move(label));
+         labels.push_back(l);
+         continue;
       }
       else if (relation == LabelStruct::ENDS_IN_LABEL)
       {
          // Beginning of label to selection end
-         mLabels[i].selectedRegion.setT0(t1);
+         label.selectedRegion.setT0(t1);
       }
       else if (relation == LabelStruct::BEGINS_IN_LABEL)
       {
          // End of label to selection beginning
-         mLabels[i].selectedRegion.setT1(t0);
+         label.selectedRegion.setT1(t0);
       }
       else if (relation == LabelStruct::SURROUNDS_LABEL)
       {
-         DeleteLabel( i );
-         len--;
-         i--;
+         // Position as if the preceding deletions were already done
+         deleted.emplace_back(labels.size(), label.title);
+         continue;
       }
+      labels.push_back(std::move(label));
    }
+   mLabels.swap(labels);
+   UpdateIndex();
+
+   for (auto &[index, title] : deleted)
+      Publish({ LabelTrackEvent::Deletion,
+         this->SharedPointer<LabelTrack>(), title, index, -1 });
 
    SortLabels();
 }
@@ -1059,6 +1156,7 @@ void LabelTrack::InsertSilence(double t, double len)
          t1 += len;
       labelStruct.selectedRegion.setTimes(t0, t1);
    }
+   UpdateIndex();
 }
 
 int LabelTrack::GetNumLabels() const
@@ -1071,18 +1169,86 @@ const LabelStruct *LabelTrack::GetLabel(int index) const
    return &mLabels[index];
 }
 
+size_t LabelTrack::LowerBound(double t) const
+{
+   return std::partition_point(mLabels.begin(), mLabels.end(),
+      [t](const LabelStruct &label){ return label.getT0() < t; }
+   ) - mLabels.begin();
+}
+
+size_t LabelTrack::UpperBound(double t) const
+{
+   return std::partition_point(mLabels.begin(), mLabels.end(),
+      [t](const LabelStruct &label){ return label.getT0() <= t; }
+   ) - mLabels.begin();
+}
+
+void LabelTrack::UpdateIndex()
+{
+   // Leaves at the bottom row, padded to a power of two, and each node above
+   // at half the index of its children
+   size_t width = 1;
+   while (width < mLabels.size())
+      width *= 2;
+   mMaxEnds.assign(2 * width, -std::numeric_limits<double>::infinity());
+   for (size_t i = 0, len = mLabels.size(); i < len; ++i)
+      mMaxEnds[width + i] = mLabels[i].getT1();
+   for (auto node = width; --node > 0;)
+      mMaxEnds[node] = std::max(mMaxEnds[2 * node], mMaxEnds[2 * node + 1]);
+}
+
+void LabelTrack::UpdateIndex(size_t first, size_t end)
+{
+   if (first >= end)
+      return;
+   const auto width = mMaxEnds.size() / 2;
+   for (auto i = first; i < end; ++i)
+      mMaxEnds[width + i] = mLabels[i].getT1();
+   // Then the nodes above, row by row
+   for (auto lo = (width + first) / 2, hi = (width + end - 1) / 2; lo > 0;
+        lo /= 2, hi /= 2)
+      for (auto node = lo; node <= hi; ++node)
+         mMaxEnds[node] =
+            std::max(mMaxEnds[2 * node], mMaxEnds[2 * node + 1]);
+}
+
+std::vector<size_t> LabelTrack::FindLabels(double t0, double t1) const
+{
+   std::vector<size_t> result;
+   // Only the labels starting no later than t1 can overlap
+   const auto end = UpperBound(t1);
+   if (end == 0)
+      return result;
+
+   const auto width = mMaxEnds.size() / 2;
+   wxASSERT(width >= mLabels.size());
+   // Visit the subtrees that contain a label ending no earlier than t0,
+   // depth first, left to right, so the result comes out sorted
+   const auto visit = [&](const auto &self,
+      size_t node, size_t first, size_t count) -> void {
+      if (first >= end || mMaxEnds[node] < t0)
+         return;
+      if (count == 1) {
+         result.push_back(first);
+         return;
+      }
+      count /= 2;
+      self(self, 2 * node, first, count);
+      self(self, 2 * node + 1, first + count, count);
+   };
+   visit(visit, 1, 0, width);
+   return result;
+}
+
 int LabelTrack::AddLabel(const SelectedRegion &selectedRegion,
                          const wxString &title)
 {
    LabelStruct l { selectedRegion, title };
 
-   int len = mLabels.size();
-   int pos = 0;
-
-   while (pos < len && mLabels[pos].getT0() < selectedRegion.t0())
-      pos++;
+   int pos = LowerBound(selectedRegion.t0());
 
    mLabels.insert(mLabels.begin() + pos, l);
+   UpdateIndex();
 
    Publish({ LabelTrackEvent::Addition,
       this->SharedPointer<LabelTrack>(), title, -1, pos });
@@ -1090,12 +1256,48 @@ int LabelTrack::AddLabel(const SelectedRegion &selectedRegion,
    return pos;
 }
 
+void LabelTrack::AddLabels(LabelArray labels)
+{
+   std::stable_sort(labels.begin(), labels.end(), StartsBefore);
+   const auto positions = MergeLabels(std::move(labels));
+
+   // As if each were added in turn, in the final order
+   for (const auto pos : positions)
+      Publish({ LabelTrackEvent::Addition,
+         this->SharedPointer<LabelTrack>(), mLabels[pos].title, -1,
+         static_cast<int>(pos) });
+}
+
+std::vector<size_t> LabelTrack::MergeLabels(LabelArray labels)
+{
+   std::vector<size_t> positions;
+   if (labels.empty())
+      return positions;
+   positions.reserve(labels.size());
+
+   LabelArray merged;
+   merged.reserve(mLabels.size() + labels.size());
+   auto iter = mLabels.begin();
+   const auto end = mLabels.end();
+   for (auto &label : labels) {
+      while (iter != end && iter->getT0() < label.getT0())
+         merged.push_back(std::move(*iter++));
+      positions.push_back(merged.size());
+      merged.push_back(std::move(label));
+   }
+   std::move(iter, end, std::back_inserter(merged));
+   mLabels.swap(merged);
+   UpdateIndex();
+   return positions;
+}
+
 void LabelTrack::DeleteLabel(int index)
 {
    wxASSERT((index < (int)mLabels.size()));
    auto iter = mLabels.begin() + index;
    const auto title = iter->title;
    mLabels.erase(iter);
+   UpdateIndex();
 
    Publish({ LabelTrackEvent::Deletion,
       this->SharedPointer<LabelTrack>(), title, index, -1 });
@@ -1104,7 +1306,7 @@ void LabelTrack::DeleteLabel(int index)
 /// Sorts the labels in order of their starting times.
 /// This function is called often (whilst dragging a label)
 /// We expect them to be very nearly in order, so insertion
-/// sort (with a linear search) is a reasonable choice.
+/// sort (with a binary search) is a reasonable choice.
 void LabelTrack::SortLabels()
 {
    const auto begin = mLabels.begin();
@@ -1118,11 +1320,12 @@ void LabelTrack::SortLabels()
       if (i >= nn)
          break;
 
-      // Where must element i sink to?  At most i - 1, maybe less
-      int j = i - 2;
-      while( (j >= 0) && (mLabels[j].getT0() > mLabels[i].getT0()) )
-         --j;
-      ++j;
+      // Where must element i sink to?  At most i - 1, maybe less; the
+      // elements before i are in order
+      const auto t0 = mLabels[i].getT0();
+      int j = std::partition_point(begin, begin + i - 1,
+         [t0](const LabelStruct &label){ return label.getT0() <= t0; }
+      ) - begin;
 
       // Now fix the disorder
       std::rotate(
@@ -1131,6 +1334,8 @@ void LabelTrack::SortLabels()
          begin + i + 1
       );
 
+      UpdateIndex(j, i + 1);
+
       // Let listeners update their stored indices
       Publish({ LabelTrackEvent::Permutation,
          this->SharedPointer<LabelTrack>(), mLabels[j].title, i, j });
@@ -1142,9 +1347,9 @@ wxString LabelTrack::GetTextOfLabels(double t0, double t1) const
    bool firstLabel = true;
    wxString retVal;
 
-   for (auto &labelStruct: mLabels) {
-      if (labelStruct.getT0() >= t0 &&
-          labelStruct.getT1() <= t1)
+   for (auto i = LowerBound(t0), end = UpperBound(t1); i < end; ++i) {
+      auto &labelStruct = mLabels[i];
+      if (labelStruct.getT1() <= t1)
       {
          if (!firstLabel)
             retVal += '\t';
@@ -1169,12 +1374,8 @@ int LabelTrack::FindNextLabel(const SelectedRegion& currentRegion)
       }
       else {
          i = 0;
-         if (currentRegion.t0() < mLabels[len - 1].getT0()) {
-            while (i < len &&
-                  mLabels[i].getT0() <= currentRegion.t0()) {
-               i++;
-            }
-         }
+         if (currentRegion.t0() < mLabels[len - 1].getT0())
+            i = UpperBound(currentRegion.t0());
       }
    }
 
@@ -1195,12 +1396,8 @@ int LabelTrack::FindNextLabel(const SelectedRegion& currentRegion)
       }
       else {
          i = len - 1;
-         if (currentRegion.t0() > mLabels[0].getT0()) {
-            while (i >=0  &&
-                  mLabels[i].getT0() >= currentRegion.t0()) {
-               i--;
-            }
-         }
+         if (currentRegion.t0() > mLabels[0].getT0())
+            i = static_cast<int>(LowerBound(currentRegion.t0())) - 1;
       }
    }
 
@@ -17,6 +17,9 @@
 #include "Track.h"
 #include "FileNames.h"
 
+#include <string>
+#include <string_view>
+
 class wxTextFile;
 
 class AudacityProject;
@@ -136,6 +139,7 @@ private:
 
 public:
    bool HandleXMLTag(const std::string_view& tag, const AttributesList& attrs) override;
+   void HandleXMLEndTag(const std::string_view& tag) override;
    XMLTagHandler *HandleXMLChild(const std::string_view& tag) override;
    void WriteXML(XMLWriter &xmlFile) const override;
 
@@ -155,14 +159,42 @@ public:
    void Import(wxTextFile & f, LabelFormat format);
    void Export(wxTextFile & f, LabelFormat format) const;
 
+   //! Replaces the labels with those in the whole text of a file
+   /*! Parses the text in place, see LabelFile::Parse, and sorts once */
+   void Import(std::string_view text, LabelFormat format);
+   //! Appends the labels to the text of a file, as the other overload would
+   //! write them line by line
+   void Export(std::string &text, LabelFormat format) const;
+
    int GetNumLabels() const;
    const LabelStruct *GetLabel(int index) const;
    const LabelArray &GetLabels() const { return mLabels; }
 
+   //! Indices of the labels that overlap the closed interval [t0, t1], in
+   //! increasing order
+   /*!
+    Takes time logarithmic in the number of labels for each label found,
+    however long the other labels are.  Assumes the labels are sorted, as
+    SortLabels leaves them.
+    */
+   std::vector<size_t> FindLabels(double t0, double t1) const;
+
    void OnLabelAdded( const wxString &title, int pos );
    //This returns the index of the label we just added.
    int AddLabel(const SelectedRegion &region, const wxString &title);
 
+   //! Adds many labels at once, keeping the labels sorted
+   /*!
+    Each new label goes before the existing labels that start at the same
+    time, as with AddLabel.  This differs from calling AddLabel for each label
+    in turn in two ways only: new labels that start at the same time keep
+    their order in `labels`, where AddLabel would leave them reversed; and the
+    Addition events come in increasing position, each giving the final
+    position of its label.  Takes time linear in the number of all the labels,
+    besides sorting the new ones, where the loop could take quadratic time.
+    */
+   void AddLabels(LabelArray labels);
+
    //This deletes the label at given index.
    void DeleteLabel(int index);
 
@@ -219,8 +251,28 @@ private:
    std::shared_ptr<WideChannelGroupInterval> DoGetInterval(size_t iInterval)
       override;
 
+   //! Merges sorted labels into mLabels; returns their new positions
+   std::vector<size_t> MergeLabels(LabelArray labels);
+
+   //! Index of the first label starting at or after t
+   size_t LowerBound(double t) const;
+   //! Index of the first label starting after t
+   size_t UpperBound(double t) const;
+
+   //! Rebuilds the index; called by each change of the labels' times or
+   //! number
+   void UpdateIndex();
+   //! Updates the index for the labels in [first, end) only, when none other
+   //! changed
+   void UpdateIndex(size_t first, size_t end);
+
+   //! Sorted by start time
    LabelArray mLabels;
 
+   //! Binary tree over mLabels, in an array, giving the latest end time of
+   //! the labels under each node
+   std::vector<double> mMaxEnds;
+
    // Set in copied label tracks
    double mClipLen;
 
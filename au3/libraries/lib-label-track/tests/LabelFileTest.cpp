@@ -0,0 +1,95 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  LabelFileTest.cpp
+
+**********************************************************************/
+#include "LabelFile.h"
+#include "MockedPrefs.h"
+
+#include <catch2/catch.hpp>
+
+TEST_CASE("LabelFile")
+{
+   MockedPrefs mockedPrefs;
+   bool error = false;
+
+   SECTION("Parses the standard and extended text formats")
+   {
+      const auto labels = LabelFile::Parse(
+         "1.5\t2.25\tfirst\r\n"
+         "3,5\tpoint\n"
+         "\\\t100\t2000\n"
+         "\\\tfrom a future version\n"
+         "not a number\tbad\n"
+         "4\t5\t\xC3\xA9t\xC3\xA9\ttab in title\r"
+         "6\t7\t\n",
+         LabelFormat::TEXT, error);
+
+      REQUIRE(error);
+      REQUIRE(labels.size() == 4);
+      REQUIRE(labels[0].getT0() == 1.5);
+      REQUIRE(labels[0].getT1() == 2.25);
+      REQUIRE(labels[0].title == wxT("first"));
+      REQUIRE(labels[1].getT0() == 3.5);
+      REQUIRE(labels[1].getT1() == 3.5);
+      REQUIRE(labels[1].title == wxT("point"));
+      REQUIRE(labels[1].selectedRegion.f0() == 100);
+      REQUIRE(labels[1].selectedRegion.f1() == 2000);
+      REQUIRE(labels[2].title == wxString::FromUTF8("\xC3\xA9t\xC3\xA9"));
+      REQUIRE(labels[3].title.empty());
+   }
+
+   SECTION("Parses SubRip")
+   {
+      const auto labels = LabelFile::Parse(
+         "1\n"
+         "00:00:01,500 --> 00:01:02,250\n"
+         "two\n"
+         "lines\n"
+         "\n"
+         "2\n"
+         "01:00:00,000 --> 01:00:00,001\n"
+         "\n"
+         "\n",
+         LabelFormat::SUBRIP, error);
+
+      REQUIRE(!error);
+      REQUIRE(labels.size() == 2);
+      REQUIRE(labels[0].getT0() == Approx(1.5));
+      REQUIRE(labels[0].getT1() == Approx(62.25));
+      REQUIRE(labels[0].title == wxT("two lines"));
+      REQUIRE(labels[1].getT0() == Approx(3600));
+      REQUIRE(labels[1].title.empty());
+   }
+
+   SECTION("Reads back what it writes")
+   {
+      LabelArray labels;
+      labels.emplace_back(SelectedRegion { 0.125, 1 }, wxT("a"));
+      labels.emplace_back(SelectedRegion { 2, 2 }, wxT(""));
+      labels.emplace_back(
+         SelectedRegion { 3723.5, 3724 }, wxString::FromUTF8("\xE2\x99\xAA"));
+
+      for (const auto format : { LabelFormat::TEXT, LabelFormat::SUBRIP })
+      {
+         std::string text;
+         LabelFile::Write(text, labels, format);
+         const auto read = LabelFile::Parse(text, format, error);
+         REQUIRE(!error);
+         REQUIRE(read.size() == labels.size());
+         for (size_t i = 0; i < labels.size(); ++i)
+         {
+            REQUIRE(read[i].getT0() == Approx(labels[i].getT0()));
+            REQUIRE(read[i].getT1() == Approx(labels[i].getT1()));
+            REQUIRE(read[i].title == labels[i].title);
+         }
+      }
+
+      std::string text;
+      LabelFile::Write(text, labels, LabelFormat::TEXT);
+      REQUIRE(text.rfind("0.125000\t1.000000\ta", 0) == 0);
+   }
+}
@@ -0,0 +1,140 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  LabelTrackTest.cpp
+
+**********************************************************************/
+#include "LabelTrack.h"
+#include "MockedPrefs.h"
+
+#include <catch2/catch.hpp>
+
+#include <random>
+
+namespace
+{
+std::shared_ptr<LabelTrack>
+MakeTrack(const std::vector<std::pair<double, double>>& times)
+{
+   auto track = std::make_shared<LabelTrack>();
+   for (const auto& [t0, t1] : times)
+      track->AddLabel(SelectedRegion { t0, t1 }, {});
+   return track;
+}
+
+std::vector<size_t> FindLabelsNaively(
+   const LabelTrack& track, double t0, double t1)
+{
+   std::vector<size_t> result;
+   const auto& labels = track.GetLabels();
+   for (size_t i = 0; i < labels.size(); ++i)
+      if (labels[i].getT0() <= t1 && labels[i].getT1() >= t0)
+         result.push_back(i);
+   return result;
+}
+
+bool IsSorted(const LabelTrack& track)
+{
+   const auto& labels = track.GetLabels();
+   return std::is_sorted(
+      labels.begin(), labels.end(), [](const auto& a, const auto& b) {
+         return a.getT0() < b.getT0();
+      });
+}
+} // namespace
+
+TEST_CASE("LabelTrack")
+{
+   MockedPrefs mockedPrefs;
+
+   SECTION("FindLabels finds the labels overlapping an interval")
+   {
+      std::mt19937 gen { 0 };
+      std::uniform_real_distribution<double> start { 0, 100 };
+      std::uniform_real_distribution<double> length { 0, 5 };
+      std::vector<std::pair<double, double>> times;
+      for (auto i = 0; i < 500; ++i)
+      {
+         const auto t0 = start(gen);
+         // Some point labels, and some very long ones
+         const auto t1 =
+            i % 7 == 0 ? t0 : t0 + length(gen) * (i % 50 ? 1 : 10);
+         times.emplace_back(t0, t1);
+      }
+      const auto track = MakeTrack(times);
+      REQUIRE(IsSorted(*track));
+
+      for (auto i = 0; i < 200; ++i)
+      {
+         const auto t0 = start(gen);
+         const auto t1 = t0 + (i % 3 ? length(gen) : 0);
+         REQUIRE(
+            track->FindLabels(t0, t1) == FindLabelsNaively(*track, t0, t1));
+      }
+      // The index follows edits
+      track->ShiftBy(50, 3);
+      track->Clear(20, 25);
+      REQUIRE(track->FindLabels(30, 60) == FindLabelsNaively(*track, 30, 60));
+      // Also when a label is moved and sorted again, as when dragged
+      auto label = *track->GetLabel(0);
+      label.selectedRegion.setTimes(70, 90);
+      track->SetLabel(0, label);
+      track->SortLabels();
+      REQUIRE(IsSorted(*track));
+      REQUIRE(track->FindLabels(60, 80) == FindLabelsNaively(*track, 60, 80));
+
+      REQUIRE(LabelTrack {}.FindLabels(0, 1).empty());
+   }
+
+   SECTION("AddLabels merges the labels and notifies their positions")
+   {
+      const auto track = MakeTrack({ { 1, 2 }, { 3, 3 }, { 5, 6 } });
+      std::vector<int> added;
+      auto subscription = track->Subscribe([&](const LabelTrackEvent& e) {
+         if (e.type == LabelTrackEvent::Addition)
+            added.push_back(e.mPresentPosition);
+      });
+
+      LabelArray labels;
+      labels.emplace_back(SelectedRegion { 6, 7 }, wxT("c"));
+      labels.emplace_back(SelectedRegion { 0, 1 }, wxT("a"));
+      labels.emplace_back(SelectedRegion { 3, 4 }, wxT("b"));
+      labels.emplace_back(SelectedRegion { 3, 5 }, wxT("b2"));
+      track->AddLabels(std::move(labels));
+
+      REQUIRE(IsSorted(*track));
+      REQUIRE(track->GetNumLabels() == 7);
+      REQUIRE(added == std::vector<int> { 0, 2, 3, 6 });
+      REQUIRE(track->GetLabel(0)->title == wxT("a"));
+      // Before the existing label at the same time, in the given order
+      REQUIRE(track->GetLabel(2)->title == wxT("b"));
+      REQUIRE(track->GetLabel(3)->title == wxT("b2"));
+      REQUIRE(track->GetLabel(4)->getT1() == 3);
+      REQUIRE(track->GetLabel(6)->title == wxT("c"));
+   }
+
+   SECTION("Clear deletes and shifts as before")
+   {
+      const auto track =
+         MakeTrack({ { 0, 1 }, { 2, 3 }, { 2.5, 5 }, { 3, 4 }, { 4, 4 },
+                     { 6, 7 } });
+      std::vector<int> deleted;
+      auto subscription = track->Subscribe([&](const LabelTrackEvent& e) {
+         if (e.type == LabelTrackEvent::Deletion)
+            deleted.push_back(e.mFormerPosition);
+      });
+
+      track->Clear(2, 4.5);
+
+      // Indices as if deleted one at a time
+      REQUIRE(deleted == std::vector<int> { 1, 2, 2 });
+      REQUIRE(track->GetNumLabels() == 3);
+      REQUIRE(track->GetLabel(0)->getT1() == 1);
+      REQUIRE(track->GetLabel(1)->getT0() == 2);
+      REQUIRE(track->GetLabel(1)->getT1() == Approx(2.5));
+      REQUIRE(track->GetLabel(2)->getT0() == Approx(3.5));
+      REQUIRE(track->GetLabel(2)->getT1() == Approx(4.5));
+   }
+}
@@ -0,0 +1,234 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  BiquadCascade.cpp
+
+**********************************************************************/
+#include "BiquadCascade.h"
+#include "Biquad.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <type_traits>
+
+namespace
+{
+// Four doubles fill the widest registers commonly available.
+constexpr size_t width = 4;
+
+// Below this many sections, a wavefront doesn't pay for its ramps.
+constexpr size_t minWavefrontSections = 3;
+
+// Far below anything audible, far above the denormals
+constexpr double flushThreshold = 1e-30;
+
+//! Coefficients and state of up to `width` biquads, in locals so that they
+//! stay in registers
+struct Lanes
+{
+   double b0[width] {}, b1[width] {}, b2[width] {}, a1[width] {}, a2[width] {};
+   double z1[width] {}, z2[width] {};
+};
+
+//! One sample through each lane, in transposed direct form II.
+//! With `ramp`, only the lanes from `first` to `end` update their state.
+template <bool ramp>
+inline void
+Filter(Lanes& lanes, const double* x, double* y, size_t first, size_t end)
+{
+   for (size_t k = 0; k < width; ++k)
+   {
+      y[k] = lanes.b0[k] * x[k] + lanes.z1[k];
+      const auto z1 = lanes.b1[k] * x[k] + lanes.z2[k] - lanes.a1[k] * y[k];
+      const auto z2 = lanes.b2[k] * x[k] - lanes.a2[k] * y[k];
+      const auto active = !ramp || (k >= first && k < end);
+      lanes.z1[k] = active ? z1 : lanes.z1[k];
+      lanes.z2[k] = active ? z2 : lanes.z2[k];
+   }
+}
+} // namespace
+
+BiquadCascade::BiquadCascade(size_t numChannels, size_t numSections)
+    : mNumChannels { numChannels }
+    , mNumSections { std::max<size_t>(numSections, 1) }
+    , mB0(mNumSections, 1.)
+    , mB1(mNumSections, 0.)
+    , mB2(mNumSections, 0.)
+    , mA1(mNumSections, 0.)
+    , mA2(mNumSections, 0.)
+    , mZ1(mNumChannels * mNumSections, 0.)
+    , mZ2(mNumChannels * mNumSections, 0.)
+{
+}
+
+size_t BiquadCascade::GetNumChannels() const
+{
+   return mNumChannels;
+}
+
+size_t BiquadCascade::GetNumSections() const
+{
+   return mNumSections;
+}
+
+void BiquadCascade::SetSection(size_t section, const Biquad& coefficients)
+{
+   assert(section < mNumSections);
+   mB0[section] = coefficients.fNumerCoeffs[Biquad::B0];
+   mB1[section] = coefficients.fNumerCoeffs[Biquad::B1];
+   mB2[section] = coefficients.fNumerCoeffs[Biquad::B2];
+   mA1[section] = coefficients.fDenomCoeffs[Biquad::A1];
+   mA2[section] = coefficients.fDenomCoeffs[Biquad::A2];
+}
+
+void BiquadCascade::Reset()
+{
+   std::fill(mZ1.begin(), mZ1.end(), 0.);
+   std::fill(mZ2.begin(), mZ2.end(), 0.);
+}
+
+void BiquadCascade::Process(const float* in, float* out, size_t numSamples)
+{
+   assert(mNumChannels == 1);
+   Process(&in, &out, numSamples);
+}
+
+void BiquadCascade::Process(
+   const float* const* in, float* const* out, size_t numSamples)
+{
+   if (numSamples == 0)
+      return;
+
+   if (mNumChannels == 1)
+   {
+      // Sections in the lanes
+      size_t section = 0;
+      if (mNumSections >= minWavefrontSections)
+         for (; section < mNumSections; section += width)
+            ProcessSections(
+               section, std::min(width, mNumSections - section),
+               section == 0 ? in[0] : out[0], out[0], numSamples);
+      for (; section < mNumSections; ++section)
+         ProcessSection(section, section == 0 ? in[0] : out[0], out[0], numSamples);
+   }
+   else
+      // Channels in the lanes
+      for (size_t channel = 0; channel < mNumChannels; channel += width)
+         ProcessChannels(
+            channel, std::min(width, mNumChannels - channel), in, out,
+            numSamples);
+
+   for (auto* z : { &mZ1, &mZ2 })
+      for (auto& value : *z)
+         if (std::abs(value) < flushThreshold)
+            value = 0.;
+}
+
+void BiquadCascade::ProcessSection(
+   size_t section, const float* in, float* out, size_t numSamples)
+{
+   const auto b0 = mB0[section], b1 = mB1[section], b2 = mB2[section];
+   const auto a1 = mA1[section], a2 = mA2[section];
+   auto z1 = mZ1[section], z2 = mZ2[section];
+   for (size_t i = 0; i < numSamples; ++i)
+   {
+      const double x = in[i];
+      const auto y = b0 * x + z1;
+      z1 = b1 * x + z2 - a1 * y;
+      z2 = b2 * x - a2 * y;
+      out[i] = y;
+   }
+   mZ1[section] = z1;
+   mZ2[section] = z2;
+}
+
+void BiquadCascade::ProcessSections(
+   size_t firstSection, size_t numSections, const float* in, float* out,
+   size_t numSamples)
+{
+   // At step t, section k filters sample t - k, which section k - 1 filtered
+   // at step t - 1: sections don't wait for one another within a step.
+   Lanes lanes;
+   for (size_t k = 0; k < numSections; ++k)
+   {
+      const auto section = firstSection + k;
+      lanes.b0[k] = mB0[section];
+      lanes.b1[k] = mB1[section];
+      lanes.b2[k] = mB2[section];
+      lanes.a1[k] = mA1[section];
+      lanes.a2[k] = mA2[section];
+      lanes.z1[k] = mZ1[section];
+      lanes.z2[k] = mZ2[section];
+   }
+
+   const auto lag = numSections - 1;
+   double x[width] {}, y[width];
+   const auto step = [&](auto ramp, size_t t) {
+      x[0] = t < numSamples ? in[t] : 0.;
+      Filter<decltype(ramp)::value>(
+         lanes, x, y, t < numSamples ? 0 : t - numSamples + 1,
+         std::min(t + 1, numSections));
+      std::copy(y, y + width - 1, x + 1);
+      if (t >= lag)
+         out[t - lag] = y[lag];
+   };
+   // All sections are busy only from step `lag` to step `numSamples - 1`.
+   const auto numSteps = numSamples + lag;
+   size_t t = 0;
+   for (; t < std::min(lag, numSteps); ++t)
+      step(std::true_type {}, t);
+   for (; t < numSamples; ++t)
+      step(std::false_type {}, t);
+   for (; t < numSteps; ++t)
+      step(std::true_type {}, t);
+
+   for (size_t k = 0; k < numSections; ++k)
+   {
+      mZ1[firstSection + k] = lanes.z1[k];
+      mZ2[firstSection + k] = lanes.z2[k];
+   }
+}
+
+void BiquadCascade::ProcessChannels(
+   size_t firstChannel, size_t numChannels, const float* const* in,
+   float* const* out, size_t numSamples)
+{
+   for (size_t section = 0; section < mNumSections; ++section)
+   {
+      Lanes lanes;
+      // The lanes beyond `numChannels` filter a copy of the first channel.
+      const float* sources[width];
+      for (size_t k = 0; k < width; ++k)
+      {
+         const auto channel = firstChannel + (k < numChannels ? k : 0);
+         sources[k] = section == 0 ? in[channel] : out[channel];
+         lanes.b0[k] = mB0[section];
+         lanes.b1[k] = mB1[section];
+         lanes.b2[k] = mB2[section];
+         lanes.a1[k] = mA1[section];
+         lanes.a2[k] = mA2[section];
+         lanes.z1[k] = mZ1[channel * mNumSections + section];
+         lanes.z2[k] = mZ2[channel * mNumSections + section];
+      }
+
+      double x[width], y[width];
+      for (size_t i = 0; i < numSamples; ++i)
+      {
+         for (size_t k = 0; k < width; ++k)
+            x[k] = sources[k][i];
+         Filter<false>(lanes, x, y, 0, width);
+         for (size_t k = 0; k < numChannels; ++k)
+            out[firstChannel + k][i] = y[k];
+      }
+
+      for (size_t k = 0; k < numChannels; ++k)
+      {
+         const auto lane = (firstChannel + k) * mNumSections + section;
+         mZ1[lane] = lanes.z1[k];
+         mZ2[lane] = lanes.z2[k];
+      }
+   }
+}
@@ -0,0 +1,72 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  BiquadCascade.h
+
+**********************************************************************/
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+struct Biquad;
+
+/*!
+ * @brief Filters several channels through the same cascade of biquads, block
+ * by block.
+ *
+ * @details Biquads are in transposed direct form II and in double precision,
+ * four at a time in the lanes of a vector. With several channels, the lanes
+ * are channels, section after section. With one channel of three sections or
+ * more, the lanes are sections, as a wavefront: at step `t`, section `s`
+ * filters sample `t - s`, which section `s - 1` filtered at step `t - 1`, so
+ * that sections don't wait for one another. Sections only lag within a
+ * block: the output has no latency. Shorter mono cascades are filtered
+ * section after section, as Biquad::Process does.
+ *
+ * State that decays below the float range is flushed to zero at the end of
+ * each block, so that silence after a sound doesn't fill the filter with
+ * denormals, which are slow on most processors.
+ */
+class MATH_API BiquadCascade final
+{
+public:
+   BiquadCascade(size_t numChannels = 1, size_t numSections = 1);
+
+   size_t GetNumChannels() const;
+   size_t GetNumSections() const;
+
+   //! Sets the coefficients of `section` for all channels, keeping the state.
+   //! @pre `section < GetNumSections()`
+   void SetSection(size_t section, const Biquad& coefficients);
+
+   //! Clears the state of all sections of all channels.
+   void Reset();
+
+   //! `in` and `out` may be the same. Doesn't allocate.
+   //! @pre `in` and `out` have `GetNumChannels()` channels.
+   void Process(const float* const* in, float* const* out, size_t numSamples);
+
+   //! For one channel
+   void Process(const float* in, float* out, size_t numSamples);
+
+private:
+   void ProcessSection(
+      size_t section, const float* in, float* out, size_t numSamples);
+   void ProcessSections(
+      size_t firstSection, size_t numSections, const float* in, float* out,
+      size_t numSamples);
+   void ProcessChannels(
+      size_t firstChannel, size_t numChannels, const float* const* in,
+      float* const* out, size_t numSamples);
+
+   const size_t mNumChannels;
+   const size_t mNumSections;
+
+   // Coefficients per section, with a0 == 1
+   std::vector<double> mB0, mB1, mB2, mA1, mA2;
+   // State per channel and section, channel after channel
+   std::vector<double> mZ1, mZ2;
+};
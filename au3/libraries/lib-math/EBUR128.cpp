@@ -9,26 +9,33 @@ Max Maisel
 ***********************************************************************/
 
 #include "EBUR128.h"
+#include <algorithm>
 #include <cstring>
 
+namespace {
+// Samples weighted at a time
+constexpr size_t chunkSize = 1024;
+}
+
 EBUR128::EBUR128(double rate, size_t channels)
    : mChannelCount{ channels }
    , mRate{ rate }
    , mBlockSize( ceil(0.4 * mRate) ) // 400 ms blocks
    , mBlockOverlap( ceil(0.1 * mRate) ) // 100 ms overlap
+   , mWeightingFilter{ channels, 2 }
 {
    mLoudnessHist.reinit(HIST_BIN_COUNT, false);
    mBlockRingBuffer.reinit(mBlockSize);
-   mWeightingFilter.reinit(mChannelCount, false);
+   const auto weightingFilter = CalcWeightingFilter(mRate);
+   mWeightingFilter.SetSection(0, weightingFilter[0]);
+   mWeightingFilter.SetSection(1, weightingFilter[1]);
+   mWeighted.reinit(mChannelCount * chunkSize);
+   mChunkIn.reinit(mChannelCount);
+   mChunkOut.reinit(mChannelCount);
    for(size_t channel = 0; channel < mChannelCount; ++channel)
-      mWeightingFilter[channel] = CalcWeightingFilter(mRate);
+      mChunkOut[channel] = mWeighted.get() + channel * chunkSize;
 
    memset(mLoudnessHist.get(), 0, HIST_BIN_COUNT*sizeof(long int));
-   for(size_t channel = 0; channel < mChannelCount; ++channel)
-   {
-      mWeightingFilter[channel][0].Reset();
-      mWeightingFilter[channel][1].Reset();
-   }
 }
 
 // fs: sample rate
@@ -80,18 +87,28 @@ ArrayOf<Biquad> EBUR128::CalcWeightingFilter(double fs)
    return pBiquad;
 }
 
-void EBUR128::ProcessSampleFromChannel(float x_in, size_t channel) const
+void EBUR128::ProcessSamples(const float* const* channels, size_t numSamples)
 {
-   double value;
-   value = mWeightingFilter[channel][0].ProcessOne(x_in);
-   value = mWeightingFilter[channel][1].ProcessOne(value);
-   if(channel == 0)
-      mBlockRingBuffer[mBlockRingPos] = value * value;
-   else
+   for(size_t start = 0; start < numSamples; start += chunkSize)
    {
-      // Add the power of additional channels to the power of first channel.
-      // As a result, stereo tracks appear about 3 LUFS louder, as specified.
-      mBlockRingBuffer[mBlockRingPos] += value * value;
+      const auto len = std::min(chunkSize, numSamples - start);
+      for(size_t channel = 0; channel < mChannelCount; ++channel)
+         mChunkIn[channel] = channels[channel] + start;
+      mWeightingFilter.Process(mChunkIn.get(), mChunkOut.get(), len);
+
+      for(size_t i = 0; i < len; ++i)
+      {
+         // Add the power of additional channels to the power of first channel.
+         // As a result, stereo tracks appear about 3 LUFS louder, as specified.
+         double power = 0;
+         for(size_t channel = 0; channel < mChannelCount; ++channel)
+         {
+            const double value = mChunkOut[channel][i];
+            power += value * value;
+         }
+         mBlockRingBuffer[mBlockRingPos] = power;
+         NextSample();
+      }
    }
 }
 
@@ -12,6 +12,7 @@ Max Maisel
 #define __EBUR128_H__
 
 #include "Biquad.h"
+#include "BiquadCascade.h"
 #include <memory>
 #include "SampleFormat.h"
 
@@ -27,13 +28,14 @@ public:
    ~EBUR128() = default;
 
    static ArrayOf<Biquad> CalcWeightingFilter(double fs);
-   void ProcessSampleFromChannel(float x_in, size_t channel) const;
-   void NextSample();
+   /// Takes the next numSamples samples of each channel.
+   void ProcessSamples(const float* const* channels, size_t numSamples);
    double IntegrativeLoudness();
    inline double IntegrativeLoudnessToLUFS(double loudness)
       { return 10 * log10(loudness); }
 
 private:
+   void NextSample();
    void HistogramSums(size_t start_idx, double& sum_v, long int& sum_c) const;
    void AddBlockToHistogram(size_t validLen);
 
@@ -50,11 +52,12 @@ private:
    const size_t mBlockSize;
    const size_t mBlockOverlap;
 
-   /// This is be an array of arrays of the type
-   /// mWeightingFilter[CHANNEL][FILTER] with
-   /// CHANNEL = LEFT/RIGHT (0/1) and
-   /// FILTER  = HSF/HPF    (0/1)
-   ArrayOf<ArrayOf<Biquad>> mWeightingFilter;
+   /// HSF then HPF, for each channel
+   BiquadCascade mWeightingFilter;
+   /// The weighted samples of each channel, a chunk at a time
+   Floats mWeighted;
+   ArrayOf<const float*> mChunkIn;
+   ArrayOf<float*> mChunkOut;
 };
 
 #endif
@@ -16,9 +16,9 @@
 
       libsoxr, written by Rob Sykes. LGPL.
 
-   Since Audacity always does resampling on mono streams that are
-   contiguous in memory, this class doesn't support multiple channels
-   or some of the other optional features of some of these resamplers.
+   Channels are given as separate buffers, each contiguous in memory.
+   This class doesn't support interleaved samples or some of the other
+   optional features of some of these resamplers.
 
 *//*******************************************************************/
 
@@ -29,7 +29,12 @@
 
 #include <soxr.h>
 
-Resample::Resample(const bool useBestMethod, const double dMinFactor, const double dMaxFactor)
+#include <algorithm>
+#include <cassert>
+
+Resample::Resample(const bool useBestMethod, const double dMinFactor, const double dMaxFactor,
+   size_t nChannels)
+   : mNumChannels{ std::max<size_t>(nChannels, 1) }
 {
    this->SetMethod(useBestMethod);
    soxr_quality_spec_t q_spec;
@@ -43,7 +48,14 @@ Resample::Resample(const bool useBestMethod, const double dMinFactor, const doub
       mbWantConstRateResampling = false; // variable rate resampling
       q_spec = soxr_quality_spec(SOXR_HQ, SOXR_VR);
    }
-   mHandle.reset(soxr_create(1, dMinFactor, 1, 0, 0, &q_spec, 0));
+   // Buffers of the channels are separate
+   const auto io_spec = soxr_io_spec(SOXR_FLOAT32_S, SOXR_FLOAT32_S);
+   // 0 means as many threads as OpenMP allows, which the audio threads of
+   // real-time playback must not wait for
+   const auto runtime_spec =
+      soxr_runtime_spec(useBestMethod && mNumChannels > 1 ? 0 : 1);
+   mHandle.reset(soxr_create(1, dMinFactor, mNumChannels, 0,
+      &io_spec, &q_spec, &runtime_spec));
 }
 
 Resample::~Resample()
@@ -91,13 +103,28 @@ std::pair<size_t, size_t>
                         bool         lastFlag,
                         float       *outBuffer,
                         size_t       outBufferLen)
+{
+   assert(mNumChannels == 1);
+   return Process(factor, &inBuffer, inBufferLen, lastFlag,
+      &outBuffer, outBufferLen);
+}
+
+std::pair<size_t, size_t>
+      Resample::Process(double       factor,
+                        const float *const *inBuffers,
+                        size_t       inBufferLen,
+                        bool         lastFlag,
+                        float *const *outBuffers,
+                        size_t       outBufferLen)
 {
    size_t idone, odone;
+   // soxr takes the array of channel pointers as non-const but only reads it
+   const auto outPointers = const_cast<float **>(outBuffers);
    if (mbWantConstRateResampling)
    {
       soxr_process(mHandle.get(),
-            inBuffer , (lastFlag? ~inBufferLen : inBufferLen), &idone,
-            outBuffer,                           outBufferLen, &odone);
+            inBuffers  , (lastFlag? ~inBufferLen : inBufferLen), &idone,
+            outPointers,                           outBufferLen, &odone);
    }
    else
    {
@@ -105,8 +132,8 @@ std::pair<size_t, size_t>
 
       inBufferLen = lastFlag? ~inBufferLen : inBufferLen;
       soxr_process(mHandle.get(),
-            inBuffer , inBufferLen , &idone,
-            outBuffer, outBufferLen, &odone);
+            inBuffers  , inBufferLen , &idone,
+            outPointers, outBufferLen, &odone);
    }
    return { idone, odone };
 }
@@ -36,7 +36,11 @@ class MATH_API Resample final
    /// the fast method.
    // dMinFactor and dMaxFactor specify the range of factors for variable-rate resampling.
    // For constant-rate, pass the same value for both.
-   Resample(const bool useBestMethod, const double dMinFactor, const double dMaxFactor);
+   /// All channels share one filter set up and are converted by the same
+   /// factor.  The fast method, meant for real-time use, never involves other
+   /// threads; the best method may convert the channels in parallel.
+   Resample(const bool useBestMethod, const double dMinFactor, const double dMaxFactor,
+      size_t nChannels = 1);
    ~Resample();
 
    Resample( Resample&&) noexcept = default;
@@ -48,6 +52,8 @@ class MATH_API Resample final
    static EnumSetting< int > FastMethodSetting;
    static EnumSetting< int > BestMethodSetting;
 
+   size_t NChannels() const { return mNumChannels; }
+
    /** @brief Main processing function. Resamples from the input buffer to the
     * output buffer.
     *
@@ -78,6 +84,23 @@ class MATH_API Resample final
                         float       *outBuffer,
                         size_t       outBufferLen);
 
+   /** @brief As above, for all channels at once.
+    *
+    * @param inBuffers NChannels() buffers of input samples, each of length
+    * inBufferLen
+    * @param outBuffers NChannels() buffers for the output, each of length
+    * outBufferLen
+    * @return Number of input samples consumed, and number of output samples
+    * created by this call, the same for each channel
+   */
+   std::pair<size_t, size_t>
+                Process(double       factor,
+                        const float *const *inBuffers,
+                        size_t       inBufferLen,
+                        bool         lastFlag,
+                        float *const *outBuffers,
+                        size_t       outBufferLen);
+
  protected:
    void SetMethod(const bool useBestMethod);
 
@@ -85,6 +108,7 @@ class MATH_API Resample final
    int   mMethod; // resampler-specific enum for resampling method
    soxrHandle mHandle; // constant-rate or variable-rate resampler (XOR per instance)
    bool mbWantConstRateResampling;
+   size_t mNumChannels;
 };
 
 #endif // __AUDACITY_RESAMPLE_H__
@@ -0,0 +1,104 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  BiquadCascadeBenchmark.cpp
+
+**********************************************************************/
+#include "BiquadCascade.h"
+#include "Biquad.h"
+
+#include <catch2/catch.hpp>
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace
+{
+// Benchmarks are not meant to be run on CI. Set to `true` to run locally.
+constexpr auto runLocally = false;
+
+constexpr auto sampleRate = 44100;
+constexpr auto duration = 20;
+constexpr size_t blockSize = 512;
+
+// Seconds of computation per second of audio
+template <typename ProcessFn> double Measure(ProcessFn process)
+{
+   constexpr size_t numSamples = duration * sampleRate;
+   const auto start = std::chrono::steady_clock::now();
+   for (size_t pos = 0; pos < numSamples; pos += blockSize)
+      process(pos, std::min(blockSize, numSamples - pos));
+   const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+   return elapsed.count() / duration;
+}
+} // namespace
+
+TEST_CASE("BiquadCascadeBenchmark")
+{
+   // Compares one Biquad per section and channel, as the filter effects used
+   // to do, with one cascade for all
+   if (!runLocally)
+      return;
+
+   std::mt19937 gen { 0 };
+   std::uniform_real_distribution<float> noise { -1.f, 1.f };
+
+   for (const auto order : { 2, 4, 6, 8, 10 })
+   {
+      const auto numSections = static_cast<size_t>(order / 2);
+      const auto prototype =
+         Biquad::CalcButterworthFilter(order, sampleRate, 1000, Biquad::kLowPass);
+      for (const auto numChannels : { 1u, 2u, 6u })
+      {
+         std::vector<std::vector<float>> input(numChannels);
+         for (auto& channel : input)
+         {
+            channel.resize(duration * sampleRate);
+            for (auto& sample : channel)
+               sample = noise(gen);
+         }
+         std::vector<float> out(numChannels * blockSize);
+
+         std::vector<Biquad> biquads;
+         for (auto c = 0u; c < numChannels; ++c)
+            for (size_t i = 0; i < numSections; ++i)
+               biquads.push_back(prototype[i]);
+         const auto serial = Measure([&](size_t pos, size_t len) {
+            for (auto c = 0u; c < numChannels; ++c)
+            {
+               const auto* in = input[c].data() + pos;
+               auto* const o = out.data() + c * blockSize;
+               for (size_t i = 0; i < numSections; ++i)
+               {
+                  biquads[c * numSections + i].Process(in, o, len);
+                  in = o;
+               }
+            }
+         });
+
+         BiquadCascade cascade { numChannels, numSections };
+         for (size_t i = 0; i < numSections; ++i)
+            cascade.SetSection(i, prototype[i]);
+         std::vector<const float*> ins(numChannels);
+         std::vector<float*> outs(numChannels);
+         const auto together = Measure([&](size_t pos, size_t len) {
+            for (auto c = 0u; c < numChannels; ++c)
+            {
+               ins[c] = input[c].data() + pos;
+               outs[c] = out.data() + c * blockSize;
+            }
+            cascade.Process(ins.data(), outs.data(), len);
+         });
+
+         std::cout << "Order " << order << ", " << numChannels
+                   << " channel(s): CPU per channel "
+                   << 100 * serial / numChannels << "% with biquads, "
+                   << 100 * together / numChannels << "% with a cascade\n";
+      }
+   }
+}
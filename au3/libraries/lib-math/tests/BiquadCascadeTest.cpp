@@ -0,0 +1,123 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  BiquadCascadeTest.cpp
+
+**********************************************************************/
+#include "BiquadCascade.h"
+#include "Biquad.h"
+
+#include <catch2/catch.hpp>
+
+#include <random>
+#include <vector>
+
+namespace
+{
+std::vector<float> MakeNoise(size_t numSamples, unsigned seed)
+{
+   std::mt19937 gen { seed };
+   std::uniform_real_distribution<float> noise { -1.f, 1.f };
+   std::vector<float> samples(numSamples);
+   for (auto& sample : samples)
+      sample = noise(gen);
+   return samples;
+}
+
+// What the effects did before the cascade
+std::vector<float> ProcessSerially(
+   const ArrayOf<Biquad>& prototype, size_t numSections,
+   const std::vector<float>& input)
+{
+   std::vector<Biquad> biquads { prototype.get(), prototype.get() + numSections };
+   for (auto& biquad : biquads)
+      biquad.Reset();
+   auto output = input;
+   for (auto& sample : output)
+      for (size_t i = 0; i < numSections; ++i)
+         sample = biquads[i].ProcessOne(sample);
+   return output;
+}
+} // namespace
+
+TEST_CASE("BiquadCascade")
+{
+   constexpr auto numSamples = 10000;
+   constexpr auto margin = 1e-5;
+
+   SECTION("matches serial biquads, whatever the blocks")
+   {
+      for (const auto order : { 1, 4, 5, 8, 10 })
+         for (const auto numChannels : { 1u, 2u, 5u })
+         {
+            const auto numSections = static_cast<size_t>((order + 1) / 2);
+            const auto prototype = Biquad::CalcChebyshevType1Filter(
+               order, 44100, 1000, 1, Biquad::kLowPass);
+            BiquadCascade sut { numChannels, numSections };
+            for (size_t i = 0; i < numSections; ++i)
+               sut.SetSection(i, prototype[i]);
+
+            std::vector<std::vector<float>> input, expected;
+            for (auto c = 0u; c < numChannels; ++c)
+            {
+               input.push_back(MakeNoise(numSamples, c));
+               expected.push_back(
+                  ProcessSerially(prototype, numSections, input.back()));
+            }
+
+            // Blocks shorter and longer than the cascade, in place
+            auto output = input;
+            std::vector<float*> channels(numChannels);
+            size_t blockSize = 1;
+            for (size_t start = 0; start < numSamples;)
+            {
+               const auto len = std::min<size_t>(blockSize, numSamples - start);
+               for (auto c = 0u; c < numChannels; ++c)
+                  channels[c] = output[c].data() + start;
+               sut.Process(channels.data(), channels.data(), len);
+               start += len;
+               blockSize = blockSize * 3 % 1031;
+            }
+
+            for (auto c = 0u; c < numChannels; ++c)
+               for (auto i = 0; i < numSamples; ++i)
+                  REQUIRE(output[c][i] == Approx(expected[c][i]).margin(margin));
+         }
+   }
+
+   SECTION("Reset clears the state")
+   {
+      const auto prototype =
+         Biquad::CalcButterworthFilter(4, 48000, 200, Biquad::kHighPass);
+      BiquadCascade sut { 1, 2 };
+      sut.SetSection(0, prototype[0]);
+      sut.SetSection(1, prototype[1]);
+      const auto input = MakeNoise(1000, 7);
+      std::vector<float> first(input.size()), second(input.size());
+      sut.Process(input.data(), first.data(), input.size());
+      sut.Reset();
+      sut.Process(input.data(), second.data(), input.size());
+      REQUIRE(first == second);
+   }
+
+   SECTION("decays to exact zero")
+   {
+      const auto prototype =
+         Biquad::CalcButterworthFilter(2, 44100, 100, Biquad::kLowPass);
+      BiquadCascade sut;
+      sut.SetSection(0, prototype[0]);
+      std::vector<float> block(4096, 0.f);
+      block[0] = 1.f;
+      sut.Process(block.data(), block.data(), block.size());
+      std::vector<float> silence(4096);
+      for (auto i = 0; i < 100; ++i)
+      {
+         std::fill(silence.begin(), silence.end(), 0.f);
+         sut.Process(silence.data(), silence.data(), silence.size());
+      }
+      for (const auto sample : silence)
+         REQUIRE(sample == 0.f);
+   }
+}
@@ -0,0 +1,117 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  ResampleBenchmark.cpp
+
+**********************************************************************/
+#include "MockedPrefs.h"
+#include "Resample.h"
+
+#include <catch2/catch.hpp>
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace
+{
+// Benchmarks are not meant to be run on CI. Set to `true` to run locally.
+constexpr auto runLocally = false;
+
+constexpr auto duration = 20;
+constexpr size_t blockSize = 1024;
+
+// Seconds of computation per second of audio
+template <typename ProcessFn>
+double Measure(int inRate, double factor, ProcessFn process)
+{
+   const size_t numInput = duration * inRate;
+   const auto outLen = static_cast<size_t>(blockSize * factor) + 16;
+   const auto start = std::chrono::steady_clock::now();
+   for (size_t pos = 0; pos < numInput;)
+   {
+      const auto len = std::min(blockSize, numInput - pos);
+      pos += process(pos, len, pos + len == numInput, outLen);
+   }
+   const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+   return elapsed.count() / duration;
+}
+} // namespace
+
+TEST_CASE("ResampleBenchmark")
+{
+   // Compares one resampler per channel, as used to be the only way, with one
+   // resampler for all channels, for the best and the fast (real-time) methods
+   if (!runLocally)
+      return;
+
+   MockedPrefs mockedPrefs;
+   std::mt19937 gen { 0 };
+   std::uniform_real_distribution<float> noise { -.5f, .5f };
+
+   for (const auto [inRate, outRate] : { std::pair { 44100, 48000 },
+                                         std::pair { 96000, 44100 } })
+   {
+      const double factor = static_cast<double>(outRate) / inRate;
+      for (const auto useBestMethod : { true, false })
+      {
+         for (const auto numChannels : { 1u, 2u, 6u })
+         {
+            std::vector<std::vector<float>> input(numChannels);
+            for (auto& channel : input)
+            {
+               channel.resize(duration * inRate);
+               for (auto& sample : channel)
+                  sample = noise(gen);
+            }
+            std::vector<float> out(
+               numChannels * (static_cast<size_t>(blockSize * factor) + 16));
+
+            std::vector<Resample> separate;
+            for (auto i = 0u; i < numChannels; ++i)
+               separate.emplace_back(useBestMethod, factor, factor);
+            const auto perChannel = Measure(
+               inRate, factor,
+               [&](size_t pos, size_t len, bool last, size_t outLen) {
+                  size_t used = 0;
+                  for (auto i = 0u; i < numChannels; ++i)
+                     used = separate[i]
+                               .Process(
+                                  factor, input[i].data() + pos, len, last,
+                                  out.data() + i * outLen, outLen)
+                               .first;
+                  return used;
+               });
+
+            Resample together { useBestMethod, factor, factor, numChannels };
+            std::vector<const float*> ins(numChannels);
+            std::vector<float*> outs(numChannels);
+            const auto multichannel = Measure(
+               inRate, factor,
+               [&](size_t pos, size_t len, bool last, size_t outLen) {
+                  for (auto i = 0u; i < numChannels; ++i)
+                  {
+                     ins[i] = input[i].data() + pos;
+                     outs[i] = out.data() + i * outLen;
+                  }
+                  return together
+                     .Process(
+                        factor, ins.data(), len, last, outs.data(), outLen)
+                     .first;
+               });
+
+            std::cout << inRate << " -> " << outRate << ", "
+                      << (useBestMethod ? "best" : "fast") << " method, "
+                      << numChannels << " channel(s): CPU per channel "
+                      << 100 * perChannel / numChannels
+                      << "% with separate resamplers, "
+                      << 100 * multichannel / numChannels
+                      << "% with one resampler\n";
+         }
+      }
+   }
+}
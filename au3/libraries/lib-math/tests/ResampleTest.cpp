@@ -0,0 +1,120 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  ResampleTest.cpp
+
+**********************************************************************/
+#include "MockedPrefs.h"
+#include "Resample.h"
+
+#include <catch2/catch.hpp>
+
+#include <cmath>
+#include <vector>
+
+namespace
+{
+constexpr size_t numChannels = 3;
+constexpr size_t numSamples = 20000;
+constexpr size_t blockSize = 1024;
+
+std::vector<std::vector<float>> MakeInput()
+{
+   std::vector<std::vector<float>> input(numChannels);
+   for (size_t iChannel = 0; iChannel < numChannels; ++iChannel)
+   {
+      input[iChannel].resize(numSamples);
+      for (size_t i = 0; i < numSamples; ++i)
+         input[iChannel][i] =
+            std::sin(0.01 * (iChannel + 1) * i) * (1.f - .2f * iChannel);
+   }
+   return input;
+}
+
+// Feeds all of the input, block by block, with the given factors, and
+// collects all of the output
+template <typename ProcessFn>
+std::vector<std::vector<float>> Run(
+   size_t nChannels, const std::vector<double>& factors, ProcessFn process)
+{
+   std::vector<std::vector<float>> output(nChannels);
+   std::vector<float> outBlock(nChannels * 4 * blockSize);
+   std::vector<float*> outPointers(nChannels);
+   for (size_t iChannel = 0; iChannel < nChannels; ++iChannel)
+      outPointers[iChannel] = outBlock.data() + iChannel * 4 * blockSize;
+
+   size_t pos = 0;
+   size_t iBlock = 0;
+   while (true)
+   {
+      const auto len = std::min(blockSize, numSamples - pos);
+      const auto last = pos + len == numSamples;
+      const auto factor = factors[iBlock++ % factors.size()];
+      const auto [used, produced] =
+         process(factor, pos, len, last, outPointers.data(), 4 * blockSize);
+      for (size_t iChannel = 0; iChannel < nChannels; ++iChannel)
+         output[iChannel].insert(
+            output[iChannel].end(), outPointers[iChannel],
+            outPointers[iChannel] + produced);
+      pos += used;
+      if (last && used == len && produced == 0)
+         break;
+   }
+   return output;
+}
+
+void CompareWithSeparateChannels(double minFactor, double maxFactor,
+   const std::vector<double>& factors)
+{
+   const auto input = MakeInput();
+
+   Resample multi { true, minFactor, maxFactor, numChannels };
+   REQUIRE(multi.NChannels() == numChannels);
+   const auto together = Run(
+      numChannels, factors,
+      [&](double factor, size_t pos, size_t len, bool last,
+          float* const* outs, size_t outLen) {
+         std::vector<const float*> ins(numChannels);
+         for (size_t iChannel = 0; iChannel < numChannels; ++iChannel)
+            ins[iChannel] = input[iChannel].data() + pos;
+         return multi.Process(
+            factor, ins.data(), len, last, outs, outLen);
+      });
+
+   for (size_t iChannel = 0; iChannel < numChannels; ++iChannel)
+   {
+      Resample mono { true, minFactor, maxFactor };
+      const auto alone = Run(
+         1, factors,
+         [&](double factor, size_t pos, size_t len, bool last,
+             float* const* outs, size_t outLen) {
+            return mono.Process(
+               factor, input[iChannel].data() + pos, len, last, outs[0],
+               outLen);
+         });
+      REQUIRE(alone[0].size() == together[iChannel].size());
+      for (size_t i = 0; i < alone[0].size(); ++i)
+         REQUIRE(alone[0][i] == Approx(together[iChannel][i]).margin(1e-6));
+   }
+}
+} // namespace
+
+TEST_CASE("Resample")
+{
+   MockedPrefs mockedPrefs;
+
+   SECTION("channels resampled together match channels resampled alone")
+   {
+      SECTION("at constant rate")
+      {
+         CompareWithSeparateChannels(48000. / 44100, 48000. / 44100,
+            { 48000. / 44100 });
+      }
+      SECTION("at variable rate")
+      {
+         CompareWithSeparateChannels(.5, 2., { .5, .9, 1.3, 2. });
+      }
+   }
+}
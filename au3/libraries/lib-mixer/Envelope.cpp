@@ -58,6 +58,18 @@ bool Envelope::IsTrivial() const
    return mDefaultValue == 1.0 && mEnv.empty();
 }
 
+bool Envelope::IsEquivalent(const Envelope &other) const
+{
+   return mDB == other.mDB &&
+      mMinValue == other.mMinValue && mMaxValue == other.mMaxValue &&
+      mDefaultValue == other.mDefaultValue &&
+      mOffset == other.mOffset && mTrackLen == other.mTrackLen &&
+      std::equal(mEnv.begin(), mEnv.end(), other.mEnv.begin(), other.mEnv.end(),
+         [](const EnvPoint &a, const EnvPoint &b){
+            return a.GetT() == b.GetT() && a.GetVal() == b.GetVal();
+         });
+}
+
 bool Envelope::ConsistencyCheck()
 {
    bool consistent = true;
@@ -878,11 +890,17 @@ void Envelope::RescaleTimesBy(double ratio)
 
 // Accessors
 double Envelope::GetValue( double t, double sampleDur ) const
+{
+   Cursor cursor;
+   return GetValue( cursor, t, sampleDur );
+}
+
+double Envelope::GetValue( Cursor &cursor, double t, double sampleDur ) const
 {
    // t is absolute time
    double temp;
 
-   GetValues( &temp, 1, t, sampleDur );
+   GetValues( cursor, &temp, 1, t, sampleDur );
    return temp;
 }
 
@@ -890,7 +908,8 @@ double Envelope::GetValueRelative(double t, bool leftLimit) const noexcept
 {
    double temp;
 
-   GetValuesRelative(&temp, 1, t, 0.0, leftLimit);
+   Cursor cursor;
+   GetValuesRelative(cursor, &temp, 1, t, 0.0, leftLimit);
    return temp;
 }
 
@@ -899,26 +918,38 @@ double Envelope::GetValueRelative(double t, bool leftLimit) const noexcept
 /// @param Hi returns first index after this time, maybe past the end
 void Envelope::BinarySearchForTime(int &Lo, int &Hi, double t) const noexcept
 {
+   Cursor cursor;
+   BinarySearchForTime( cursor, Lo, Hi, t );
+}
+
+// relative time
+/// @param Lo returns last index at or before this time, maybe -1
+/// @param Hi returns first index after this time, maybe past the end
+void Envelope::BinarySearchForTime(
+   Cursor &cursor, int &Lo, int &Hi, double t) const noexcept
+{
+   auto &searchGuess = cursor.mSearchGuess;
+
    // Optimizations for the usual pattern of repeated calls with
    // small increases of t.
    {
-      if (mSearchGuess >= 0 && mSearchGuess < (int)mEnv.size()) {
-         if (t >= mEnv[mSearchGuess].GetT() &&
-             (1 + mSearchGuess == (int)mEnv.size() ||
-              t < mEnv[1 + mSearchGuess].GetT())) {
-            Lo = mSearchGuess;
-            Hi = 1 + mSearchGuess;
+      if (searchGuess >= 0 && searchGuess < (int)mEnv.size()) {
+         if (t >= mEnv[searchGuess].GetT() &&
+             (1 + searchGuess == (int)mEnv.size() ||
+              t < mEnv[1 + searchGuess].GetT())) {
+            Lo = searchGuess;
+            Hi = 1 + searchGuess;
             return;
          }
       }
 
-      ++mSearchGuess;
-      if (mSearchGuess >= 0 && mSearchGuess < (int)mEnv.size()) {
-         if (t >= mEnv[mSearchGuess].GetT() &&
-             (1 + mSearchGuess == (int)mEnv.size() ||
-              t < mEnv[1 + mSearchGuess].GetT())) {
-            Lo = mSearchGuess;
-            Hi = 1 + mSearchGuess;
+      ++searchGuess;
+      if (searchGuess >= 0 && searchGuess < (int)mEnv.size()) {
+         if (t >= mEnv[searchGuess].GetT() &&
+             (1 + searchGuess == (int)mEnv.size() ||
+              t < mEnv[1 + searchGuess].GetT())) {
+            Lo = searchGuess;
+            Hi = 1 + searchGuess;
             return;
          }
       }
@@ -938,14 +969,14 @@ void Envelope::BinarySearchForTime(int &Lo, int &Hi, double t) const noexcept
    }
    wxASSERT( Hi == ( Lo+1 ));
 
-   mSearchGuess = Lo;
+   searchGuess = Lo;
 }
 
 // relative time
 /// @param Lo returns last index before this time, maybe -1
 /// @param Hi returns first index at or after this time, maybe past the end
-void Envelope::BinarySearchForTime_LeftLimit(int &Lo, int &Hi, double t)
-   const noexcept
+void Envelope::BinarySearchForTime_LeftLimit(
+   Cursor &cursor, int &Lo, int &Hi, double t) const noexcept
 {
    Lo = -1;
    Hi = mEnv.size();
@@ -961,7 +992,7 @@ void Envelope::BinarySearchForTime_LeftLimit(int &Lo, int &Hi, double t)
    }
    wxASSERT( Hi == ( Lo+1 ));
 
-   mSearchGuess = Lo;
+   cursor.mSearchGuess = Lo;
 }
 
 /// GetInterpolationStartValueAtPoint() is used to select either the
@@ -980,14 +1011,53 @@ double Envelope::GetInterpolationStartValueAtPoint(int iPoint) const noexcept
 
 void Envelope::GetValues( double *buffer, int bufferLen,
                           double t0, double tstep ) const
+{
+   Cursor cursor;
+   GetValues( cursor, buffer, bufferLen, t0, tstep );
+}
+
+void Envelope::GetValues( Cursor &cursor, double *buffer, int bufferLen,
+                          double t0, double tstep ) const
 {
    // Convert t0 from absolute to clip-relative time
    t0 -= mOffset;
-   GetValuesRelative( buffer, bufferLen, t0, tstep);
+   GetValuesRelative( cursor, buffer, bufferLen, t0, tstep);
+}
+
+namespace {
+// The loops have no dependencies between iterations, so that compilers
+// vectorize them
+
+void FillLinear(double *buffer, int len, double v, double vstep) noexcept
+{
+   for (int i = 0; i < len; ++i)
+      buffer[i] = v + i * vstep;
 }
 
-void Envelope::GetValuesRelative
-   (double *buffer, int bufferLen, double t0, double tstep, bool leftLimit)
+void FillExponential(double *buffer, int len, double v, double vstep) noexcept
+{
+   constexpr int width = 4;
+   double factors[width];
+   factors[0] = 1.0;
+   for (int j = 1; j < width; ++j)
+      factors[j] = factors[j - 1] * vstep;
+   const auto widthStep = factors[width - 1] * vstep;
+
+   int i = 0;
+   for (; i + width <= len; i += width) {
+      for (int j = 0; j < width; ++j)
+         buffer[i + j] = v * factors[j];
+      v *= widthStep;
+   }
+   for (; i < len; ++i) {
+      buffer[i] = v;
+      v *= vstep;
+   }
+}
+}
+
+void Envelope::GetValuesRelative(Cursor &cursor,
+   double *buffer, int bufferLen, double t0, double tstep, bool leftLimit)
    const noexcept
 {
    // JC: If bufferLen ==0 we have probably just allocated a zero sized buffer.
@@ -996,109 +1066,125 @@ void Envelope::GetValuesRelative
    const auto epsilon = tstep / 2;
    int len = mEnv.size();
 
-   double t = t0;
+   // Times are computed from t0 rather than accumulated, so that the samples
+   // of an interval can be counted without visiting each of them
+   const auto timeAt = [t0, tstep](int b) { return t0 + b * tstep; };
+   // Index after the samples from b onward that are before tlimit (or at it,
+   // for the left limit); b itself is assumed to be
+   const auto endBefore = [&](int b, double tlimit, double offset) {
+      const auto before = [&](int i) {
+         const auto tp = timeAt(i) + offset;
+         return leftLimit ? tp <= tlimit : tp < tlimit;
+      };
+      if (tstep <= 0)
+         return tstep == 0 ? bufferLen : b + 1;
+      // Estimate, then correct for roundoff
+      auto end = static_cast<int>(std::clamp<double>(
+         (tlimit - offset - t0) / tstep, b + 1, bufferLen));
+      while (end < bufferLen && before(end))
+         ++end;
+      while (end > b + 1 && !before(end - 1))
+         --end;
+      return end;
+   };
+
    double increment = 0;
-   if ( len > 1 && t <= mEnv[0].GetT() && mEnv[0].GetT() == mEnv[1].GetT() )
+   if ( len > 1 && t0 <= mEnv[0].GetT() && mEnv[0].GetT() == mEnv[1].GetT() )
       increment = leftLimit ? -epsilon : epsilon;
 
-   double tprev, vprev, tnext = 0, vnext, vstep = 0;
-
-   for (int b = 0; b < bufferLen; b++) {
+   for (int b = 0; b < bufferLen;) {
 
       // Get easiest cases out the way first...
       // IF empty envelope THEN default value
       if (len <= 0) {
-         buffer[b] = mDefaultValue;
-         t += tstep;
-         continue;
+         std::fill(buffer + b, buffer + bufferLen, mDefaultValue);
+         return;
       }
 
-      auto tplus = t + increment;
+      const auto t = timeAt(b);
+      const auto tplus = t + increment;
 
       // IF before envelope THEN first value
       if ( leftLimit ? tplus <= mEnv[0].GetT() : tplus < mEnv[0].GetT() ) {
-         buffer[b] = mEnv[0].GetVal();
-         t += tstep;
+         const auto end = endBefore(b, mEnv[0].GetT(), increment);
+         std::fill(buffer + b, buffer + end, mEnv[0].GetVal());
+         b = end;
          continue;
       }
       // IF after envelope THEN last value
       if ( leftLimit
             ? tplus > mEnv[len - 1].GetT() : tplus >= mEnv[len - 1].GetT() ) {
-         buffer[b] = mEnv[len - 1].GetVal();
-         t += tstep;
+         const auto end = tstep >= 0 ? bufferLen : b + 1;
+         std::fill(buffer + b, buffer + end, mEnv[len - 1].GetVal());
+         b = end;
          continue;
       }
 
-      // be careful to get the correct limit even in case epsilon == 0
-      if ( b == 0 ||
-           ( leftLimit ? tplus > tnext : tplus >= tnext ) ) {
-
-         // We're beyond our tnext, so find the next one.
-         // Don't just increment lo or hi because we might
-         // be zoomed far out and that could be a large number of
-         // points to move over.  That's why we binary search.
+      // We're beyond the previous interval, so find the next one.
+      // Don't just increment lo or hi because we might
+      // be zoomed far out and that could be a large number of
+      // points to move over.  That's why we binary search.
 
-         int lo,hi;
-         if ( leftLimit )
-            BinarySearchForTime_LeftLimit( lo, hi, tplus );
-         else
-            BinarySearchForTime( lo, hi, tplus );
-
-         // mEnv[0] is before tplus because of eliminations above, therefore lo >= 0
-         // mEnv[len - 1] is after tplus, therefore hi <= len - 1
-         wxASSERT( lo >= 0 && hi <= len - 1 );
-
-         tprev = mEnv[lo].GetT();
-         tnext = mEnv[hi].GetT();
-
-         if ( hi + 1 < len && tnext == mEnv[ hi + 1 ].GetT() )
-            // There is a discontinuity after this point-to-point interval.
-            // Usually will stop evaluating in this interval when time is slightly
-            // before tNext, then use the right limit.
-            // This is the right intent
-            // in case small roundoff errors cause a sample time to be a little
-            // before the envelope point time.
-            // Less commonly we want a left limit, so we continue evaluating in
-            // this interval until shortly after the discontinuity.
-            increment = leftLimit ? -epsilon : epsilon;
-         else
-            increment = 0;
-
-         vprev = GetInterpolationStartValueAtPoint( lo );
-         vnext = GetInterpolationStartValueAtPoint( hi );
+      int lo,hi;
+      if ( leftLimit )
+         BinarySearchForTime_LeftLimit( cursor, lo, hi, tplus );
+      else
+         BinarySearchForTime( cursor, lo, hi, tplus );
+
+      // mEnv[0] is before tplus because of eliminations above, therefore lo >= 0
+      // mEnv[len - 1] is after tplus, therefore hi <= len - 1
+      wxASSERT( lo >= 0 && hi <= len - 1 );
+
+      const auto tprev = mEnv[lo].GetT();
+      const auto tnext = mEnv[hi].GetT();
+
+      if ( hi + 1 < len && tnext == mEnv[ hi + 1 ].GetT() )
+         // There is a discontinuity after this point-to-point interval.
+         // Usually will stop evaluating in this interval when time is slightly
+         // before tNext, then use the right limit.
+         // This is the right intent
+         // in case small roundoff errors cause a sample time to be a little
+         // before the envelope point time.
+         // Less commonly we want a left limit, so we continue evaluating in
+         // this interval until shortly after the discontinuity.
+         increment = leftLimit ? -epsilon : epsilon;
+      else
+         increment = 0;
 
-         // Interpolate, either linear or log depending on mDB.
-         double dt = (tnext - tprev);
-         double to = t - tprev;
-         double v;
-         if (dt > 0.0)
-         {
-            v = (vprev * (dt - to) + vnext * to) / dt;
-            vstep = (vnext - vprev) * tstep / dt;
-         }
-         else
-         {
-            v = vnext;
-            vstep = 0.0;
-         }
+      const auto vprev = GetInterpolationStartValueAtPoint( lo );
+      const auto vnext = GetInterpolationStartValueAtPoint( hi );
 
-         // An adjustment if logarithmic scale.
-         if( mDB )
-         {
-            v = pow(10.0, v);
-            vstep = pow( 10.0, vstep );
-         }
+      // Interpolate, either linear or log depending on mDB.
+      double dt = (tnext - tprev);
+      double to = t - tprev;
+      double v, vstep;
+      if (dt > 0.0)
+      {
+         v = (vprev * (dt - to) + vnext * to) / dt;
+         vstep = (vnext - vprev) * tstep / dt;
+      }
+      else
+      {
+         v = vnext;
+         vstep = 0.0;
+      }
 
-         buffer[b] = v;
-      } else {
-         if (mDB){
-            buffer[b] = buffer[b - 1] * vstep;
-         }else{
-            buffer[b] = buffer[b - 1] + vstep;
-         }
+      // An adjustment if logarithmic scale.
+      if( mDB )
+      {
+         v = pow(10.0, v);
+         vstep = pow( 10.0, vstep );
       }
 
-      t += tstep;
+      // Count the samples in this interval, then fill them at once
+      // (be careful to get the correct limit even in case epsilon == 0)
+      const auto end = endBefore(b, tnext, increment);
+
+      if ( mDB )
+         FillExponential( buffer + b, end - b, v, vstep );
+      else
+         FillLinear( buffer + b, end - b, v, vstep );
+      b = end;
    }
 }
 
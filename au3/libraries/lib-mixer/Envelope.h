@@ -87,6 +87,10 @@ public:
    // and repaired
    bool ConsistencyCheck();
 
+   //! Whether the envelopes have the same range, extent and points, which is
+   //! all that copying preserves
+   bool IsEquivalent(const Envelope &other) const;
+
    double GetOffset() const { return mOffset; }
    double GetTrackLen() const { return mTrackLen; }
 
@@ -127,15 +131,35 @@ public:
    void RescaleTimes( double newLength );
    void RescaleTimesBy(double ratio);
 
+   //! Search state for evaluating an envelope at nondecreasing times
+   /*!
+    The envelope keeps no such state itself, so readers on different threads
+    do not race as long as each has its own cursor.  The state is only a hint,
+    checked before use, so a cursor stays valid when the envelope changes.
+    */
+   class Cursor final {
+      friend Envelope;
+      int mSearchGuess { -2 };
+   };
+
    // Accessors
    /** \brief Get envelope value at time t */
    double GetValue( double t, double sampleDur = 0 ) const;
+   /** \brief Get envelope value at time t, resuming the search from the
+    * previous call with the same cursor */
+   double GetValue( Cursor &cursor, double t, double sampleDur = 0 ) const;
 
    /** \brief Get many envelope points at once.
     *
     * This is much faster than calling GetValue() multiple times if you need
     * more than one value in a row. */
    void GetValues(double *buffer, int len, double t0, double tstep) const;
+   /** \brief Get many envelope points at once, resuming the search from the
+    * previous call with the same cursor
+    *
+    * Consecutive buffers of a stream are best filled with the same cursor. */
+   void GetValues(Cursor &cursor,
+      double *buffer, int len, double t0, double tstep) const;
 
    // Guarantee an envelope point at the end of the domain.
    void Cap( double sampleDur );
@@ -148,8 +172,8 @@ private:
       ( size_t startAt, bool rightward, bool testNeighbors = true ) noexcept;
 
    double GetValueRelative(double t, bool leftLimit = false) const noexcept;
-   void GetValuesRelative
-      (double *buffer, int len, double t0, double tstep, bool leftLimit = false)
+   void GetValuesRelative(Cursor &cursor,
+      double *buffer, int len, double t0, double tstep, bool leftLimit = false)
       const noexcept;
    // relative time
    int NumberOfPointsAfter(double t) const;
@@ -228,8 +252,10 @@ private:
    void CopyRange(const Envelope &orig, size_t begin, size_t end);
    // relative time
    void BinarySearchForTime(int &Lo, int &Hi, double t) const noexcept;
-   void BinarySearchForTime_LeftLimit(int &Lo, int &Hi, double t)
+   void BinarySearchForTime(Cursor &cursor, int &Lo, int &Hi, double t)
       const noexcept;
+   void BinarySearchForTime_LeftLimit(
+      Cursor &cursor, int &Lo, int &Hi, double t) const noexcept;
    double GetInterpolationStartValueAtPoint(int iPoint) const noexcept;
 
    // The list of envelope control points.
@@ -254,8 +280,6 @@ private:
    bool mDragPointValid { false };
    int mDragPoint { -1 };
    size_t mVersion { 0 };
-
-   mutable int mSearchGuess { -2 };
 };
 
 inline void EnvPoint::SetVal( Envelope *pEnvelope, double val )
@@ -47,7 +47,10 @@ initVector(size_t dim1, size_t dim2)
 
 namespace
 {
-
+// TODO: more-than-two-channels
+// Channels of the buffers that sources fill: those of DownmixStage and of the
+// inputs of effect stages, which have one extra for issue 3854
+constexpr unsigned sourceBufferChannels = 3;
 
 void ConsiderStages(const Mixer::Stages& stages, size_t& blockSize)
 {
@@ -161,8 +164,9 @@ Mixer::Mixer(
          break;
       }
 
-      auto &source = mSources.emplace_back(sequence, BufferSize(), outRate,
-         warpOptions, highQuality, mayThrow, mTimesAndSpeed);
+      auto &source = mSources.emplace_back(sequence, BufferSize(),
+         sourceBufferChannels, outRate, warpOptions, highQuality, mayThrow,
+         mTimesAndSpeed);
       AudioGraph::Source *pDownstream = &source;
       for (const auto &stage : input.stages)
          if (
@@ -422,7 +426,8 @@ std::unique_ptr<EffectStage>& Mixer::RegisterEffectStage(
    // Like mFloatBuffers but padding not needed for soxr
    // Allocate one extra buffer to hold dummy zero inputs
    // (Issue 3854)
-   auto& stageInput = mStageBuffers.emplace_back(3, mBufferSize, 1);
+   auto& stageInput =
+      mStageBuffers.emplace_back(sourceBufferChannels, mBufferSize, 1);
    const auto& factory = [&stage] {
       // Avoid unnecessary repeated calls to the factory
       return stage.mpFirstInstance ? move(stage.mpFirstInstance) :
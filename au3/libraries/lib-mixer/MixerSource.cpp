@@ -37,12 +37,14 @@ initVector(size_t dim1, size_t dim2)
 }
 }
 
-void MixerSource::MakeResamplers()
+#define stackAllocate(T, count) static_cast<T*>(alloca(count * sizeof(T)))
+
+void MixerSource::MakeResamplers(size_t nChannels)
 {
-   for (size_t j = 0; j < mnChannels; ++j)
-      mResample[j] = std::make_unique<Resample>(
-         mResampleParameters.mHighQuality,
-         mResampleParameters.mMinFactor, mResampleParameters.mMaxFactor);
+   mResample = std::make_unique<Resample>(
+      mResampleParameters.mHighQuality,
+      mResampleParameters.mMinFactor, mResampleParameters.mMaxFactor,
+      nChannels);
 }
 
 namespace {
@@ -91,6 +93,14 @@ size_t MixerSource::MixVariableRates(
 
    size_t out = 0;
 
+   // The constructor made the resamplers for as many channels, so that this,
+   // which allocates, doesn't happen during playback
+   assert(mResample->NChannels() == nChannels);
+   if (mResample->NChannels() != nChannels)
+      MakeResamplers(nChannels);
+   const auto inputs = stackAllocate(const float *, nChannels);
+   const auto outputs = stackAllocate(float *, nChannels);
+
    /* time is floating point. Sample rate is integer. The number of samples
     * has to be integer, but the multiplication gives a float result, which we
     * round to get an integer result. TODO: is this always right or can it be
@@ -174,28 +184,20 @@ size_t MixerSource::MixVariableRates(
                t, t + (double)thisProcessLen / sequenceRate);
       }
 
-      std::pair<size_t, size_t> results;
+      // All channels are resampled by one call
       for (size_t iChannel = 0; iChannel < nChannels; ++iChannel) {
-         const auto queue = mSampleQueue[iChannel].data();
-         const auto pResample = mResample[iChannel].get();
-         const auto pFloat = floatBuffers[iChannel];
-         // Assuming that progress of the Resampler depends only
-         // on the size of its inputs, this assignment has the same effect on
-         // each pass.
-         results = pResample->Process(factor,
-            &queue[queueStart],
-            thisProcessLen,
-            last,
-            // PRL:  Bug2536: crash in soxr happened on Mac, sometimes, when
-            // maxOut - out == 1 and &pFloat[out + 1] was an unmapped
-            // address, because soxr, strangely, fetched an 8-byte (misaligned!)
-            // value from &pFloat[out], but did nothing with it anyway,
-            // in soxr_output_no_callback.
-            // Now we make the bug go away by allocating a little more space in
-            // the buffer than we need.
-            &pFloat[out],
-            maxOut - out);
+         inputs[iChannel] = &mSampleQueue[iChannel][queueStart];
+         // PRL:  Bug2536: crash in soxr happened on Mac, sometimes, when
+         // maxOut - out == 1 and &pFloat[out + 1] was an unmapped
+         // address, because soxr, strangely, fetched an 8-byte (misaligned!)
+         // value from &pFloat[out], but did nothing with it anyway,
+         // in soxr_output_no_callback.
+         // Now we make the bug go away by allocating a little more space in
+         // the buffer than we need.
+         outputs[iChannel] = &floatBuffers[iChannel][out];
       }
+      const auto results = mResample->Process(factor,
+         inputs, thisProcessLen, last, outputs, maxOut - out);
 
       const auto input_used = results.first;
       queueStart += input_used;
@@ -288,7 +290,7 @@ void MixerSource::ZeroFill(
 
 MixerSource::MixerSource(
    const std::shared_ptr<const WideSampleSequence> &seq, size_t bufferSize,
-   double rate, const MixerOptions::Warp &options, bool highQuality,
+   unsigned maxChannels, double rate, const MixerOptions::Warp &options, bool highQuality,
    bool mayThrow, std::shared_ptr<TimesAndSpeed> pTimesAndSpeed
 )  : mpSeq{ seq }
    , mnChannels{ mpSeq->NChannels() }
@@ -300,13 +302,13 @@ MixerSource::MixerSource(
    , mQueueStart{ 0 }
    , mQueueLen{ 0 }
    , mResampleParameters{ highQuality, mpSeq->GetRate(), rate, options }
-   , mResample( mnChannels )
    , mEnvValues( std::max(sQueueMaxLen, bufferSize) )
 {
    assert(mTimesAndSpeed);
    auto t0 = mTimesAndSpeed->mT0;
    mSamplePos = GetSequence().TimeToLongSamples(t0);
-   MakeResamplers();
+   // Acquire() fills no more channels than the buffers have
+   MakeResamplers(std::min<size_t>(mnChannels, maxChannels));
 }
 
 MixerSource::~MixerSource() = default;
@@ -326,8 +328,6 @@ bool MixerSource::AcceptsBlockSize(size_t blockSize) const
    return blockSize <= mEnvValues.size();
 }
 
-#define stackAllocate(T, count) static_cast<T*>(alloca(count * sizeof(T)))
-
 std::optional<size_t> MixerSource::Acquire(Buffers &data, size_t bound)
 {
    assert(AcceptsBuffers(data));
@@ -409,5 +409,5 @@ void MixerSource::Reposition(double time, bool skipping)
    // flushed.  Should that be considered a bug in sox?  This works around it.
    // (See also bug 1887, and the same work around in Mixer::Restart().)
    if (skipping)
-      MakeResamplers();
+      MakeResamplers(mResample->NChannels());
 }
@@ -36,10 +36,12 @@ public:
    using ResampleParameters = MixerOptions::ResampleParameters;
 
    /*!
+    @param maxChannels how many channels the buffers given to Acquire() have,
+    so that resamplers are made here and not while acquiring
     @pre `pTimesAndSpeed != nullptr`
     */
    MixerSource(const std::shared_ptr<const WideSampleSequence> &seq,
-      size_t bufferSize,
+      size_t bufferSize, unsigned maxChannels,
       double rate, const MixerOptions::Warp &options, bool highQuality,
       bool mayThrow, std::shared_ptr<TimesAndSpeed> pTimesAndSpeed
    );
@@ -61,7 +63,7 @@ public:
    bool VariableRates() const { return mResampleParameters.mVariableRates; }
 
 private:
-   void MakeResamplers();
+   void MakeResamplers(size_t nChannels);
 
    //! Cut the queue into blocks of this finer size
    //! for variable rate resampling.  Each block is resampled at some
@@ -121,7 +123,8 @@ private:
    int mQueueLen;
 
    const ResampleParameters mResampleParameters;
-   std::vector<std::unique_ptr<Resample>> mResample;
+   //! Converts all channels at once, by the same factor
+   std::unique_ptr<Resample> mResample;
 
    //! Gain envelopes are applied to input before other transformations
    std::vector<double> mEnvValues;
@@ -0,0 +1,58 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file PluginScanQueue.cpp
+
+  Part of lib-module-manager library
+
+**********************************************************************/
+
+#include "PluginScanQueue.h"
+
+#include <cassert>
+
+PluginScanQueue::PluginScanQueue(size_t pluginsCount)
+   : mPluginsCount(pluginsCount)
+{
+}
+
+std::optional<size_t> PluginScanQueue::Next()
+{
+   if(!mGivenBack.empty())
+   {
+      const auto pluginIndex = mGivenBack.back();
+      mGivenBack.pop_back();
+      return pluginIndex;
+   }
+   if(mNextPluginIndex < mPluginsCount)
+      return mNextPluginIndex++;
+   return std::nullopt;
+}
+
+void PluginScanQueue::GiveBack(size_t pluginIndex)
+{
+   assert(pluginIndex < mNextPluginIndex);
+   mGivenBack.push_back(pluginIndex);
+}
+
+void PluginScanQueue::SetProcessed()
+{
+   assert(mProcessedCount < mPluginsCount);
+   ++mProcessedCount;
+}
+
+size_t PluginScanQueue::GetPluginsCount() const noexcept
+{
+   return mPluginsCount;
+}
+
+size_t PluginScanQueue::GetProcessedCount() const noexcept
+{
+   return mProcessedCount;
+}
+
+bool PluginScanQueue::IsComplete() const noexcept
+{
+   return mProcessedCount == mPluginsCount;
+}
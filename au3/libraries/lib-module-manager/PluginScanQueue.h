@@ -0,0 +1,41 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file PluginScanQueue.h
+
+  Part of lib-module-manager library
+
+**********************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <vector>
+
+///Hands out the plugins to validate, by index, to several workers, and takes
+///back those that a worker could not validate, so that another one does
+class MODULE_MANAGER_API PluginScanQueue final
+{
+   const size_t mPluginsCount;
+   size_t mNextPluginIndex{0};
+   std::vector<size_t> mGivenBack;
+   size_t mProcessedCount{0};
+
+public:
+   explicit PluginScanQueue(size_t pluginsCount);
+
+   ///Plugins given back are handed out again first
+   ///@return nullopt if no plugin is left to hand out
+   std::optional<size_t> Next();
+   ///Takes back a plugin handed out before, that wasn't validated
+   void GiveBack(size_t pluginIndex);
+   ///Counts a plugin handed out before as validated, successfully or not
+   void SetProcessed();
+
+   size_t GetPluginsCount() const noexcept;
+   size_t GetProcessedCount() const noexcept;
+   ///Whether every plugin has been validated
+   bool IsComplete() const noexcept;
+};
@@ -0,0 +1,57 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  PluginScanQueueTest.cpp
+
+**********************************************************************/
+#include "PluginScanQueue.h"
+
+#include <catch2/catch.hpp>
+
+TEST_CASE("PluginScanQueue")
+{
+   PluginScanQueue sut { 3 };
+
+   SECTION("Hands out every plugin once")
+   {
+      REQUIRE(sut.Next() == 0u);
+      REQUIRE(sut.Next() == 1u);
+      REQUIRE(sut.Next() == 2u);
+      REQUIRE(!sut.Next());
+   }
+
+   SECTION("A plugin given back by a failed worker is handed out again first")
+   {
+      const auto first = sut.Next();
+      sut.Next();
+      sut.GiveBack(*first);
+      REQUIRE(sut.Next() == first);
+      REQUIRE(sut.Next() == 2u);
+      REQUIRE(!sut.Next());
+   }
+
+   SECTION("Is complete once every plugin is processed, given back or not")
+   {
+      const auto first = sut.Next();
+      sut.Next();
+      sut.Next();
+      sut.GiveBack(*first);
+      sut.SetProcessed();
+      sut.SetProcessed();
+      REQUIRE(!sut.IsComplete());
+      REQUIRE(sut.GetProcessedCount() == 2);
+      REQUIRE(sut.Next() == first);
+      sut.SetProcessed();
+      REQUIRE(sut.IsComplete());
+      REQUIRE(sut.GetPluginsCount() == 3);
+   }
+
+   SECTION("An empty queue is complete")
+   {
+      PluginScanQueue empty { 0 };
+      REQUIRE(empty.IsComplete());
+      REQUIRE(!empty.Next());
+   }
+}
@@ -0,0 +1,73 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  MemoryMirAudioReader.cpp
+
+**********************************************************************/
+#include "MemoryMirAudioReader.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+namespace MIR
+{
+MemoryMirAudioReader::MemoryMirAudioReader(const MirAudioReader& source)
+    : mSampleRate { source.GetSampleRate() }
+    , mSamples(std::max(source.GetNumSamples(), 0ll))
+{
+   // In chunks, in case the source buffers what it reads.
+   constexpr long long chunkSize = 1 << 16;
+   const long long numSamples = mSamples.size();
+   for (long long start = 0; start < numSamples; start += chunkSize)
+      source.ReadFloats(
+         mSamples.data() + start, start,
+         std::min(chunkSize, numSamples - start));
+}
+
+double MemoryMirAudioReader::GetSampleRate() const
+{
+   return mSampleRate;
+}
+
+long long MemoryMirAudioReader::GetNumSamples() const
+{
+   return mSamples.size();
+}
+
+void MemoryMirAudioReader::ReadFloats(
+   float* buffer, long long where, size_t numFrames) const
+{
+   assert(where >= 0);
+   assert(where + numFrames <= mSamples.size());
+   std::copy(
+      mSamples.begin() + where, mSamples.begin() + where + numFrames, buffer);
+}
+
+uint64_t MemoryMirAudioReader::GetContentHash() const
+{
+   // 64-bit FNV-1a, taking 32-bit words rather than bytes.
+   constexpr uint64_t prime = 0x100000001b3;
+   uint64_t hash = 0xcbf29ce484222325;
+   const auto mix = [&](uint32_t word) {
+      hash ^= word;
+      hash *= prime;
+   };
+   uint64_t rate;
+   static_assert(sizeof(rate) == sizeof(mSampleRate));
+   std::memcpy(&rate, &mSampleRate, sizeof(rate));
+   mix(static_cast<uint32_t>(rate));
+   mix(static_cast<uint32_t>(rate >> 32));
+   mix(static_cast<uint32_t>(mSamples.size()));
+   for (const auto sample : mSamples)
+   {
+      uint32_t word;
+      static_assert(sizeof(word) == sizeof(sample));
+      std::memcpy(&word, &sample, sizeof(word));
+      mix(word);
+   }
+   return hash;
+}
+} // namespace MIR
@@ -0,0 +1,42 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  MemoryMirAudioReader.h
+
+**********************************************************************/
+#pragma once
+
+#include "MirTypes.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace MIR
+{
+/*!
+ * Holds all of the audio of another reader in memory, read once on
+ * construction. Worth it when the analysis reads the same samples several
+ * times, as does the STFT with its overlapping frames, and the source is
+ * costly to read from.
+ */
+class MUSIC_INFORMATION_RETRIEVAL_API MemoryMirAudioReader
+    : public MirAudioReader
+{
+public:
+   explicit MemoryMirAudioReader(const MirAudioReader& source);
+
+   double GetSampleRate() const override;
+   long long GetNumSamples() const override;
+   void
+   ReadFloats(float* buffer, long long where, size_t numFrames) const override;
+
+   //! A hash of the sample rate and the samples, to recognize identical audio.
+   uint64_t GetContentHash() const;
+
+private:
+   const double mSampleRate;
+   std::vector<float> mSamples;
+};
+} // namespace MIR
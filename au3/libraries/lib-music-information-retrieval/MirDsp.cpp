@@ -16,8 +16,11 @@
 #include "MirUtils.h"
 #include "PowerSpectrumGetter.h"
 #include "StftFrameProvider.h"
+#include "concurrency/TaskGraph.h"
+#include <algorithm>
 #include <cassert>
 #include <cmath>
+#include <memory>
 #include <numeric>
 #include <pffft.h>
 
@@ -25,12 +28,15 @@ namespace MIR
 {
 namespace
 {
+// Frames whose power spectra are computed together, on the thread pool
+constexpr auto batchSize = 128;
+
 float GetNoveltyMeasure(
-   const PffftFloatVector& prevPowSpec, const PffftFloatVector& powSpec)
+   const float* prevPowSpec, const float* powSpec, int powSpecSize)
 {
    auto k = 0;
    return std::accumulate(
-      powSpec.begin(), powSpec.end(), 0.f, [&](float a, float mag) {
+      powSpec, powSpec + powSpecSize, 0.f, [&](float a, float mag) {
          // Half-wave-rectified stuff
          return a + std::max(0.f, mag - prevPowSpec[k++]);
       });
@@ -112,49 +118,85 @@ std::vector<float> GetOnsetDetectionFunction(
    QuantizationFitDebugOutput* debugOutput)
 {
    StftFrameProvider frameProvider { audio };
-   const auto sampleRate = frameProvider.GetSampleRate();
    const auto numFrames = frameProvider.GetNumFrames();
    const auto frameSize = frameProvider.GetFftSize();
-   PffftFloatVector buffer(frameSize);
+   const auto frameStride = frameProvider.GetFrameStride();
    std::vector<float> odf;
    odf.reserve(numFrames);
    const auto powSpecSize = frameSize / 2 + 1;
-   PffftFloatVector powSpec(powSpecSize);
-   PffftFloatVector prevPowSpec(powSpecSize);
+   const PffftAlignedCount powSpecStride { static_cast<size_t>(powSpecSize) };
+   PffftFloatVector frames;
+   PffftFloatVector powSpecs(powSpecStride * static_cast<size_t>(batchSize));
+   PffftFloatVector prevPowSpec(powSpecSize, 0.f);
    PffftFloatVector firstPowSpec;
-   std::fill(prevPowSpec.begin(), prevPowSpec.end(), 0.f);
 
-   PowerSpectrumGetter getPowerSpectrum { frameSize };
+   // Frames are read here, for the reader may not be thread-safe, and
+   // transformed on the pool, a part of each batch per worker.
+   using namespace audacity::concurrency;
+   auto& pool = ThreadPool::Get();
+   const auto numParts = std::min<size_t>(pool.GetNumThreads(), batchSize);
+   std::vector<std::unique_ptr<PowerSpectrumGetter>> getters;
+   for (size_t i = 0; i < numParts; ++i)
+      getters.push_back(std::make_unique<PowerSpectrumGetter>(frameSize));
 
    auto frameCounter = 0;
-   while (frameProvider.GetNextFrame(buffer))
+   while (const auto numBatchFrames =
+             frameProvider.GetNextFrames(frames, batchSize))
    {
-      getPowerSpectrum(buffer.aligned(), powSpec.aligned());
-
-      // Compress the frame as per section (6.5) in Müller, Meinard.
-      // Fundamentals of music processing: Audio, analysis, algorithms,
-      // applications. Vol. 5. Cham: Springer, 2015.
-      constexpr auto gamma = 100.f;
-      std::transform(
-         powSpec.begin(), powSpec.end(), powSpec.begin(),
-         [gamma](float x) { return FastLog2(1 + gamma * std::sqrt(x)); });
-
-      if (firstPowSpec.empty())
-         firstPowSpec = powSpec;
-      else
-         odf.push_back(GetNoveltyMeasure(prevPowSpec, powSpec));
-
-      if (debugOutput)
-         debugOutput->postProcessedStft.push_back(powSpec);
-
-      std::swap(prevPowSpec, powSpec);
-
+      const auto batchLength = static_cast<size_t>(numBatchFrames);
+      const auto partSize = (batchLength + numParts - 1) / numParts;
+      TaskGraph graph { pool };
+      for (size_t part = 0; part * partSize < batchLength; ++part)
+         graph.Add([&, part] {
+            auto& getPowerSpectrum = *getters[part];
+            const auto end = std::min((part + 1) * partSize, batchLength);
+            for (auto i = part * partSize; i < end; ++i)
+            {
+               const auto powSpec = powSpecs.aligned(powSpecStride, i);
+               getPowerSpectrum(frames.aligned(frameStride, i), powSpec);
+
+               // Compress the frame as per section (6.5) in Müller, Meinard.
+               // Fundamentals of music processing: Audio, analysis,
+               // algorithms, applications. Vol. 5. Cham: Springer, 2015.
+               constexpr auto gamma = 100.f;
+               std::transform(
+                  powSpec.get(), powSpec.get() + powSpecSize, powSpec.get(),
+                  [gamma](float x) {
+                     return FastLog2(1 + gamma * std::sqrt(x));
+                  });
+            }
+         });
+      graph.Start();
+      graph.Wait();
+
+      const float* prev = prevPowSpec.data();
+      for (size_t i = 0; i < batchLength; ++i)
+      {
+         const float* powSpec = powSpecs.aligned(powSpecStride, i).get();
+         if (firstPowSpec.empty())
+            firstPowSpec.assign(powSpec, powSpec + powSpecSize);
+         else
+            odf.push_back(GetNoveltyMeasure(prev, powSpec, powSpecSize));
+
+         if (debugOutput)
+            debugOutput->postProcessedStft.emplace_back(
+               powSpec, powSpec + powSpecSize);
+
+         prev = powSpec;
+      }
+      std::copy(prev, prev + powSpecSize, prevPowSpec.begin());
+
+      frameCounter += numBatchFrames;
       if (progressCallback)
-         progressCallback(1. * ++frameCounter / numFrames);
+         progressCallback(1. * frameCounter / numFrames);
    }
 
    // Close the loop.
-   odf.push_back(GetNoveltyMeasure(prevPowSpec, firstPowSpec));
+   odf.push_back(
+      firstPowSpec.empty() ?
+         0.f :
+         GetNoveltyMeasure(
+            prevPowSpec.data(), firstPowSpec.data(), powSpecSize));
    assert(IsPowOfTwo(odf.size()));
 
    const auto movingAverage =
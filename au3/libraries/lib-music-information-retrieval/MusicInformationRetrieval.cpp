@@ -11,16 +11,21 @@
 #include "MusicInformationRetrieval.h"
 #include "DecimatingMirAudioReader.h"
 #include "GetMeterUsingTatumQuantizationFit.h"
+#include "MemoryMirAudioReader.h"
 #include "MirProjectInterface.h"
 #include "MirTypes.h"
 #include "MirUtils.h"
 #include "StftFrameProvider.h"
 
 #include "MemoryX.h"
+#include "concurrency/ThreadPool.h"
 
+#include <algorithm>
 #include <array>
+#include <atomic>
 #include <cassert>
 #include <cmath>
+#include <mutex>
 #include <numeric>
 #include <regex>
 
@@ -43,6 +48,53 @@ auto RemovePathPrefix(const std::string& filename)
 // has 1.5 quarter notes per beat.
 constexpr std::array<double, numTimeSignatures> quarternotesPerBeat { 2., 1.,
                                                                       1., 1.5 };
+
+// Results of the signal analyses done in this session, by audio content, so
+// that importing the same audio again costs no analysis.
+class MeterCache
+{
+public:
+   using Key = std::pair<uint64_t, FalsePositiveTolerance>;
+
+   //! Outer optional empty if not found
+   std::optional<std::optional<MusicalMeter>> Find(const Key& key) const
+   {
+      std::lock_guard<std::mutex> lock { mMutex };
+      const auto it = mMeters.find(key);
+      if (it == mMeters.end())
+         return std::nullopt;
+      return it->second;
+   }
+
+   void Insert(const Key& key, const std::optional<MusicalMeter>& meter)
+   {
+      std::lock_guard<std::mutex> lock { mMutex };
+      mMeters.emplace(key, meter);
+   }
+
+private:
+   struct KeyHash
+   {
+      size_t operator()(const Key& key) const
+      {
+         return key.first ^ static_cast<size_t>(key.second);
+      }
+   };
+
+   mutable std::mutex mMutex;
+   std::unordered_map<Key, std::optional<MusicalMeter>, KeyHash> mMeters;
+};
+
+MeterCache& GetMeterCache()
+{
+   static MeterCache cache;
+   return cache;
+}
+
+// Thrown through the analysis to abandon it.
+struct AnalysisCancelled
+{
+};
 } // namespace
 
 std::optional<ProjectSyncInfo>
@@ -141,9 +193,72 @@ std::optional<MusicalMeter> GetMusicalMeterFromSignal(
       // A file longer than 1 minute is most likely not a loop, and processing
       // it would be costly.
       return {};
-   DecimatingMirAudioReader decimatedAudio { audio };
-   return GetMeterUsingTatumQuantizationFit(
+   // Read and decimate the audio once: the overlapping STFT frames would
+   // otherwise read every sample several times from the source.
+   const MemoryMirAudioReader decimatedAudio { DecimatingMirAudioReader {
+      audio } };
+
+   // Debug output can only come from an actual analysis.
+   const MeterCache::Key key { decimatedAudio.GetContentHash(), tolerance };
+   if (!debugOutput)
+      if (const auto cached = GetMeterCache().Find(key))
+      {
+         if (progressCallback)
+            progressCallback(1.);
+         return *cached;
+      }
+
+   const auto meter = GetMeterUsingTatumQuantizationFit(
       decimatedAudio, tolerance, progressCallback, debugOutput);
+   GetMeterCache().Insert(key, meter);
+   return meter;
+}
+
+std::vector<std::optional<ProjectSyncInfo>> GetProjectSyncInfos(
+   const std::vector<ProjectSyncInfoInput>& inputs,
+   const std::function<void(double)>& reportProgress)
+{
+   const auto numInputs = inputs.size();
+   std::vector<std::optional<ProjectSyncInfo>> results(numInputs);
+   if (numInputs == 0)
+      return results;
+
+   // Workers report their progress here, and the calling thread forwards it.
+   const auto progresses = std::make_unique<std::atomic<double>[]>(numInputs);
+   for (size_t i = 0; i < numInputs; ++i)
+      progresses[i] = 0.;
+
+   const auto render = [&](size_t i, const std::atomic<bool>& cancelled) {
+      auto input = inputs[i];
+      input.progressCallback = [&, i](double progress) {
+         if (cancelled)
+            throw AnalysisCancelled {};
+         progresses[i] = progress;
+      };
+      try
+      {
+         if (const auto info = GetProjectSyncInfo(input))
+            results[i].emplace(*info);
+      }
+      catch (const AnalysisCancelled&)
+      {
+         return;
+      }
+      progresses[i] = 1.;
+   };
+
+   const auto report = [&] {
+      if (!reportProgress)
+         return true;
+      auto sum = 0.;
+      for (size_t i = 0; i < numInputs; ++i)
+         sum += progresses[i];
+      reportProgress(sum / numInputs);
+      return true;
+   };
+   audacity::concurrency::RenderInParallel(numInputs, render, report);
+
+   return results;
 }
 
 void SynchronizeProject(
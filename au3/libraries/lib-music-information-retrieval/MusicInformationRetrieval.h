@@ -65,10 +65,27 @@ struct ProjectSyncInfoInput
 std::optional<ProjectSyncInfo> MUSIC_INFORMATION_RETRIEVAL_API
 GetProjectSyncInfo(const ProjectSyncInfoInput& input);
 
+/*!
+ * Does `GetProjectSyncInfo` for all `inputs`, several at a time on the shared
+ * thread pool. Each source is read by a single thread, but different sources may
+ * be read concurrently. The `progressCallback`s of the inputs are not called:
+ * `reportProgress` is instead, from the calling thread, with the overall
+ * progress. If it throws, the analyses are abandoned and the exception is
+ * rethrown once all workers have stopped.
+ */
+MUSIC_INFORMATION_RETRIEVAL_API std::vector<std::optional<ProjectSyncInfo>>
+GetProjectSyncInfos(
+   const std::vector<ProjectSyncInfoInput>& inputs,
+   const std::function<void(double)>& reportProgress);
+
 // Used internally by `MusicInformation`, made public for testing.
 MUSIC_INFORMATION_RETRIEVAL_API std::optional<double>
 GetBpmFromFilename(const std::string& filename);
 
+/*!
+ * Results are cached for the session by audio content, unless `debugOutput`
+ * is given.
+ */
 MUSIC_INFORMATION_RETRIEVAL_API std::optional<MusicalMeter>
 GetMusicalMeterFromSignal(
    const MirAudioReader& source, FalsePositiveTolerance tolerance,
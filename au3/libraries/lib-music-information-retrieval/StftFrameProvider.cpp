@@ -60,26 +60,49 @@ bool StftFrameProvider::GetNextFrame(PffftFloatVector& frame)
 {
    if (mNumFramesProvided >= mNumFrames)
       return false;
-   frame.resize(mFftSize, 0.f);
+   frame.resize(mFftSize);
+   ReadNextFrame(frame.data());
+   return true;
+}
+
+int StftFrameProvider::GetNextFrames(
+   PffftFloatVector& frames, int maxNumFrames)
+{
+   const auto numFrames =
+      std::max(0, std::min(maxNumFrames, mNumFrames - mNumFramesProvided));
+   const auto stride = GetFrameStride();
+   frames.resize(stride * static_cast<size_t>(numFrames));
+   for (auto i = 0; i < numFrames; ++i)
+      ReadNextFrame(frames.aligned(stride, i).get());
+   return numFrames;
+}
+
+PffftAlignedCount StftFrameProvider::GetFrameStride() const
+{
+   return PffftAlignedCount { static_cast<size_t>(mFftSize) };
+}
+
+void StftFrameProvider::ReadNextFrame(float* frame)
+{
+   std::fill(frame, frame + mFftSize, 0.f);
    const int firstReadPosition = mHopSize - mFftSize;
    int start = std::round(firstReadPosition + mNumFramesProvided * mHopSize);
    while (start < 0)
       start += mNumSamples;
    const auto end = std::min<long long>(start + mFftSize, mNumSamples);
    const auto numToRead = end - start;
-   mAudio.ReadFloats(frame.data(), start, numToRead);
+   mAudio.ReadFloats(frame, start, numToRead);
    // It's not impossible that some user drops a file so short that `mFftSize >
    // mNumSamples`. In that case we won't be returning a meaningful
    // STFT, but that's a use case we're not interested in. We just need to make
    // sure we don't crash.
    const auto numRemaining = std::min(mFftSize - numToRead, mNumSamples);
    if (numRemaining > 0)
-      mAudio.ReadFloats(frame.data() + numToRead, 0, numRemaining);
+      mAudio.ReadFloats(frame + numToRead, 0, numRemaining);
    std::transform(
-      frame.begin(), frame.end(), mWindow.begin(), frame.begin(),
+      frame, frame + mFftSize, mWindow.begin(), frame,
       std::multiplies<float>());
    ++mNumFramesProvided;
-   return true;
 }
 
 int StftFrameProvider::GetNumFrames() const
@@ -30,12 +30,25 @@ class MUSIC_INFORMATION_RETRIEVAL_API StftFrameProvider
 public:
    StftFrameProvider(const MirAudioReader& source);
    bool GetNextFrame(PffftFloatVector& frame);
+
+   /*!
+    * Gets up to `maxNumFrames` next frames at once, as rows of `frames`,
+    * `GetFrameStride()` floats apart, so that each row is aligned for
+    * pffft.
+    * @return the number of frames gotten, 0 when there are no more
+    */
+   int GetNextFrames(PffftFloatVector& frames, int maxNumFrames);
+   PffftAlignedCount GetFrameStride() const;
+
    int GetNumFrames() const;
    int GetSampleRate() const;
    double GetFrameRate() const;
    int GetFftSize() const;
 
 private:
+   //! Reads and windows the next frame into `frame`, of `GetFftSize()` floats
+   void ReadNextFrame(float* frame);
+
    const MirAudioReader& mAudio;
    const int mFftSize;
    const double mHopSize;
@@ -173,6 +173,105 @@ TEST_CASE("GetProjectSyncInfo")
    }
 }
 
+namespace
+{
+// Short bursts of noise every `period` samples.
+class ClickTrackMirAudioReader : public MirAudioReader
+{
+public:
+   ClickTrackMirAudioReader(int period, unsigned seed)
+       : mPeriod { period }
+       , mSeed { seed }
+   {
+   }
+
+   double GetSampleRate() const override
+   {
+      return 44100;
+   }
+   long long GetNumSamples() const override
+   {
+      return 8 * 44100;
+   }
+   void
+   ReadFloats(float* buffer, long long where, size_t numFrames) const override
+   {
+      for (size_t i = 0; i < numFrames; ++i)
+      {
+         const auto n = where + i;
+         auto x = static_cast<uint32_t>(n * 2654435761u) ^ mSeed;
+         x ^= x >> 15;
+         buffer[i] =
+            n % mPeriod < 500 ? (x & 0xffff) / 32768.f - 1.f : 0.f;
+      }
+   }
+
+private:
+   const int mPeriod;
+   const unsigned mSeed;
+};
+
+bool Equal(const ProjectSyncInfo& a, const ProjectSyncInfo& b)
+{
+   return a.rawAudioTempo == b.rawAudioTempo && a.usedMethod == b.usedMethod &&
+          a.timeSignature == b.timeSignature &&
+          a.stretchMinimizingPowOfTwo == b.stretchMinimizingPowOfTwo &&
+          a.excessDurationInQuarternotes == b.excessDurationInQuarternotes;
+}
+} // namespace
+
+TEST_CASE("GetProjectSyncInfos")
+{
+   const ClickTrackMirAudioReader fast { 22050, 1 };
+   const ClickTrackMirAudioReader slow { 33075, 2 };
+   const ClickTrackMirAudioReader fastAgain { 22050, 1 };
+   std::vector<ProjectSyncInfoInput> inputs;
+   for (const auto& source : { &fast, &slow, &fastAgain })
+   {
+      ProjectSyncInfoInput input { *source };
+      input.viewIsBeatsAndMeasures = true;
+      inputs.push_back(input);
+   }
+   auto withFilename = arbitaryInput;
+   withFilename.filename = filename100bpm;
+   inputs.push_back(withFilename);
+   inputs.push_back(arbitaryInput);
+
+   SECTION("gives the same results as GetProjectSyncInfo")
+   {
+      auto lastProgress = 0.;
+      const auto results =
+         GetProjectSyncInfos(inputs, [&](double progress) {
+            REQUIRE(progress >= 0.);
+            REQUIRE(progress <= 1.);
+            lastProgress = progress;
+         });
+      REQUIRE(results.size() == inputs.size());
+      for (size_t i = 0; i < inputs.size(); ++i)
+      {
+         const auto expected = GetProjectSyncInfo(inputs[i]);
+         REQUIRE(results[i].has_value() == expected.has_value());
+         if (expected)
+            REQUIRE(Equal(*results[i], *expected));
+      }
+      // Same audio, same result, whether analyzed or found in the cache.
+      REQUIRE(results[0].has_value() == results[2].has_value());
+      if (results[0])
+         REQUIRE(Equal(*results[0], *results[2]));
+      REQUIRE(results[3]->rawAudioTempo == 100);
+      REQUIRE(!results[4].has_value());
+   }
+
+   SECTION("stops all workers when reporting progress throws")
+   {
+      struct Cancel
+      {
+      };
+      REQUIRE_THROWS_AS(
+         GetProjectSyncInfos(inputs, [](double) { throw Cancel {}; }), Cancel);
+   }
+}
+
 TEST_CASE("SynchronizeProject")
 {
    constexpr auto initialProjectTempo = 100.;
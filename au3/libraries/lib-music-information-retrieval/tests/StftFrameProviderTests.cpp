@@ -14,6 +14,8 @@
 
 #include <catch2/catch.hpp>
 
+#include <algorithm>
+
 namespace MIR
 {
 namespace
@@ -42,6 +44,26 @@ public:
       REQUIRE(where + numFrames <= numSamples);
    };
 };
+
+//! A second of a sawtooth, so that frames differ
+class RampMirAudioReader : public MirAudioReader
+{
+public:
+   double GetSampleRate() const override
+   {
+      return 44100;
+   }
+   long long GetNumSamples() const override
+   {
+      return 44100;
+   }
+   void
+   ReadFloats(float* buffer, long long where, size_t numFrames) const override
+   {
+      for (size_t i = 0; i < numFrames; ++i)
+         buffer[i] = (where + i) % 1000 / 1000.f;
+   }
+};
 } // namespace
 TEST_CASE("StftFrameProvider")
 {
@@ -62,6 +84,31 @@ TEST_CASE("StftFrameProvider")
       StftFrameProvider sut { TestMirAudioReader { 123456 } };
       REQUIRE(IsPowOfTwo(sut.GetNumFrames()));
    }
+   SECTION("gives the same frames in batches as one by one")
+   {
+      const RampMirAudioReader reader;
+      StftFrameProvider oneByOne { reader };
+      StftFrameProvider sut { reader };
+      const auto stride = sut.GetFrameStride();
+      PffftFloatVector frame;
+      PffftFloatVector frames;
+      // Not a divisor of the number of frames, for the last batch to be short
+      constexpr auto batchSize = 7;
+      auto numFrames = 0;
+      while (const auto numBatchFrames = sut.GetNextFrames(frames, batchSize))
+      {
+         REQUIRE(numBatchFrames <= batchSize);
+         for (auto i = 0; i < numBatchFrames; ++i)
+         {
+            REQUIRE(oneByOne.GetNextFrame(frame));
+            const auto row = frames.aligned(stride, i).get();
+            REQUIRE(std::equal(frame.begin(), frame.end(), row));
+         }
+         numFrames += numBatchFrames;
+      }
+      REQUIRE(numFrames == sut.GetNumFrames());
+      REQUIRE(!oneByOne.GetNextFrame(frame));
+   }
    SECTION("respects MirAudioReader boundaries")
    {
       TestMirAudioReader reader { 123456 };
@@ -1623,6 +1623,8 @@ bool NyquistBase::ProcessOne(
             static_cast<LabelTrack*>(pOutputs->AddToOutputTracks(newTrack));
       }
 
+      LabelArray labels;
+      labels.reserve(numLabels);
       for (l = 0; l < numLabels; l++)
       {
          double t0, t1;
@@ -1632,8 +1634,10 @@ bool NyquistBase::ProcessOne(
          // let Nyquist analyzers define more complicated selections
          nyx_get_label(l, &t0, &t1, &str);
 
-         ltrack->AddLabel(SelectedRegion(t0 + mT0, t1 + mT0), UTF8CTOWX(str));
+         labels.emplace_back(
+            SelectedRegion(t0 + mT0, t1 + mT0), UTF8CTOWX(str));
       }
+      ltrack->AddLabels(std::move(labels));
       return (GetType() != EffectTypeProcess || mIsPrompt);
    }
 
@@ -148,6 +148,8 @@ int DBConnection::Open(const FilePath fileName)
    mCheckpointStop = false;
    mCheckpointPending = false;
    mCheckpointActive = false;
+   mSampleBlocksUsage.Reset();
+   mSpectrogramTileBytes.reset();
    rc = OpenStepByStep( fileName );
    if ( rc != SQLITE_OK)
    {
@@ -694,6 +696,9 @@ bool DBConnectionTransactionScopeImpl::TransactionRollback(const wxString &name)
    if (rc != SQLITE_OK)
       return false;
 
+   // Rows inserted or deleted since the savepoint are not known here
+   mConnection.GetSampleBlocksUsage().Reset();
+
    // Rollback AND REMOVE the transaction
    // -- must do both; rolling back a savepoint only rewinds it
    // without removing it, unlike the ROLLBACK command
@@ -18,10 +18,12 @@ Paul Licameli -- split from ProjectFileIO.h
 #include <map>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <thread>
 
 #include "ClientData.h"
 #include "Identifier.h"
+#include "SampleBlocksUsage.h"
 
 struct sqlite3;
 struct sqlite3_stmt;
@@ -80,13 +82,26 @@ public:
       InsertSampleBlock,
       DeleteSampleBlock,
       GetSampleBlockSize,
-      GetAllSampleBlocksSize
+      GetAllSampleBlocksSize,
+      LoadAllSampleBlocks,
+      LoadSpectrogramTile,
+      SaveSpectrogramTile,
+      GetSpectrogramTileSizes,
+      DeleteSpectrogramTiles
    };
    sqlite3_stmt *Prepare(enum StatementID id, const char *sql);
 
    void SetBypass( bool bypass );
    bool ShouldBypass();
 
+   //! Totals of the main sampleblocks table, kept up to date by its writers
+   SampleBlocksUsage &GetSampleBlocksUsage() { return mSampleBlocksUsage; }
+
+   //! Bytes of the tiles SpectrogramTileDB keeps in this database, if it
+   //! set the database up for them
+   std::optional<unsigned long long> &GetSpectrogramTileBytes()
+   { return mSpectrogramTileBytes; }
+
    //! Just set stored errors
    void SetError(
       const TranslatableString &msg,
@@ -122,6 +137,9 @@ private:
    using StatementIndex = std::pair<enum StatementID, std::thread::id>;
    std::map<StatementIndex, sqlite3_stmt *> mStatements;
 
+   SampleBlocksUsage mSampleBlocksUsage;
+   std::optional<unsigned long long> mSpectrogramTileBytes;
+
    std::shared_ptr<DBConnectionErrors> mpErrors;
    CheckpointFailureCallback mCallback;
 
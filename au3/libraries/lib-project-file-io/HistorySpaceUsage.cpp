@@ -0,0 +1,234 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  HistorySpaceUsage.cpp
+
+**********************************************************************/
+#include "HistorySpaceUsage.h"
+
+#include "Project.h"
+#include "Track.h"
+#include "UndoManager.h"
+#include "UndoTracks.h"
+#include "WaveTrackUtilities.h"
+
+#include <algorithm>
+
+static const AudacityProject::AttachedObjects::RegisteredFactory
+sHistorySpaceUsageKey{
+   [](AudacityProject &project){
+      return std::make_shared<HistorySpaceUsage>(project);
+   }
+};
+
+namespace {
+// The UndoManager publishes pushes and modifications later, at idle time, but
+// captures the project state at once, by calling the savers.  This saver
+// restores nothing; it only learns of the change in time for queries.
+UndoRedoExtensionRegistry::Entry sEntry {
+   [](AudacityProject &project) -> std::shared_ptr<UndoStateExtension> {
+      HistorySpaceUsage::Get(project).Invalidate();
+      return nullptr;
+   }
+};
+}
+
+HistorySpaceUsage &HistorySpaceUsage::Get(AudacityProject &project)
+{
+   return project.AttachedObjects::Get<HistorySpaceUsage>(
+      sHistorySpaceUsageKey);
+}
+
+HistorySpaceUsage::HistorySpaceUsage(AudacityProject &project)
+   : mProject{ project }
+   , mUndoSubscription{
+      UndoManager::Get(project).Subscribe([this](UndoRedoMessage message){
+         switch (message.type) {
+         case UndoRedoMessage::EndPurge:
+            // Sent at once; the removed states may still be followed by a push
+            return Invalidate();
+         case UndoRedoMessage::Pushed:
+         case UndoRedoMessage::Modified:
+         case UndoRedoMessage::Purge:
+            if (mInvalid)
+               Update();
+            return;
+         default:
+            return;
+         }
+      }) }
+{
+}
+
+HistorySpaceUsage::~HistorySpaceUsage() = default;
+
+auto HistorySpaceUsage::GetStateUsages() -> std::vector<Type>
+{
+   if (mInvalid)
+      Update();
+   std::vector<Type> result;
+   result.reserve(mStates.size());
+   for (const auto &pState : mStates)
+      result.push_back(pState->usage);
+   return result;
+}
+
+auto HistorySpaceUsage::GetTotal() -> Type
+{
+   if (mInvalid)
+      Update();
+   return mTotal;
+}
+
+size_t HistorySpaceUsage::GetBlockCount()
+{
+   if (mInvalid)
+      Update();
+   return mBlocks.size();
+}
+
+auto HistorySpaceUsage::GetStateTotals(size_t state) -> StateTotals
+{
+   if (mInvalid)
+      Update();
+   const auto &recorded = *mStates.at(state);
+   return { recorded.blocks.size(), recorded.space };
+}
+
+void HistorySpaceUsage::Invalidate()
+{
+   mInvalid = true;
+}
+
+void HistorySpaceUsage::Update()
+{
+   mInvalid = false;
+
+   // Tracks of undo states are never modified, but replaced when the state
+   // is, so they identify the states
+   std::vector<std::shared_ptr<const TrackList>> lists;
+   UndoManager::Get(mProject).VisitStates(
+      [&](const UndoStackElem &elem) {
+         const auto pTracks = UndoTracks::Find(elem);
+         lists.push_back(pTracks ? pTracks->shared_from_this() : nullptr);
+      },
+      false // oldest state first
+   );
+
+   std::unordered_map<const TrackList*, size_t> recorded;
+   for (size_t i = 0; i < mStates.size(); ++i)
+      if (const auto pTracks = mStates[i]->tracks.lock())
+         recorded.emplace(pTracks.get(), i);
+
+   // The undo stack only removes, inserts and replaces states, so the states
+   // that remain are still in the same order
+   std::vector<std::unique_ptr<State>> states;
+   states.reserve(lists.size());
+   std::vector<std::unique_ptr<State>> removed;
+   std::vector<State*> added;
+   size_t next = 0;
+   for (const auto &pTracks : lists) {
+      const auto iter = pTracks ? recorded.find(pTracks.get()) : recorded.end();
+      if (iter != recorded.end() && iter->second >= next) {
+         for (; next < iter->second; ++next)
+            removed.push_back(std::move(mStates[next]));
+         states.push_back(std::move(mStates[next++]));
+      }
+      else {
+         auto &pState = states.emplace_back(std::make_unique<State>());
+         pState->tracks = pTracks;
+         added.push_back(pState.get());
+      }
+      states.back()->position = states.size() - 1;
+   }
+   for (; next < mStates.size(); ++next)
+      removed.push_back(std::move(mStates[next]));
+   mStates = std::move(states);
+
+   if (removed.empty() && added.empty())
+      return;
+
+   std::vector<SampleBlockID> orphans;
+   for (const auto &pState : removed)
+      RemoveState(*pState, orphans);
+   removed.clear();
+
+   for (const auto pState : added)
+      if (const auto pTracks = pState->tracks.lock())
+         AddState(*pState, *pTracks);
+
+   // Find the newest states that still use blocks whose newest state was
+   // removed, unless an added state already took them
+   for (const auto id : orphans) {
+      const auto iter = mBlocks.find(id);
+      if (iter == mBlocks.end())
+         continue;
+      auto &block = iter->second;
+      for (auto pos = mStates.size(); pos-- > 0;) {
+         auto &state = *mStates[pos];
+         if (block.newest && block.newest->position >= pos)
+            break;
+         if (std::binary_search(state.blocks.begin(), state.blocks.end(), id)) {
+            Attribute(block, state);
+            break;
+         }
+      }
+   }
+}
+
+void HistorySpaceUsage::AddState(State &state, const TrackList &tracks)
+{
+   using namespace WaveTrackUtilities;
+   SampleBlockIDSet seen;
+   InspectBlocks(tracks,
+      [&](SampleBlockConstPtr pBlock) {
+         const auto id = pBlock->GetBlockID();
+         // Silent blocks occupy no space
+         if (id <= 0)
+            return;
+         state.blocks.push_back(id);
+         auto [iter, inserted] = mBlocks.try_emplace(id);
+         auto &block = iter->second;
+         if (inserted) {
+            block.space = pBlock->GetSpaceUsage();
+            mTotal += block.space;
+         }
+         state.space += block.space;
+         ++block.useCount;
+         Attribute(block, state);
+      },
+      &seen
+   );
+   std::sort(state.blocks.begin(), state.blocks.end());
+}
+
+void HistorySpaceUsage::RemoveState(
+   const State &state, std::vector<SampleBlockID> &orphans)
+{
+   for (const auto id : state.blocks) {
+      const auto iter = mBlocks.find(id);
+      if (iter == mBlocks.end())
+         continue;
+      auto &block = iter->second;
+      if (--block.useCount == 0) {
+         mTotal -= block.space;
+         mBlocks.erase(iter);
+      }
+      else if (block.newest == &state) {
+         block.newest = nullptr;
+         orphans.push_back(id);
+      }
+   }
+}
+
+void HistorySpaceUsage::Attribute(Block &block, State &state)
+{
+   if (block.newest && block.newest->position >= state.position)
+      return;
+   if (block.newest)
+      block.newest->usage -= block.space;
+   block.newest = &state;
+   state.usage += block.space;
+}
@@ -0,0 +1,107 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  HistorySpaceUsage.h
+
+**********************************************************************/
+#pragma once
+
+#include "ClientData.h"
+#include "Observer.h"
+#include "SampleBlock.h"
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+class AudacityProject;
+class TrackList;
+
+//! Disk space used by the sample blocks of the undo history of a project
+/*!
+ A block may be used by several states, and more than once in one state.  It is
+ counted once only, in the newest state that uses it, because discarding the
+ history oldest first frees it only with that state.
+
+ The blocks of each state and the use counts of the blocks are recorded, and
+ brought up to date when the UndoManager pushes, modifies or removes states,
+ by comparing the recorded states with its own.  Only the states that changed
+ are inspected, and the space of each block is asked once.  Queries just read
+ the totals, unless they come after a change and before the UndoManager
+ publishes it.
+ */
+class PROJECT_FILE_IO_API HistorySpaceUsage final : public ClientData::Base
+{
+public:
+   using Type = unsigned long long;
+
+   static HistorySpaceUsage &Get(AudacityProject &project);
+
+   explicit HistorySpaceUsage(AudacityProject &project);
+   HistorySpaceUsage(const HistorySpaceUsage&) = delete;
+   HistorySpaceUsage &operator=(const HistorySpaceUsage&) = delete;
+   ~HistorySpaceUsage() override;
+
+   //! Space attributed to each undo state, oldest first
+   std::vector<Type> GetStateUsages();
+
+   //! Space of all distinct blocks of the history
+   Type GetTotal();
+
+   //! Number of distinct blocks of the history
+   size_t GetBlockCount();
+
+   struct StateTotals
+   {
+      size_t blockCount = 0;
+      Type space = 0;
+   };
+   //! Distinct blocks of one undo state and their space, whichever states
+   //! they are attributed to
+   /*!
+    @pre `state` is less than the number of states of the UndoManager
+    */
+   StateTotals GetStateTotals(size_t state);
+
+   //! Note that the undo history is changing, before the UndoManager publishes
+   //! the change
+   void Invalidate();
+
+private:
+   struct State
+   {
+      std::weak_ptr<const TrackList> tracks;
+      //! Sorted, without repetitions, without silent blocks
+      std::vector<SampleBlockID> blocks;
+      //! Space of `blocks`
+      Type space = 0;
+      //! Space of the blocks attributed to this state
+      Type usage = 0;
+      //! Index in the undo stack, as of the last update
+      size_t position = 0;
+   };
+
+   struct Block
+   {
+      Type space = 0;
+      //! Number of states using the block
+      size_t useCount = 0;
+      //! The newest of those states, or null while to be found again
+      State *newest = nullptr;
+   };
+
+   void Update();
+   void AddState(State &state, const TrackList &tracks);
+   void RemoveState(const State &state, std::vector<SampleBlockID> &orphans);
+   void Attribute(Block &block, State &state);
+
+   AudacityProject &mProject;
+   Observer::Subscription mUndoSubscription;
+   //! Whether the undo history may have changed since the last update
+   bool mInvalid = true;
+   std::vector<std::unique_ptr<State>> mStates;
+   std::unordered_map<SampleBlockID, Block> mBlocks;
+   Type mTotal = 0;
+};
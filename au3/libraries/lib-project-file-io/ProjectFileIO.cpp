@@ -24,6 +24,7 @@ Paul Licameli split from AudacityProject.cpp
 #include "CodeConversions.h"
 #include "DBConnection.h"
 #include "FileNames.h"
+#include "HistorySpaceUsage.h"
 #include "PendingTracks.h"
 #include "Project.h"
 #include "ProjectFileIOExtension.h"
@@ -31,8 +32,10 @@ Paul Licameli split from AudacityProject.cpp
 #include "ProjectSerializer.h"
 #include "FileNames.h"
 #include "SampleBlock.h"
+#include "SpectrogramTileDB.h"
 #include "TempDirectory.h"
 #include "TransactionScope.h"
+#include "UndoManager.h"
 #include "WaveTrack.h"
 #include "WaveTrackUtilities.h"
 #include "BasicUI.h"
@@ -297,7 +300,8 @@ public:
 
    BufferedProjectBlobStream(
       sqlite3* db, const char* schema, const char* table,
-      int64_t rowID)
+      int64_t rowID, const ProgressReporter& reportProgress = {},
+      int64_t totalBytes = 0)
        // Despite we use 64k pages in SQLite - it is impossible to guarantee
        // that read is satisfied from a single page.
        // Reading 64k proved to be slower, (64k - 8) gives no measurable difference
@@ -308,6 +312,8 @@ public:
        , mSchema(schema)
        , mTable(table)
        , mRowID(rowID)
+       , mReportProgress(reportProgress)
+       , mTotalBytes(totalBytes)
    {
    }
 
@@ -334,6 +340,10 @@ private:
    const char* mTable;
    const int64_t mRowID;
 
+   const ProgressReporter mReportProgress;
+   const int64_t mTotalBytes;
+   int64_t mBytesRead { 0 };
+
 protected:
    bool HasMoreData() const override
    {
@@ -366,6 +376,11 @@ protected:
          mBlobStream = {};
       }
 
+      mBytesRead += bytesRead;
+      if (mReportProgress && mTotalBytes > 0)
+         mReportProgress(
+            std::min(1.0, static_cast<double>(mBytesRead) / mTotalBytes));
+
       return static_cast<size_t>(bytesRead);
    }
 };
@@ -534,6 +549,7 @@ bool ProjectFileIO::OpenConnection(FilePath fileName /* = {}  */)
       curConn.reset();
       return false;
    }
+   SpectrogramTileDB::Setup(*curConn);
 
    mTemporary = isTemp;
 
@@ -635,6 +651,7 @@ void ProjectFileIO::UseConnection(Connection &&conn, const FilePath &filePath)
    wxASSERT(!curConn);
 
    curConn = std::move(conn);
+   SpectrogramTileDB::Setup(*curConn);
    SetFileName(filePath);
 }
 
@@ -908,6 +925,8 @@ bool ProjectFileIO::DeleteBlocks(const BlockIDs &blockids, bool complement)
    {
       wxLogInfo(XO("Total orphan blocks deleted %d").Translation(), changes);
       mRecovered = true;
+      // The sizes of the deleted rows are not known
+      GetConnection().GetSampleBlocksUsage().Reset();
    }
 
    return true;
@@ -1175,39 +1194,61 @@ bool ProjectFileIO::CopyTo(const FilePath &destpath,
    return true;
 }
 
-bool ProjectFileIO::ShouldCompact(const std::vector<const TrackList *> &tracks)
-{
-   WaveTrackUtilities::SampleBlockIDSet active;
-   unsigned long long current = 0;
+bool ProjectFileIO::ShouldCompact()
+{
+   // Get the number of blocks to keep and their total length, which the
+   // history keeps up to date as states are pushed and removed.  Those are
+   // the blocks of the last saved state, if it is still in the history.
+   auto &history = HistorySpaceUsage::Get(mProject);
+   const auto saved = UndoManager::Get(mProject).GetSavedState();
+   const auto known = saved >= 0;
+   const auto active = known
+      ? history.GetStateTotals(saved)
+      : HistorySpaceUsage::StateTotals{
+         history.GetBlockCount(), history.GetTotal() };
+   unsigned long long current = active.space;
+
+   // Get the number of blocks and total length from the project file.  The
+   // connection keeps them up to date, after at most one scan of the table.
+   auto &usage = GetConnection().GetSampleBlocksUsage();
+   auto totals = usage.Get();
+   if (!totals)
+   {
+      const auto generation = usage.GetGeneration();
+      SampleBlocksUsage::Totals scanned;
+      auto cb = [&scanned](int cols, char **vals, char **)
+      {
+         // Convert
+         wxString(vals[0]).ToULongLong(&scanned.count);
+         if (vals[1])
+            wxString(vals[1]).ToULongLong(&scanned.bytes);
+         return 0;
+      };
 
-   {
-      auto fn = BlockSpaceUsageAccumulator( current );
-      for (auto pTracks : tracks)
-         if (pTracks)
-            WaveTrackUtilities::InspectBlocks(*pTracks, fn,
-               &active // Visit unique blocks only
-            );
+      if (!Query(
+R"(SELECT
+	Count(*),
+	sum(length(blockid) + length(sampleformat) +
+	length(summin) + length(summax) + length(sumrms) +
+	length(summary256) + length(summary64k) +
+	length(samples))
+FROM sampleblocks;)", cb))
+      {
+         // Shouldn't compact since we don't have the full picture
+         return false;
+      }
+      usage.Seed(scanned, generation);
+      totals = scanned;
    }
 
-   // Get the number of blocks and total length from the project file.
-   unsigned long long total = GetTotalUsage();
-   unsigned long long blockcount = 0;
-
-   auto cb = [&blockcount](int cols, char **vals, char **)
-   {
-      // Convert
-      wxString(vals[0]).ToULongLong(&blockcount);
-      return 0;
-   };
-
-   if (!Query("SELECT Count(*) FROM sampleblocks;", cb) || blockcount == 0)
-   {
-      // Shouldn't compact since we don't have the full picture
+   const auto blockcount = totals->count;
+   const auto total = totals->bytes;
+   if (blockcount == 0)
       return false;
-   }
 
-   // Remember if we had unused blocks in the project file
-   mHadUnused = (blockcount > active.size());
+   // Remember if we had unused blocks in the project file.  Without the saved
+   // state, assume so, lest blocks of unsaved changes stay in the file.
+   mHadUnused = !known || (blockcount > active.blockCount);
 
    // Let's make a percentage...should be plenty of head room
    current *= 100;
@@ -1420,7 +1461,7 @@ void ProjectFileIO::Compact(
    {
       // Don't compact if this is a temporary project or if it's determined there are not
       // enough unused blocks to make it worthwhile.
-      if (IsTemporary() || !ShouldCompact(tracks))
+      if (IsTemporary() || !ShouldCompact())
       {
          // Delete the AutoSave doc it if exists
          if (IsModified())
@@ -2024,10 +2065,19 @@ void ProjectFileIO::TentativeConnection::Commit()
    }
 }
 
-auto ProjectFileIO::LoadProject(const FilePath &fileName, bool ignoreAutosave)
+auto ProjectFileIO::LoadProject(const FilePath &fileName, bool ignoreAutosave,
+   const ProgressReporter &reportProgress)
    -> std::optional<TentativeConnection>
 {
-   auto now = std::chrono::high_resolution_clock::now();
+   using namespace std::chrono;
+   auto now = high_resolution_clock::now();
+   auto phaseStart = now;
+   const auto phaseMs = [&phaseStart]{
+      const auto end = high_resolution_clock::now();
+      const auto ms = duration_cast<milliseconds>(end - phaseStart).count();
+      phaseStart = end;
+      return static_cast<long long>(ms);
+   };
 
    std::optional<TentativeConnection> result{ *this };
 
@@ -2062,11 +2112,35 @@ auto ProjectFileIO::LoadProject(const FilePath &fileName, bool ignoreAutosave)
       return {};
    else
    {
+      const char *table = useAutosave ? "autosave" : "project";
+
+      // The size of the document, so that progress can be reported as it
+      // is read; without it, the load goes on silently
+      int64_t totalBytes = 0;
+      if (reportProgress)
+      {
+         const auto sql = wxString::Format(
+            "SELECT length(dict) + length(doc) FROM main.%s WHERE ROWID = %lld;",
+            table, static_cast<long long>(rowId));
+         if (!GetValue(sql.ToUTF8().data(), totalBytes, true))
+            totalBytes = 0;
+      }
+
+      wxLogInfo("Project opened in %lld ms", phaseMs());
+
       // Load 'er up
       BufferedProjectBlobStream stream(
-         DB(), "main", useAutosave ? "autosave" : "project", rowId);
+         DB(), "main", table, rowId, reportProgress, totalBytes);
 
-      success = ProjectSerializer::Decode(stream, this);
+      // Let the sample block factory read the metadata of all blocks at once
+      // while the document is decoded, rather than one query per block
+      const auto pSampleBlockFactory =
+         WaveTrackFactory::Get( mProject ).GetSampleBlockFactory();
+      pSampleBlockFactory->BeginBulkLoad();
+      {
+         auto cleanup = finally([&]{ pSampleBlockFactory->EndBulkLoad(); });
+         success = ProjectSerializer::Decode(stream, this);
+      }
 
       if (!success)
       {
@@ -2076,17 +2150,21 @@ auto ProjectFileIO::LoadProject(const FilePath &fileName, bool ignoreAutosave)
          return {};
       }
 
+      wxLogInfo(
+         "Project document of %lld bytes decoded in %lld ms",
+         static_cast<long long>(totalBytes), phaseMs());
+
       // Check for orphans blocks...sets mRecovered if any were deleted
       
-      auto blockids = WaveTrackFactory::Get( mProject )
-         .GetSampleBlockFactory()
-            ->GetActiveBlockIDs();
+      auto blockids = pSampleBlockFactory->GetActiveBlockIDs();
       if (blockids.size() > 0)
       {
          success = DeleteBlocks(blockids, true);
          if (!success)
             return {};
       }
+
+      wxLogInfo("Orphan blocks checked in %lld ms", phaseMs());
    
       // Remember if we used autosave or not
       if (useAutosave)
@@ -2113,11 +2191,11 @@ auto ProjectFileIO::LoadProject(const FilePath &fileName, bool ignoreAutosave)
 
    result->SetFileName(fileName);
 
-   auto duration = std::chrono::high_resolution_clock::now() - now;
+   auto duration = high_resolution_clock::now() - now;
 
    wxLogInfo(
       "Project loaded in %lld ms",
-      std::chrono::duration_cast<std::chrono::milliseconds>(duration).count());
+      static_cast<long long>(duration_cast<milliseconds>(duration).count()));
 
    return result;
 }
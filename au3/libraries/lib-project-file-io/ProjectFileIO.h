@@ -11,6 +11,7 @@ Paul Licameli split from AudacityProject.h
 #ifndef __AUDACITY_PROJECT_FILE_IO__
 #define __AUDACITY_PROJECT_FILE_IO__
 
+#include <functional>
 #include <memory>
 #include <optional>
 #include <unordered_set>
@@ -38,6 +39,7 @@ class WaveTrack;
 namespace BasicUI{ class WindowPlacement; }
 
 using WaveTrackArray = std::vector < std::shared_ptr < WaveTrack > >;
+using ProgressReporter = std::function<void(double)>;
 
 // From SampleBlock.h
 using SampleBlockID = long long;
@@ -119,8 +121,13 @@ public:
 
    //! If successful, return non-empty; the caller must commit to keep the
    //! association of the opened file with the project
+   /*!
+    @param reportProgress if not empty, is called with the fraction of the
+    project document decoded so far; it may throw to cancel the load
+    */
    std::optional<TentativeConnection>
-      LoadProject(const FilePath &fileName, bool ignoreAutosave);
+      LoadProject(const FilePath &fileName, bool ignoreAutosave,
+         const ProgressReporter &reportProgress = {});
 
    bool UpdateSaved(const TrackList *tracks = nullptr);
    bool SaveProject(const FilePath &fileName, const TrackList *lastSaved);
@@ -299,7 +306,7 @@ private:
        const TranslatableString& libraryError = {},
        int errorCode = -1);
 
-   bool ShouldCompact(const std::vector<const TrackList *> &tracks);
+   bool ShouldCompact();
 
 private:
    Connection &CurrConn();
@@ -0,0 +1,65 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  SampleBlocksUsage.cpp
+
+**********************************************************************/
+#include "SampleBlocksUsage.h"
+
+#include <cassert>
+
+auto SampleBlocksUsage::Get() const -> std::optional<Totals>
+{
+   std::lock_guard<std::mutex> lock{ mMutex };
+   return mTotals;
+}
+
+auto SampleBlocksUsage::GetGeneration() const -> Generation
+{
+   std::lock_guard<std::mutex> lock{ mMutex };
+   return mGeneration;
+}
+
+bool SampleBlocksUsage::Seed(const Totals &totals, Generation generation)
+{
+   std::lock_guard<std::mutex> lock{ mMutex };
+   if (generation != mGeneration)
+      return false;
+   mTotals = totals;
+   return true;
+}
+
+void SampleBlocksUsage::Inserted(Type bytes)
+{
+   std::lock_guard<std::mutex> lock{ mMutex };
+   ++mGeneration;
+   if (mTotals) {
+      ++mTotals->count;
+      mTotals->bytes += bytes;
+   }
+}
+
+void SampleBlocksUsage::Deleted(Type bytes)
+{
+   std::lock_guard<std::mutex> lock{ mMutex };
+   ++mGeneration;
+   if (mTotals) {
+      assert(mTotals->count > 0 && mTotals->bytes >= bytes);
+      if (mTotals->count == 0 || mTotals->bytes < bytes)
+         // Should not happen, but don't wrap around
+         mTotals.reset();
+      else {
+         --mTotals->count;
+         mTotals->bytes -= bytes;
+      }
+   }
+}
+
+void SampleBlocksUsage::Reset()
+{
+   std::lock_guard<std::mutex> lock{ mMutex };
+   ++mGeneration;
+   mTotals.reset();
+}
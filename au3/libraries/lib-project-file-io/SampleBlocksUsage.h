@@ -0,0 +1,60 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  SampleBlocksUsage.h
+
+**********************************************************************/
+#pragma once
+
+#include <mutex>
+#include <optional>
+
+//! Running count and size of the rows of the sampleblocks table of a database
+/*!
+ The totals are unknown until one scan of the table gives them.  Then each
+ row inserted or deleted updates them, so that they need no other scan.
+ Changes whose sizes are not known, like deletion of many rows at once or
+ rollback of a transaction, make the totals unknown again.
+
+ Rows may be inserted from worker threads, so all methods lock.
+ */
+class PROJECT_FILE_IO_API SampleBlocksUsage final
+{
+public:
+   using Type = unsigned long long;
+
+   struct Totals
+   {
+      Type count = 0;
+      //! Bytes, as ProjectFileIO::GetDiskUsage() counts them
+      Type bytes = 0;
+   };
+
+   //! Identifies the state of the table, as of the last change counted
+   using Generation = unsigned long long;
+
+   std::optional<Totals> Get() const;
+
+   Generation GetGeneration() const;
+
+   //! Take the totals of a scan of the table
+   /*!
+    @param generation as of the start of the scan
+    @return whether the totals were taken: not if any change was counted
+    after `generation`
+    */
+   bool Seed(const Totals &totals, Generation generation);
+
+   void Inserted(Type bytes);
+   void Deleted(Type bytes);
+
+   //! Forget the totals after changes that cannot be counted
+   void Reset();
+
+private:
+   mutable std::mutex mMutex;
+   std::optional<Totals> mTotals;
+   Generation mGeneration = 0;
+};
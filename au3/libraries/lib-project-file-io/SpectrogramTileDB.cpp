@@ -0,0 +1,228 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  SpectrogramTileDB.cpp
+
+**********************************************************************/
+#include "SpectrogramTileDB.h"
+
+#include "DBConnection.h"
+#include "MemoryX.h"
+#include "Project.h"
+#include "Sequence.h"
+#include "WaveClip.h"
+
+#include <sqlite3.h>
+#include <wx/log.h>
+
+#include <algorithm>
+#include <cstring>
+
+BoolSetting SpectrogramTileDB::Enabled{ L"/Spectrum/StoreTiles", false };
+
+static const AudacityProject::AttachedObjects::RegisteredFactory
+sSpectrogramTileDBKey{
+   [](AudacityProject &project){
+      return std::make_shared<SpectrogramTileDB>(project);
+   }
+};
+
+SpectrogramTileDB &SpectrogramTileDB::Get(AudacityProject &project)
+{
+   return project.AttachedObjects::Get<SpectrogramTileDB>(
+      sSpectrogramTileDBKey);
+}
+
+SpectrogramTileCache::Store SpectrogramTileDB::MakeStore(
+   AudacityProject *pProject, const WaveClipChannel &clip)
+{
+   const auto &blocks = clip.GetSequence().GetBlockArray();
+   if (!pProject || blocks.empty())
+      return {};
+   // The tiles go from the file with the first block of the clip
+   const auto blockId = blocks.front().sb->GetBlockID();
+   const auto wProject = pProject->weak_from_this();
+   return {
+      [wProject](const std::string &key, std::vector<float> &data) {
+         const auto pProject = wProject.lock();
+         return pProject && Get(*pProject).Load(key, data);
+      },
+      [wProject, blockId](
+         const std::string &key, const std::vector<float> &data) {
+         if (const auto pProject = wProject.lock())
+            Get(*pProject).Save(key, blockId, data);
+      }
+   };
+}
+
+SpectrogramTileDB::SpectrogramTileDB(AudacityProject &project)
+   : mProject{ project }
+{
+}
+
+SpectrogramTileDB::~SpectrogramTileDB() = default;
+
+void SpectrogramTileDB::Setup(DBConnection &connection)
+{
+   auto &bytes = connection.GetSpectrogramTileBytes();
+   bytes.reset();
+   const auto db = connection.DB();
+
+   char *errmsg = nullptr;
+   auto cleanup = finally([&errmsg]{ sqlite3_free(errmsg); });
+   if (!Enabled.Read())
+   {
+      // Give the space back, if the tiles were kept before
+      if (sqlite3_exec(db, "DROP TABLE IF EXISTS spectrogramtiles;",
+         nullptr, nullptr, &errmsg) != SQLITE_OK)
+         wxLogDebug(wxT("SpectrogramTileDB - SQLITE error %s"), errmsg);
+      return;
+   }
+
+   auto rc = sqlite3_exec(db,
+      "CREATE TABLE IF NOT EXISTS spectrogramtiles"
+      "("
+      "  key                 TEXT PRIMARY KEY,"
+      "  blockid             INTEGER,"
+      "  data                BLOB"
+      ");"
+      "DELETE FROM spectrogramtiles"
+      "  WHERE blockid NOT IN (SELECT blockid FROM sampleblocks);",
+      nullptr, nullptr, &errmsg);
+   if (rc != SQLITE_OK)
+   {
+      // Perhaps a read-only file; keep no tiles then
+      wxLogDebug(wxT("SpectrogramTileDB - SQLITE error %s"), errmsg);
+      return;
+   }
+
+   sqlite3_stmt *stmt = nullptr;
+   if (sqlite3_prepare_v2(db,
+      "SELECT total(length(data)) FROM spectrogramtiles;", -1, &stmt, nullptr)
+       != SQLITE_OK)
+      return;
+   auto finalize = finally([stmt]{ sqlite3_finalize(stmt); });
+   if (sqlite3_step(stmt) == SQLITE_ROW)
+      bytes = sqlite3_column_int64(stmt, 0);
+}
+
+DBConnection *SpectrogramTileDB::GetConnection()
+{
+   const auto pConnection = ConnectionPtr::Get(mProject).mpConnection.get();
+   if (!pConnection || !pConnection->GetSpectrogramTileBytes())
+      return nullptr;
+   return pConnection;
+}
+
+bool SpectrogramTileDB::Load(
+   const std::string &key, std::vector<float> &data)
+{
+   const auto pConnection = GetConnection();
+   if (!pConnection)
+      return false;
+
+   // Prepare and cache statement...automatically finalized at DB close
+   sqlite3_stmt *stmt = pConnection->Prepare(
+      DBConnection::LoadSpectrogramTile,
+      "SELECT data FROM spectrogramtiles WHERE key = ?1;");
+   auto cleanup = finally([stmt]
+   {
+      sqlite3_clear_bindings(stmt);
+      sqlite3_reset(stmt);
+   });
+
+   if (sqlite3_bind_text(stmt, 1, key.c_str(), -1, SQLITE_STATIC))
+      return false;
+   if (sqlite3_step(stmt) != SQLITE_ROW)
+      return false;
+
+   const auto bytes = static_cast<size_t>(sqlite3_column_bytes(stmt, 0));
+   data.resize(bytes / sizeof(float));
+   if (!data.empty())
+      std::memcpy(data.data(), sqlite3_column_blob(stmt, 0),
+         data.size() * sizeof(float));
+   return true;
+}
+
+void SpectrogramTileDB::Save(
+   const std::string &key, long long blockId, const std::vector<float> &data)
+{
+   const auto pConnection = GetConnection();
+   if (!pConnection)
+      return;
+   auto &connection = *pConnection;
+
+   {
+      // Prepare and cache statement...automatically finalized at DB close
+      sqlite3_stmt *stmt = connection.Prepare(
+         DBConnection::SaveSpectrogramTile,
+         "INSERT OR IGNORE INTO spectrogramtiles (key, blockid, data)"
+         "  VALUES(?1,?2,?3);");
+      auto cleanup = finally([stmt]
+      {
+         sqlite3_clear_bindings(stmt);
+         sqlite3_reset(stmt);
+      });
+
+      const auto size = data.size() * sizeof(float);
+      if (sqlite3_bind_text(stmt, 1, key.c_str(), -1, SQLITE_STATIC) ||
+          sqlite3_bind_int64(stmt, 2, blockId) ||
+          sqlite3_bind_blob(stmt, 3, data.data(), static_cast<int>(size),
+             SQLITE_STATIC))
+         return;
+      if (sqlite3_step(stmt) != SQLITE_DONE)
+      {
+         wxLogDebug(wxT("SpectrogramTileDB::Save - SQLITE error %s"),
+            sqlite3_errmsg(connection.DB()));
+         return;
+      }
+      if (sqlite3_changes(connection.DB()) > 0)
+         *connection.GetSpectrogramTileBytes() += size;
+   }
+
+   if (*connection.GetSpectrogramTileBytes() > MaxBytes)
+      Evict(connection);
+}
+
+void SpectrogramTileDB::Evict(DBConnection &connection)
+{
+   auto &bytes = *connection.GetSpectrogramTileBytes();
+   // Down to three quarters of the bound, so that not every save evicts
+   const auto target = MaxBytes / 4 * 3;
+
+   // The oldest rows come first, because a key is never replaced
+   sqlite3_int64 lastRowId = 0;
+   auto freed = 0ull;
+   {
+      sqlite3_stmt *stmt = connection.Prepare(
+         DBConnection::GetSpectrogramTileSizes,
+         "SELECT rowid, length(data) FROM spectrogramtiles ORDER BY rowid;");
+      auto cleanup = finally([stmt]{ sqlite3_reset(stmt); });
+      while (freed + target < bytes && sqlite3_step(stmt) == SQLITE_ROW)
+      {
+         lastRowId = sqlite3_column_int64(stmt, 0);
+         freed += sqlite3_column_int64(stmt, 1);
+      }
+   }
+   if (freed == 0)
+      return;
+
+   sqlite3_stmt *stmt = connection.Prepare(
+      DBConnection::DeleteSpectrogramTiles,
+      "DELETE FROM spectrogramtiles WHERE rowid <= ?1;");
+   auto cleanup = finally([stmt]
+   {
+      sqlite3_clear_bindings(stmt);
+      sqlite3_reset(stmt);
+   });
+   if (sqlite3_bind_int64(stmt, 1, lastRowId) ||
+       sqlite3_step(stmt) != SQLITE_DONE)
+   {
+      wxLogDebug(wxT("SpectrogramTileDB::Evict - SQLITE error %s"),
+         sqlite3_errmsg(connection.DB()));
+      return;
+   }
+   bytes -= std::min(freed, bytes);
+}
@@ -0,0 +1,76 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  SpectrogramTileDB.h
+
+**********************************************************************/
+#pragma once
+
+#include "ClientData.h"
+#include "Prefs.h"
+#include "SpectrogramTileCache.h"
+
+#include <string>
+#include <vector>
+
+class AudacityProject;
+class DBConnection;
+class WaveClipChannel;
+
+//! Keeps tiles of spectrograms in the project file, so that they are not
+//! computed again in the next session
+/*!
+ Meant as the store of a SpectrogramTileCache, which gives the keys and
+ calls from the main thread only.  Off unless `Enabled`.
+
+ The tiles are in a table of their own, that older versions ignore, made when
+ a connection is set up.  Each tile names a sample block it was computed
+ from, and goes with it, when the file is next opened.  The table holds at
+ most `MaxBytes` of tiles, dropping the oldest.  The tiles are a cache: they
+ are not copied when the project is saved as another file or compacted.
+ */
+class PROJECT_FILE_IO_API SpectrogramTileDB final : public ClientData::Base
+{
+public:
+   //! Whether project files keep tiles; read when a connection is set up,
+   //! which drops the tiles of the file if not
+   static BoolSetting Enabled;
+
+   //! Bound on the tiles of one project file
+   static constexpr unsigned long long MaxBytes = 128 * 1024 * 1024;
+
+   static SpectrogramTileDB &Get(AudacityProject &project);
+
+   //! A store for the tiles of one channel of a clip, keeping them with its
+   //! first sample block; empty if there is no project or no block
+   static SpectrogramTileCache::Store
+   MakeStore(AudacityProject *pProject, const WaveClipChannel &clip);
+
+   explicit SpectrogramTileDB(AudacityProject &project);
+   SpectrogramTileDB(const SpectrogramTileDB&) = delete;
+   SpectrogramTileDB &operator=(const SpectrogramTileDB&) = delete;
+   ~SpectrogramTileDB() override;
+
+   //! Called by ProjectFileIO once for each connection it uses: makes the
+   //! table, drops tiles whose block is gone, and counts the rest
+   static void Setup(DBConnection &connection);
+
+   //! @return false if there is no such tile, or the file keeps no tiles
+   bool Load(const std::string &key, std::vector<float> &data);
+
+   //! Keeps any tile of the same key, which has the same values.  Failures
+   //! are logged and otherwise ignored; the tile can always be computed again.
+   //! @param blockId of a sample block the tile was computed from
+   void Save(
+      const std::string &key, long long blockId,
+      const std::vector<float> &data);
+
+private:
+   //! The connection, if the tiles are kept in it
+   DBConnection *GetConnection();
+   void Evict(DBConnection &connection);
+
+   AudacityProject &mProject;
+};
@@ -23,11 +23,17 @@ Paul Licameli -- split from SampleBlock.cpp and SampleBlock.h
 #include "UndoTracks.h"
 #include "WaveTrack.h"
 #include "WaveTrackUtilities.h"
+#include "concurrency/ThreadPool.h"
 
 #include "SentryHelper.h"
 #include <wx/log.h>
 
+#include <atomic>
+#include <cstring>
+#include <future>
 #include <mutex>
+#include <optional>
+#include <unordered_map>
 
 class SqliteSampleBlockFactory;
 
@@ -42,6 +48,18 @@ private:
    std::mutex mCacheMutex;
 
 public:
+   //! The columns of a row of the sampleblocks table that are read on load
+   struct Metadata
+   {
+      sampleFormat format;
+      double sumMin;
+      double sumMax;
+      double sumRms;
+      size_t sampleBytes;
+      //! Bytes of the whole row, or 0 when not read with the rest
+      size_t spaceUsage;
+   };
+
    explicit SqliteSampleBlock(
       const std::shared_ptr<SqliteSampleBlockFactory> &pFactory);
    ~SqliteSampleBlock() override;
@@ -84,6 +102,7 @@ public:
 private:
    bool IsSilent() const { return mBlockID <= 0; }
    void Load(SampleBlockID sbid);
+   void Load(SampleBlockID sbid, const Metadata &metadata);
    bool GetSummary(float *dest,
                    size_t frameoffset,
                    size_t numframes,
@@ -131,11 +150,28 @@ private:
    double mSumMax;
    double mSumRms;
 
+   //! Rows are never updated, so the size of this one is queried at most once;
+   //! 0 until then
+   mutable std::atomic<size_t> mSpaceUsage{ 0 };
+
 #if defined(WORDS_BIGENDIAN)
 #error All sample block data is little endian...big endian not yet supported
 #endif
 };
 
+// SQLite's length() of a number is that of its text, which it makes so
+static size_t TextLength(sqlite3_int64 value)
+{
+   return std::to_string(value).size();
+}
+
+static size_t TextLength(double value)
+{
+   char buffer[64];
+   sqlite3_snprintf(sizeof buffer, buffer, "%!.15g", value);
+   return strlen(buffer);
+}
+
 // Silent blocks use nonpositive id values to encode a length
 // and don't occupy any rows in the database; share blocks for repeatedly
 // used length values
@@ -154,6 +190,9 @@ public:
 
    SampleBlockIDs GetActiveBlockIDs() override;
 
+   void BeginBulkLoad() override;
+   void EndBulkLoad() override;
+
    SampleBlockPtr DoCreate(constSamplePtr src,
       size_t numsamples,
       sampleFormat srcformat) override;
@@ -179,6 +218,15 @@ private:
    void OnBeginPurge(size_t begin, size_t end);
    void OnEndPurge();
 
+   using MetadataMap =
+      std::unordered_map< SampleBlockID, SqliteSampleBlock::Metadata >;
+   //! Also seeds the totals of the connection, if no change was counted
+   //! since `generation`
+   static MetadataMap LoadAllMetadata(
+      DBConnection &connection, const std::atomic<bool> &cancelled,
+      SampleBlocksUsage::Generation generation);
+   const SqliteSampleBlock::Metadata *FindPreloadedMetadata(SampleBlockID id);
+
    friend SqliteSampleBlock;
 
    AudacityProject &mProject;
@@ -193,6 +241,13 @@ private:
    using AllBlocksMap =
       std::map< SampleBlockID, std::weak_ptr< SqliteSampleBlock > >;
    AllBlocksMap mAllBlocks;
+
+   // Between BeginBulkLoad() and EndBulkLoad(), the metadata of all blocks
+   // is read by a single scan of the table in a worker thread.  Blocks
+   // created from ids before it is done are loaded one by one.
+   std::atomic<bool> mPreloadCancelled{ false };
+   std::future<MetadataMap> mPreloading;
+   std::optional<MetadataMap> mPreloaded;
 };
 
 SqliteSampleBlockFactory::SqliteSampleBlockFactory( AudacityProject &project )
@@ -212,7 +267,10 @@ SqliteSampleBlockFactory::SqliteSampleBlockFactory( AudacityProject &project )
       });
 }
 
-SqliteSampleBlockFactory::~SqliteSampleBlockFactory() = default;
+SqliteSampleBlockFactory::~SqliteSampleBlockFactory()
+{
+   EndBulkLoad();
+}
 
 SampleBlockPtr SqliteSampleBlockFactory::DoCreate(
    constSamplePtr src, size_t numsamples, sampleFormat srcformat )
@@ -239,6 +297,109 @@ auto SqliteSampleBlockFactory::GetActiveBlockIDs() -> SampleBlockIDs
    return result;
 }
 
+void SqliteSampleBlockFactory::BeginBulkLoad()
+{
+   EndBulkLoad();
+
+   auto &pConnection = mppConnection->mpConnection;
+   if (!pConnection)
+      return;
+
+   mPreloadCancelled.store(false);
+   using namespace audacity::concurrency;
+   mPreloading = ThreadPool::Get().Async(
+      [&connection = *pConnection, &cancelled = mPreloadCancelled,
+       generation = pConnection->GetSampleBlocksUsage().GetGeneration()]{
+         return LoadAllMetadata(connection, cancelled, generation);
+      }, TaskPriority::Interactive);
+}
+
+void SqliteSampleBlockFactory::EndBulkLoad()
+{
+   if (mPreloading.valid()) {
+      mPreloadCancelled.store(true);
+      mPreloading.wait();
+      mPreloading = {};
+   }
+   mPreloaded.reset();
+}
+
+auto SqliteSampleBlockFactory::LoadAllMetadata(
+   DBConnection &connection, const std::atomic<bool> &cancelled,
+   SampleBlocksUsage::Generation generation)
+   -> MetadataMap
+{
+   MetadataMap result;
+   SampleBlocksUsage::Totals totals;
+
+   // Prepare and cache statement...automatically finalized at DB close
+   // (The cache is per thread, so this does not disturb the main thread)
+   sqlite3_stmt *stmt = connection.Prepare(DBConnection::LoadAllSampleBlocks,
+      "SELECT blockid, sampleformat, summin, summax, sumrms,"
+      "       length(samples),"
+      "       length(blockid) + length(sampleformat) +"
+      "       length(summin) + length(summax) + length(sumrms) +"
+      "       length(summary256) + length(summary64k) +"
+      "       length(samples)"
+      "  FROM sampleblocks;");
+
+   int rc = SQLITE_DONE;
+   while (!cancelled.load(std::memory_order_relaxed) &&
+          (rc = sqlite3_step(stmt)) == SQLITE_ROW)
+   {
+      ++totals.count;
+      totals.bytes += sqlite3_column_int64(stmt, 6);
+      result.emplace(sqlite3_column_int64(stmt, 0),
+         SqliteSampleBlock::Metadata{
+            static_cast<sampleFormat>(sqlite3_column_int(stmt, 1)),
+            sqlite3_column_double(stmt, 2),
+            sqlite3_column_double(stmt, 3),
+            sqlite3_column_double(stmt, 4),
+            static_cast<size_t>(sqlite3_column_int(stmt, 5)),
+            static_cast<size_t>(sqlite3_column_int64(stmt, 6)) });
+   }
+
+   if (!cancelled.load() && rc != SQLITE_DONE) {
+      // Not fatal: the blocks are then loaded one by one, which reports the
+      // error if there is any for them
+      wxLogDebug(
+         wxT("SqliteSampleBlockFactory::LoadAllMetadata - SQLITE error %s"),
+         sqlite3_errmsg(connection.DB()));
+      result.clear();
+   }
+   else if (!cancelled.load())
+      // The whole table was read, so ShouldCompact() needs no other scan
+      connection.GetSampleBlocksUsage().Seed(totals, generation);
+
+   // Rewind statement
+   sqlite3_reset(stmt);
+
+   return result;
+}
+
+const SqliteSampleBlock::Metadata *
+SqliteSampleBlockFactory::FindPreloadedMetadata(SampleBlockID id)
+{
+   // Don't wait for the worker, rather load this block by itself
+   if (!mPreloaded && mPreloading.valid() &&
+       mPreloading.wait_for(std::chrono::seconds{ 0 }) ==
+          std::future_status::ready)
+   {
+      try {
+         mPreloaded.emplace(mPreloading.get());
+      }
+      catch (...) {
+         // Not fatal either: the blocks are then loaded one by one
+         mPreloaded.emplace();
+      }
+   }
+
+   if (!mPreloaded)
+      return nullptr;
+   const auto iter = mPreloaded->find(id);
+   return iter == mPreloaded->end() ? nullptr : &iter->second;
+}
+
 SampleBlockPtr SqliteSampleBlockFactory::DoCreateSilent(
    size_t numsamples, sampleFormat )
 {
@@ -291,9 +452,12 @@ SampleBlockPtr SqliteSampleBlockFactory::DoCreateFromId(
    auto ssb           = std::make_shared<SqliteSampleBlock>(shared_from_this());
    wb                 = ssb;
    ssb->mSampleFormat = srcformat;
-   // This may throw database errors
-   // It initializes the rest of the fields
-   ssb->Load(static_cast<SampleBlockID>(id));
+   if (const auto pMetadata = FindPreloadedMetadata(id))
+      ssb->Load(static_cast<SampleBlockID>(id), *pMetadata);
+   else
+      // This may throw database errors
+      // It initializes the rest of the fields
+      ssb->Load(static_cast<SampleBlockID>(id));
 
    return ssb;
 }
@@ -571,8 +735,13 @@ size_t SqliteSampleBlock::GetSpaceUsage() const
 {
    if (IsSilent())
       return 0;
-   else
-      return ProjectFileIO::GetDiskUsage(*Conn(), mBlockID);
+
+   auto result = mSpaceUsage.load(std::memory_order_relaxed);
+   if (result == 0) {
+      result = ProjectFileIO::GetDiskUsage(*Conn(), mBlockID);
+      mSpaceUsage.store(result, std::memory_order_relaxed);
+   }
+   return result;
 }
 
 size_t SqliteSampleBlock::GetBlob(void *dest,
@@ -752,18 +921,35 @@ void SqliteSampleBlock::Load(SampleBlockID sbid)
    }
 
    // Retrieve returned data
-   mBlockID = sbid;
-   mSampleFormat = (sampleFormat) sqlite3_column_int(stmt, 0);
-   mSumMin = sqlite3_column_double(stmt, 1);
-   mSumMax = sqlite3_column_double(stmt, 2);
-   mSumRms = sqlite3_column_double(stmt, 3);
-   mSampleBytes = sqlite3_column_int(stmt, 4);
-   mSampleCount = mSampleBytes / SAMPLE_SIZE(mSampleFormat);
+   const Metadata metadata{
+      (sampleFormat) sqlite3_column_int(stmt, 0),
+      sqlite3_column_double(stmt, 1),
+      sqlite3_column_double(stmt, 2),
+      sqlite3_column_double(stmt, 3),
+      static_cast<size_t>(sqlite3_column_int(stmt, 4)),
+      0
+   };
 
    // Clear statement bindings and rewind statement
    sqlite3_clear_bindings(stmt);
    sqlite3_reset(stmt);
 
+   Load(sbid, metadata);
+}
+
+void SqliteSampleBlock::Load(SampleBlockID sbid, const Metadata &metadata)
+{
+   wxASSERT(sbid > 0);
+
+   mBlockID = sbid;
+   mSampleFormat = metadata.format;
+   mSumMin = metadata.sumMin;
+   mSumMax = metadata.sumMax;
+   mSumRms = metadata.sumRms;
+   mSampleBytes = metadata.sampleBytes;
+   mSampleCount = mSampleBytes / SAMPLE_SIZE(mSampleFormat);
+   mSpaceUsage.store(metadata.spaceUsage, std::memory_order_relaxed);
+
    mValid = true;
 }
 
@@ -822,6 +1008,10 @@ void SqliteSampleBlock::Commit(Sizes sizes)
    // Retrieve returned data
    mBlockID = sqlite3_last_insert_rowid(db);
 
+   // Clear statement bindings and rewind statement
+   sqlite3_clear_bindings(stmt);
+   sqlite3_reset(stmt);
+
    // Reset local arrays
    mSamples.reset();
    mSummary256.reset();
@@ -831,11 +1021,16 @@ void SqliteSampleBlock::Commit(Sizes sizes)
       mCache.reset();
    }
 
-   // Clear statement bindings and rewind statement
-   sqlite3_clear_bindings(stmt);
-   sqlite3_reset(stmt);
-
    mValid = true;
+
+   // Count the new row in the totals of the table, with the size that
+   // ProjectFileIO::GetDiskUsage() would find, from the values just bound
+   const size_t spaceUsage = TextLength(mBlockID) +
+      TextLength(static_cast<sqlite3_int64>(mSampleFormat)) +
+      TextLength(mSumMin) + TextLength(mSumMax) + TextLength(mSumRms) +
+      mSummary256Bytes + mSummary64kBytes + mSampleBytes;
+   mSpaceUsage.store(spaceUsage, std::memory_order_relaxed);
+   Conn()->GetSampleBlocksUsage().Inserted(spaceUsage);
 }
 
 void SqliteSampleBlock::Delete()
@@ -845,6 +1040,9 @@ void SqliteSampleBlock::Delete()
 
    wxASSERT(!IsSilent());
 
+   // Needed for the totals of the table, so ask it while the row exists
+   const auto spaceUsage = GetSpaceUsage();
+
    // Prepare and cache statement...automatically finalized at DB close
    sqlite3_stmt *stmt = Conn()->Prepare(DBConnection::DeleteSampleBlock,
       "DELETE FROM sampleblocks WHERE blockid = ?1;");
@@ -879,6 +1077,9 @@ void SqliteSampleBlock::Delete()
       Conn()->ThrowException( true );
    }
 
+   if (sqlite3_changes(db) > 0)
+      Conn()->GetSampleBlocksUsage().Deleted(spaceUsage);
+
    // Clear statement bindings and rewind statement
    sqlite3_clear_bindings(stmt);
    sqlite3_reset(stmt);
@@ -0,0 +1,235 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  HistorySpaceUsageTest.cpp
+
+**********************************************************************/
+#include "HistorySpaceUsage.h"
+#include "Project.h"
+#include "UndoManager.h"
+#include "WaveTrack.h"
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+
+namespace
+{
+constexpr auto sampleRate = 44100;
+
+//! Counts the queries of its space, which is that of its samples
+class CountingSampleBlock final : public SampleBlock
+{
+public:
+   CountingSampleBlock(
+      SampleBlockID id, size_t numSamples, sampleFormat format,
+      size_t& spaceQueries)
+       : mId { id }
+       , mNumSamples { numSamples }
+       , mFormat { format }
+       , mSpaceQueries { spaceQueries }
+   {
+   }
+
+   void CloseLock() noexcept override
+   {
+   }
+   SampleBlockID GetBlockID() const override
+   {
+      return mId;
+   }
+   BlockSampleView GetFloatSampleView(bool) override
+   {
+      return std::make_shared<std::vector<float>>(mNumSamples);
+   }
+   sampleFormat GetSampleFormat() const override
+   {
+      return mFormat;
+   }
+   size_t GetSampleCount() const override
+   {
+      return mNumSamples;
+   }
+   bool GetSummary256(float*, size_t, size_t) override
+   {
+      return true;
+   }
+   bool GetSummary64k(float*, size_t, size_t) override
+   {
+      return true;
+   }
+   size_t GetSpaceUsage() const override
+   {
+      ++mSpaceQueries;
+      return mNumSamples * SAMPLE_SIZE(mFormat);
+   }
+   void SaveXML(XMLWriter&) override
+   {
+   }
+   size_t DoGetSamples(
+      samplePtr dest, sampleFormat destformat, size_t, size_t numsamples)
+      override
+   {
+      std::fill(dest, dest + numsamples * SAMPLE_SIZE(destformat), 0);
+      return numsamples;
+   }
+   MinMaxRMS DoGetMinMaxRMS(size_t, size_t) override
+   {
+      return {};
+   }
+   MinMaxRMS DoGetMinMaxRMS() const override
+   {
+      return {};
+   }
+
+private:
+   const SampleBlockID mId;
+   const size_t mNumSamples;
+   const sampleFormat mFormat;
+   size_t& mSpaceQueries;
+};
+
+class CountingSampleBlockFactory final : public SampleBlockFactory
+{
+public:
+   SampleBlockIDs GetActiveBlockIDs() override
+   {
+      return {};
+   }
+
+   SampleBlockPtr
+   DoCreate(constSamplePtr, size_t numsamples, sampleFormat srcformat) override
+   {
+      return std::make_shared<CountingSampleBlock>(
+         ++mLastId, numsamples, srcformat, spaceQueries);
+   }
+
+   SampleBlockPtr
+   DoCreateSilent(size_t numsamples, sampleFormat srcformat) override
+   {
+      // Silent blocks have nonpositive ids
+      return std::make_shared<CountingSampleBlock>(
+         -static_cast<SampleBlockID>(numsamples), numsamples, srcformat,
+         spaceQueries);
+   }
+
+   SampleBlockPtr DoCreateFromXML(sampleFormat, const AttributesList&) override
+   {
+      return nullptr;
+   }
+
+   SampleBlockPtr DoCreateFromId(sampleFormat, SampleBlockID) override
+   {
+      return nullptr;
+   }
+
+   size_t spaceQueries = 0;
+
+private:
+   SampleBlockID mLastId = 0;
+};
+
+//! A track of one block of `numSamples` float samples
+std::shared_ptr<WaveTrack>
+MakeTrack(const SampleBlockFactoryPtr& factory, size_t numSamples)
+{
+   const auto track = WaveTrack::Create(factory, floatSample, sampleRate);
+   const std::vector<float> samples(numSamples);
+   track->Append(
+      0, reinterpret_cast<constSamplePtr>(samples.data()), floatSample,
+      numSamples);
+   track->Flush();
+   return track;
+}
+
+using Usages = std::vector<HistorySpaceUsage::Type>;
+} // namespace
+
+TEST_CASE("HistorySpaceUsage")
+{
+   const auto project = AudacityProject::Create();
+   auto& tracks = TrackList::Get(*project);
+   auto& manager = UndoManager::Get(*project);
+   auto& sut = HistorySpaceUsage::Get(*project);
+   const auto factory = std::make_shared<CountingSampleBlockFactory>();
+
+   constexpr auto bytesA = 1000 * sizeof(float);
+   constexpr auto bytesB = 500 * sizeof(float);
+
+   // State 0 has block A
+   tracks.Add(MakeTrack(factory, 1000));
+   manager.PushState({}, {});
+   REQUIRE(sut.GetStateUsages() == Usages { bytesA });
+   REQUIRE(factory->spaceQueries == 1);
+
+   // State 1 has blocks A and B; A is attributed to the newest state
+   const auto trackB = MakeTrack(factory, 500);
+   tracks.Add(trackB);
+   manager.PushState({}, {});
+   REQUIRE(sut.GetStateUsages() == Usages { 0, bytesA + bytesB });
+   REQUIRE(sut.GetTotal() == bytesA + bytesB);
+   REQUIRE(sut.GetBlockCount() == 2);
+
+   SECTION("The space of each block is asked once, also for repeated queries")
+   {
+      REQUIRE(factory->spaceQueries == 2);
+      sut.GetStateUsages();
+      sut.GetTotal();
+      REQUIRE(factory->spaceQueries == 2);
+      // A new state sharing the blocks
+      manager.PushState({}, {});
+      REQUIRE(sut.GetStateUsages() == Usages { 0, 0, bytesA + bytesB });
+      REQUIRE(factory->spaceQueries == 2);
+   }
+
+   SECTION("Each state has the totals of all its blocks")
+   {
+      const auto oldest = sut.GetStateTotals(0);
+      REQUIRE(oldest.blockCount == 1);
+      REQUIRE(oldest.space == bytesA);
+      const auto newest = sut.GetStateTotals(1);
+      REQUIRE(newest.blockCount == 2);
+      REQUIRE(newest.space == bytesA + bytesB);
+   }
+
+   SECTION("Modifying a state releases the blocks it no longer uses")
+   {
+      tracks.Remove(*trackB);
+      manager.ModifyState();
+      REQUIRE(sut.GetStateUsages() == Usages { 0, bytesA });
+      REQUIRE(sut.GetTotal() == bytesA);
+      REQUIRE(sut.GetBlockCount() == 1);
+      REQUIRE(sut.GetStateTotals(1).space == bytesA);
+   }
+
+   SECTION("Removing the newest state attributes its blocks to an older one")
+   {
+      manager.Undo([](const UndoStackElem&) {});
+      manager.AbandonRedo();
+      REQUIRE(sut.GetStateUsages() == Usages { bytesA });
+      REQUIRE(sut.GetTotal() == bytesA);
+      REQUIRE(sut.GetBlockCount() == 1);
+   }
+
+   SECTION("Removing the oldest state keeps blocks of newer states")
+   {
+      manager.RemoveStates(0, 1);
+      REQUIRE(sut.GetStateUsages() == Usages { bytesA + bytesB });
+      REQUIRE(sut.GetBlockCount() == 2);
+   }
+
+   SECTION("Silent blocks occupy no space")
+   {
+      const auto track = WaveTrack::Create(factory, floatSample, sampleRate);
+      track->InsertSilence(0, 1.0);
+      tracks.Add(track);
+      manager.PushState({}, {});
+      REQUIRE(sut.GetStateUsages() == Usages { 0, 0, bytesA + bytesB });
+      REQUIRE(sut.GetBlockCount() == 2);
+   }
+
+   tracks.Clear();
+   manager.ClearStates();
+}
@@ -0,0 +1,64 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  SampleBlocksUsageTest.cpp
+
+**********************************************************************/
+#include "SampleBlocksUsage.h"
+
+#include <catch2/catch.hpp>
+
+namespace
+{
+bool Equal(
+   const std::optional<SampleBlocksUsage::Totals>& totals,
+   SampleBlocksUsage::Type count, SampleBlocksUsage::Type bytes)
+{
+   return totals && totals->count == count && totals->bytes == bytes;
+}
+} // namespace
+
+TEST_CASE("SampleBlocksUsage")
+{
+   SampleBlocksUsage sut;
+   REQUIRE(!sut.Get());
+
+   SECTION("Changes before the first scan are not counted")
+   {
+      sut.Inserted(100);
+      sut.Deleted(10);
+      REQUIRE(!sut.Get());
+   }
+
+   SECTION("Changes after a scan are counted")
+   {
+      REQUIRE(sut.Seed({ 2, 300 }, sut.GetGeneration()));
+      REQUIRE(Equal(sut.Get(), 2, 300));
+      sut.Inserted(100);
+      REQUIRE(Equal(sut.Get(), 3, 400));
+      sut.Deleted(50);
+      REQUIRE(Equal(sut.Get(), 2, 350));
+   }
+
+   SECTION("A scan is not taken if changes happened meanwhile")
+   {
+      const auto generation = sut.GetGeneration();
+      sut.Inserted(100);
+      // The scan may or may not have seen the new row
+      REQUIRE(!sut.Seed({ 1, 100 }, generation));
+      REQUIRE(!sut.Get());
+      REQUIRE(sut.Seed({ 1, 100 }, sut.GetGeneration()));
+      REQUIRE(Equal(sut.Get(), 1, 100));
+   }
+
+   SECTION("Reset forgets the totals and rejects scans started before")
+   {
+      const auto generation = sut.GetGeneration();
+      REQUIRE(sut.Seed({ 2, 300 }, generation));
+      sut.Reset();
+      REQUIRE(!sut.Get());
+      REQUIRE(!sut.Seed({ 2, 300 }, generation));
+   }
+}
@@ -77,11 +77,33 @@ void ProjectHistory::PushState(const TranslatableString &desc,
 
    // remaining no-fail operations "commit" the changes of undo manager state
    auto &undoManager = UndoManager::Get( project );
-   undoManager.PushState(desc, shortDesc, flags);
+   if (mCombinedDescription)
+      // Consolidation modifies the state that the first push made
+      undoManager.PushState(*mCombinedDescription, *mCombinedDescription,
+         flags | UndoPush::CONSOLIDATE);
+   else
+      undoManager.PushState(desc, shortDesc, flags);
 
    mDirty = true;
 }
 
+ProjectHistory::CombinedPushes::CombinedPushes(
+   AudacityProject &project, const TranslatableString &desc )
+   : mHistory{ Get( project ) }
+   , mPrevious{ mHistory.mCombinedDescription }
+{
+   if (mPrevious)
+      return;
+   // The first push must not be consolidated with the state before
+   UndoManager::Get( project ).StopConsolidating();
+   mHistory.mCombinedDescription = desc;
+}
+
+ProjectHistory::CombinedPushes::~CombinedPushes()
+{
+   mHistory.mCombinedDescription = mPrevious;
+}
+
 void ProjectHistory::RollbackState()
 {
    auto &project = mProject;
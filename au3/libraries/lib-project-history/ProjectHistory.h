@@ -13,6 +13,9 @@ Paul Licameli split from ProjectManager.h
 
 #include "ClientData.h"
 #include "GlobalVariable.h"
+#include "TranslatableString.h"
+
+#include <optional>
 
 class AudacityProject;
 struct UndoState;
@@ -32,6 +35,21 @@ public:
       void(AudacityProject &)
    > {};
 
+   //! While one exists, the states that PushState pushes make one, as if
+   //! pushed once with its description; a nested one changes nothing
+   class PROJECT_HISTORY_API CombinedPushes final {
+   public:
+      CombinedPushes(
+         AudacityProject &project, const TranslatableString &desc );
+      CombinedPushes( const CombinedPushes & ) = delete;
+      CombinedPushes &operator=( const CombinedPushes & ) = delete;
+      ~CombinedPushes();
+
+   private:
+      ProjectHistory &mHistory;
+      const std::optional<TranslatableString> mPrevious;
+   };
+
    static ProjectHistory &Get( AudacityProject &project );
    static const ProjectHistory &Get( const AudacityProject &project );
 
@@ -66,6 +84,8 @@ private:
    AudacityProject &mProject;
 
    bool mDirty{ false };
+   //! Description of the pushes being combined, if any
+   std::optional<TranslatableString> mCombinedDescription;
 };
 
 #endif
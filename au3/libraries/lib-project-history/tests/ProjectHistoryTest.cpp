@@ -0,0 +1,93 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  ProjectHistoryTest.cpp
+
+**********************************************************************/
+#include "ProjectHistory.h"
+#include "Project.h"
+#include "UndoManager.h"
+
+#include <catch2/catch.hpp>
+
+namespace
+{
+TranslatableString ShortDescription(UndoManager& manager, unsigned int n)
+{
+   TranslatableString result;
+   manager.GetShortDescription(n, &result);
+   return result;
+}
+} // namespace
+
+TEST_CASE("ProjectHistory::CombinedPushes")
+{
+   const auto project = AudacityProject::Create();
+   auto& history = ProjectHistory::Get(*project);
+   auto& manager = UndoManager::Get(*project);
+   history.InitialState();
+   REQUIRE(manager.GetNumStates() == 1);
+
+   const auto batch = Verbatim("Batch");
+
+   SECTION("Without one, each push makes a state")
+   {
+      history.PushState(Verbatim("A"), Verbatim("A"));
+      history.PushState(Verbatim("B"), Verbatim("B"));
+      REQUIRE(manager.GetNumStates() == 3);
+   }
+
+   SECTION("Pushes make one state with its description")
+   {
+      {
+         ProjectHistory::CombinedPushes combined { *project, batch };
+         history.PushState(Verbatim("A"), Verbatim("A"));
+         history.PushState(Verbatim("B"), Verbatim("B"));
+         history.PushState(Verbatim("C"), Verbatim("C"), UndoPush::CONSOLIDATE);
+      }
+      REQUIRE(manager.GetNumStates() == 2);
+      REQUIRE(manager.GetCurrentState() == 1);
+      REQUIRE(ShortDescription(manager, 1) == batch);
+
+      // Later pushes are not combined
+      history.PushState(Verbatim("D"), Verbatim("D"));
+      REQUIRE(manager.GetNumStates() == 3);
+   }
+
+   SECTION("Pushes are not combined with a state pushed before")
+   {
+      history.PushState(batch, batch, UndoPush::CONSOLIDATE);
+      {
+         ProjectHistory::CombinedPushes combined { *project, batch };
+         history.PushState(Verbatim("A"), Verbatim("A"));
+      }
+      REQUIRE(manager.GetNumStates() == 3);
+   }
+
+   SECTION("Without pushes there is no new state")
+   {
+      {
+         ProjectHistory::CombinedPushes combined { *project, batch };
+      }
+      REQUIRE(manager.GetNumStates() == 1);
+   }
+
+   SECTION("A nested one changes nothing")
+   {
+      {
+         ProjectHistory::CombinedPushes combined { *project, batch };
+         history.PushState(Verbatim("A"), Verbatim("A"));
+         {
+            ProjectHistory::CombinedPushes nested { *project, Verbatim("N") };
+            history.PushState(Verbatim("B"), Verbatim("B"));
+         }
+         history.PushState(Verbatim("C"), Verbatim("C"));
+      }
+      REQUIRE(manager.GetNumStates() == 2);
+      REQUIRE(ShortDescription(manager, 1) == batch);
+   }
+
+   manager.ClearStates();
+}
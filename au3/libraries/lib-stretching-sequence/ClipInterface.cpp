@@ -3,3 +3,9 @@
 ClipTimes::~ClipTimes() = default;
 
 ClipInterface::~ClipInterface() = default;
+
+std::shared_ptr<const StretchedClipCache>
+ClipInterface::GetStretchedClipCache() const
+{
+   return nullptr;
+}
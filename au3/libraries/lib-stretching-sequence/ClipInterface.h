@@ -15,6 +15,8 @@
 #include "SampleCount.h"
 #include "SampleFormat.h"
 
+class StretchedClipCache;
+
 class STRETCHING_SEQUENCE_API ClipTimes
 {
 public:
@@ -63,6 +65,15 @@ public:
    [[nodiscard]] virtual Observer::Subscription
    SubscribeToPitchAndSpeedPresetChange(
       std::function<void(PitchAndSpeedPreset)> cb) const = 0;
+
+   /*!
+    * Audio of the clip stretched ahead of playback, if any. It may still be
+    * rendering, and may have been rendered with other parameters than the
+    * current ones.
+    * Default implementation returns nullptr.
+    */
+   virtual std::shared_ptr<const StretchedClipCache>
+   GetStretchedClipCache() const;
 };
 
 using ClipConstHolders = std::vector<std::shared_ptr<const ClipInterface>>;
@@ -12,22 +12,15 @@
 #include "ClipInterface.h"
 #include "SampleFormat.h"
 #include "StaffPadTimeAndPitch.h"
+#include "StretchedClipCache.h"
+#include <algorithm>
 #include <cassert>
-#include <cmath>
 #include <functional>
 
 namespace
 {
-TimeAndPitchInterface::Parameters
-GetStretchingParameters(const ClipInterface& clip)
-{
-   TimeAndPitchInterface::Parameters params;
-   params.timeRatio = clip.GetStretchRatio();
-   params.pitchRatio = std::pow(2., clip.GetCentShift() / 1200.);
-   params.preserveFormants =
-      clip.GetPitchAndSpeedPreset() == PitchAndSpeedPreset::OptimizeForVoice;
-   return params;
-}
+// About one hop of the stretcher, whose window lasts about 93 ms at any rate
+constexpr auto cacheCrossfadeDuration = .025;
 
 sampleCount
 GetTotalNumSamplesToProduce(const ClipInterface& clip, double durationToDiscard)
@@ -36,20 +29,34 @@ GetTotalNumSamplesToProduce(const ClipInterface& clip, double durationToDiscard)
                            clip.GetStretchRatio() -
                         durationToDiscard * clip.GetRate() + .5 };
 }
+
+std::shared_ptr<const StretchedClipCache>
+GetUpToDateCache(const ClipInterface& clip)
+{
+   auto cache = clip.GetStretchedClipCache();
+   return cache && cache->Matches(clip) ? cache : nullptr;
+}
 } // namespace
 
 ClipSegment::ClipSegment(
    const ClipInterface& clip, double durationToDiscard,
    PlaybackDirection direction)
-    : mTotalNumSamplesToProduce { GetTotalNumSamplesToProduce(
+    : mClip { clip }
+    , mDurationToDiscard { durationToDiscard }
+    , mDirection { direction }
+    , mTotalNumSamplesToProduce { GetTotalNumSamplesToProduce(
          clip, durationToDiscard) }
-    , mSource { clip, durationToDiscard, direction }
+    , mSource { std::make_unique<ClipTimeAndPitchSource>(
+         clip, durationToDiscard, direction) }
     , mPreserveFormants { clip.GetPitchAndSpeedPreset() ==
                           PitchAndSpeedPreset::OptimizeForVoice }
     , mCentShift { clip.GetCentShift() }
     , mStretcher { std::make_unique<StaffPadTimeAndPitch>(
-         clip.GetRate(), clip.NChannels(), mSource,
+         clip.GetRate(), clip.NChannels(), *mSource,
          GetStretchingParameters(clip)) }
+    , mCache { GetUpToDateCache(clip) }
+    , mCacheCrossfadeLength { static_cast<size_t>(
+         cacheCrossfadeDuration * clip.GetRate() + .5) }
     , mOnSemitoneShiftChangeSubscription { clip.SubscribeToCentShiftChange(
          [this](int cents) {
             mCentShift = cents;
@@ -64,12 +71,21 @@ ClipSegment::ClipSegment(
           })
     }
 {
+   if (mCache)
+   {
+      // Allocated here rather than on the playback thread
+      mLiveChannels.resize(
+         mSource->NChannels(), std::vector<float>(mCacheCrossfadeLength));
+      for (auto& channel : mLiveChannels)
+         mLivePointers.push_back(channel.data());
+   }
 }
 
 ClipSegment::~ClipSegment()
 {
    mOnSemitoneShiftChangeSubscription.Reset();
    mOnFormantPreservationChangeSubscription.Reset();
+   StretchedClipCache::Release(std::move(mCache));
 }
 
 size_t ClipSegment::GetFloats(float* const* buffers, size_t numSamples)
@@ -81,17 +97,90 @@ size_t ClipSegment::GetFloats(float* const* buffers, size_t numSamples)
    // cannot trust that the observer subscriptions do not get called after
    // destruction of this object, so better not do anything too sophisticated
    // there.
+   auto pitchChanged = false;
    if (mUpdateFormantPreservation.exchange(false))
+   {
       mStretcher->OnFormantPreservationChange(mPreserveFormants);
+      pitchChanged = true;
+   }
    if (mUpdateCentShift.exchange(false))
+   {
       mStretcher->OnCentShiftChange(mCentShift);
+      pitchChanged = true;
+   }
+   if (pitchChanged && mCache)
+   {
+      // The cached audio is stale now.
+      if (mPlayingFromCache)
+         ResumeStretching();
+      // Not destroyed here, where it could be the last owner.
+      StretchedClipCache::Release(std::move(mCache));
+      mPlayingFromCache = false;
+      mCrossfadeRemaining = 0;
+   }
+   else if (mCache && !mPlayingFromCache && mCache->IsReady())
+   {
+      mPlayingFromCache = true;
+      // The stretcher and the cache don't render the same phases: past the
+      // start, switching at once could click.
+      if (mTotalNumSamplesProduced > 0)
+         mCrossfadeRemaining = mCacheCrossfadeLength;
+   }
    const auto numSamplesToProduce = limitSampleBufferSize(
       numSamples, mTotalNumSamplesToProduce - mTotalNumSamplesProduced);
-   mStretcher->GetSamples(buffers, numSamplesToProduce);
+   if (mPlayingFromCache)
+   {
+      GetCachedFloats(buffers, numSamplesToProduce);
+      CrossfadeFromStretcher(buffers, numSamplesToProduce);
+   }
+   else
+      mStretcher->GetSamples(buffers, numSamplesToProduce);
    mTotalNumSamplesProduced += numSamplesToProduce;
    return numSamplesToProduce;
 }
 
+void ClipSegment::GetCachedFloats(float* const* buffers, size_t numSamples)
+{
+   // The cache holds the whole clip, while this segment may start anywhere in
+   // it.
+   const auto start =
+      mDirection == PlaybackDirection::forward ?
+         mCache->GetNumSamples() - mTotalNumSamplesToProduce +
+            mTotalNumSamplesProduced :
+         mTotalNumSamplesToProduce - 1 - mTotalNumSamplesProduced;
+   mCache->GetFloats(buffers, start, numSamples, mDirection);
+}
+
+void ClipSegment::CrossfadeFromStretcher(
+   float* const* buffers, size_t numSamples)
+{
+   const auto numFading = std::min(numSamples, mCrossfadeRemaining);
+   if (numFading == 0)
+      return;
+   mStretcher->GetSamples(mLivePointers.data(), numFading);
+   const auto done = mCacheCrossfadeLength - mCrossfadeRemaining;
+   for (size_t c = 0; c < mLiveChannels.size(); ++c)
+      for (size_t i = 0; i < numFading; ++i)
+      {
+         const auto gain =
+            static_cast<float>(done + i + 1) / (mCacheCrossfadeLength + 1);
+         buffers[c][i] =
+            gain * buffers[c][i] + (1 - gain) * mLiveChannels[c][i];
+      }
+   mCrossfadeRemaining -= numFading;
+}
+
+void ClipSegment::ResumeStretching()
+{
+   // The stretcher has the current parameters already ; it only needs to
+   // forget what it read before the cache took over, and to read on from
+   // where the cache stops.
+   mSource->Seek(
+      mDurationToDiscard +
+      mTotalNumSamplesProduced.as_double() / mClip.GetRate());
+   mStretcher->Restart();
+}
+
 bool ClipSegment::Empty() const
 {
    return mTotalNumSamplesProduced == mTotalNumSamplesToProduce;
@@ -99,5 +188,5 @@ bool ClipSegment::Empty() const
 
 size_t ClipSegment::NChannels() const
 {
-   return mSource.NChannels();
+   return mSource->NChannels();
 }
@@ -16,8 +16,10 @@
 #include "PlaybackDirection.h"
 #include <atomic>
 #include <memory>
+#include <vector>
 
 class ClipInterface;
+class StretchedClipCache;
 class TimeAndPitchInterface;
 
 using PitchRatioChangeCbSubscriber =
@@ -40,9 +42,19 @@ public:
    size_t NChannels() const override;
 
 private:
+   void GetCachedFloats(float* const* buffers, size_t numSamples);
+   //! Mixes the stretcher's output into the start of `buffers`, while the
+   //! crossfade into the cached audio lasts
+   void CrossfadeFromStretcher(float* const* buffers, size_t numSamples);
+   //! Restarts the stretcher where the cached audio stopped being used
+   void ResumeStretching();
+
+   const ClipInterface& mClip;
+   const double mDurationToDiscard;
+   const PlaybackDirection mDirection;
    const sampleCount mTotalNumSamplesToProduce;
    sampleCount mTotalNumSamplesProduced = 0;
-   ClipTimeAndPitchSource mSource;
+   std::unique_ptr<ClipTimeAndPitchSource> mSource;
    bool mPreserveFormants;
    int mCentShift;
    std::atomic<bool> mUpdateFormantPreservation = false;
@@ -51,6 +63,15 @@ private:
    // in its ctor.
    // todo(mhodgkinson) make this safe.
    std::unique_ptr<TimeAndPitchInterface> mStretcher;
+   //! Rendered in the background; played instead of `mStretcher` once ready,
+   //! until the pitch parameters change
+   std::shared_ptr<const StretchedClipCache> mCache;
+   bool mPlayingFromCache = false;
+   const size_t mCacheCrossfadeLength;
+   size_t mCrossfadeRemaining = 0;
+   //! The stretcher's output during the crossfade
+   std::vector<std::vector<float>> mLiveChannels;
+   std::vector<float*> mLivePointers;
    Observer::Subscription mOnSemitoneShiftChangeSubscription;
    Observer::Subscription mOnFormantPreservationChangeSubscription;
 };
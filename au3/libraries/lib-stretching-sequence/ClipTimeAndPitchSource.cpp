@@ -14,6 +14,7 @@
 
 
 #include <cassert>
+#include <cmath>
 
 namespace
 {
@@ -32,6 +33,17 @@ sampleCount GetLastReadSample(
 }
 } // namespace
 
+TimeAndPitchInterface::Parameters
+GetStretchingParameters(const ClipInterface& clip)
+{
+   TimeAndPitchInterface::Parameters params;
+   params.timeRatio = clip.GetStretchRatio();
+   params.pitchRatio = std::pow(2., clip.GetCentShift() / 1200.);
+   params.preserveFormants =
+      clip.GetPitchAndSpeedPreset() == PitchAndSpeedPreset::OptimizeForVoice;
+   return params;
+}
+
 ClipTimeAndPitchSource::ClipTimeAndPitchSource(
    const ClipInterface& clip, double durationToDiscard,
    PlaybackDirection direction)
@@ -91,3 +103,9 @@ size_t ClipTimeAndPitchSource::NChannels() const
 {
    return mClip.NChannels();
 }
+
+void ClipTimeAndPitchSource::Seek(double durationToDiscard)
+{
+   mLastReadSample =
+      GetLastReadSample(mClip, durationToDiscard, mPlaybackDirection);
+}
@@ -20,6 +20,10 @@
 class ClipInterface;
 using ChannelSampleViews = std::vector<AudioSegmentSampleView>;
 
+//! The parameters to stretch `clip` with, in its current state
+STRETCHING_SEQUENCE_API TimeAndPitchInterface::Parameters
+GetStretchingParameters(const ClipInterface& clip);
+
 class STRETCHING_SEQUENCE_API ClipTimeAndPitchSource final :
     public TimeAndPitchSource
 {
@@ -32,6 +36,10 @@ public:
 
    size_t NChannels() const;
 
+   //! Goes on reading from where a new source with `durationToDiscard` would
+   //! start
+   void Seek(double durationToDiscard);
+
 private:
    const ClipInterface& mClip;
    sampleCount mLastReadSample = 0;
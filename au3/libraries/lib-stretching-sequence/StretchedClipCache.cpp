@@ -0,0 +1,293 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  StretchedClipCache.cpp
+
+**********************************************************************/
+#include "StretchedClipCache.h"
+#include "AudioContainer.h"
+#include "ClipTimeAndPitchSource.h"
+#include "StaffPadTimeAndPitch.h"
+#include "concurrency/TaskGraph.h"
+
+#include <algorithm>
+#include <cassert>
+
+using namespace audacity::concurrency;
+
+namespace
+{
+constexpr auto blockSize = 1024u;
+
+std::atomic<size_t> memoryUsage { 0 };
+
+bool Reserve(size_t bytes)
+{
+   auto usage = memoryUsage.load();
+   do
+      if (bytes > StretchedClipCache::maxMemoryUsage - usage)
+         return false;
+   while (!memoryUsage.compare_exchange_weak(usage, usage + bytes));
+   return true;
+}
+
+size_t NumSamples(double duration, int rate)
+{
+   return static_cast<size_t>(duration * rate + .5);
+}
+} // namespace
+
+bool StretchedClipCache::Parameters::operator==(const Parameters& other) const
+{
+   return stretchRatio == other.stretchRatio &&
+          centShift == other.centShift && preset == other.preset &&
+          numSamples == other.numSamples;
+}
+
+bool StretchedClipCache::Parameters::operator!=(const Parameters& other) const
+{
+   return !(*this == other);
+}
+
+StretchedClipCache::Parameters
+StretchedClipCache::GetParameters(const ClipInterface& clip)
+{
+   return { clip.GetStretchRatio(), clip.GetCentShift(),
+            clip.GetPitchAndSpeedPreset(),
+            sampleCount { clip.GetVisibleSampleCount().as_double() *
+                             clip.GetStretchRatio() +
+                          .5 } };
+}
+
+bool StretchedClipCache::IsWorthRendering(const ClipInterface& clip)
+{
+   if (
+      TimeAndPitchInterface::IsPassThroughMode(clip.GetStretchRatio()) &&
+      clip.GetCentShift() == 0)
+      return false;
+   const auto numSamples = GetParameters(clip).numSamples;
+   return numSamples > 0 &&
+          numSamples.as_double() <= maxDuration * clip.GetRate();
+}
+
+std::shared_ptr<StretchedClipCache>
+StretchedClipCache::Create(std::shared_ptr<const ClipInterface> clip)
+{
+   const auto bytes = GetParameters(*clip).numSamples.as_double() *
+                      clip->NChannels() * sizeof(float);
+   if (bytes > maxMemoryUsage || !Reserve(static_cast<size_t>(bytes)))
+      return nullptr;
+   try
+   {
+      // The constructor is private
+      return std::shared_ptr<StretchedClipCache> { new StretchedClipCache {
+         std::move(clip), static_cast<size_t>(bytes) } };
+   }
+   catch (...)
+   {
+      memoryUsage -= static_cast<size_t>(bytes);
+      throw;
+   }
+}
+
+size_t StretchedClipCache::GetMemoryUsage()
+{
+   return memoryUsage.load();
+}
+
+void StretchedClipCache::Release(std::shared_ptr<const StretchedClipCache> cache)
+{
+   if (!cache)
+      return;
+   // Nobody can take a new reference from the last owner: the tasks rendering
+   // may as well be skipped rather than run before the release.
+   if (cache.use_count() == 1)
+      cache->Cancel();
+   ThreadPool::Get().Submit(
+      [cache = std::move(cache)]() mutable { cache.reset(); },
+      TaskPriority::Background);
+}
+
+StretchedClipCache::StretchedClipCache(
+   std::shared_ptr<const ClipInterface> clip, size_t bytes)
+    : mClip { std::move(clip) }
+    , mParameters { GetParameters(*mClip) }
+    , mNumSamples { mParameters.numSamples.as_size_t() }
+    , mSectionLength { std::max<size_t>(
+         NumSamples(sectionDuration, mClip->GetRate()), 1) }
+    , mPrerollLength { NumSamples(prerollDuration, mClip->GetRate()) }
+    , mCrossfadeLength { std::min(
+         NumSamples(crossfadeDuration, mClip->GetRate()), mSectionLength) }
+    , mNumSections { (mNumSamples + mSectionLength - 1) / mSectionLength }
+    , mMemoryUsage { bytes }
+{
+   Render();
+}
+
+StretchedClipCache::~StretchedClipCache()
+{
+   Cancel();
+   Wait();
+   memoryUsage -= mMemoryUsage;
+}
+
+const ClipInterface& StretchedClipCache::GetClip() const
+{
+   return *mClip;
+}
+
+bool StretchedClipCache::Matches(const ClipInterface& clip) const
+{
+   return clip.NChannels() == mClip->NChannels() &&
+          clip.GetRate() == mClip->GetRate() &&
+          GetParameters(clip) == mParameters;
+}
+
+bool StretchedClipCache::IsReady() const
+{
+   return mReady.load(std::memory_order_acquire);
+}
+
+void StretchedClipCache::Wait() const
+{
+   try
+   {
+      mRender->Wait();
+   }
+   catch (...)
+   {
+      // Not ready then: playback stretches in real time.
+   }
+}
+
+size_t StretchedClipCache::NChannels() const
+{
+   return mClip->NChannels();
+}
+
+sampleCount StretchedClipCache::GetNumSamples() const
+{
+   return mNumSamples;
+}
+
+void StretchedClipCache::GetFloats(
+   float* const* buffers, sampleCount start, size_t numSamples,
+   PlaybackDirection direction) const
+{
+   assert(IsReady());
+   const auto nChannels = mChannels.size();
+   const auto step = direction == PlaybackDirection::forward ? 1ll : -1ll;
+   const auto end = static_cast<long long>(mNumSamples);
+   auto index = start.as_long_long();
+   for (auto i = 0u; i < numSamples; ++i, index += step)
+   {
+      const auto inRange = index >= 0 && index < end;
+      for (auto iChannel = 0u; iChannel < nChannels; ++iChannel)
+         buffers[iChannel][i] = inRange ? mChannels[iChannel][index] : 0.f;
+   }
+}
+
+void StretchedClipCache::Cancel() const
+{
+   mCancelled.store(true);
+   mRender->Cancel();
+}
+
+void StretchedClipCache::Render()
+{
+   // Nobody waits for the cache: playback stretches in real time until it is
+   // ready.
+   mRender = std::make_unique<TaskGraph>(
+      ThreadPool::Get(), TaskPriority::Background);
+   // Allocating may take a while for long clips, so it is a task too.
+   const auto allocate = mRender->Add([this] { Allocate(); });
+   std::vector<TaskGraph::TaskId> sections;
+   sections.reserve(mNumSections);
+   for (size_t iSection = 0; iSection < mNumSections; ++iSection)
+      sections.push_back(
+         mRender->Then(allocate, [this, iSection] { RenderSection(iSection); }));
+   mRender->Add(
+      [this]
+      {
+         if (mCancelled.load())
+            return;
+         Crossfade();
+         mReady.store(true, std::memory_order_release);
+      },
+      std::move(sections));
+   mRender->Start();
+}
+
+void StretchedClipCache::Allocate()
+{
+   const auto nChannels = mClip->NChannels();
+   mChannels.assign(nChannels, std::vector<float>(mNumSamples));
+   mTails.resize(mNumSections);
+}
+
+void StretchedClipCache::RenderSection(size_t iSection)
+{
+   const auto sectionStart = iSection * mSectionLength;
+   const auto sectionEnd = std::min(sectionStart + mSectionLength, mNumSamples);
+   const auto renderStart =
+      sectionStart > mPrerollLength ? sectionStart - mPrerollLength : 0u;
+   const auto renderEnd = std::min(sectionEnd + mCrossfadeLength, mNumSamples);
+
+   const auto nChannels = mClip->NChannels();
+   const auto rate = mClip->GetRate();
+   ClipTimeAndPitchSource source { *mClip,
+                                   static_cast<double>(renderStart) / rate,
+                                   PlaybackDirection::forward };
+   StaffPadTimeAndPitch stretcher { rate, nChannels, source,
+                                    GetStretchingParameters(*mClip) };
+
+   auto& tail = mTails[iSection];
+   tail.assign(nChannels, std::vector<float>(renderEnd - sectionEnd));
+
+   AudioContainer container(blockSize, nChannels);
+   auto position = renderStart;
+   while (position < renderEnd)
+   {
+      if (mCancelled.load(std::memory_order_relaxed))
+         return;
+      const auto numSamples = std::min<size_t>(blockSize, renderEnd - position);
+      stretcher.GetSamples(container.Get(), numSamples);
+      for (auto i = 0u; i < numSamples; ++i, ++position)
+      {
+         if (position < sectionStart)
+            continue;
+         for (auto iChannel = 0u; iChannel < nChannels; ++iChannel)
+         {
+            const auto sample = container.channelVectors[iChannel][i];
+            if (position < sectionEnd)
+               mChannels[iChannel][position] = sample;
+            else
+               tail[iChannel][position - sectionEnd] = sample;
+         }
+      }
+   }
+}
+
+void StretchedClipCache::Crossfade()
+{
+   for (size_t iSection = 1; iSection < mNumSections; ++iSection)
+   {
+      const auto sectionStart = iSection * mSectionLength;
+      const auto& tail = mTails[iSection - 1];
+      for (auto iChannel = 0u; iChannel < mChannels.size(); ++iChannel)
+      {
+         const auto& fadingOut = tail[iChannel];
+         auto fadingIn = mChannels[iChannel].begin() + sectionStart;
+         const auto length = fadingOut.size();
+         for (auto i = 0u; i < length; ++i)
+         {
+            const auto gain = (i + .5f) / length;
+            fadingIn[i] = fadingIn[i] * gain + fadingOut[i] * (1.f - gain);
+         }
+      }
+   }
+   mTails.clear();
+   mTails.shrink_to_fit();
+}
@@ -0,0 +1,140 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  StretchedClipCache.h
+
+**********************************************************************/
+#pragma once
+
+#include "ClipInterface.h"
+#include "PlaybackDirection.h"
+#include "SampleCount.h"
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+namespace audacity::concurrency
+{
+class TaskGraph;
+}
+
+/*!
+ * The time-stretched and pitch-shifted audio of a clip, rendered in the
+ * background so that playback does not need to run the stretcher in real time.
+ *
+ * The clip is cut into sections which are rendered in parallel, each by its
+ * own stretcher. A section starts rendering a little ahead of its start, so
+ * that its stretcher has settled by then, and renders a little past its end,
+ * where it is crossfaded into the next section.
+ *
+ * The audio is kept in memory, hence the limit on the duration of the clips
+ * worth rendering, and the limit on the memory of all caches together.
+ */
+class STRETCHING_SEQUENCE_API StretchedClipCache final
+{
+public:
+   //! What the rendered audio depends on, besides the samples of the clip
+   struct Parameters
+   {
+      double stretchRatio = 1.;
+      int centShift = 0;
+      PitchAndSpeedPreset preset = PitchAndSpeedPreset::Default;
+      sampleCount numSamples = 0;
+
+      bool operator==(const Parameters& other) const;
+      bool operator!=(const Parameters& other) const;
+   };
+
+   static constexpr auto sectionDuration = 10.;
+   static constexpr auto prerollDuration = .5;
+   static constexpr auto crossfadeDuration = .05;
+   static constexpr auto maxDuration = 600.;
+   //! Bytes of audio, shared by all caches
+   static constexpr size_t maxMemoryUsage = 1u << 30;
+
+   static Parameters GetParameters(const ClipInterface& clip);
+
+   //! Whether the clip needs a stretcher at all and is not too long to keep
+   //! in memory
+   static bool IsWorthRendering(const ClipInterface& clip);
+
+   /*!
+    * Starts rendering right away, on the shared thread pool.
+    * @param clip a copy of the clip that nobody modifies while rendering
+    * @return null if the audio would not fit in what remains of
+    * `maxMemoryUsage`
+    */
+   static std::shared_ptr<StretchedClipCache>
+   Create(std::shared_ptr<const ClipInterface> clip);
+
+   //! Bytes of audio of all caches alive
+   static size_t GetMemoryUsage();
+
+   /*!
+    * Lets go of `cache` on a worker of the thread pool, so that the thread
+    * calling, e.g. that of playback, doesn't wait for rendering to stop or for
+    * the audio to be freed if it was the last owner.
+    */
+   static void Release(std::shared_ptr<const StretchedClipCache> cache);
+
+   StretchedClipCache(const StretchedClipCache&) = delete;
+   StretchedClipCache& operator=(const StretchedClipCache&) = delete;
+
+   //! Cancels rendering if still running and waits for the tasks to stop
+   ~StretchedClipCache();
+
+   //! The copy of the clip being rendered
+   const ClipInterface& GetClip() const;
+
+   //! Whether the parameters of `clip` are the ones rendered with
+   bool Matches(const ClipInterface& clip) const;
+
+   bool IsReady() const;
+
+   //! Blocks until rendering is over
+   void Wait() const;
+
+   size_t NChannels() const;
+
+   sampleCount GetNumSamples() const;
+
+   /*!
+    * Copies rendered samples, in playback order: from `start` upwards when
+    * playing forward, from `start` downwards when playing backward. Samples
+    * out of range are zeroed.
+    * @pre `IsReady()`
+    */
+   void GetFloats(
+      float* const* buffers, sampleCount start, size_t numSamples,
+      PlaybackDirection direction) const;
+
+private:
+   StretchedClipCache(std::shared_ptr<const ClipInterface> clip, size_t bytes);
+
+   void Cancel() const;
+   void Render();
+   void Allocate();
+   void RenderSection(size_t iSection);
+   void Crossfade();
+
+   const std::shared_ptr<const ClipInterface> mClip;
+   const Parameters mParameters;
+   const size_t mNumSamples;
+   const size_t mSectionLength;
+   const size_t mPrerollLength;
+   const size_t mCrossfadeLength;
+   const size_t mNumSections;
+   //! Reserved in the budget until destruction
+   const size_t mMemoryUsage;
+
+   std::vector<std::vector<float>> mChannels;
+   //! Per section and channel, what is rendered past the end of the section
+   std::vector<std::vector<std::vector<float>>> mTails;
+
+   mutable std::atomic<bool> mCancelled { false };
+   std::atomic<bool> mReady { false };
+   std::unique_ptr<audacity::concurrency::TaskGraph> mRender;
+};
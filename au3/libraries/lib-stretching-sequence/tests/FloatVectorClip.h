@@ -68,12 +68,22 @@ public:
    Observer::Subscription SubscribeToPitchAndSpeedPresetChange(
       std::function<void(PitchAndSpeedPreset)> cb) const override
    {
+      presetChangeCallback = std::move(cb);
       return {};
    }
 
+   std::shared_ptr<const StretchedClipCache>
+   GetStretchedClipCache() const override
+   {
+      return stretchedClipCache;
+   }
+
 public:
    double stretchRatio = 1.;
    double playStartTime = 0.;
+   std::shared_ptr<const StretchedClipCache> stretchedClipCache;
+   //! The last subscriber, to simulate changes of the preset
+   mutable std::function<void(PitchAndSpeedPreset)> presetChangeCallback;
 
 private:
    double GetPlayDuration() const;
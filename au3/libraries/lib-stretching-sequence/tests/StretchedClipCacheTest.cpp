@@ -0,0 +1,195 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  StretchedClipCacheTest.cpp
+
+**********************************************************************/
+#include "StretchedClipCache.h"
+#include "AudioContainer.h"
+#include "ClipSegment.h"
+#include "FloatVectorClip.h"
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <numeric>
+#include <thread>
+
+namespace
+{
+// Low, for the sections not to be too long, but only usable unstretched.
+constexpr auto sampleRate = 100;
+constexpr auto stretchingSampleRate = 44100;
+
+std::vector<float> Ramp(size_t numSamples, float sign)
+{
+   std::vector<float> ramp(numSamples);
+   std::iota(ramp.begin(), ramp.end(), 1.f);
+   for (auto& sample : ramp)
+      sample *= sign;
+   return ramp;
+}
+} // namespace
+
+TEST_CASE("StretchedClipCache")
+{
+   SECTION("sections are joined seamlessly")
+   {
+      // Not stretched, so that the rendered audio must be the clip's,
+      // whatever the sectioning and crossfading.
+      const auto numSamples = static_cast<size_t>(
+         3.5 * StretchedClipCache::sectionDuration * sampleRate);
+      const auto audio = Ramp(numSamples, 1.f);
+      const auto clip = std::make_shared<FloatVectorClip>(
+         sampleRate, std::vector<std::vector<float>> { audio, audio });
+      const auto sut = StretchedClipCache::Create(clip);
+      REQUIRE(sut);
+      sut->Wait();
+      REQUIRE(sut->IsReady());
+      REQUIRE(sut->GetNumSamples() == numSamples);
+      REQUIRE(sut->Matches(*clip));
+
+      AudioContainer output(numSamples, 2);
+      sut->GetFloats(
+         output.channelPointers.data(), 0, numSamples,
+         PlaybackDirection::forward);
+      // Crossfading a signal with itself is exact but for rounding.
+      for (const auto& channel : output.channelVectors)
+      {
+         auto maxError = 0.f;
+         for (auto i = 0u; i < numSamples; ++i)
+            maxError = std::max(maxError, std::abs(channel[i] - audio[i]));
+         REQUIRE(maxError < 1e-2f);
+      }
+   }
+
+   SECTION("stretched clip is rendered to its stretched length")
+   {
+      const auto clip = std::make_shared<FloatVectorClip>(
+         stretchingSampleRate, Ramp(stretchingSampleRate, 1.f), 1u);
+      clip->stretchRatio = 1.5;
+      REQUIRE(StretchedClipCache::IsWorthRendering(*clip));
+      const auto sut = StretchedClipCache::Create(clip);
+      REQUIRE(sut);
+      REQUIRE(sut->GetNumSamples() == stretchingSampleRate * 3 / 2);
+      clip->stretchRatio = 2.;
+      REQUIRE(!sut->Matches(*clip));
+      sut->Wait();
+      REQUIRE(sut->IsReady());
+   }
+
+   SECTION("unstretched clip is not worth rendering")
+   {
+      const auto clip =
+         std::make_shared<FloatVectorClip>(sampleRate, Ramp(1000, 1.f), 1u);
+      REQUIRE(!StretchedClipCache::IsWorthRendering(*clip));
+   }
+
+   SECTION("destruction while rendering does not hang")
+   {
+      const auto clip = std::make_shared<FloatVectorClip>(
+         stretchingSampleRate, Ramp(60 * stretchingSampleRate, 1.f), 2u);
+      clip->stretchRatio = 1.5;
+      StretchedClipCache::Create(clip).reset();
+      SUCCEED();
+   }
+
+   SECTION("caches beyond the memory budget are not created")
+   {
+      const auto usage = StretchedClipCache::GetMemoryUsage();
+      const auto clip =
+         std::make_shared<FloatVectorClip>(sampleRate, Ramp(10, 1.f), 1u);
+      clip->stretchRatio = 1e9;
+      REQUIRE(!StretchedClipCache::Create(clip));
+
+      clip->stretchRatio = 1.;
+      auto sut = StretchedClipCache::Create(clip);
+      REQUIRE(sut);
+      REQUIRE(
+         StretchedClipCache::GetMemoryUsage() == usage + 10 * sizeof(float));
+      sut.reset();
+      REQUIRE(StretchedClipCache::GetMemoryUsage() == usage);
+   }
+
+   SECTION("released caches are destroyed on another thread")
+   {
+      const auto clip = std::make_shared<FloatVectorClip>(
+         stretchingSampleRate, Ramp(60 * stretchingSampleRate, 1.f), 2u);
+      clip->stretchRatio = 1.5;
+      std::shared_ptr<const StretchedClipCache> sut =
+         StretchedClipCache::Create(clip);
+      REQUIRE(sut);
+      std::weak_ptr<const StretchedClipCache> weak = sut;
+      StretchedClipCache::Release(std::move(sut));
+      REQUIRE(!sut);
+      while (!weak.expired())
+         std::this_thread::sleep_for(std::chrono::milliseconds { 1 });
+      SUCCEED();
+   }
+}
+
+TEST_CASE("ClipSegment plays from the StretchedClipCache once ready")
+{
+   const auto direction =
+      GENERATE(PlaybackDirection::forward, PlaybackDirection::backward);
+
+   // Cache rendered from other audio with the same parameters, so that we
+   // can tell which is played.
+   const auto clip =
+      std::make_shared<FloatVectorClip>(sampleRate, Ramp(5, 1.f), 1u);
+   const auto other =
+      std::make_shared<FloatVectorClip>(sampleRate, Ramp(5, -1.f), 1u);
+   auto cache = StretchedClipCache::Create(other);
+   REQUIRE(cache);
+   cache->Wait();
+   clip->stretchedClipCache = cache;
+
+   // Offset of two samples, in seconds.
+   constexpr auto playbackOffset = 2 / static_cast<double>(sampleRate);
+   ClipSegment sut { *clip, playbackOffset, direction };
+   AudioContainer output(5, 1u);
+   REQUIRE(sut.GetFloats(output.channelPointers.data(), 5) == 3);
+   const auto expected = direction == PlaybackDirection::forward ?
+                            std::vector<float> { -3.f, -4.f, -5.f, 0.f, 0.f } :
+                            std::vector<float> { -3.f, -2.f, -1.f, 0.f, 0.f };
+   REQUIRE(output.channelVectors[0] == expected);
+}
+
+TEST_CASE("ClipSegment stretches on from where the cache stops")
+{
+   const auto direction =
+      GENERATE(PlaybackDirection::forward, PlaybackDirection::backward);
+
+   const auto clip =
+      std::make_shared<FloatVectorClip>(sampleRate, Ramp(10, 1.f), 1u);
+   const auto other =
+      std::make_shared<FloatVectorClip>(sampleRate, Ramp(10, -1.f), 1u);
+   auto cache = StretchedClipCache::Create(other);
+   REQUIRE(cache);
+   cache->Wait();
+   clip->stretchedClipCache = cache;
+
+   constexpr auto playbackOffset = 2 / static_cast<double>(sampleRate);
+   ClipSegment sut { *clip, playbackOffset, direction };
+   AudioContainer output(3, 1u);
+   sut.GetFloats(output.channelPointers.data(), 3);
+   const auto forward = direction == PlaybackDirection::forward;
+   REQUIRE(
+      output.channelVectors[0] ==
+      (forward ? std::vector<float> { -3.f, -4.f, -5.f } :
+                 std::vector<float> { -8.f, -7.f, -6.f }));
+
+   // The cache is stale now. The clip needs no stretcher, so the audio must
+   // be the clip's, exactly.
+   REQUIRE(clip->presetChangeCallback);
+   clip->presetChangeCallback(PitchAndSpeedPreset::OptimizeForVoice);
+   sut.GetFloats(output.channelPointers.data(), 3);
+   REQUIRE(
+      output.channelVectors[0] ==
+      (forward ? std::vector<float> { 6.f, 7.f, 8.f } :
+                 std::vector<float> { 5.f, 4.f, 3.f }));
+}
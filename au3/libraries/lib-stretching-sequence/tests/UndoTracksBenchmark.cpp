@@ -0,0 +1,108 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  UndoTracksBenchmark.cpp
+
+**********************************************************************/
+#include "MockSampleBlockFactory.h"
+#include "Project.h"
+#include "TestWaveClipMaker.h"
+#include "UndoManager.h"
+#include "UndoTracks.h"
+#include "WaveTrack.h"
+
+#include <catch2/catch.hpp>
+
+#include <chrono>
+#include <iostream>
+#include <unordered_set>
+#include <vector>
+
+namespace
+{
+// Benchmarks are not meant to be run on CI. Set to `true` to run locally.
+constexpr auto runLocally = false;
+} // namespace
+
+TEST_CASE("UndoTracksBenchmark")
+{
+   // Prints, against the number of tracks, the time it takes to push a state
+   // after moving one clip of one track, and to undo it, and how many clips
+   // the history holds compared with one copy of every clip per state.
+   if (!runLocally)
+      return;
+
+   constexpr auto sampleRate = 44100;
+   constexpr auto numClipsPerTrack = 20;
+   constexpr auto numSamplesPerClip = 10000;
+   constexpr auto numEdits = 100;
+
+   const auto factory = std::make_shared<MockSampleBlockFactory>();
+   const TestWaveClipMaker clipMaker { sampleRate, factory };
+
+   for (const auto numTracks : { 10, 50, 150 })
+   {
+      const auto project = AudacityProject::Create();
+      auto& tracks = TrackList::Get(*project);
+      auto& manager = UndoManager::Get(*project);
+
+      std::vector<WaveTrack*> waveTracks;
+      for (auto i = 0; i < numTracks; ++i)
+      {
+         const auto track =
+            WaveTrack::Create(factory, floatSample, sampleRate);
+         waveTracks.push_back(track.get());
+         for (auto j = 0; j < numClipsPerTrack; ++j)
+            track->InsertInterval(
+               clipMaker.ClipFilledWith(
+                  .5f, numSamplesPerClip, 1,
+                  [j](WaveClip& clip) { clip.SetPlayStartTime(j); }),
+               true);
+         tracks.Add(track);
+      }
+      manager.PushState({}, {});
+
+      using namespace std::chrono;
+      steady_clock::duration pushDuration {};
+      for (auto i = 0; i < numEdits; ++i)
+      {
+         const auto clip = waveTracks[i % numTracks]->GetClip(
+            i / numTracks % numClipsPerTrack);
+         clip->ShiftBy(.001);
+         const auto start = steady_clock::now();
+         manager.PushState({}, {});
+         pushDuration += steady_clock::now() - start;
+      }
+
+      std::unordered_set<const WaveClip*> distinctClips;
+      manager.VisitStates(
+         [&](const UndoStackElem& elem) {
+            for (auto pTrack : UndoTracks::Find(elem)->Any<WaveTrack>())
+               for (size_t i = 0; i < pTrack->NIntervals(); ++i)
+                  distinctClips.insert(pTrack->GetClip(i).get());
+         },
+         true);
+
+      const auto start = steady_clock::now();
+      manager.Undo([&](const UndoStackElem& elem) {
+         for (auto& pExtension : elem.state.extensions)
+            if (pExtension)
+               pExtension->RestoreUndoRedoState(*project);
+      });
+      const auto undoDuration = steady_clock::now() - start;
+
+      std::cout << numTracks << " tracks: push "
+                << duration_cast<microseconds>(pushDuration).count() /
+                      numEdits
+                << "us, undo "
+                << duration_cast<microseconds>(undoDuration).count()
+                << "us, history holds " << distinctClips.size() << " of "
+                << (numEdits + 1) * numTracks * numClipsPerTrack
+                << " clip copies\n";
+
+      manager.ClearStates();
+      tracks.Clear();
+   }
+}
@@ -0,0 +1,171 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  UndoTracksTest.cpp
+
+**********************************************************************/
+#include "MockSampleBlockFactory.h"
+#include "Project.h"
+#include "TempoChange.h"
+#include "TestWaveClipMaker.h"
+#include "UndoManager.h"
+#include "UndoTracks.h"
+#include "WaveTrack.h"
+#include "XMLWriter.h"
+
+#include <catch2/catch.hpp>
+
+namespace
+{
+constexpr auto sampleRate = 44100;
+
+//! The clips of every wave track of a state of the history, in order
+std::vector<WaveClipHolders> GetClips(UndoManager& manager, size_t iState)
+{
+   std::vector<WaveClipHolders> result;
+   manager.VisitStates(
+      [&](const UndoStackElem& elem) {
+         for (auto pTrack : UndoTracks::Find(elem)->Any<WaveTrack>())
+         {
+            auto& clips = result.emplace_back();
+            for (size_t i = 0; i < pTrack->NIntervals(); ++i)
+               clips.push_back(pTrack->GetClip(i));
+         }
+      },
+      iState, iState + 1);
+   return result;
+}
+
+//! Clip state saved with the project, as the clip colour
+struct SavedAttachment final : WaveClipListener
+{
+   std::unique_ptr<WaveClipListener> Clone() const override
+   {
+      return std::make_unique<SavedAttachment>(*this);
+   }
+   void MarkChanged() noexcept override
+   {
+   }
+   void Invalidate() override
+   {
+   }
+   void WriteXMLAttributes(XMLWriter& writer) const override
+   {
+      writer.WriteAttr(wxT("savedvalue"), value);
+   }
+
+   int value = 0;
+};
+
+const WaveClip::Attachments::RegisteredFactory savedAttachmentKey {
+   [](WaveClip&) { return std::make_unique<SavedAttachment>(); }
+};
+
+void Undo(AudacityProject& project)
+{
+   UndoManager::Get(project).Undo([&](const UndoStackElem& elem) {
+      for (auto& pExtension : elem.state.extensions)
+         if (pExtension)
+            pExtension->RestoreUndoRedoState(project);
+   });
+}
+} // namespace
+
+TEST_CASE("UndoTracks")
+{
+   const auto project = AudacityProject::Create();
+   auto& tracks = TrackList::Get(*project);
+   auto& manager = UndoManager::Get(*project);
+   const auto factory = std::make_shared<MockSampleBlockFactory>();
+   const TestWaveClipMaker clipMaker { sampleRate, factory };
+
+   for (auto i = 0; i < 2; ++i)
+   {
+      const auto track = WaveTrack::Create(factory, floatSample, sampleRate);
+      track->InsertInterval(clipMaker.ClipFilledWith(.5f, 100, 1), true);
+      track->InsertInterval(
+         clipMaker.ClipFilledWith(
+            -.5f, 100, 1, [](WaveClip& clip) { clip.SetPlayStartTime(1.); }),
+         true);
+      tracks.Add(track);
+   }
+   manager.PushState({}, {});
+
+   const auto editedClip = (*tracks.Any<WaveTrack>().begin())->GetClip(1);
+   editedClip->SetPlayStartTime(2.);
+   manager.PushState({}, {});
+
+   const auto before = GetClips(manager, 0);
+   const auto after = GetClips(manager, 1);
+   REQUIRE(before.size() == 2);
+   REQUIRE(after.size() == 2);
+
+   SECTION("Unchanged clips are shared between states")
+   {
+      REQUIRE(after[0][0] == before[0][0]);
+      REQUIRE(after[1] == before[1]);
+   }
+
+   SECTION("Changed clips are copied")
+   {
+      REQUIRE(after[0][1] != before[0][1]);
+      REQUIRE(before[0][1]->GetPlayStartTime() == 1.);
+      REQUIRE(after[0][1]->GetPlayStartTime() == 2.);
+   }
+
+   SECTION("Clips with changed saved attachments are copied")
+   {
+      const auto clip = (*tracks.Any<WaveTrack>().begin())->GetClip(0);
+      clip->Attachments::Get<SavedAttachment>(savedAttachmentKey).value = 1;
+      manager.PushState({}, {});
+      const auto latest = GetClips(manager, 2);
+      REQUIRE(latest[0][0] != after[0][0]);
+      REQUIRE(latest[0][1] == after[0][1]);
+      REQUIRE(latest[1] == after[1]);
+   }
+
+   SECTION("Undoing restores copies of the shared clips")
+   {
+      Undo(*project);
+      const auto pTrack = *tracks.Any<WaveTrack>().begin();
+      REQUIRE(pTrack->GetClip(1)->GetPlayStartTime() == 1.);
+      REQUIRE(pTrack->GetClip(0) != before[0][0]);
+
+      // Pushing again after undoing shares with the state restored
+      manager.PushState({}, {});
+      REQUIRE(GetClips(manager, 1) == before);
+   }
+
+   manager.ClearStates();
+   tracks.Clear();
+}
+
+TEST_CASE("UndoTracks with a project tempo")
+{
+   const auto project = AudacityProject::Create();
+   auto& tracks = TrackList::Get(*project);
+   auto& manager = UndoManager::Get(*project);
+   const auto factory = std::make_shared<MockSampleBlockFactory>();
+   const TestWaveClipMaker clipMaker { sampleRate, factory };
+
+   const auto track = WaveTrack::Create(factory, floatSample, sampleRate);
+   DoProjectTempoChange(*track, 120);
+   track->InsertInterval(clipMaker.ClipFilledWith(.5f, 100, 1), true);
+   tracks.Add(track);
+   manager.PushState({}, {});
+   const auto before = GetClips(manager, 0);
+
+   // Applying the tempo again to a shared clip would notify of a stretch
+   auto notified = false;
+   const auto subscription =
+      before[0][0]->Observer::Publisher<StretchRatioChange>::Subscribe(
+         [&](const StretchRatioChange&) { notified = true; });
+   manager.PushState({}, {});
+   REQUIRE(GetClips(manager, 1) == before);
+   REQUIRE(!notified);
+
+   manager.ClearStates();
+   tracks.Clear();
+}
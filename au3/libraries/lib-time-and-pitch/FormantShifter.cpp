@@ -18,13 +18,13 @@
 
 namespace
 {
-// `x` has length `fftSize/2+1`.
+// `x` and `tmp` have length `fftSize/2+1`.
 // Returns the last bin that wasn't zeroed.
-size_t ResampleFreqDomain(float* x, size_t fftSize, double factor)
+size_t
+ResampleFreqDomain(float* x, float* tmp, size_t fftSize, double factor)
 {
    const auto size = fftSize / 2 + 1;
    const auto end = std::min(size, size_t(size * factor));
-   std::vector<float> tmp(end);
    for (size_t i = 0; i < end; ++i)
    {
       const int int_pos = i / factor;
@@ -33,7 +33,7 @@ size_t ResampleFreqDomain(float* x, size_t fftSize, double factor)
       const auto l = MapToPositiveHalfIndex(int_pos + 1, fftSize);
       tmp[i] = (1 - frac_pos) * x[k] + frac_pos * x[l];
    }
-   std::copy(tmp.begin(), tmp.begin() + end, x);
+   std::copy(tmp, tmp + end, x);
    if (end < size)
       std::fill(x + end, x + size, 0.f);
    return end;
@@ -51,25 +51,35 @@ FormantShifter::FormantShifter(
 
 void FormantShifter::Reset(size_t fftSize)
 {
-   mFft = std::make_unique<staffpad::audio::FourierTransform>(
-      static_cast<int32_t>(fftSize));
-   const auto numBins = fftSize / 2 + 1;
-   mEnvelope.setSize(1, numBins);
-   mCepstrum.setSize(1, fftSize);
-   mEnvelopeReal.resize(numBins);
-   mWeights.resize(numBins);
+   // Formant preservation may be toggled while playing: only allocate when
+   // the size changes, so that toggling it back on costs nothing.
+   if (!mFft || mFft->getSize() != static_cast<int32_t>(fftSize))
+   {
+      // Stays disabled if an allocation throws
+      mEnabled = false;
+      mFft = std::make_unique<staffpad::audio::FourierTransform>(
+         static_cast<int32_t>(fftSize));
+      const auto numBins = fftSize / 2 + 1;
+      mEnvelope.setSize(1, numBins);
+      mCepstrum.setSize(1, fftSize);
+      mEnvelopeReal.resize(numBins);
+      mResampled.resize(numBins);
+      mWeights.resize(numBins);
+   }
+   // Only once all is allocated
+   mEnabled = true;
 }
 
 void FormantShifter::Reset()
 {
-   mFft.reset();
+   mEnabled = false;
 }
 
 void FormantShifter::Process(
    const float* powSpec, std::complex<float>* spec, double factor)
 {
    assert(factor > 0);
-   if (factor <= 0 || cutoffQuefrency == 0 || !mFft)
+   if (factor <= 0 || cutoffQuefrency == 0 || !mEnabled)
       return;
 
    const auto fftSize = mFft->getSize();
@@ -112,7 +122,8 @@ void FormantShifter::Process(
       [](float env) { return std::isnormal(env) ? 1.f / env : 0.f; });
 
    const auto lastNonZeroedBin =
-      ResampleFreqDomain(mEnvelopeReal.data(), fftSize, factor);
+      ResampleFreqDomain(
+      mEnvelopeReal.data(), mResampled.data(), fftSize, factor);
 
    mLogger.Log(mEnvelopeReal.data(), numBins, "envelopeResampled");
    std::transform(
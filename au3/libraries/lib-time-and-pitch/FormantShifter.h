@@ -33,7 +33,13 @@ public:
       int sampleRate, double cutoffQuefrency,
       FormantShifterLoggerInterface& logger);
 
+   /*!
+    * \brief Enables processing, allocating all that `Process` needs if
+    * `fftSize` differs from that of the previous call.
+    */
    void Reset(size_t fftSize);
+
+   //! Disables processing, keeping the buffers for a later `Reset(fftSize)`
    void Reset();
 
    /*!
@@ -42,6 +48,7 @@ public:
     *
     * \details "Shifts" the frequency-domain envelope of the input signal.
     * typically used for formant preservation. Tuned to work best with voice.
+    * Does not allocate, and so may be called from the audio thread.
     *
     * \param powerSpectrum The power of `spectrum`, i.e., `powerSpectrum[i] =
     * norm(spectrum[i])`, i.e., the square root was NOT taken.
@@ -63,5 +70,7 @@ private:
    staffpad::SamplesComplex mEnvelope;
    staffpad::SamplesReal mCepstrum;
    std::vector<float> mEnvelopeReal;
+   std::vector<float> mResampled;
    std::vector<float> mWeights;
+   bool mEnabled = false;
 };
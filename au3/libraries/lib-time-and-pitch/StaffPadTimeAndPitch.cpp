@@ -4,9 +4,14 @@
 #include "StaffPad/FourierTransform_pffft.h"
 #include "TimeAndPitchExperimentalSettings.h"
 #include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cmath>
+#include <condition_variable>
+#include <functional>
 #include <memory>
+#include <mutex>
+#include <thread>
 
 namespace
 {
@@ -41,16 +46,16 @@ int GetFftSize(int sampleRate, bool formantPreservationOn)
                   (int)std::round(std::log2(sampleRate / 44100.));
 }
 
+//! @param shifter if not null, processes the spectra when enabled
 std::unique_ptr<staffpad::TimeAndPitch> CreateTimeAndPitch(
-   int sampleRate, size_t numChannels,
-   const TimeAndPitchInterface::Parameters& params, FormantShifter& shifter)
+   int fftSize, size_t numChannels, FormantShifter* shifter)
 {
-   const auto fftSize = GetFftSize(sampleRate, params.preserveFormants);
-   auto shiftTimbreCb = params.preserveFormants && params.pitchRatio != 1. ?
-                           [&](
+   auto shiftTimbreCb = shifter ?
+                           [shifter](
                               double factor, std::complex<float>* spectrum,
                               const float* magnitude) {
-                              shifter.Process(magnitude, spectrum, factor);
+                              if (factor != 1.)
+                                 shifter->Process(magnitude, spectrum, factor);
                            } :
                            staffpad::TimeAndPitch::ShiftTimbreCb {};
    auto timeAndPitch = std::make_unique<staffpad::TimeAndPitch>(
@@ -60,8 +65,6 @@ std::unique_ptr<staffpad::TimeAndPitch> CreateTimeAndPitch(
       std::move(shiftTimbreCb));
 
    timeAndPitch->setup(static_cast<int>(numChannels), maxBlockSize);
-   timeAndPitch->setTimeStretchAndPitchFactor(
-      params.timeRatio, params.pitchRatio);
 
    return timeAndPitch;
 }
@@ -77,24 +80,158 @@ GetFormantShifterLogger(int sampleRate)
 }
 } // namespace
 
+struct StaffPadTimeAndPitch::ChannelGroup
+{
+   ChannelGroup(
+      int sampleRate, size_t firstChannel, size_t numChannels,
+      FormantShifterLoggerInterface* sharedLogger)
+       : firstChannel { firstChannel }
+       , numChannels { numChannels }
+       , ownLogger { sharedLogger ?
+                        nullptr :
+                        std::make_unique<DummyFormantShifterLogger>() }
+       , formantShifter { sampleRate,
+                          TimeAndPitchExperimentalSettings::
+                             GetCutoffQuefrencyOverride()
+                                .value_or(0.002),
+                          sharedLogger ? *sharedLogger : *ownLogger }
+   {
+   }
+
+   const size_t firstChannel;
+   const size_t numChannels;
+   // Only the first group logs.
+   const std::unique_ptr<FormantShifterLoggerInterface> ownLogger;
+   FormantShifter formantShifter;
+   //! Stretchers for the FFT sizes without and with formant preservation, so
+   //! that toggling it does not allocate. The first is null if both sizes are
+   //! the same.
+   std::unique_ptr<staffpad::TimeAndPitch> plainTimeAndPitch;
+   std::unique_ptr<staffpad::TimeAndPitch> formantTimeAndPitch;
+   //! One of the above
+   staffpad::TimeAndPitch* timeAndPitch = nullptr;
+};
+
+/*!
+ * Threads feeding the channel groups in parallel with the calling thread.
+ * They are started with the stretcher, so that a hop allocates nothing and
+ * takes no lock: the caller starts a run by moving a counter, feeds every
+ * group that no worker took, and then spins until the groups that workers are
+ * feeding are done. Workers spin for a moment after a run, as hops often come
+ * back to back, and then sleep until a run wakes them.
+ */
+class StaffPadTimeAndPitch::Workers final
+{
+public:
+   Workers(size_t numTasks, std::function<void(size_t)> task)
+       : mNumTasks { numTasks }
+       , mTask { std::move(task) }
+   {
+      mThreads.reserve(numTasks - 1);
+      for (size_t i = 1; i < numTasks; ++i)
+         mThreads.emplace_back([this] { Loop(); });
+   }
+
+   ~Workers()
+   {
+      {
+         std::lock_guard<std::mutex> lock { mMutex };
+         mQuit = true;
+      }
+      mWake.notify_all();
+      for (auto& thread : mThreads)
+         thread.join();
+   }
+
+   //! Calls the task for every index below the number of tasks, and returns
+   //! when all calls are done
+   void Run()
+   {
+      // All tasks of the previous run are done, so `mNext` is at its end too.
+      const auto end = mEnd.load(std::memory_order_relaxed) + mNumTasks;
+      mEnd.store(end);
+      // Sleeping workers may miss this and wake only at their timeout, but
+      // then this thread feeds their groups.
+      if (mNumSleeping.load() > 0)
+         mWake.notify_all();
+      Work(end);
+      while (mDone.load(std::memory_order_acquire) != end)
+         std::this_thread::yield();
+   }
+
+private:
+   void Loop()
+   {
+      using namespace std::chrono_literals;
+      constexpr auto maxSpins = 1000;
+      size_t end = 0;
+      auto spins = 0;
+      while (true)
+      {
+         if (const auto newEnd = mEnd.load(); newEnd != end)
+         {
+            Work(end = newEnd);
+            spins = 0;
+         }
+         else if (++spins < maxSpins)
+            std::this_thread::yield();
+         else
+         {
+            std::unique_lock<std::mutex> lock { mMutex };
+            ++mNumSleeping;
+            mWake.wait_for(lock, 100ms, [&] {
+               return mQuit || mEnd.load() != end;
+            });
+            --mNumSleeping;
+            if (mQuit)
+               return;
+            spins = 0;
+         }
+      }
+   }
+
+   //! Calls the task for indices not taken yet, as long as they are below
+   //! `end`, counting over all runs
+   void Work(size_t end)
+   {
+      auto i = mNext.load();
+      while (i < end)
+         if (mNext.compare_exchange_weak(i, i + 1))
+         {
+            mTask(i + mNumTasks - end);
+            mDone.fetch_add(1, std::memory_order_release);
+            i = mNext.load();
+         }
+   }
+
+   const size_t mNumTasks;
+   const std::function<void(size_t)> mTask;
+   std::atomic<size_t> mEnd { 0 };
+   std::atomic<size_t> mNext { 0 };
+   std::atomic<size_t> mDone { 0 };
+   std::atomic<size_t> mNumSleeping { 0 };
+   //! Only for workers to sleep
+   std::mutex mMutex;
+   std::condition_variable mWake;
+   bool mQuit = false;
+   std::vector<std::thread> mThreads;
+};
+
 StaffPadTimeAndPitch::StaffPadTimeAndPitch(
    int sampleRate, size_t numChannels, TimeAndPitchSource& audioSource,
    const Parameters& parameters)
-    : mSampleRate(sampleRate)
-    , mParameters(parameters)
+    : mParameters(parameters)
     , mFormantShifterLogger(GetFormantShifterLogger(sampleRate))
-    , mFormantShifter(
-         sampleRate,
-         TimeAndPitchExperimentalSettings::GetCutoffQuefrencyOverride()
-            .value_or(0.002),
-         *mFormantShifterLogger)
     , mAudioSource(audioSource)
     , mReadBuffer(maxBlockSize, numChannels)
     , mNumChannels(numChannels)
+    , mFftSize(GetFftSize(sampleRate, false))
+    , mFormantFftSize(GetFftSize(sampleRate, true))
 {
-   if (mParameters.preserveFormants)
-      mFormantShifter.Reset(
-         GetFftSize(sampleRate, parameters.preserveFormants));
+   for (size_t first = 0; first < numChannels; first += 2)
+      mGroups.push_back(std::make_unique<ChannelGroup>(
+         sampleRate, first, std::min<size_t>(2, numChannels - first),
+         first == 0 ? mFormantShifterLogger.get() : nullptr));
    if (
       !TimeAndPitchInterface::IsPassThroughMode(mParameters.timeRatio) ||
       // No need for sophisticated comparison for pitch ratio, as our UI doesn't
@@ -103,6 +240,8 @@ StaffPadTimeAndPitch::StaffPadTimeAndPitch(
       InitializeStretcher();
 }
 
+StaffPadTimeAndPitch::~StaffPadTimeAndPitch() = default;
+
 void StaffPadTimeAndPitch::GetSamples(float* const* output, size_t outputLen)
 {
    if (!mTimeAndPitch)
@@ -129,7 +268,7 @@ void StaffPadTimeAndPitch::GetSamples(float* const* output, size_t outputLen)
             const auto numSamplesToFeed = std::min(numRequired, maxBlockSize);
             mAudioSource.Pull(mReadBuffer.Get(), numSamplesToFeed);
             mFormantShifterLogger->NewSamplesComing(numSamplesToFeed);
-            mTimeAndPitch->feedAudio(mReadBuffer.Get(), numSamplesToFeed);
+            FeedAudio(mReadBuffer.Get(), numSamplesToFeed);
             numRequired -= numSamplesToFeed;
          }
          numOutputSamplesAvailable =
@@ -140,17 +279,48 @@ void StaffPadTimeAndPitch::GetSamples(float* const* output, size_t outputLen)
          const auto numSamplesToGet =
             std::min({ maxBlockSize, numOutputSamplesAvailable,
                        static_cast<int>(outputLen - numOutputSamples) });
-         // More-than-stereo isn't supported
-         assert(mNumChannels <= 2);
-         float* buffer[2] {};
-         GetOffsetBuffer(buffer, output, mNumChannels, numOutputSamples);
-         mTimeAndPitch->retrieveAudio(buffer, numSamplesToGet);
+         RetrieveAudio(output, numOutputSamples, numSamplesToGet);
          numOutputSamplesAvailable -= numSamplesToGet;
          numOutputSamples += numSamplesToGet;
       }
    }
 }
 
+void StaffPadTimeAndPitch::FeedAudio(float* const* input, int numSamples)
+{
+   mFeedInput = input;
+   mFeedNumSamples = numSamples;
+   if (mWorkers)
+      mWorkers->Run();
+   else
+      FeedGroup(0);
+}
+
+void StaffPadTimeAndPitch::FeedGroup(size_t iGroup)
+{
+   auto& group = *mGroups[iGroup];
+   group.timeAndPitch->feedAudio(
+      mFeedInput + group.firstChannel, mFeedNumSamples);
+}
+
+void StaffPadTimeAndPitch::RetrieveAudio(
+   float* const* output, size_t offset, int numSamples)
+{
+   // All groups are fed the same number of samples with the same parameters,
+   // so they have the same number of samples available.
+   [[maybe_unused]] const auto numAvailable =
+      mTimeAndPitch->getNumAvailableOutputSamples();
+   for (auto& group : mGroups)
+   {
+      assert(
+         group->timeAndPitch->getNumAvailableOutputSamples() == numAvailable);
+      float* buffer[2] {};
+      GetOffsetBuffer(
+         buffer, output + group->firstChannel, group->numChannels, offset);
+      group->timeAndPitch->retrieveAudio(buffer, numSamples);
+   }
+}
+
 void StaffPadTimeAndPitch::OnCentShiftChange(int cents)
 {
    mParameters.pitchRatio = std::pow(2., cents / 1200.);
@@ -160,29 +330,71 @@ void StaffPadTimeAndPitch::OnCentShiftChange(int cents)
    if (!mTimeAndPitch)
       InitializeStretcher();
    else
-      mTimeAndPitch->setTimeStretchAndPitchFactor(
-         mParameters.timeRatio, mParameters.pitchRatio);
+      for (auto& group : mGroups)
+         group->timeAndPitch->setTimeStretchAndPitchFactor(
+            mParameters.timeRatio, mParameters.pitchRatio);
 }
 
 void StaffPadTimeAndPitch::OnFormantPreservationChange(bool preserve)
 {
    mParameters.preserveFormants = preserve;
-   const auto fftSize = GetFftSize(mSampleRate, preserve);
-   preserve ? mFormantShifter.Reset(fftSize) : mFormantShifter.Reset();
-   // FFT size is a constant of the stretcher, so we need to reset it - if there
-   // is a stretcher.
+   // FFT size is a constant of the stretcher, so we need to switch to the
+   // other one - if there is a stretcher. It is allocated already, as this is
+   // called from the audio thread.
    if (mTimeAndPitch)
-      InitializeStretcher();
+      ActivateStretcher();
+}
+
+void StaffPadTimeAndPitch::Restart()
+{
+   // In pass-through mode, there is nothing buffered.
+   if (mTimeAndPitch)
+      ActivateStretcher();
 }
 
 void StaffPadTimeAndPitch::InitializeStretcher()
 {
-   mTimeAndPitch = CreateTimeAndPitch(
-      mSampleRate, mNumChannels, mParameters, mFormantShifter);
+   for (auto& group : mGroups)
+   {
+      // Allocate the shifter even if not preserving formants yet
+      group->formantShifter.Reset(mFormantFftSize);
+      group->formantTimeAndPitch = CreateTimeAndPitch(
+         mFormantFftSize, group->numChannels, &group->formantShifter);
+      if (mFftSize != mFormantFftSize)
+         group->plainTimeAndPitch =
+            CreateTimeAndPitch(mFftSize, group->numChannels, nullptr);
+   }
+   if (mGroups.size() > 1 && !mWorkers)
+      mWorkers = std::make_unique<Workers>(
+         mGroups.size(), [this](size_t iGroup) { FeedGroup(iGroup); });
+   ActivateStretcher();
+}
+
+void StaffPadTimeAndPitch::ActivateStretcher()
+{
+   for (auto& group : mGroups)
+   {
+      auto& timeAndPitch =
+         mParameters.preserveFormants || !group->plainTimeAndPitch ?
+            group->formantTimeAndPitch :
+            group->plainTimeAndPitch;
+      timeAndPitch->reset();
+      timeAndPitch->setTimeStretchAndPitchFactor(
+         mParameters.timeRatio, mParameters.pitchRatio);
+      group->timeAndPitch = timeAndPitch.get();
+      if (mParameters.preserveFormants)
+         group->formantShifter.Reset(mFormantFftSize);
+      else
+         group->formantShifter.Reset();
+   }
+   mTimeAndPitch = mGroups.front()->timeAndPitch;
+
+   // Prime the stretcher, reading through mReadBuffer, which is free between
+   // calls to GetSamples()
    auto numOutputSamplesToDiscard =
       mTimeAndPitch->getLatencySamplesForStretchRatio(
          mParameters.timeRatio * mParameters.pitchRatio);
-   AudioContainer container(maxBlockSize, mNumChannels);
+   const auto buffer = mReadBuffer.Get();
    while (numOutputSamplesToDiscard > 0)
    {
       if (IllState())
@@ -191,8 +403,8 @@ void StaffPadTimeAndPitch::InitializeStretcher()
       while (numRequired > 0)
       {
          const auto numSamplesToFeed = std::min(maxBlockSize, numRequired);
-         mAudioSource.Pull(container.Get(), numSamplesToFeed);
-         mTimeAndPitch->feedAudio(container.Get(), numSamplesToFeed);
+         mAudioSource.Pull(buffer, numSamplesToFeed);
+         FeedAudio(buffer, numSamplesToFeed);
          numRequired -= numSamplesToFeed;
       }
       const auto totalNumSamplesToRetrieve = std::min(
@@ -203,7 +415,7 @@ void StaffPadTimeAndPitch::InitializeStretcher()
       {
          const auto numSamplesToRetrieve = std::min(
             maxBlockSize, totalNumSamplesToRetrieve - totalNumRetrievedSamples);
-         mTimeAndPitch->retrieveAudio(container.Get(), numSamplesToRetrieve);
+         RetrieveAudio(buffer, 0, numSamplesToRetrieve);
          totalNumRetrievedSamples += numSamplesToRetrieve;
       }
       numOutputSamplesToDiscard -= totalNumSamplesToRetrieve;
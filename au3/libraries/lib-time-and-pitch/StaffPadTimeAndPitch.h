@@ -4,6 +4,9 @@
 #include "StaffPad/TimeAndPitch.h"
 #include "TimeAndPitchInterface.h"
 
+#include <memory>
+#include <vector>
+
 class TIME_AND_PITCH_API StaffPadTimeAndPitch final :
     public TimeAndPitchInterface
 {
@@ -11,20 +14,44 @@ public:
    StaffPadTimeAndPitch(
       int sampleRate, size_t numChannels, TimeAndPitchSource&,
       const Parameters&);
+   ~StaffPadTimeAndPitch() override;
    void GetSamples(float* const*, size_t) override;
    void OnCentShiftChange(int cents) override;
    void OnFormantPreservationChange(bool preserve) override;
+   void Restart() override;
 
 private:
+   /*!
+    * The StaffPad stretcher handles up to two channels, sharing the phase
+    * analysis between them. More channels are processed in groups of two, each
+    * with its own stretcher, fed in parallel.
+    */
+   struct ChannelGroup;
+   class Workers;
+
    bool IllState() const;
+   //! Allocates, then activates
    void InitializeStretcher();
+   //! Resets and primes the stretcher for the current parameters, without
+   //! allocating
+   void ActivateStretcher();
+   void FeedAudio(float* const* input, int numSamples);
+   void FeedGroup(size_t iGroup);
+   void RetrieveAudio(float* const* output, size_t offset, int numSamples);
 
-   const int mSampleRate;
    const std::unique_ptr<FormantShifterLoggerInterface> mFormantShifterLogger;
    TimeAndPitchInterface::Parameters mParameters;
-   FormantShifter mFormantShifter;
-   std::unique_ptr<staffpad::TimeAndPitch> mTimeAndPitch;
+   std::vector<std::unique_ptr<ChannelGroup>> mGroups;
+   //! Null in pass-through mode
+   staffpad::TimeAndPitch* mTimeAndPitch = nullptr;
    TimeAndPitchSource& mAudioSource;
    AudioContainer mReadBuffer;
    const size_t mNumChannels;
+   //! FFT sizes without and with formant preservation
+   const int mFftSize;
+   const int mFormantFftSize;
+   //! Only with more than one group
+   std::unique_ptr<Workers> mWorkers;
+   float* const* mFeedInput = nullptr;
+   int mFeedNumSamples = 0;
 };
@@ -43,6 +43,9 @@ public:
    virtual void GetSamples(float* const*, size_t) = 0;
    virtual void OnCentShiftChange(int cents) = 0;
    virtual void OnFormantPreservationChange(bool preserve) = 0;
+   //! Drops the audio taken from the source so far and goes on from where the
+   //! source is now, as a new stretcher would, without allocating.
+   virtual void Restart() = 0;
 
    virtual ~TimeAndPitchInterface();
 };
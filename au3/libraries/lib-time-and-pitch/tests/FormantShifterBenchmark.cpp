@@ -0,0 +1,90 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  FormantShifterBenchmark.cpp
+
+**********************************************************************/
+#include "DummyFormantShifterLogger.h"
+#include "FormantShifter.h"
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <complex>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <vector>
+
+namespace
+{
+// Benchmarks are not meant to be run on CI. Set to `true` to run locally.
+constexpr auto runLocally = false;
+} // namespace
+
+TEST_CASE("FormantShifterBenchmark")
+{
+   // `FormantShifter::Process` runs once per hop on the audio thread. Prints
+   // the mean, 99.9th-percentile and worst per-hop cost, and how the latter
+   // compare with the duration of a hop, i.e., the deadline the audio thread
+   // has. The worst case also includes the preemptions by the OS, hence the
+   // percentile.
+   if (!runLocally)
+      return;
+
+   constexpr auto sampleRate = 44100;
+   constexpr size_t fftSize = 2048;
+   // StaffPad's TimeAndPitch hops a quarter of the FFT size.
+   constexpr auto hopDuration = fftSize / 4. / sampleRate;
+   constexpr auto numBins = fftSize / 2 + 1;
+   constexpr auto numHops = 100000;
+
+   DummyFormantShifterLogger logger;
+   FormantShifter sut { sampleRate, .002, logger };
+   sut.Reset(fftSize);
+
+   std::mt19937 gen { 0 };
+   std::uniform_real_distribution<float> noise { -1.f, 1.f };
+   std::vector<std::complex<float>> input(numBins);
+   std::vector<float> power(numBins);
+   for (auto i = 0u; i < numBins; ++i)
+   {
+      input[i] = { noise(gen), noise(gen) };
+      power[i] = std::norm(input[i]);
+   }
+
+   std::vector<std::complex<float>> spectrum(numBins);
+   std::vector<double> durations(numHops);
+   for (const auto factor : { .5, .8, 1.25, 2. })
+   {
+      for (auto i = 0; i < numHops; ++i)
+      {
+         std::copy(input.begin(), input.end(), spectrum.begin());
+         // Toggling formant preservation from the audio thread must not cost
+         // anything either.
+         if (i % 1000 == 0)
+         {
+            sut.Reset();
+            sut.Reset(fftSize);
+         }
+         const auto start = std::chrono::steady_clock::now();
+         sut.Process(power.data(), spectrum.data(), factor);
+         const std::chrono::duration<double> elapsed =
+            std::chrono::steady_clock::now() - start;
+         durations[i] = elapsed.count();
+      }
+      const auto mean =
+         std::accumulate(durations.begin(), durations.end(), 0.) / numHops;
+      const auto percentile = durations.begin() + numHops * 999 / 1000;
+      std::nth_element(durations.begin(), percentile, durations.end());
+      const auto worst = *std::max_element(percentile, durations.end());
+      std::cout << "factor " << factor << ": mean " << mean * 1e6
+                << "us, 99.9% " << *percentile * 1e6 << "us ("
+                << 100 * *percentile / hopDuration << "% of a hop), worst "
+                << worst * 1e6 << "us (" << 100 * worst / hopDuration
+                << "% of a hop)\n";
+   }
+}
@@ -0,0 +1,67 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  FormantShifterTest.cpp
+
+**********************************************************************/
+#include "DummyFormantShifterLogger.h"
+#include "FormantShifter.h"
+
+#include <catch2/catch.hpp>
+
+#include <complex>
+#include <random>
+#include <vector>
+
+TEST_CASE("FormantShifter")
+{
+   constexpr auto sampleRate = 44100;
+   constexpr size_t fftSize = 2048;
+   constexpr auto numBins = fftSize / 2 + 1;
+   constexpr auto factor = 1.25;
+
+   std::mt19937 gen { 0 };
+   std::uniform_real_distribution<float> noise { -1.f, 1.f };
+   std::vector<std::complex<float>> input(numBins);
+   std::vector<float> power(numBins);
+   for (auto i = 0u; i < numBins; ++i)
+   {
+      input[i] = { noise(gen), noise(gen) };
+      power[i] = std::norm(input[i]);
+   }
+
+   DummyFormantShifterLogger logger;
+   FormantShifter sut { sampleRate, .002, logger };
+
+   SECTION("Does nothing until reset with an FFT size")
+   {
+      auto spectrum = input;
+      sut.Process(power.data(), spectrum.data(), factor);
+      REQUIRE(spectrum == input);
+   }
+
+   SECTION("Does nothing after reset without an FFT size")
+   {
+      sut.Reset(fftSize);
+      sut.Reset();
+      auto spectrum = input;
+      sut.Process(power.data(), spectrum.data(), factor);
+      REQUIRE(spectrum == input);
+   }
+
+   SECTION("Re-enabling gives the same output as when first enabled")
+   {
+      sut.Reset(fftSize);
+      auto expected = input;
+      sut.Process(power.data(), expected.data(), factor);
+      REQUIRE(expected != input);
+
+      sut.Reset();
+      sut.Reset(fftSize);
+      auto spectrum = input;
+      sut.Process(power.data(), spectrum.data(), factor);
+      REQUIRE(spectrum == expected);
+   }
+}
@@ -0,0 +1,70 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  StaffPadTimeAndPitchBenchmark.cpp
+
+**********************************************************************/
+#include "AudioContainer.h"
+#include "MockedPrefs.h"
+#include "StaffPadTimeAndPitch.h"
+#include "TimeAndPitchRealSource.h"
+
+#include <catch2/catch.hpp>
+
+#include <chrono>
+#include <iostream>
+#include <random>
+
+namespace
+{
+// Benchmarks are not meant to be run on CI. Set to `true` to run locally.
+constexpr auto runLocally = false;
+} // namespace
+
+TEST_CASE("StaffPadTimeAndPitchBenchmark")
+{
+   // Prints the real-time factor, i.e., how many seconds of audio are produced
+   // per second of computation, when stretching and pitch-shifting through
+   // `TimeAndPitchInterface` with increasing channel counts.
+   if (!runLocally)
+      return;
+
+   MockedPrefs mockedPrefs;
+   constexpr auto sampleRate = 44100;
+   constexpr auto outputDuration = 20;
+   constexpr size_t blockSize = 512;
+   const auto numOutputFrames = static_cast<size_t>(outputDuration * sampleRate);
+
+   TimeAndPitchInterface::Parameters params;
+   params.timeRatio = 1.25;
+   params.pitchRatio = 1.1;
+
+   std::mt19937 gen { 0 };
+   std::uniform_real_distribution<float> noise { -.5f, .5f };
+
+   for (const auto numChannels : { 1u, 2u, 4u, 6u, 8u })
+   {
+      std::vector<std::vector<float>> input(numChannels);
+      for (auto& channel : input)
+      {
+         channel.resize(numOutputFrames);
+         for (auto& sample : channel)
+            sample = noise(gen);
+      }
+      TimeAndPitchRealSource src(input);
+      StaffPadTimeAndPitch stretcher(sampleRate, numChannels, src, params);
+      TimeAndPitchInterface& sut = stretcher;
+      AudioContainer output(blockSize, numChannels);
+
+      const auto start = std::chrono::steady_clock::now();
+      for (size_t offset = 0; offset < numOutputFrames; offset += blockSize)
+         sut.GetSamples(output.Get(), blockSize);
+      const std::chrono::duration<double> elapsed =
+         std::chrono::steady_clock::now() - start;
+
+      std::cout << numChannels << " channel(s): real-time factor "
+                << outputDuration / elapsed.count() << "\n";
+   }
+}
@@ -17,9 +17,47 @@
 
 #include <catch2/catch.hpp>
 
+#include <algorithm>
+#include <random>
+#include <thread>
+
 using namespace std::literals::string_literals;
 using namespace std::literals::chrono_literals;
 
+namespace
+{
+constexpr auto sampleRate = 44100;
+constexpr auto numChannels = 2u;
+constexpr size_t numFrames = 10000;
+
+std::vector<std::vector<float>> Noise(size_t nChannels, size_t length)
+{
+   std::mt19937 gen { 0 };
+   std::uniform_real_distribution<float> noise { -1.f, 1.f };
+   std::vector<std::vector<float>> result(
+      nChannels, std::vector<float>(length));
+   for (auto& channel : result)
+      std::generate(channel.begin(), channel.end(), [&] { return noise(gen); });
+   return result;
+}
+
+//! The first `numOutputFrames` frames of a new stretcher fed `input` from
+//! `firstFrame` on
+std::vector<std::vector<float>> StretchFrom(
+   const std::vector<std::vector<float>>& input, size_t firstFrame,
+   const TimeAndPitchInterface::Parameters& params, size_t numOutputFrames)
+{
+   std::vector<std::vector<float>> rest;
+   for (const auto& channel : input)
+      rest.emplace_back(channel.begin() + firstFrame, channel.end());
+   TimeAndPitchRealSource src(rest);
+   StaffPadTimeAndPitch sut(sampleRate, rest.size(), src, params);
+   AudioContainer output(numOutputFrames, rest.size());
+   sut.GetSamples(output.Get(), numOutputFrames);
+   return output.channelVectors;
+}
+} // namespace
+
 TEST_CASE("StaffPadTimeAndPitch")
 {
    MockedPrefs mockedPrefs;
@@ -116,6 +154,120 @@ TEST_CASE("StaffPadTimeAndPitch")
       REQUIRE(outputEqualsInput);
    }
 
+   SECTION("More than two channels are stretched in pairs")
+   {
+      // Channels 2 and 3 are copies of 0 and 1, and must come out as such,
+      // stretched exactly like a stereo signal would be.
+      const auto inputPath = std::string(CMAKE_SOURCE_DIR) +
+                             "/tests/samples/FifeAndDrumsStereo.wav";
+      std::vector<std::vector<float>> stereoInput;
+      AudioFileInfo info;
+      REQUIRE(WavFileIO::Read(inputPath, stereoInput, info, 1s));
+      REQUIRE(info.numChannels == 2);
+      auto quadInput = stereoInput;
+      quadInput.insert(quadInput.end(), stereoInput.begin(), stereoInput.end());
+
+      TimeAndPitchInterface::Parameters params;
+      params.timeRatio = 1.5;
+      params.pitchRatio = 1.25;
+      const auto numOutputFrames = static_cast<size_t>(info.numFrames * 1.5);
+
+      AudioContainer stereoOutput(numOutputFrames, 2);
+      TimeAndPitchRealSource stereoSrc(stereoInput);
+      StaffPadTimeAndPitch stereoSut(info.sampleRate, 2, stereoSrc, params);
+      stereoSut.GetSamples(stereoOutput.Get(), numOutputFrames);
+
+      AudioContainer quadOutput(numOutputFrames, 4);
+      TimeAndPitchRealSource quadSrc(quadInput);
+      StaffPadTimeAndPitch quadSut(info.sampleRate, 4, quadSrc, params);
+      quadSut.GetSamples(quadOutput.Get(), numOutputFrames);
+
+      for (auto i = 0u; i < 4u; ++i)
+      {
+         const auto asStereo =
+            quadOutput.channelVectors[i] == stereoOutput.channelVectors[i % 2];
+         REQUIRE(asStereo);
+      }
+   }
+
+   SECTION("Channel groups come out right over many short reads")
+   {
+      // Workers take turns with the calling thread over many runs, and sleep
+      // between some of them.
+      const auto stereoInput = Noise(2, sampleRate);
+      std::vector<std::vector<float>> hexInput;
+      for (auto i = 0; i < 3; ++i)
+         hexInput.insert(
+            hexInput.end(), stereoInput.begin(), stereoInput.end());
+      TimeAndPitchInterface::Parameters params;
+      params.timeRatio = 1.5;
+      params.pitchRatio = 1.25;
+      TimeAndPitchRealSource src(hexInput);
+      StaffPadTimeAndPitch sut(sampleRate, 6, src, params);
+      AudioContainer output(numFrames, 6);
+      constexpr size_t blockSize = 100;
+      for (size_t offset = 0; offset < numFrames; offset += blockSize)
+      {
+         float* block[6];
+         for (auto i = 0u; i < 6u; ++i)
+            block[i] = output.channelVectors[i].data() + offset;
+         sut.GetSamples(block, std::min(blockSize, numFrames - offset));
+         if (offset % (50 * blockSize) == 0)
+            std::this_thread::sleep_for(5ms);
+      }
+
+      const auto expected = StretchFrom(stereoInput, 0, params, numFrames);
+      for (auto i = 0u; i < 6u; ++i)
+      {
+         const auto asStereo = output.channelVectors[i] == expected[i % 2];
+         REQUIRE(asStereo);
+      }
+   }
+
+   SECTION("Toggling formant preservation restarts as a new stretcher would")
+   {
+      // The stretcher for the new FFT size is allocated beforehand and only
+      // reset, which must not make a difference.
+      const auto input = Noise(numChannels, sampleRate);
+      const auto preserve = GENERATE(true, false);
+      TimeAndPitchInterface::Parameters params;
+      params.pitchRatio = 1.25;
+      params.preserveFormants = !preserve;
+      TimeAndPitchRealSource src(input);
+      StaffPadTimeAndPitch sut(sampleRate, numChannels, src, params);
+      AudioContainer output(numFrames, numChannels);
+      sut.GetSamples(output.Get(), numFrames);
+      const auto numPulledFrames = src.GetNumPulledFrames();
+      sut.OnFormantPreservationChange(preserve);
+      sut.GetSamples(output.Get(), numFrames);
+
+      params.preserveFormants = preserve;
+      const auto outputEqualsExpected =
+         output.channelVectors ==
+         StretchFrom(input, numPulledFrames, params, numFrames);
+      REQUIRE(outputEqualsExpected);
+   }
+
+   SECTION("Restarting goes on from the source as a new stretcher would")
+   {
+      const auto input = Noise(numChannels, sampleRate);
+      TimeAndPitchInterface::Parameters params;
+      params.timeRatio = 1.5;
+      params.pitchRatio = 1.25;
+      TimeAndPitchRealSource src(input);
+      StaffPadTimeAndPitch sut(sampleRate, numChannels, src, params);
+      AudioContainer output(numFrames, numChannels);
+      sut.GetSamples(output.Get(), numFrames);
+      const auto numPulledFrames = src.GetNumPulledFrames();
+      sut.Restart();
+      sut.GetSamples(output.Get(), numFrames);
+
+      const auto outputEqualsExpected =
+         output.channelVectors ==
+         StretchFrom(input, numPulledFrames, params, numFrames);
+      REQUIRE(outputEqualsExpected);
+   }
+
    SECTION("Extreme stretch ratios")
    {
       constexpr auto originalDuration = 60.;      // 1 minute
@@ -42,6 +42,11 @@ public:
       mNumPulledFrames += framesToRead;
    }
 
+   unsigned long long GetNumPulledFrames() const
+   {
+      return mNumPulledFrames;
+   }
+
 private:
    const std::vector<std::vector<float>>& mInput;
    unsigned long long mNumPulledFrames = 0u;
@@ -114,6 +114,11 @@ auto Track::Duplicate(DuplicateOptions options) const -> Holder
    return result;
 }
 
+auto Track::DuplicateSharing(const Track &) const -> Holder
+{
+   return Duplicate();
+}
+
 Track::~Track()
 {
 }
@@ -295,6 +295,14 @@ private:
    //! public nonvirtual duplication function that invokes Clone()
    virtual Holder Duplicate(DuplicateOptions = {}) const;
 
+   //! Duplication for the undo history, which modifies neither the copy nor
+   //! `previous`, an earlier copy of this track made the same way
+   /*!
+    The copy may share with `previous` those parts of the track that did not
+    change since.  Default implementation just duplicates.
+    */
+   virtual Holder DuplicateSharing(const Track &previous) const;
+
    void ReparentAllAttachments();
 
    //! Name is always the same for all channels of a group
@@ -14,15 +14,37 @@
 
 // Undo/redo handling of selection changes
 namespace {
+//! The tracks of the current undo state, which the project's tracks were
+//! pushed as or restored from, if there is such a state
+TrackList *FindCurrentTracks(AudacityProject &project)
+{
+   auto &manager = UndoManager::Get(project);
+   const auto current = manager.GetCurrentState();
+   if (current >= manager.GetNumStates())
+      return nullptr;
+   TrackList *result = nullptr;
+   manager.VisitStates([&](const UndoStackElem &elem){
+      result = UndoTracks::Find(elem);
+   }, current, current + 1);
+   return result;
+}
+
 struct TrackListRestorer final : UndoStateExtension {
    TrackListRestorer(AudacityProject &project)
       : mpTracks{ TrackList::Create(nullptr) }
    {
+      // Tracks of undo states are never modified, so those of the current
+      // state can share their unchanged parts with the new state
+      const auto pPrevious = FindCurrentTracks(project);
       for (auto pTrack : TrackList::Get(project)) {
          if (pTrack->GetId() == TrackId{})
             // Don't copy a pending added track
             continue;
-         mpTracks->Add(pTrack->Duplicate());
+         const auto pPreviousTrack =
+            pPrevious ? pPrevious->FindById(pTrack->GetId()) : nullptr;
+         mpTracks->Add(pPreviousTrack
+            ? pTrack->DuplicateSharing(*pPreviousTrack)
+            : pTrack->Duplicate());
       }
    }
    void RestoreUndoRedoState(AudacityProject &project) override {
@@ -10,6 +10,7 @@
 **********************************************************************/
 #pragma once
 
+#include <algorithm>
 #include <cstdint>
 
 /*!
@@ -44,3 +45,38 @@ constexpr float FastLog2(float x)
    return log_2;
 }
 static constexpr float log2ToDb = 20 / 3.321928094887362f;
+static constexpr float dbToLog2 = 1 / log2ToDb;
+
+/*!
+ * @brief Approximates 2 to the power of x, to about the precision of a float,
+ * in a form that compilers can vectorize
+ *
+ * @details Splits x in an integer part, which goes to the exponent bits, and a
+ * fractional part in [0, 1], for which a fifth-order polynomial (least-squares
+ * fit of the relative error) gives the mantissa. The relative error is below
+ * 3e-7 ; see MathApproxTest.cpp. x is clamped to [-126, 126], so that the
+ * result is always a normal number.
+ */
+constexpr float FastExp2(float x)
+{
+   static_assert(sizeof(float) == sizeof(int32_t));
+   x = std::min(std::max(x, -126.f), 126.f);
+   // Truncation rounds toward zero: go one down for negative numbers, which
+   // gives a fractional part of 1 rather than 0 for negative integers, still
+   // in the range of the polynomial.
+   const auto exponent = static_cast<int32_t>(x) - (x < 0 ? 1 : 0);
+   const auto f = x - static_cast<float>(exponent);
+   union
+   {
+      float val;
+      int32_t x;
+   } u = { ((((0.001876234363f * f + 0.008992594112f) * f + 0.05582358157f) *
+                f +
+             0.2401545448f) *
+               f +
+            0.6931529648f) *
+              f +
+           0.9999999271f };
+   u.x += exponent * (1 << 23);
+   return u.val;
+}
@@ -11,6 +11,7 @@
 
 #include "MathApprox.h"
 #include <catch2/catch.hpp>
+#include <cmath>
 #include <numeric>
 
 TEST_CASE("FastLog2")
@@ -47,3 +48,22 @@ TEST_CASE("FastLog2")
    const auto maxError = *std::max_element(error.begin(), error.end());
    REQUIRE(maxError < 1e-2);
 }
+
+TEST_CASE("FastExp2")
+{
+   // Covers the range of gains in dB that dynamic-range processors use, and
+   // the integer exponents, where the fractional part wraps around.
+   auto maxRelativeError = 0.;
+   for (auto x = -120.f; x <= 120.f; x += 0.01f)
+   {
+      const auto expected = std::exp2(static_cast<double>(x));
+      const auto actual = static_cast<double>(FastExp2(x));
+      maxRelativeError =
+         std::max(maxRelativeError, std::abs(actual / expected - 1));
+   }
+   for (auto i = -126; i <= 126; ++i)
+      REQUIRE(FastExp2(i) == Approx(std::exp2(i)).epsilon(1e-6));
+   REQUIRE(maxRelativeError < 3e-7);
+   REQUIRE(FastExp2(-1000.f) > 0.f);
+   REQUIRE(std::isfinite(FastExp2(1000.f)));
+}
@@ -0,0 +1,519 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  SpectrogramTileCache.cpp
+
+**********************************************************************/
+#include "SpectrogramTileCache.h"
+
+#include "FFT.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <future>
+#include <numeric>
+
+using namespace audacity::concurrency;
+
+struct SpectrogramTileCache::Entry
+{
+   Entry(TileIndex tileIndex)
+       : tileIndex { tileIndex }
+       , future { promise.get_future().share() }
+   {
+   }
+
+   const TileIndex tileIndex;
+   std::promise<TilePtr> promise;
+   const std::shared_future<TilePtr> future;
+
+   // Guarded by mMutex
+   bool started = false;
+   TilePtr tile;
+   unsigned long long lastUse = 0;
+};
+
+//! Lets the tasks queued in the pool find whether the cache still exists, and
+//! the cache wait for those that started
+struct SpectrogramTileCache::Tasks
+{
+   std::mutex mutex;
+   std::condition_variable ended;
+   SpectrogramTileCache* cache = nullptr;
+   size_t numRunning = 0;
+
+   void Run()
+   {
+      {
+         std::lock_guard<std::mutex> lock { mutex };
+         if (!cache)
+            return;
+         ++numRunning;
+      }
+      cache->ComputeNewest();
+      std::lock_guard<std::mutex> lock { mutex };
+      --numRunning;
+      ended.notify_all();
+   }
+};
+
+bool SpectrogramTileKey::operator==(const SpectrogramTileKey& other) const
+{
+   return contentHash == other.contentHash && windowType == other.windowType &&
+          windowSize == other.windowSize && fftSize == other.fftSize &&
+          hop == other.hop;
+}
+
+bool SpectrogramTileKey::operator!=(const SpectrogramTileKey& other) const
+{
+   return !(*this == other);
+}
+
+std::string SpectrogramTileKey::ToString() const
+{
+   char buffer[128];
+   std::snprintf(
+      buffer, sizeof(buffer), "spectrogram-%016llx-%d-%zu-%zu-%zu",
+      static_cast<unsigned long long>(contentHash), windowType, windowSize,
+      fftSize, hop);
+   return buffer;
+}
+
+SpectrogramTileSource::~SpectrogramTileSource() = default;
+
+SpectrogramTileCache::SpectrogramTileCache(
+   const SpectrogramTileKey& key,
+   std::shared_ptr<const SpectrogramTileSource> source, Store store,
+   TileReadyCallback onTileReady, size_t maxBytes, ThreadPool& pool)
+    : mKey { key }
+    , mSource { std::move(source) }
+    , mStore { std::move(store) }
+    , mOnTileReady { std::move(onTileReady) }
+    , mMaxBytes { maxBytes }
+    , mNumSamples { mSource->GetNumSamples() }
+    , mFFT { GetFFT(key.fftSize) }
+    , mWindow(key.fftSize, 0.f)
+    , mPool { pool }
+    , mTasks { std::make_shared<Tasks>() }
+{
+   assert(key.hop > 0);
+   assert(key.windowSize > 0 && key.windowSize <= key.fftSize);
+   assert(key.windowSize % 2 == 0);
+   assert((key.fftSize & (key.fftSize - 1)) == 0);
+
+   // As SpectrogramSettings makes the window of the spectrogram view
+   const auto padding = (key.fftSize - key.windowSize) / 2;
+   const auto extra = padding > 0;
+   const auto windowSize = key.windowSize + (extra ? 1 : 0);
+   auto* const window = mWindow.data() + padding;
+   std::fill(window, window + windowSize, 1.f);
+   NewWindowFunc(key.windowType, windowSize, extra, window);
+   const auto sum = std::accumulate(window, window + windowSize, 0.0);
+   if (sum > 0)
+      std::transform(
+         window, window + windowSize, window,
+         [scale = 2.0 / sum](float x) { return x * scale; });
+
+   mTasks->cache = this;
+}
+
+SpectrogramTileCache::~SpectrogramTileCache()
+{
+   {
+      std::lock_guard<std::mutex> lock { mMutex };
+      mPending.clear();
+   }
+   {
+      std::unique_lock<std::mutex> lock { mTasks->mutex };
+      mTasks->cache = nullptr;
+      mTasks->ended.wait(lock, [this] { return mTasks->numRunning == 0; });
+   }
+   SaveComputed();
+}
+
+const SpectrogramTileKey& SpectrogramTileCache::GetKey() const
+{
+   return mKey;
+}
+
+size_t SpectrogramTileCache::GetNumBins() const
+{
+   return mKey.fftSize / 2;
+}
+
+long long SpectrogramTileCache::GetNumColumns(int level) const
+{
+   const long long hop = mKey.hop;
+   const auto numBaseColumns = (mNumSamples + hop - 1) / hop;
+   const auto width = 1ll << level;
+   return (numBaseColumns + width - 1) / width;
+}
+
+long long SpectrogramTileCache::GetNumTiles(int level) const
+{
+   const long long width = tileWidth;
+   return (GetNumColumns(level) + width - 1) / width;
+}
+
+int SpectrogramTileCache::GetLevel(double samplesPerPixel) const
+{
+   auto level = 0;
+   while (GetNumTiles(level) > 1 &&
+          static_cast<double>(mKey.hop << (level + 1)) <= samplesPerPixel)
+      ++level;
+   return level;
+}
+
+SpectrogramTileCache::TilePtr
+SpectrogramTileCache::GetTile(int level, long long index)
+{
+   assert(level >= 0 && index >= 0 && index < GetNumTiles(level));
+   SaveComputed();
+   {
+      std::lock_guard<std::mutex> lock { mMutex };
+      if (const auto it = mEntries.find({ level, index }); it != mEntries.end())
+      {
+         it->second->lastUse = ++mUseCount;
+         return it->second->tile;
+      }
+   }
+   if (auto tile = Load(level, index))
+      return tile;
+
+   EntryPtr entry;
+   auto added = false;
+   {
+      std::lock_guard<std::mutex> lock { mMutex };
+      entry = FindOrAdd({ level, index }, added);
+      if (added)
+         mPending.push_back(entry);
+   }
+   if (added)
+      // One task for each tile, which computes the newest pending
+      mPool.Submit(
+         [tasks = mTasks] { tasks->Run(); }, TaskPriority::Interactive);
+   std::lock_guard<std::mutex> lock { mMutex };
+   return entry->tile;
+}
+
+SpectrogramTileCache::TilePtr
+SpectrogramTileCache::WaitForTile(int level, long long index)
+{
+   assert(level >= 0 && index >= 0 && index < GetNumTiles(level));
+   SaveComputed();
+   EntryPtr entry;
+   {
+      std::lock_guard<std::mutex> lock { mMutex };
+      if (const auto it = mEntries.find({ level, index }); it != mEntries.end())
+      {
+         entry = it->second;
+         entry->lastUse = ++mUseCount;
+      }
+   }
+   if (!entry)
+   {
+      if (auto tile = Load(level, index))
+         return tile;
+      std::lock_guard<std::mutex> lock { mMutex };
+      auto added = false;
+      entry = FindOrAdd({ level, index }, added);
+   }
+   auto tile = Obtain(entry);
+   SaveComputed();
+   return tile;
+}
+
+void SpectrogramTileCache::CancelPending()
+{
+   std::lock_guard<std::mutex> lock { mMutex };
+   for (const auto& entry : mPending)
+      if (!entry->started)
+         mEntries.erase(entry->tileIndex);
+   mPending.clear();
+}
+
+std::string SpectrogramTileCache::GetStoreKey(int level, long long index) const
+{
+   return mKey.ToString() + "-" + std::to_string(level) + "-" +
+          std::to_string(index);
+}
+
+size_t SpectrogramTileCache::GetNumComputed() const
+{
+   std::lock_guard<std::mutex> lock { mMutex };
+   return mNumComputed;
+}
+
+SpectrogramTileCache::EntryPtr
+SpectrogramTileCache::FindOrAdd(TileIndex tileIndex, bool& added)
+{
+   auto& entry = mEntries[tileIndex];
+   added = !entry;
+   if (added)
+      entry = std::make_shared<Entry>(tileIndex);
+   entry->lastUse = ++mUseCount;
+   return entry;
+}
+
+void SpectrogramTileCache::Complete(Entry& entry, TilePtr tile, bool computed)
+{
+   entry.tile = tile;
+   entry.promise.set_value(tile);
+   // Started entries are neither cancelled nor evicted, so this one is still
+   // in mEntries.
+   mBytes += tile->data.size() * sizeof(float);
+   if (computed)
+   {
+      ++mNumComputed;
+      if (mStore.save)
+         mToSave.push_back(std::move(tile));
+   }
+   EvictIfNeeded();
+}
+
+void SpectrogramTileCache::EvictIfNeeded()
+{
+   while (mBytes > mMaxBytes)
+   {
+      // Linear, but there are few tiles of any useful size in memory.
+      auto oldest = mEntries.end();
+      for (auto it = mEntries.begin(); it != mEntries.end(); ++it)
+         if (it->second->tile &&
+             (oldest == mEntries.end() ||
+              it->second->lastUse < oldest->second->lastUse))
+            oldest = it;
+      if (oldest == mEntries.end())
+         break;
+      mBytes -= oldest->second->tile->data.size() * sizeof(float);
+      mEntries.erase(oldest);
+   }
+}
+
+SpectrogramTileCache::TilePtr
+SpectrogramTileCache::Load(int level, long long index)
+{
+   if (!mStore.load)
+      return nullptr;
+   std::vector<float> data;
+   if (!mStore.load(GetStoreKey(level, index), data))
+      return nullptr;
+   const auto numColumns = GetTileNumColumns(level, index);
+   // Anything else was written by some other version of this class.
+   if (data.size() != numColumns * GetNumBins())
+      return nullptr;
+
+   auto tile = std::make_shared<SpectrogramTile>();
+   tile->level = level;
+   tile->index = index;
+   tile->numColumns = numColumns;
+   tile->numBins = GetNumBins();
+   tile->data = std::move(data);
+
+   std::lock_guard<std::mutex> lock { mMutex };
+   auto added = false;
+   const auto entry = FindOrAdd({ level, index }, added);
+   if (!entry->started)
+   {
+      entry->started = true;
+      Complete(*entry, tile, false);
+      return tile;
+   }
+   // A worker started it meanwhile; let it finish
+   return entry->tile;
+}
+
+SpectrogramTileCache::TilePtr SpectrogramTileCache::Obtain(const EntryPtr& entry)
+{
+   auto compute = false;
+   {
+      std::lock_guard<std::mutex> lock { mMutex };
+      if (entry->tile)
+         return entry->tile;
+      // Scheduled but not started: rather than waiting for a worker, compute
+      // it here. This also guarantees that workers computing coarse tiles
+      // never wait for a tile no one is computing.
+      compute = !entry->started;
+      entry->started = true;
+   }
+   if (compute)
+      return Compute(*entry);
+   // Another thread is computing it, and tiles depend only on finer tiles,
+   // so this can't deadlock.
+   return entry->future.get();
+}
+
+SpectrogramTileCache::TilePtr SpectrogramTileCache::Compute(Entry& entry)
+{
+   const auto [level, index] = entry.tileIndex;
+   TilePtr tile;
+   try
+   {
+      tile = level == 0 ? ComputeBase(index) : ComputeDerived(level, index);
+   }
+   catch (...)
+   {
+      std::lock_guard<std::mutex> lock { mMutex };
+      // Let a later request try again
+      const auto it = mEntries.find(entry.tileIndex);
+      if (it != mEntries.end() && it->second.get() == &entry)
+         mEntries.erase(it);
+      entry.promise.set_exception(std::current_exception());
+      throw;
+   }
+   {
+      std::lock_guard<std::mutex> lock { mMutex };
+      Complete(entry, tile, true);
+   }
+   if (mOnTileReady)
+      mOnTileReady(level, index);
+   return tile;
+}
+
+size_t SpectrogramTileCache::GetTileNumColumns(int level, long long index) const
+{
+   const long long width = tileWidth;
+   return std::min(width, GetNumColumns(level) - index * width);
+}
+
+SpectrogramTileCache::TilePtr
+SpectrogramTileCache::ComputeBase(long long index) const
+{
+   const auto numColumns = GetTileNumColumns(0, index);
+   const auto numBins = GetNumBins();
+   const auto fftSize = mKey.fftSize;
+   const long long hop = mKey.hop;
+
+   // Read the samples of all the overlapping windows at once.
+   const auto firstColumn = index * static_cast<long long>(tileWidth);
+   const auto start = firstColumn * hop - static_cast<long long>(fftSize / 2);
+   const auto length = (numColumns - 1) * hop + fftSize;
+   std::vector<float> samples(length, 0.f);
+   const auto readStart = std::max(start, 0ll);
+   const auto readEnd =
+      std::min(start + static_cast<long long>(length), mNumSamples);
+   if (readEnd > readStart)
+      mSource->ReadFloats(
+         samples.data() + (readStart - start), readStart, readEnd - readStart);
+
+   auto tile = std::make_shared<SpectrogramTile>();
+   tile->level = 0;
+   tile->index = index;
+   tile->numColumns = numColumns;
+   tile->numBins = numBins;
+   tile->data.resize(numColumns * numBins);
+
+   std::vector<float> buffer(fftSize);
+   for (size_t column = 0; column < numColumns; ++column)
+   {
+      const auto* const in = samples.data() + column * hop;
+      for (size_t i = 0; i < fftSize; ++i)
+         buffer[i] = in[i] * mWindow[i];
+      RealFFTf(buffer.data(), mFFT.get());
+
+      // As in the spectrogram view, power in dB, -160 for silence
+      const auto toDb = [](float power) {
+         return power <= 0 ? -160.f : 10.f * std::log10(power);
+      };
+      auto* const out = tile->data.data() + column * numBins;
+      // The bin of the Nyquist frequency, packed with the real-only DC, is
+      // left out.
+      out[0] = toDb(buffer[0] * buffer[0]);
+      for (size_t bin = 1; bin < numBins; ++bin)
+      {
+         const auto i = mFFT->BitReversed[bin];
+         const auto re = buffer[i], im = buffer[i + 1];
+         out[bin] = toDb(re * re + im * im);
+      }
+   }
+   return tile;
+}
+
+SpectrogramTileCache::TilePtr
+SpectrogramTileCache::ComputeDerived(int level, long long index)
+{
+   const auto numColumns = GetTileNumColumns(level, index);
+   const auto numBins = GetNumBins();
+
+   auto tile = std::make_shared<SpectrogramTile>();
+   tile->level = level;
+   tile->index = index;
+   tile->numColumns = numColumns;
+   tile->numBins = numBins;
+   tile->data.resize(numColumns * numBins);
+
+   // Each half of the tile comes from one tile of the finer level.
+   const auto numFinerTiles = GetNumTiles(level - 1);
+   for (auto half = 0; half < 2; ++half)
+   {
+      const auto finerIndex = 2 * index + half;
+      if (finerIndex >= numFinerTiles)
+         break;
+      EntryPtr entry;
+      {
+         std::lock_guard<std::mutex> lock { mMutex };
+         auto added = false;
+         entry = FindOrAdd({ level - 1, finerIndex }, added);
+      }
+      const auto finer = Obtain(entry);
+      for (size_t i = 0; 2 * i < finer->numColumns; ++i)
+      {
+         auto* const out = tile->data.data() + (half * tileWidth / 2 + i) * numBins;
+         const auto* const first = finer->GetColumn(2 * i);
+         if (2 * i + 1 < finer->numColumns)
+         {
+            const auto* const second = finer->GetColumn(2 * i + 1);
+            for (size_t bin = 0; bin < numBins; ++bin)
+               out[bin] = std::max(first[bin], second[bin]);
+         }
+         else
+            std::copy(first, first + numBins, out);
+      }
+   }
+   return tile;
+}
+
+void SpectrogramTileCache::SaveComputed()
+{
+   if (!mStore.save)
+      return;
+   std::vector<TilePtr> toSave;
+   {
+      std::lock_guard<std::mutex> lock { mMutex };
+      toSave.swap(mToSave);
+   }
+   for (const auto& tile : toSave)
+      mStore.save(GetStoreKey(tile->level, tile->index), tile->data);
+}
+
+void SpectrogramTileCache::ComputeNewest()
+{
+   EntryPtr entry;
+   {
+      std::lock_guard<std::mutex> lock { mMutex };
+      // Last requested, first served; the pending tile of this task may have
+      // been cancelled, or computed by a thread waiting for it.
+      while (!entry && !mPending.empty())
+      {
+         entry = std::move(mPending.back());
+         mPending.pop_back();
+         if (entry->started)
+            entry.reset();
+      }
+      if (!entry)
+         return;
+      entry->started = true;
+   }
+   try
+   {
+      Compute(*entry);
+   }
+   catch (...)
+   {
+      // Compute made the entry retryable; nothing more to do here.
+   }
+}
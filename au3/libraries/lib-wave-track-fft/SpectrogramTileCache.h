@@ -0,0 +1,206 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  SpectrogramTileCache.h
+
+**********************************************************************/
+#pragma once
+
+#include "RealFFTf.h"
+#include "concurrency/ThreadPool.h"
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+//! Identifies one analysis of one piece of audio
+struct WAVE_TRACK_FFT_API SpectrogramTileKey
+{
+   //! Supplied by the client, and must change whenever the samples do; with a
+   //! store, also the same for the same samples in another session, e.g. a
+   //! hash of the sample block ids and trims of a clip
+   uint64_t contentHash = 0;
+   //! One of eWindowFunctions
+   int windowType = 0;
+   size_t windowSize = 0;
+   //! A power of two, at least `windowSize`; the window is zero-padded.
+   size_t fftSize = 0;
+   //! Samples between the centres of consecutive columns of the base level
+   size_t hop = 0;
+
+   bool operator==(const SpectrogramTileKey& other) const;
+   bool operator!=(const SpectrogramTileKey& other) const;
+
+   //! Unique for each key, for use as a key of persistent storage
+   std::string ToString() const;
+};
+
+//! The samples to analyze.
+class WAVE_TRACK_FFT_API SpectrogramTileSource
+{
+public:
+   virtual ~SpectrogramTileSource();
+
+   virtual long long GetNumSamples() const = 0;
+
+   //! Called from worker threads, possibly several at once
+   //! @pre `start >= 0 && start + numSamples <= GetNumSamples()`
+   virtual void
+   ReadFloats(float* buffer, long long start, size_t numSamples) const = 0;
+};
+
+//! A run of consecutive columns of a spectrogram, in dB
+struct WAVE_TRACK_FFT_API SpectrogramTile
+{
+   //! Columns at level `n` each cover `2^n` base columns
+   int level = 0;
+   //! The first column of the tile is `index * SpectrogramTileCache::tileWidth`
+   //! of its level
+   long long index = 0;
+   size_t numColumns = 0;
+   size_t numBins = 0;
+   //! `numColumns` columns of `numBins` values, column after column
+   std::vector<float> data;
+
+   const float* GetColumn(size_t column) const
+   {
+      return data.data() + column * numBins;
+   }
+};
+
+/*!
+ * @brief Holds the spectrogram of one piece of audio as tiles of a fixed
+ * number of columns, at several resolutions, so that changing the zoom
+ * reuses what was already computed.
+ *
+ * @details Level 0 is the short-time Fourier transform with one column every
+ * `hop` samples, column `i` centred on sample `i * hop`, windowed as in the
+ * spectrogram view: the window is centred in the zero padding and scaled so
+ * that a sine of 0 dB peaks at 0 dB. Each column at level
+ * `n + 1` is made from two adjacent columns of level `n`, keeping the greater
+ * value of each bin so that short events stay visible when zoomed out. A
+ * view should pick the coarsest level whose columns are no wider than a pixel.
+ *
+ * Tiles are computed by tasks of a thread pool, which read the source
+ * directly, and coarser tiles reuse the finer ones already in memory. The
+ * memory held is bounded, by discarding the least recently used tiles. An
+ * optional store keeps the tiles computed beyond the life of the cache.
+ */
+class WAVE_TRACK_FFT_API SpectrogramTileCache final
+{
+public:
+   static constexpr size_t tileWidth = 256;
+
+   using TilePtr = std::shared_ptr<const SpectrogramTile>;
+
+   //! Optional persistent storage, indexed by the strings of `GetStoreKey`.
+   //! Called only from the thread calling `GetTile`, `WaitForTile` or the
+   //! destructor.
+   struct Store
+   {
+      //! Returns false if there is no such entry
+      std::function<bool(const std::string& key, std::vector<float>& data)>
+         load;
+      std::function<void(const std::string& key, const std::vector<float>& data)>
+         save;
+   };
+
+   //! Called from a worker thread when a tile is ready, e.g. to post a
+   //! repaint to the main thread
+   using TileReadyCallback = std::function<void(int level, long long index)>;
+
+   /*!
+    * @pre `key.fftSize` is a power of two and `key.fftSize >= key.windowSize`
+    * @pre `key.windowSize` is even
+    * @pre `key.hop > 0`
+    */
+   SpectrogramTileCache(
+      const SpectrogramTileKey& key,
+      std::shared_ptr<const SpectrogramTileSource> source, Store store = {},
+      TileReadyCallback onTileReady = {}, size_t maxBytes = 64 * 1024 * 1024,
+      audacity::concurrency::ThreadPool& pool =
+         audacity::concurrency::ThreadPool::Get());
+
+   //! Waits for the tiles being computed, abandoning the others, and stores
+   //! those not yet stored
+   ~SpectrogramTileCache();
+
+   SpectrogramTileCache(const SpectrogramTileCache&) = delete;
+   SpectrogramTileCache& operator=(const SpectrogramTileCache&) = delete;
+
+   const SpectrogramTileKey& GetKey() const;
+
+   size_t GetNumBins() const;
+
+   //! Number of columns at `level`, the last tile possibly being partial
+   long long GetNumColumns(int level) const;
+   long long GetNumTiles(int level) const;
+
+   //! The coarsest level needed to draw `samplesPerPixel`
+   int GetLevel(double samplesPerPixel) const;
+
+   //! Doesn't block on computation. If the tile is neither in memory nor in
+   //! the store, schedules its computation and returns null. The tiles
+   //! requested last are computed first.
+   TilePtr GetTile(int level, long long index);
+
+   //! Like GetTile, but computes the tile if needed and waits for it
+   TilePtr WaitForTile(int level, long long index);
+
+   //! Forgets the tiles scheduled but not started, e.g. after the view moved.
+   void CancelPending();
+
+   std::string GetStoreKey(int level, long long index) const;
+
+   //! How many tiles have been computed, rather than found in memory or in
+   //! the store, since construction
+   size_t GetNumComputed() const;
+
+private:
+   struct Entry;
+   struct Tasks;
+   using EntryPtr = std::shared_ptr<Entry>;
+   using TileIndex = std::pair<int, long long>;
+
+   // These require mMutex to be locked
+   EntryPtr FindOrAdd(TileIndex tileIndex, bool& added);
+   void Complete(Entry& entry, TilePtr tile, bool computed);
+   void EvictIfNeeded();
+
+   TilePtr Load(int level, long long index);
+   TilePtr Obtain(const EntryPtr& entry);
+   TilePtr Compute(Entry& entry);
+   TilePtr ComputeBase(long long index) const;
+   TilePtr ComputeDerived(int level, long long index);
+   size_t GetTileNumColumns(int level, long long index) const;
+   void SaveComputed();
+   void ComputeNewest();
+
+   const SpectrogramTileKey mKey;
+   const std::shared_ptr<const SpectrogramTileSource> mSource;
+   const Store mStore;
+   const TileReadyCallback mOnTileReady;
+   const size_t mMaxBytes;
+   const long long mNumSamples;
+
+   const HFFT mFFT;
+   std::vector<float> mWindow;
+
+   mutable std::mutex mMutex;
+   std::map<TileIndex, EntryPtr> mEntries;
+   std::vector<EntryPtr> mPending;
+   std::vector<TilePtr> mToSave;
+   size_t mBytes = 0;
+   unsigned long long mUseCount = 0;
+   size_t mNumComputed = 0;
+
+   audacity::concurrency::ThreadPool& mPool;
+   //! Outlives the cache, for the tasks still queued in the pool
+   const std::shared_ptr<Tasks> mTasks;
+};
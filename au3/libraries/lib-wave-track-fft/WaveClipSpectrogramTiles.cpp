@@ -0,0 +1,57 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  WaveClipSpectrogramTiles.cpp
+
+**********************************************************************/
+#include "WaveClipSpectrogramTiles.h"
+
+#include "Sequence.h"
+#include "WaveClip.h"
+
+#include <cstring>
+
+WaveClipTileSource::WaveClipTileSource(const WaveClipChannel& clip)
+   : mSequence { std::make_unique<Sequence>(
+        clip.GetSequence(), clip.GetSequence().GetFactory()) }
+   , mStart { clip.TimeToSamples(clip.GetTrimLeft()) }
+   , mNumSamples { clip.GetVisibleSampleCount().as_long_long() }
+{
+}
+
+WaveClipTileSource::~WaveClipTileSource() = default;
+
+long long WaveClipTileSource::GetNumSamples() const
+{
+   return mNumSamples;
+}
+
+void WaveClipTileSource::ReadFloats(
+   float* buffer, long long start, size_t numSamples) const
+{
+   constexpr auto mayThrow = false; // Don't throw just for display
+   mSequence->GetFloatSampleView(mStart + start, numSamples, mayThrow)
+      .Copy(buffer, numSamples);
+}
+
+uint64_t GetSpectrogramContentHash(const WaveClipChannel& clip)
+{
+   uint64_t hash = 0;
+   const auto combine = [&hash](uint64_t value) {
+      hash ^= value + 0x9e3779b97f4a7c15ull + (hash << 6) + (hash >> 2);
+   };
+   for (const auto& block : clip.GetSequence().GetBlockArray())
+   {
+      combine(block.sb->GetBlockID());
+      combine(block.start.as_long_long());
+   }
+   for (double trim : { clip.GetTrimLeft(), clip.GetTrimRight() })
+   {
+      uint64_t bits;
+      std::memcpy(&bits, &trim, sizeof(bits));
+      combine(bits);
+   }
+   return hash;
+}
@@ -0,0 +1,41 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  WaveClipSpectrogramTiles.h
+
+**********************************************************************/
+#pragma once
+
+#include "SampleCount.h"
+#include "SpectrogramTileCache.h"
+
+class Sequence;
+class WaveClipChannel;
+
+//! One channel of a clip as it was when the tiles were requested, which the
+//! tasks computing them may read while the clip changes
+class WAVE_TRACK_FFT_API WaveClipTileSource final :
+   public SpectrogramTileSource
+{
+public:
+   explicit WaveClipTileSource(const WaveClipChannel& clip);
+   ~WaveClipTileSource() override;
+
+   long long GetNumSamples() const override;
+
+   void
+   ReadFloats(float* buffer, long long start, size_t numSamples) const override;
+
+private:
+   const std::unique_ptr<const Sequence> mSequence;
+   const sampleCount mStart;
+   const long long mNumSamples;
+};
+
+//! Identifies the samples of one channel of a clip, in this session and the
+//! next: sample blocks never change, and have the same ids when the project
+//! is opened again
+WAVE_TRACK_FFT_API
+uint64_t GetSpectrogramContentHash(const WaveClipChannel& clip);
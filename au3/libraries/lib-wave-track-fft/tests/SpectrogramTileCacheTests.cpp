@@ -0,0 +1,252 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  SpectrogramTileCacheTests.cpp
+
+**********************************************************************/
+#include "SpectrogramTileCache.h"
+
+#include "FFT.h"
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <future>
+#include <unordered_map>
+
+namespace
+{
+constexpr auto pi = 3.141592653589793;
+
+class SineSource : public SpectrogramTileSource
+{
+public:
+   SineSource(long long numSamples, double cyclesPerSample)
+       : mNumSamples { numSamples }
+       , mCyclesPerSample { cyclesPerSample }
+   {
+   }
+
+   long long GetNumSamples() const override
+   {
+      return mNumSamples;
+   }
+
+   void ReadFloats(
+      float* buffer, long long start, size_t numSamples) const override
+   {
+      ++numReads;
+      // Not REQUIRE, which isn't for worker threads
+      assert(start >= 0);
+      assert(start + static_cast<long long>(numSamples) <= mNumSamples);
+      for (size_t i = 0; i < numSamples; ++i)
+         buffer[i] = std::sin(2 * pi * mCyclesPerSample * (start + i));
+   }
+
+   mutable std::atomic<int> numReads { 0 };
+
+private:
+   const long long mNumSamples;
+   const double mCyclesPerSample;
+};
+
+SpectrogramTileKey MakeKey()
+{
+   SpectrogramTileKey key;
+   key.contentHash = 123;
+   key.windowType = eWinFuncHann;
+   key.windowSize = 256;
+   key.fftSize = 512;
+   key.hop = 128;
+   return key;
+}
+
+size_t GetLoudestBin(const float* column, size_t numBins)
+{
+   return std::max_element(column, column + numBins) - column;
+}
+} // namespace
+
+TEST_CASE("SpectrogramTileCache")
+{
+   // A sine on bin 64 of a 512-point FFT, lasting a little more than 5 base
+   // tiles.
+   constexpr auto numSamples = 5 * 256 * 128 + 1000;
+   const auto source = std::make_shared<SineSource>(numSamples, 64. / 512);
+   const auto key = MakeKey();
+
+   SECTION("levels")
+   {
+      SpectrogramTileCache sut { key, source };
+      REQUIRE(sut.GetNumBins() == 256);
+      REQUIRE(sut.GetNumColumns(0) == 5 * 256 + 8);
+      REQUIRE(sut.GetNumTiles(0) == 6);
+      REQUIRE(sut.GetNumColumns(1) == 5 * 128 + 4);
+      REQUIRE(sut.GetNumTiles(1) == 3);
+      REQUIRE(sut.GetNumTiles(3) == 1);
+
+      REQUIRE(sut.GetLevel(1.) == 0);
+      REQUIRE(sut.GetLevel(128.) == 0);
+      REQUIRE(sut.GetLevel(256.) == 1);
+      REQUIRE(sut.GetLevel(1000.) == 2);
+      // No further than a single tile
+      REQUIRE(sut.GetLevel(1e9) == 3);
+   }
+
+   SECTION("base level finds the frequency")
+   {
+      SpectrogramTileCache sut { key, source };
+      const auto tile = sut.WaitForTile(0, 2);
+      REQUIRE(tile);
+      REQUIRE(tile->numColumns == SpectrogramTileCache::tileWidth);
+      for (size_t i = 0; i < tile->numColumns; ++i)
+         REQUIRE(GetLoudestBin(tile->GetColumn(i), tile->numBins) == 64);
+
+      const auto last = sut.WaitForTile(0, 5);
+      REQUIRE(last->numColumns == 8);
+      REQUIRE(last->data.size() == 8 * 256);
+   }
+
+   SECTION("coarser levels keep the maximum")
+   {
+      SpectrogramTileCache sut { key, source };
+      const auto coarse = sut.WaitForTile(2, 0);
+      REQUIRE(coarse->numColumns == 256);
+      for (auto i : { 0, 100, 255 })
+      {
+         // Column i of level 2 covers base columns 4 * i to 4 * i + 3.
+         const auto baseColumn = 4 * i;
+         const auto base = sut.WaitForTile(0, baseColumn / 256);
+         const auto* const column = coarse->GetColumn(i);
+         for (size_t bin = 0; bin < coarse->numBins; ++bin)
+         {
+            auto expected = -1000.f;
+            for (auto j = 0; j < 4; ++j)
+               expected = std::max(
+                  expected, base->GetColumn(baseColumn % 256 + j)[bin]);
+            REQUIRE(column[bin] == expected);
+         }
+      }
+   }
+
+   SECTION("GetTile doesn't block and eventually has the tile")
+   {
+      SpectrogramTileCache sut { key, source };
+      auto tile = sut.GetTile(1, 0);
+      const auto start = std::chrono::steady_clock::now();
+      while (!tile &&
+             std::chrono::steady_clock::now() - start < std::chrono::seconds(10))
+      {
+         std::this_thread::sleep_for(std::chrono::milliseconds(1));
+         tile = sut.GetTile(1, 0);
+      }
+      REQUIRE(tile);
+      REQUIRE(tile->level == 1);
+      REQUIRE(tile->index == 0);
+   }
+
+   SECTION("memory is bounded")
+   {
+      const auto tileBytes = 256 * 256 * sizeof(float);
+      SpectrogramTileCache sut { key, source, {}, {}, 2 * tileBytes };
+      for (auto i = 0; i < 6; ++i)
+         sut.WaitForTile(0, i);
+      REQUIRE(sut.GetNumComputed() == 6);
+      // The last two are still there ...
+      sut.WaitForTile(0, 5);
+      REQUIRE(sut.GetNumComputed() == 6);
+      // ... but not the first.
+      sut.WaitForTile(0, 0);
+      REQUIRE(sut.GetNumComputed() == 7);
+   }
+
+   SECTION("tiles still queued in the pool are dropped with the cache")
+   {
+      audacity::concurrency::ThreadPool pool { 1 };
+      std::promise<void> release;
+      // Occupy the only worker
+      auto blocker = pool.Async([released = release.get_future()] {
+         released.wait();
+      });
+      {
+         SpectrogramTileCache sut {
+            key, source, {}, {}, 64 * 1024 * 1024, pool
+         };
+         for (auto i = 0; i < 6; ++i)
+            REQUIRE(!sut.GetTile(0, i));
+         // Doesn't wait for the worker
+      }
+      release.set_value();
+      blocker.get();
+      pool.Async([] {}).get();
+      REQUIRE(source->numReads == 0);
+   }
+
+   SECTION("store")
+   {
+      std::unordered_map<std::string, std::vector<float>> stored;
+      SpectrogramTileCache::Store store;
+      store.load = [&](const std::string& key, std::vector<float>& data) {
+         const auto it = stored.find(key);
+         if (it == stored.end())
+            return false;
+         data = it->second;
+         return true;
+      };
+      store.save = [&](const std::string& key, const std::vector<float>& data) {
+         stored[key] = data;
+      };
+
+      SpectrogramTileCache::TilePtr computed;
+      {
+         SpectrogramTileCache sut { key, source, store };
+         computed = sut.WaitForTile(1, 2);
+         REQUIRE(sut.GetNumComputed() == 3);
+      }
+      // The tile and the two finer ones it was made from
+      REQUIRE(stored.size() == 3);
+
+      SpectrogramTileCache sut { key, source, store };
+      const auto loaded = sut.GetTile(1, 2);
+      REQUIRE(loaded);
+      REQUIRE(loaded->data == computed->data);
+      REQUIRE(sut.GetNumComputed() == 0);
+
+      // Tiles of other samples are not found
+      auto otherKey = key;
+      ++otherKey.contentHash;
+      SpectrogramTileCache other { otherKey, source, store };
+      REQUIRE(!other.GetTile(1, 2));
+   }
+
+   SECTION("tiles computed by the pool are stored")
+   {
+      std::unordered_map<std::string, std::vector<float>> stored;
+      SpectrogramTileCache::Store store;
+      store.load = [](const std::string&, std::vector<float>&) {
+         return false;
+      };
+      store.save = [&](const std::string& key, const std::vector<float>& data) {
+         stored[key] = data;
+      };
+      std::string storeKey;
+      {
+         SpectrogramTileCache sut { key, source, store };
+         storeKey = sut.GetStoreKey(0, 1);
+         auto tile = sut.GetTile(0, 1);
+         while (!tile)
+         {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            tile = sut.GetTile(0, 1);
+         }
+      }
+      // At the latest by the destructor
+      REQUIRE(stored.count(storeKey) == 1);
+   }
+}
@@ -23,6 +23,14 @@ SampleBlockFactoryPtr SampleBlockFactory::New( AudacityProject &project )
 
 SampleBlockFactory::~SampleBlockFactory() = default;
 
+void SampleBlockFactory::BeginBulkLoad()
+{
+}
+
+void SampleBlockFactory::EndBulkLoad()
+{
+}
+
 SampleBlockPtr SampleBlockFactory::Create(constSamplePtr src,
    size_t numsamples,
    sampleFormat srcformat)
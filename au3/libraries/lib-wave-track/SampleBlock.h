@@ -146,6 +146,17 @@ public:
    /*! @return ids of all sample blocks created by this factory and still extant */
    virtual SampleBlockIDs GetActiveBlockIDs() = 0;
 
+   /*!
+    * Hints that many blocks are about to be created from ids, as when a
+    * project is opened, so that the factory may fetch what it needs for all
+    * of them at once. Must be balanced by `EndBulkLoad()`.
+    * Default implementation does nothing.
+    */
+   virtual void BeginBulkLoad();
+
+   //! Frees what `BeginBulkLoad()` fetched. Default implementation does nothing.
+   virtual void EndBulkLoad();
+
 protected:
    // The override should throw more informative exceptions on error than the
    // default InconsistencyException thrown by Create
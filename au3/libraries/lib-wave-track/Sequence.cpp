@@ -97,6 +97,19 @@ bool Sequence::CloseLock() noexcept
    return true;
 }
 
+bool Sequence::IsEquivalent(const Sequence &other) const
+{
+   return mpFactory == other.mpFactory &&
+      mSampleFormats == other.mSampleFormats &&
+      mMinSamples == other.mMinSamples && mMaxSamples == other.mMaxSamples &&
+      mNumSamples == other.mNumSamples &&
+      std::equal(mBlock.begin(), mBlock.end(),
+         other.mBlock.begin(), other.mBlock.end(),
+         [](const SeqBlock &a, const SeqBlock &b){
+            return a.sb == b.sb && a.start == b.start;
+         });
+}
+
 SampleFormats Sequence::GetSampleFormats() const
 {
    return mSampleFormats;
@@ -188,6 +188,10 @@ class WAVE_TRACK_API Sequence final : public XMLTagHandler{
 
    bool GetErrorOpening() const { return mErrorOpening; }
 
+   //! Whether the sequences have the same formats and share the same sample
+   //! blocks at the same positions, which is all that copying preserves
+   bool IsEquivalent(const Sequence &other) const;
+
    //
    // Lock all of this sequence's sample blocks, keeping them
    // from being destroyed when closing.
@@ -15,6 +15,7 @@
 *//*******************************************************************/
 #include "WaveClip.h"
 
+#include <algorithm>
 #include <math.h>
 #include <numeric>
 #include <optional>
@@ -26,8 +27,10 @@
 #include "InconsistencyException.h"
 #include "Resample.h"
 #include "Sequence.h"
+#include "StretchedClipCache.h"
 #include "TimeAndPitchInterface.h"
 #include "UserException.h"
+#include "XMLWriter.h"
 
 #include "global/realfn.h"
 
@@ -590,10 +593,17 @@ void WaveClip::OnProjectTempoChange(
       mClipTempo = newTempo;
    }
 
+   DropStretchedClipCache();
    Observer::Publisher<StretchRatioChange>::Publish(
       StretchRatioChange { GetStretchRatio() });
 }
 
+bool WaveClip::HasProjectTempo(double tempo) const
+{
+   return mRawAudioTempo.has_value() &&
+          (!mStretchToMatchProjectTempo || mClipTempo == tempo);
+}
+
 void WaveClip::StretchLeftTo(double to)
 {
    const auto pet = GetPlayEndTime();
@@ -609,6 +619,7 @@ void WaveClip::StretchLeftTo(double to)
    mEnvelope->SetOffset(mSequenceOffset);
    mEnvelope->RescaleTimesBy(ratioChange);
    StretchCutLines(ratioChange);
+   DropStretchedClipCache();
    Observer::Publisher<StretchRatioChange>::Publish(
       StretchRatioChange { GetStretchRatio() });
 }
@@ -634,6 +645,7 @@ void WaveClip::StretchBy(double ratio)
    mEnvelope->SetOffset(mSequenceOffset);
    mEnvelope->RescaleTimesBy(ratio);
    StretchCutLines(ratio);
+   DropStretchedClipCache();
    Observer::Publisher<StretchRatioChange>::Publish(
       StretchRatioChange { GetStretchRatio() });
 }
@@ -692,6 +704,41 @@ bool WaveClip::HasEqualPitchAndSpeed(const WaveClip& other) const
           GetCentShift() == other.GetCentShift();
 }
 
+bool WaveClip::IsEquivalent(const WaveClip& other) const
+{
+   if (
+      mId != other.mId || mSequenceOffset != other.mSequenceOffset ||
+      mTrimLeft != other.mTrimLeft || mTrimRight != other.mTrimRight ||
+      mPitchAndSpeedPreset != other.mPitchAndSpeedPreset ||
+      mCentShift != other.mCentShift ||
+      mClipStretchRatio != other.mClipStretchRatio ||
+      mRawAudioTempo != other.mRawAudioTempo ||
+      mClipTempo != other.mClipTempo ||
+      mStretchToMatchProjectTempo != other.mStretchToMatchProjectTempo ||
+      mRate != other.mRate || mIsPlaceholder != other.mIsPlaceholder ||
+      mName != other.mName || NChannels() != other.NChannels() ||
+      mCutLines.size() != other.mCutLines.size())
+      return false;
+   for (size_t ii = 0; ii < NChannels(); ++ii)
+      if (!mSequences[ii]->IsEquivalent(*other.mSequences[ii]))
+         return false;
+   if (!mEnvelope->IsEquivalent(*other.mEnvelope))
+      return false;
+   for (size_t ii = 0; ii < mCutLines.size(); ++ii)
+      if (!mCutLines[ii]->IsEquivalent(*other.mCutLines[ii]))
+         return false;
+   // Some attachments are saved with the clip, as its colour: compare what
+   // they save
+   XMLStringWriter attributes, otherAttributes;
+   Attachments::ForEach([&](const WaveClipListener& listener) {
+      listener.WriteXMLAttributes(attributes);
+   });
+   other.Attachments::ForEach([&](const WaveClipListener& listener) {
+      listener.WriteXMLAttributes(otherAttributes);
+   });
+   return attributes == otherAttributes;
+}
+
 bool WaveClip::HasPitchOrSpeed() const
 {
    return !StretchRatioEquals(1.0) || GetCentShift() != 0;
@@ -1653,6 +1700,7 @@ bool WaveClip::SetCentShift(int cents)
       cents > TimeAndPitchInterface::MaxCents)
       return false;
    mCentShift = cents;
+   DropStretchedClipCache();
    Observer::Publisher<CentShiftChange>::Publish(CentShiftChange { cents });
    return true;
 }
@@ -1660,6 +1708,7 @@ bool WaveClip::SetCentShift(int cents)
 void WaveClip::SetPitchAndSpeedPreset(PitchAndSpeedPreset preset)
 {
    mPitchAndSpeedPreset = preset;
+   DropStretchedClipCache();
    Observer::Publisher<PitchAndSpeedPresetChange>::Publish(
       PitchAndSpeedPresetChange { mPitchAndSpeedPreset });
 }
@@ -1669,6 +1718,63 @@ PitchAndSpeedPreset WaveClip::GetPitchAndSpeedPreset() const
    return mPitchAndSpeedPreset;
 }
 
+void WaveClip::PrerenderPitchAndSpeed()
+{
+   if (NChannels() == 0 || !StretchedClipCache::IsWorthRendering(*this))
+   {
+      DropStretchedClipCache();
+      return;
+   }
+   if (GetStretchedClipCache())
+      return;
+   // A stale render would still count in the memory of all renders.
+   DropStretchedClipCache();
+   // The copy shares the sample blocks, it is cheap.
+   std::shared_ptr<const WaveClip> snapshot =
+      NewSharedFrom(*this, GetFactory(), false);
+   std::atomic_store(
+      &mStretchedClipCache, std::shared_ptr<const StretchedClipCache> {
+                               StretchedClipCache::Create(
+                                  std::move(snapshot)) });
+}
+
+std::shared_ptr<const StretchedClipCache>
+WaveClip::GetStretchedClipCache() const
+{
+   auto cache = std::atomic_load(&mStretchedClipCache);
+   if (!cache || !cache->Matches(*this))
+      return nullptr;
+   // Edits of the samples do not drop the render, but leave it stale.
+   const auto& snapshot = static_cast<const WaveClip&>(cache->GetClip());
+   return HasSameVisibleSamples(snapshot) ? cache : nullptr;
+}
+
+bool WaveClip::HasSameVisibleSamples(const WaveClip& other) const
+{
+   if (
+      NChannels() != other.NChannels() || mTrimLeft != other.mTrimLeft ||
+      mTrimRight != other.mTrimRight)
+      return false;
+   for (size_t ii = 0; ii < NChannels(); ++ii)
+   {
+      const auto& blocks = mSequences[ii]->GetBlockArray();
+      const auto& otherBlocks = other.mSequences[ii]->GetBlockArray();
+      if (!std::equal(
+             blocks.begin(), blocks.end(), otherBlocks.begin(),
+             otherBlocks.end(), [](const SeqBlock& a, const SeqBlock& b) {
+                return a.sb == b.sb && a.start == b.start;
+             }))
+         return false;
+   }
+   return true;
+}
+
+void WaveClip::DropStretchedClipCache()
+{
+   std::atomic_store(
+      &mStretchedClipCache, std::shared_ptr<const StretchedClipCache> {});
+}
+
 /*! @excsafety{Strong} */
 void WaveClip::Resample(int rate, BasicUI::ProgressDialog *progress)
 {
@@ -1683,15 +1789,18 @@ void WaveClip::Resample(int rate, BasicUI::ProgressDialog *progress)
    // This function does its own RAII without a Transaction
 
    double factor = (double)rate / (double)mRate;
-   //Resample is always configured to have single channel.
-   //Create Resample instance per each channel in the clip
-   std::vector<::Resample> resample;
-   for (unsigned n = 0; n < mSequences.size(); ++n)
-      resample.emplace_back(true, factor, factor);// constant rate resampling
+   // One resampler converts all channels in step
+   const auto nChannels = mSequences.size();
+   ::Resample resample(true, factor, factor, nChannels); // constant rate resampling
 
    const size_t bufsize = 65536;
-   Floats inBuffer{ bufsize };
-   Floats outBuffer{ bufsize };
+   std::vector<Floats> inBuffers, outBuffers;
+   std::vector<const float *> inPointers;
+   std::vector<float *> outPointers;
+   for (size_t iChannel = 0; iChannel < nChannels; ++iChannel) {
+      inPointers.push_back(inBuffers.emplace_back(bufsize).get());
+      outPointers.push_back(outBuffers.emplace_back(bufsize).get());
+   }
    sampleCount pos = 0;
    bool error = false;
    int outGenerated = 0;
@@ -1705,49 +1814,36 @@ void WaveClip::Resample(int rate, BasicUI::ProgressDialog *progress)
     * with OR as long as the resampler spews out samples (which could continue
     * for a few iterations after we stop feeding it)
     */
-   while (pos < numSamples || outGenerated > 0) {
+   while (!error && (pos < numSamples || outGenerated > 0)) {
       const auto inLen = limitSampleBufferSize( bufsize, numSamples - pos );
 
       bool isLast = ((pos + inLen) == numSamples);
 
-      auto ppNewSequence = newSequences.begin();
-      std::optional<std::pair<size_t, size_t>> results{};
-      size_t nSequence = 0;
-      for (auto &pSequence : mSequences) {
-         auto &pNewSequence = *ppNewSequence++;
+      for (size_t iChannel = 0; iChannel < nChannels; ++iChannel) {
          if (
             inLen > 0 &&
-            !pSequence->Get(
-               (samplePtr)inBuffer.get(), floatSample, pos, inLen, true))
+            !mSequences[iChannel]->Get(
+               (samplePtr)inBuffers[iChannel].get(), floatSample, pos, inLen,
+               true))
          {
             error = true;
             break;
          }
+      }
+      if (error)
+         break;
 
-         // Expect the same results for all channels, or else fail
-         auto newResults = resample[nSequence].Process(factor, inBuffer.get(), inLen,
-            isLast, outBuffer.get(), bufsize);
-         if (!results)
-            results.emplace(newResults);
-         else if (*results != newResults) {
-            error = true;
-            break;
-         }
-
-         outGenerated = results->second;
-         if (outGenerated < 0) {
-            error = true;
-            break;
-         }
+      const auto results = resample.Process(factor, inPointers.data(), inLen,
+         isLast, outPointers.data(), bufsize);
 
-         pNewSequence->Append((samplePtr)outBuffer.get(), floatSample,
+      outGenerated = results.second;
+      for (size_t iChannel = 0; iChannel < nChannels; ++iChannel)
+         newSequences[iChannel]->Append(
+            (samplePtr)outBuffers[iChannel].get(), floatSample,
             outGenerated, 1,
             widestSampleFormat /* computed samples need dither */
          );
-         ++nSequence;
-      }
-      if (results)
-         pos += results->first;
+      pos += results.first;
 
       if (progress)
       {
@@ -415,6 +415,13 @@ public:
    bool HasPitchOrSpeed() const;
    //! @}
 
+   /*!
+    * Whether a copy of `other` would be indistinguishable from this clip.
+    * Unlike `HasEqualPitchAndSpeed`, compares exactly, the samples by the
+    * sample blocks shared, and the attachments by what they write to XML.
+    */
+   bool IsEquivalent(const WaveClip& other) const;
+
    //! Enabling stretch to match tempo
    bool GetStretchToMatchProjectTempo() const;
    void SetStretchToMatchProjectTempo(bool enabled);
@@ -433,6 +440,24 @@ public:
    SubscribeToPitchAndSpeedPresetChange(
       std::function<void(PitchAndSpeedPreset)> cb) const override;
 
+   //! Starts rendering the stretched and pitch-shifted audio in the
+   //! background, for playback to use instead of stretching in real time
+   /*!
+    Does nothing if an up-to-date render exists. Drops the render if the clip
+    needs no stretching, or is too long for its render to be kept in memory,
+    or if it would not fit in the memory left to all renders.
+    */
+   void PrerenderPitchAndSpeed();
+
+   //! The background render if it is up to date, or nullptr.
+   /*!
+    Compares the sample blocks of the clip with those rendered, so like
+    reading samples, it may be called from the playback thread as long as the
+    main thread doesn't edit the clip meanwhile.
+    */
+   std::shared_ptr<const StretchedClipCache>
+   GetStretchedClipCache() const override;
+
    // Resample clip. This also will set the rate, but without changing
    // the length of the clip
    void Resample(int rate, BasicUI::ProgressDialog *progress = nullptr);
@@ -862,6 +887,10 @@ public:
    void
    OnProjectTempoChange(const std::optional<double>& oldTempo, double newTempo);
 
+   //! Whether `OnProjectTempoChange(std::nullopt, tempo)` would change nothing
+   //! but the caches and notify
+   bool HasProjectTempo(double tempo) const;
+
    SampleFormats GetSampleFormats() const;
 
    size_t CountBlocks() const;
@@ -942,6 +971,11 @@ private:
    std::vector<std::unique_ptr<Sequence>> GetEmptySequenceCopies() const;
    void StretchCutLines(double ratioChange);
    double SnapToTrackSample(double time) const noexcept;
+   //! Whether the visible part of the clip has the same samples as `other`'s,
+   //! judging by the sample blocks they share
+   bool HasSameVisibleSamples(const WaveClip& other) const;
+   //! Cancels and forgets the background render of the stretched audio
+   void DropStretchedClipCache();
 
    //! Fix consistency of cutlines and envelope after deleting from Sequences
    /*!
@@ -1038,6 +1072,10 @@ private:
    // AWD, Oct. 2009: for whitespace-at-end-of-selection pasting
    bool mIsPlaceholder { false };
 
+   //! Not copied with the clip. Read from the playback thread, hence only
+   //! accessed through std::atomic_load and std::atomic_store.
+   std::shared_ptr<const StretchedClipCache> mStretchedClipCache;
+
    wxString mName;
 };
 
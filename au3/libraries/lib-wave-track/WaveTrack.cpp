@@ -596,12 +596,16 @@ bool WaveTrack::LinkConsistencyFix(const bool doFix)
    // This implies satisfaction of the precondition of SetRate()
    assert(!doFix || IsLeader());
 
-   const auto removeZeroClips = [](WaveClipHolders& clips) {
+   const auto removeZeroClips = [](WaveTrack& track) {
       // Check for zero-length clips and remove them
+      auto& clips = track.NarrowClips();
       for (auto it = clips.begin(); it != clips.end();)
       {
-         if ((*it)->IsEmpty())
+         if ((*it)->IsEmpty()) {
+            auto pClip = *it;
             it = clips.erase(it);
+            track.Publish({ pClip, WaveTrackMessage::Removed });
+         }
          else
             ++it;
       }
@@ -636,8 +640,8 @@ bool WaveTrack::LinkConsistencyFix(const bool doFix)
             //this can't break alignment as there should be a "twin"
             //in the right channel which will also be removed, otherwise
             //track will be unlinked because AreAligned returned false
-            removeZeroClips(NarrowClips());
-            removeZeroClips(next->NarrowClips());
+            removeZeroClips(*this);
+            removeZeroClips(*next);
          }
       }
    }
@@ -663,7 +667,7 @@ bool WaveTrack::LinkConsistencyFix(const bool doFix)
       }
       if (linkType == LinkType::None)
          // Did not visit the other call to removeZeroClips, do it now
-         removeZeroClips(NarrowClips());
+         removeZeroClips(*this);
       else
          // Make a real wide wave track from two deserialized narrow tracks
          ZipClips();
@@ -788,6 +792,46 @@ Track::Holder WaveTrack::Clone(bool backup) const
    return newTrack;
 }
 
+Track::Holder WaveTrack::DuplicateSharing(const Track &previous) const
+{
+   const auto pPrevious = dynamic_cast<const WaveTrack*>(&previous);
+   if (!pPrevious || pPrevious->mpFactory != mpFactory)
+      return Duplicate();
+
+   // As Duplicate() does, except for the clips
+   auto newTrack = EmptyCopy(NChannels());
+   const auto &tempo = GetProjectTempo(*newTrack);
+   const auto &previousClips = pPrevious->mClips;
+   for (size_t ii = 0; ii < mClips.size(); ++ii) {
+      const auto &clip = *mClips[ii];
+      const auto isEquivalent = [&](const WaveClipHolder &previousClip){
+         return previousClip->IsEquivalent(clip);
+      };
+      // Clips are most often at the same position as in the previous copy
+      auto iter = previousClips.end();
+      if (ii < previousClips.size() && isEquivalent(previousClips[ii]))
+         iter = previousClips.begin() + ii;
+      else
+         iter = std::find_if(
+            previousClips.begin(), previousClips.end(), isEquivalent);
+      // InsertClip() applies the project tempo, which must not modify a clip
+      // of the previous copy: share only those that already have it.
+      if (
+         iter != previousClips.end() &&
+         (!tempo.has_value() || (*iter)->HasProjectTempo(*tempo)))
+      {
+         newTrack->mClips.push_back(*iter);
+         newTrack->Publish({ *iter, WaveTrackMessage::Inserted });
+      }
+      else
+         newTrack->InsertClip(newTrack->mClips,
+            WaveClip::NewSharedFrom(clip, mpFactory, true),
+            false, false, false);
+   }
+   Track::CopyAttachments(*newTrack, *this, true);
+   return newTrack;
+}
+
 wxString WaveTrack::MakeClipCopyName(const wxString& originalName) const
 {
    auto name = originalName;
@@ -1538,8 +1582,11 @@ std::ptrdiff_t WaveTrack::FindClip(const Interval &clip)
 void WaveTrack::RemoveClip(std::ptrdiff_t distance)
 {
    auto &clips = NarrowClips();
-   if (distance < clips.size())
+   if (distance < clips.size()) {
+      auto pClip = clips[distance];
       clips.erase(clips.begin() + distance);
+      Publish({ pClip, WaveTrackMessage::Removed });
+   }
 }
 
 /*! @excsafety{Strong} */
@@ -3268,8 +3315,10 @@ void WaveTrack::RemoveInterval(const IntervalHolder& interval)
 {
    const auto end = mClips.end(),
       iter = find(mClips.begin(), end, interval);
-   if (iter != end)
+   if (iter != end) {
       mClips.erase(iter);
+      Publish({ interval, WaveTrackMessage::Removed });
+   }
 }
 
 void WaveTrack::ReplaceInterval(
@@ -75,6 +75,7 @@ struct WaveTrackMessage {
       New, //!< newly created and empty
       Deserialized, //!< being read from project file
       Inserted, //!< (partly) copied from another clip, or moved from a track
+      Removed, //!< taken out of the track; may still be alive elsewhere
    } type{};
 };
 
@@ -286,6 +287,10 @@ public:
 
    virtual ~WaveTrack();
 
+   //! Shares the clips that are equivalent to clips of `previous`, and
+   //! copies the others
+   Track::Holder DuplicateSharing(const Track &previous) const override;
+
    void MoveTo(double o) override;
    void ShiftBy(double t0, double delta) override;
 
@@ -0,0 +1,170 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  EnvelopeTest.cpp
+
+**********************************************************************/
+#include "Envelope.h"
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace
+{
+constexpr auto minValue = 1e-3;
+constexpr auto maxValue = 4.0;
+
+//! Points at increasing times in [0, 10), without discontinuities
+std::unique_ptr<Envelope>
+RandomEnvelope(std::mt19937& engine, bool exponential, double offset)
+{
+   auto result =
+      std::make_unique<Envelope>(exponential, minValue, maxValue, 1.0);
+   result->SetOffset(offset);
+   std::uniform_int_distribution<int> numPoints { 0, 20 };
+   std::uniform_real_distribution<double> time { 0, 10 };
+   std::uniform_real_distribution<double> value { minValue, maxValue };
+   std::vector<double> times(numPoints(engine));
+   std::generate(times.begin(), times.end(), [&] { return time(engine); });
+   std::sort(times.begin(), times.end());
+   times.erase(std::unique(times.begin(), times.end()), times.end());
+   for (auto t : times)
+      result->Insert(t, value(engine));
+   return result;
+}
+
+//! Evaluates the envelope at one absolute time straight from its points
+double Expected(const Envelope& envelope, double t)
+{
+   const int numPoints = envelope.GetNumberOfPoints();
+   if (numPoints == 0)
+      return envelope.GetDefaultValue();
+   t -= envelope.GetOffset();
+   if (t < envelope[0].GetT())
+      return envelope[0].GetVal();
+   if (t >= envelope[numPoints - 1].GetT())
+      return envelope[numPoints - 1].GetVal();
+   auto hi = 1;
+   while (envelope[hi].GetT() <= t)
+      ++hi;
+   const auto &prev = envelope[hi - 1], &next = envelope[hi];
+   const auto fraction = (t - prev.GetT()) / (next.GetT() - prev.GetT());
+   if (envelope.GetExponential())
+      return prev.GetVal() *
+             std::pow(next.GetVal() / prev.GetVal(), fraction);
+   return prev.GetVal() + (next.GetVal() - prev.GetVal()) * fraction;
+}
+
+// The evaluation accumulates products or sums over a buffer, and may put a
+// sample time on the other side of a point by roundoff, but envelopes without
+// discontinuities are continuous
+bool Close(double actual, double expected)
+{
+   return std::abs(actual - expected) <= 1e-9 * maxValue;
+}
+
+//! Calls `check(envelope, t0, tstep, bufferLength)` for random envelopes and
+//! query patterns
+template <typename Check> void ForRandomQueries(const Check& check)
+{
+   std::mt19937 engine { 1234 };
+   std::uniform_real_distribution<double> offset { -1, 1 };
+   std::uniform_real_distribution<double> start { -2, 12 };
+   std::uniform_int_distribution<int> length { 1, 2048 };
+   // Samples much denser than points, or much sparser, or going back
+   const std::vector<double> tsteps { 1e-4, 1e-2, 1.0, 0.0, -1e-3 };
+
+   for (auto exponential : { false, true })
+      for (auto i = 0; i < 200; ++i)
+      {
+         const auto envelope =
+            RandomEnvelope(engine, exponential, offset(engine));
+         const auto tstep = tsteps[i % tsteps.size()];
+         INFO("exponential " << exponential << " tstep " << tstep);
+         check(*envelope, start(engine), tstep, length(engine));
+      }
+}
+} // namespace
+
+TEST_CASE("Envelope::GetValues, in consecutive buffers with a cursor")
+{
+   ForRandomQueries(
+      [](const Envelope& envelope, double t0, double tstep, int bufferLength) {
+         Envelope::Cursor cursor;
+         for (auto j = 0; j < 3; ++j)
+         {
+            std::vector<double> buffer(bufferLength);
+            envelope.GetValues(cursor, buffer.data(), bufferLength, t0, tstep);
+            for (auto k = 0; k < bufferLength; ++k)
+            {
+               const auto t = t0 + k * tstep;
+               INFO("t " << t);
+               REQUIRE(Close(buffer[k], Expected(envelope, t)));
+            }
+            t0 += bufferLength * tstep;
+         }
+      });
+}
+
+TEST_CASE("Envelope::GetValues agrees with GetValue at each sample")
+{
+   ForRandomQueries(
+      [](const Envelope& envelope, double t0, double tstep, int bufferLength) {
+         std::vector<double> buffer(bufferLength);
+         envelope.GetValues(buffer.data(), bufferLength, t0, tstep);
+         for (auto k = 0; k < bufferLength; ++k)
+            REQUIRE(Close(buffer[k], envelope.GetValue(t0 + k * tstep)));
+      });
+}
+
+TEST_CASE("Envelope::GetValue, with a cursor at increasing or random times")
+{
+   std::mt19937 engine { 5678 };
+   std::uniform_real_distribution<double> jump { -2, 12 };
+   std::uniform_real_distribution<double> step { 0, 0.1 };
+   ForRandomQueries([&](const Envelope& envelope, double t, double, int) {
+      Envelope::Cursor cursor;
+      for (auto j = 0; j < 100; ++j)
+      {
+         t = j % 10 == 9 ? jump(engine) : t + step(engine);
+         INFO("t " << t);
+         REQUIRE(Close(envelope.GetValue(cursor, t), Expected(envelope, t)));
+      }
+   });
+}
+
+TEST_CASE("Envelope")
+{
+   SECTION("A cursor stays valid when the envelope changes")
+   {
+      Envelope envelope { false, 0, maxValue, 1.0 };
+      for (auto t : { 0.0, 1.0, 2.0, 3.0 })
+         envelope.Insert(t, t);
+      Envelope::Cursor cursor;
+      REQUIRE(envelope.GetValue(cursor, 2.5) == Approx(2.5));
+      envelope.Delete(3);
+      envelope.Delete(2);
+      REQUIRE(envelope.GetValue(cursor, 2.5) == Approx(1.0));
+      REQUIRE(envelope.GetValue(cursor, 0.5) == Approx(0.5));
+   }
+
+   SECTION("Samples at a discontinuity take the right limit")
+   {
+      Envelope envelope { false, 0, maxValue, 1.0 };
+      envelope.Insert(0, 0);
+      envelope.Insert(1, 1);
+      envelope.Insert(1, 2);
+      envelope.Insert(2, 2);
+      std::vector<double> buffer(8);
+      envelope.GetValues(buffer.data(), buffer.size(), 0, 0.25);
+      const std::vector<double> expected { 0, 0.25, 0.5, 0.75, 2, 2, 2, 2 };
+      for (size_t k = 0; k < buffer.size(); ++k)
+         REQUIRE(buffer[k] == Approx(expected[k]));
+   }
+}
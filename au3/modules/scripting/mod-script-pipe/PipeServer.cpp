@@ -4,6 +4,7 @@
 #include <windows.h>
 #include <stdio.h>
 #include <tchar.h>
+#include <string>
 
 const int nBuff = 1024;
 
@@ -70,16 +71,21 @@ void PipeServer()
          for(;;)
          {
             printf( "About to read\n" );
-            bSuccess = ReadFile( hPipeToSrv, chRequest, nBuff, &cbBytesRead, NULL);
-
-            chRequest[ cbBytesRead] = '\0'; 
+            // A message longer than the buffer, such as a batch of commands,
+            // is read in several parts
+            std::string request;
+            do
+            {
+               bSuccess = ReadFile( hPipeToSrv, chRequest, nBuff, &cbBytesRead, NULL);
+               request.append( chRequest, cbBytesRead );
+            } while( !bSuccess && GetLastError() == ERROR_MORE_DATA );
 
-            if( !bSuccess || cbBytesRead==0 )
+            if( !bSuccess || request.empty() )
                break;
 
-            printf( "Rxd %s\n", chRequest );
+            printf( "Rxd %s\n", request.c_str() );
 
-            DoSrv( chRequest );
+            DoSrv( request.data() );
             jj++;
             while( true )
             {
@@ -112,6 +118,7 @@ void PipeServer()
 #include <sys/stat.h>
 #include <stdio.h>
 #include <unistd.h>
+#include <stdlib.h>
 #include <string.h>
 
 const char fifotmpl[] = "/tmp/audacity_script_pipe.%s.%d";
@@ -164,19 +171,24 @@ void PipeServer()
       return;
    }
 
-   while (fgets(buf, sizeof(buf), toFifo) != NULL)
+   // Lines have no length limit, so that a batch of commands may be one line
+   char *line = NULL;
+   size_t capacity = 0;
+   ssize_t lineLength;
+   while ((lineLength = getline(&line, &capacity, toFifo)) != -1)
    {
-      int len = strlen(buf);
-      if (len <= 1)
+      if (lineLength <= 1)
       {
          continue;
       }
 
-      buf[len - 1] = '\0';
+      if (line[lineLength - 1] == '\n')
+         line[lineLength - 1] = '\0';
 
-      printf("Server received %s\n", buf);
-      DoSrv(buf);
+      printf("Server received %s\n", line);
+      DoSrv(line);
 
+      int len;
       while (true)
       {
          len = DoSrvMore(buf, nBuff);
@@ -194,6 +206,8 @@ void PipeServer()
 
    printf("Read failed on fifo, quitting\n");
 
+   free(line);
+
    if (toFifo != NULL)
       fclose(toFifo);
 
@@ -61,6 +61,13 @@ wxArrayString aStr;
 unsigned int currentLine;
 size_t currentPosition;
 
+// Lines from "BeginBatch:" to "EndBatch:" are gathered, and sent to Audacity
+// as one batch when the last is received.  Each line before that is answered
+// at once, so that clients that wait for the answer of each line can send a
+// batch too.
+wxString batch;
+bool gatheringBatch = false;
+
 // Send the received command to Audacity and build an array of response lines.
 // The response lines can be retrieved by calling DoSrvMore repeatedly.
 int DoSrv(char *pIn)
@@ -72,8 +79,32 @@ int DoSrv(char *pIn)
    wxString Str1(pIn, wxConvUTF8); 
    Str1.Replace( wxT("\r"), wxT(""));
    Str1.Replace( wxT("\n"), wxT(""));
-   Str2 = wxEmptyString;
-   (*pScriptServerFn)( &Str1 , &Str2);
+
+   if( !gatheringBatch && Str1.StartsWith(wxT("BeginBatch:")) )
+   {
+      gatheringBatch = true;
+      batch = Str1;
+      Str2 = wxT("Batch begun: OK\n");
+   }
+   else if( gatheringBatch && Str1.StartsWith(wxT("EndBatch")) )
+   {
+      // The relay takes a message of several lines for a batch
+      gatheringBatch = false;
+      Str2 = wxEmptyString;
+      (*pScriptServerFn)( &batch , &Str2);
+      batch.clear();
+   }
+   else if( gatheringBatch )
+   {
+      batch += wxT('\n');
+      batch += Str1;
+      Str2 = wxT("Batched: OK\n");
+   }
+   else
+   {
+      Str2 = wxEmptyString;
+      (*pScriptServerFn)( &Str1 , &Str2);
+   }
 
    Str2 += wxT('\n');
    size_t outputLength = Str2.Length();
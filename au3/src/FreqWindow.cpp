@@ -602,7 +602,7 @@ void FrequencyPlotDialog::DrawBackground(wxMemoryDC & dc)
 
 void FrequencyPlotDialog::DrawPlot()
 {
-   if (!mData || mDataLen < mWindowSize || mAnalyst->GetProcessedSize() == 0) {
+   if (mTracks.empty() || mDataLen < mWindowSize || mAnalyst->GetProcessedSize() == 0) {
       wxMemoryDC memDC;
 
       vRuler->ruler.SetUpdater(&LinearUpdater::Instance());
@@ -820,7 +820,7 @@ void FrequencyPlotDialog::PlotPaint(wxPaintEvent & event)
 
    dc.DrawBitmap( *mBitmap, 0, 0, true );
    // Fix for Bug 1226 "Plot Spectrum freezes... if insufficient samples selected"
-   if (!mData || mDataLen < mWindowSize)
+   if (mTracks.empty() || mDataLen < mWindowSize)
       return;
 
    dc.SetFont(mFreqFont);
@@ -930,7 +930,7 @@ void FrequencyPlotDialog::OnCloseButton(wxCommandEvent & WXUNUSED(event))
    gPrefs->Write(wxT("/FrequencyPlotDialog/FuncChoice"), mFuncChoice->GetSelection());
    gPrefs->Write(wxT("/FrequencyPlotDialog/AxisChoice"), mAxisChoice->GetSelection());
    gPrefs->Flush();
-   mData.reset();
+   mTracks.clear();
    Show(false);
 }
 
@@ -942,7 +942,7 @@ void FrequencyPlotDialog::SendRecalcEvent()
 
 void FrequencyPlotDialog::Recalc()
 {
-   if (!mData || mDataLen < mWindowSize) {
+   if (mTracks.empty() || mDataLen < mWindowSize) {
       DrawPlot();
       return;
    }
@@ -971,8 +971,11 @@ void FrequencyPlotDialog::Recalc()
          mProgress->SetValue(num);
       };
 
+      const auto read = [this](float *buffer, size_t start, size_t len) {
+         return ReadAudio(buffer, start, len);
+      };
       mAnalyst->Calculate(alg, windowFunc, mWindowSize, mRate,
-         mData.get(), mDataLen,
+         read, mDataLen,
          &mYMin, &mYMax, std::move(progress));
 
       mProgress->Reset();
@@ -33,6 +33,7 @@ undo memory so as to free up space.
 #include "Clipboard.h"
 #include "CommonCommandFlags.h"
 #include "Diags.h"
+#include "HistorySpaceUsage.h"
 #include "../images/Arrow.xpm"
 #include "../images/Empty9x16.xpm"
 #include "UndoManager.h"
@@ -71,10 +72,8 @@ struct SpaceUsageCalculator {
    SpaceArray space;
    Type clipboardSpaceUsage;
 
-   void Calculate( UndoManager &manager )
+   void Calculate( AudacityProject &project )
    {
-      SampleBlockIDSet seen;
-
       // After copies and pastes, a block file may be used in more than
       // one place in one undo history state, and it may be used in more than
       // one undo history state.  It might even be used in two states, but not
@@ -90,18 +89,15 @@ struct SpaceUsageCalculator {
       // contribution to space usage should be counted only in that latest
       // state.
 
-      manager.VisitStates(
-         [this, &seen](const UndoStackElem &elem) {
-            // Scan all tracks at current level
-            if (auto pTracks = UndoTracks::Find(elem))
-               space.push_back(CalculateUsage(*pTracks, seen));
-         },
-         true // newest state first
-      );
+      // HistorySpaceUsage does that, and inspects only the states that changed
+      // since the last refresh.
+
+      // Oldest state first
+      space = HistorySpaceUsage::Get( project ).GetStateUsages();
 
       // Count the usage of the clipboard separately, using another set.  Do not
       // multiple-count any block occurring multiple times within the clipboard.
-      seen.clear();
+      SampleBlockIDSet seen;
       clipboardSpaceUsage = CalculateUsage(
          Clipboard::Get().GetTracks(), seen);
 
@@ -286,10 +282,10 @@ void HistoryDialog::DoUpdate()
    int i = 0;
 
    SpaceUsageCalculator calculator;
-   calculator.Calculate( *mManager );
+   calculator.Calculate( *mProject );
 
    // point to size for oldest state
-   auto iter = calculator.space.rbegin();
+   auto iter = calculator.space.begin();
 
    mList->DeleteAllItems();
 
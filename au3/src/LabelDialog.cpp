@@ -26,6 +26,7 @@
 #include <wx/textdlg.h>
 
 #include "ShuttleGui.h"
+#include "LabelFile.h"
 #include "LabelTrack.h"
 #include "Prefs.h"
 #include "Project.h"
@@ -641,11 +642,10 @@ void LabelDialog::OnImport(wxCommandEvent & WXUNUSED(event))
    if (!fileName.empty()) {
       LabelFormat format = LabelTrack::FormatForFileName(fileName);
 
-      wxTextFile f;
+      std::string text;
 
       // Get at the data
-      f.Open(fileName);
-      if (!f.IsOpened()) {
+      if (!LabelFile::Read(fileName, text)) {
          AudacityMessageBox(
             XO("Could not open file: %s").Format( fileName ) );
       }
@@ -653,7 +653,7 @@ void LabelDialog::OnImport(wxCommandEvent & WXUNUSED(event))
          // Create a temporary label track and load the labels
          // into it
          auto lt = std::make_shared<LabelTrack>();
-         lt->Import(f, format);
+         lt->Import(text, format);
 
          // Add the labels to our collection
          AddLabels(lt.get());
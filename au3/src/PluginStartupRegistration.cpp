@@ -10,7 +10,9 @@
 
 #include "PluginStartupRegistration.h"
 
+#include <algorithm>
 #include <thread>
+#include <utility>
 
 #include <wx/log.h>
 #include <wx/app.h>
@@ -127,18 +129,92 @@ namespace
    };
 }
 
-PluginStartupRegistration::PluginStartupRegistration(const std::map<wxString, std::vector<wxString>>& pluginsToProcess)
+PluginStartupRegistration::Worker::Worker(PluginStartupRegistration& owner)
+   : mOwner(owner)
 {
-   for(auto& p : pluginsToProcess)
-      mPluginsToProcess.push_back(p);
 }
 
-void PluginStartupRegistration::OnInternalError(const wxString& error)
+PluginStartupRegistration::Worker::~Worker() = default;
+
+void PluginStartupRegistration::Worker::Start(size_t pluginIndex)
+{
+   mCurrentPluginIndex = pluginIndex;
+   mCurrentPluginProviderIndex = 0;
+   ValidateCurrent();
+}
+
+void PluginStartupRegistration::Worker::ValidateCurrent()
+{
+   try
+   {
+      //Host process is created on demand, and again after a crash
+      //or a skip, without disturbing other workers
+      if(!mValidator)
+         mValidator = std::make_unique<AsyncPluginValidator>(*this);
+
+      const auto& plugin = mOwner.mPluginsToProcess[*mCurrentPluginIndex];
+      mValidator->Validate(plugin.second[mCurrentPluginProviderIndex], plugin.first);
+      mRequestStartTime = std::chrono::system_clock::now();
+   }
+   catch(std::exception& e)
+   {
+      mOwner.OnHostFailed(*this, e.what());
+   }
+   catch(...)
+   {
+      mOwner.OnHostFailed(*this, "unknown error");
+   }
+}
+
+void PluginStartupRegistration::Worker::Stop()
+{
+   mValidator.reset();
+}
+
+std::optional<size_t> PluginStartupRegistration::Worker::Retire()
+{
+   mHostFailed = true;
+   mValidator.reset();
+   mCurrentPluginProviderIndex = 0;
+   mValidProviderFound = false;
+   mFailedPluginsCache.clear();
+   return std::exchange(mCurrentPluginIndex, std::nullopt);
+}
+
+bool PluginStartupRegistration::Worker::IsHostFailed() const noexcept
+{
+   return mHostFailed;
+}
+
+std::optional<size_t> PluginStartupRegistration::Worker::GetCurrentPluginIndex() const noexcept
+{
+   return mCurrentPluginIndex;
+}
+
+std::chrono::system_clock::time_point PluginStartupRegistration::Worker::GetRequestStartTime() const noexcept
 {
-   StopWithError(error);
+   return mRequestStartTime;
 }
 
-void PluginStartupRegistration::OnPluginFound(const PluginDescriptor& desc)
+bool PluginStartupRegistration::Worker::IsTimedOut(std::chrono::system_clock::duration timeout) const
+{
+   return mCurrentPluginIndex.has_value() && mValidator &&
+      std::chrono::system_clock::now() - mRequestStartTime >= timeout &&
+      mValidator->InactiveSince() < mRequestStartTime;
+}
+
+void PluginStartupRegistration::Worker::OnInternalError(const wxString& error)
+{
+   //The current plugin is counted as failed, and the next one gets a host
+   //process of its own; the other workers aren't disturbed
+   wxLogError("Plugin validation error: %s", error);
+   if(mCurrentPluginIndex)
+      Skip();
+   else
+      Stop();
+}
+
+void PluginStartupRegistration::Worker::OnPluginFound(const PluginDescriptor& desc)
 {
    if(!mValidProviderFound)
       mFailedPluginsCache.clear();
@@ -149,7 +225,7 @@ void PluginStartupRegistration::OnPluginFound(const PluginDescriptor& desc)
    PluginManager::Get().RegisterPlugin(PluginDescriptor { desc });
 }
 
-void PluginStartupRegistration::OnPluginValidationFailed(const wxString& providerId, const wxString& path)
+void PluginStartupRegistration::Worker::OnPluginValidationFailed(const wxString& providerId, const wxString& path)
 {
    PluginID ID = providerId + wxT("_") + path;
    PluginDescriptor pluginDescriptor;
@@ -165,54 +241,103 @@ void PluginStartupRegistration::OnPluginValidationFailed(const wxString& provide
    mFailedPluginsCache.push_back(std::move(pluginDescriptor));
 }
 
-
-void PluginStartupRegistration::OnValidationFinished()
+void PluginStartupRegistration::Worker::OnValidationFinished()
 {
    ++mCurrentPluginProviderIndex;
-   if(mValidProviderFound ||
-      mPluginsToProcess[mCurrentPluginIndex].second.size() == mCurrentPluginProviderIndex)
+   if(!mValidProviderFound &&
+      mOwner.mPluginsToProcess[*mCurrentPluginIndex].second.size() != mCurrentPluginProviderIndex)
    {
-      if(!mFailedPluginsCache.empty())
+      ValidateCurrent();
+      return;
+   }
+
+   std::vector<wxString> failedPaths;
+   if(!mFailedPluginsCache.empty())
+   {
+      //we've tried all providers associated with same module path...
+      if(!mValidProviderFound)
       {
-         //we've tried all providers associated with same module path...
-         if(!mValidProviderFound)
-         {
-            //...but none of them succeeded
-            mFailedPluginsPaths.push_back(mFailedPluginsCache[0].GetPath());
+         //...but none of them succeeded
+         failedPaths.push_back(mFailedPluginsCache[0].GetPath());
 
-            //Same plugin path, but different providers, we need to register all of them
-            for(auto& desc : mFailedPluginsCache)
-               PluginManager::Get().RegisterPlugin(std::move(desc));
-         }
-         //plugin type was detected, but plugin instance validation has failed
-         else
+         //Same plugin path, but different providers, we need to register all of them
+         for(auto& desc : mFailedPluginsCache)
+            PluginManager::Get().RegisterPlugin(std::move(desc));
+      }
+      //plugin type was detected, but plugin instance validation has failed
+      else
+      {
+         for(auto& desc : mFailedPluginsCache)
          {
-            for(auto& desc : mFailedPluginsCache)
-            {
-               if(desc.GetPluginType() != PluginTypeStub)
-                  mFailedPluginsPaths.push_back(desc.GetPath());
-            }
+            if(desc.GetPluginType() != PluginTypeStub)
+               failedPaths.push_back(desc.GetPath());
          }
       }
-      ++mCurrentPluginIndex;
-      mCurrentPluginProviderIndex = 0;
-      mValidProviderFound = false;
-      mFailedPluginsCache.clear();
    }
-   ProcessNext();
+   mCurrentPluginIndex.reset();
+   mCurrentPluginProviderIndex = 0;
+   mValidProviderFound = false;
+   mFailedPluginsCache.clear();
+
+   mOwner.OnPluginProcessed(*this, failedPaths);
+}
+
+void PluginStartupRegistration::Worker::Skip()
+{
+   if(!mCurrentPluginIndex)
+      return;
+
+   if(mValidator)
+   {
+      //Drop current validator, no more callbacks will be received from now
+      mValidator->SetDelegate(nullptr);
+      //While on Linux and MacOS socket `shutdown()` wakes up `select()` almost
+      //immediately, on Windows it sometimes get delayed on unspecified amount
+      //of time. As we do not expect any data we can safely move remaining
+      //operations to another thread.
+      std::thread([validator = std::shared_ptr<AsyncPluginValidator>(std::move(mValidator))]{ }).detach();
+   }
+
+   if(!mValidProviderFound)
+   {
+      // Validator didn't report anything yet or it tried
+      // one or more providers that didn't recognize the plugin.
+      // In that case we assume that none of the remaining providers
+      // can recognize that plugin.
+      // Note: create stub `PluginDescriptors` for each associated provider
+      const auto& plugin = mOwner.mPluginsToProcess[*mCurrentPluginIndex];
+      for(;mCurrentPluginProviderIndex < plugin.second.size(); ++mCurrentPluginProviderIndex)
+         OnPluginValidationFailed(
+            plugin.second[mCurrentPluginProviderIndex],
+            plugin.first);
+      mCurrentPluginProviderIndex = plugin.second.size() - 1;
+   }
+   //else
+   //    Don't assume that `OnValidationFinished()` and `OnPluginFound()`
+   //    aren't deferred within run loop
+
+   OnValidationFinished();
 }
 
+PluginStartupRegistration::PluginStartupRegistration(const std::map<wxString, std::vector<wxString>>& pluginsToProcess)
+   : mQueue(pluginsToProcess.size())
+{
+   for(auto& p : pluginsToProcess)
+      mPluginsToProcess.push_back(p);
+}
+
+PluginStartupRegistration::~PluginStartupRegistration() = default;
+
 const std::vector<wxString>& PluginStartupRegistration::GetFailedPluginsPaths() const noexcept
 {
    return mFailedPluginsPaths;
 }
 
-void PluginStartupRegistration::Run(std::chrono::seconds timeout)
+void PluginStartupRegistration::Run(std::chrono::seconds timeout, size_t workersCount)
 {
    PluginScanDialog dialog(nullptr, wxID_ANY, XO("Searching for plugins"));
    wxTimer timeoutTimer(&dialog, OnPluginScanTimeout);
    mScanDialog = &dialog;
-   mTimeoutTimer = &timeoutTimer;
    mTimeout = timeout;
 
    dialog.Bind(wxEVT_BUTTON, [this](wxCommandEvent& evt) {
@@ -222,24 +347,38 @@ void PluginStartupRegistration::Run(std::chrono::seconds timeout)
    });
    dialog.Bind(wxEVT_TIMER, [this](wxTimerEvent& evt) {
       if(evt.GetId() == OnPluginScanTimeout)
-      {
-         if(mValidator && mValidator->InactiveSince() < mRequestStartTime)
-            Skip();
-         //else
-         //   wxMessageBox("Please check for plugin popups!");
-      }
+         CheckTimeouts();
       else
          evt.Skip();
    });
    dialog.Bind(wxEVT_CLOSE_WINDOW, [this](wxCloseEvent& evt) {
       evt.Skip();
-      mValidator.reset();
+      for(auto& worker : mWorkers)
+         worker->Stop();
       PluginManager::Get().Save();
       PluginManager::Get().NotifyPluginsChanged();
    });
 
    dialog.CenterOnScreen();
-   ProcessNext();
+
+   if(workersCount == 0)
+      workersCount = std::max(1u, std::thread::hardware_concurrency());
+   workersCount = std::min(workersCount, mPluginsToProcess.size());
+   for(size_t i = 0; i < workersCount; ++i)
+      mWorkers.push_back(std::make_unique<Worker>(*this));
+
+   if(mPluginsToProcess.empty())
+      Stop();
+   for(auto& worker : mWorkers)
+      ProcessNext(*worker);
+   UpdateProgress();
+
+   if(timeout.count() > 0)
+   {
+      //Each worker's request times out separately; check them all regularly
+      const auto period = std::min<std::chrono::milliseconds>(timeout, std::chrono::seconds(1));
+      timeoutTimer.Start(period.count());
+   }
    dialog.ShowModal();
 }
 
@@ -251,32 +390,8 @@ void PluginStartupRegistration::Stop()
 
 void PluginStartupRegistration::Skip()
 {
-   //Drop current validator, no more callbacks will be received from now
-   mValidator->SetDelegate(nullptr);
-   //While on Linux and MacOS socket `shutdown()` wakes up `select()` almost
-   //immediately, on Windows it sometimes get delayed on unspecified amount
-   //of time. As we do not expect any data we can safely move remaining
-   //operations to another thread.
-   std::thread([validator = std::shared_ptr<AsyncPluginValidator>(std::move(mValidator))]{ }).detach();
-
-   if(!mValidProviderFound)
-   {
-      // Validator didn't report anything yet or it tried
-      // one or more providers that didn't recognize the plugin.
-      // In that case we assume that none of the remaining providers
-      // can recognize that plugin.
-      // Note: create stub `PluginDescriptors` for each associated provider
-      for(;mCurrentPluginProviderIndex < mPluginsToProcess[mCurrentPluginIndex].second.size(); ++mCurrentPluginProviderIndex)
-         OnPluginValidationFailed(
-            mPluginsToProcess[mCurrentPluginIndex].second[mCurrentPluginProviderIndex],
-            mPluginsToProcess[mCurrentPluginIndex].first);
-      mCurrentPluginProviderIndex = mPluginsToProcess[mCurrentPluginIndex].second.size() - 1;
-   }
-   //else
-   //    Don't assume that `OnValidationFinished()` and `OnPluginFound()`
-   //    aren't deferred within run loop
-
-   OnValidationFinished();
+   if(auto worker = FindOldestRequest())
+      worker->Skip();
 }
 
 void PluginStartupRegistration::StopWithError(const wxString& msg)
@@ -286,41 +401,85 @@ void PluginStartupRegistration::StopWithError(const wxString& msg)
    Stop();
 }
 
-void PluginStartupRegistration::ProcessNext()
+void PluginStartupRegistration::OnHostFailed(Worker& worker, const wxString& msg)
 {
-   if(mCurrentPluginIndex == mPluginsToProcess.size())
+   if(auto pluginIndex = worker.Retire())
+      mQueue.GiveBack(*pluginIndex);
+
+   const auto hasWorkersLeft = std::any_of(mWorkers.begin(), mWorkers.end(),
+      [](const auto& other) { return !other->IsHostFailed(); });
+   if(!hasWorkersLeft)
    {
-      Stop();
+      StopWithError(msg);
       return;
    }
+   wxLogError("Plugin host error: %s", msg);
 
-   try
+   //Otherwise the plugin is taken by the next worker done with its own
+   for(auto& other : mWorkers)
    {
-      if(auto dialog = static_cast<PluginScanDialog*>(mScanDialog.get()))
+      if(!other->IsHostFailed() && !other->GetCurrentPluginIndex())
       {
-         const auto progress = static_cast<float>(mCurrentPluginIndex) / static_cast<float>(mPluginsToProcess.size());
-         dialog->UpdateProgress(
-            mPluginsToProcess[mCurrentPluginIndex].first,
-            progress);
+         ProcessNext(*other);
+         break;
       }
-      if(!mValidator)
-         mValidator = std::make_unique<AsyncPluginValidator>(*this);
-
-      mValidator->Validate(
-         mPluginsToProcess[mCurrentPluginIndex].second[mCurrentPluginProviderIndex],
-         mPluginsToProcess[mCurrentPluginIndex].first
-      );
-      mRequestStartTime = std::chrono::system_clock::now();
-      if(auto timer = mTimeoutTimer.get())
-         timer->StartOnce(std::chrono::duration_cast<std::chrono::milliseconds>(mTimeout).count());
    }
-   catch(std::exception& e)
+   UpdateProgress();
+}
+
+void PluginStartupRegistration::ProcessNext(Worker& worker)
+{
+   //A worker may have been given a plugin meanwhile by OnHostFailed
+   if(worker.IsHostFailed() || worker.GetCurrentPluginIndex())
+      return;
+   if(auto pluginIndex = mQueue.Next())
+      worker.Start(*pluginIndex);
+}
+
+void PluginStartupRegistration::OnPluginProcessed(Worker& worker, const std::vector<wxString>& failedPaths)
+{
+   mFailedPluginsPaths.insert(mFailedPluginsPaths.end(), failedPaths.begin(), failedPaths.end());
+   mQueue.SetProcessed();
+   if(mQueue.IsComplete())
    {
-      StopWithError(e.what());
+      Stop();
+      return;
    }
-   catch(...)
+   ProcessNext(worker);
+   UpdateProgress();
+}
+
+PluginStartupRegistration::Worker* PluginStartupRegistration::FindOldestRequest() const
+{
+   Worker* result{nullptr};
+   for(auto& worker : mWorkers)
    {
-      StopWithError("unknown error");
+      if(worker->GetCurrentPluginIndex() &&
+         (result == nullptr || worker->GetRequestStartTime() < result->GetRequestStartTime()))
+         result = worker.get();
    }
+   return result;
 }
 
+void PluginStartupRegistration::UpdateProgress()
+{
+   auto dialog = static_cast<PluginScanDialog*>(mScanDialog.get());
+   auto worker = FindOldestRequest();
+   if(dialog == nullptr || worker == nullptr)
+      return;
+
+   //Show the plugin that takes longest, as that is the one to skip
+   const auto progress = static_cast<float>(mQueue.GetProcessedCount()) / static_cast<float>(mQueue.GetPluginsCount());
+   dialog->UpdateProgress(
+      mPluginsToProcess[*worker->GetCurrentPluginIndex()].first,
+      progress);
+}
+
+void PluginStartupRegistration::CheckTimeouts()
+{
+   for(auto& worker : mWorkers)
+   {
+      if(worker->IsTimedOut(mTimeout))
+         worker->Skip();
+   }
+}
@@ -14,50 +14,98 @@
 #include <map>
 #include <memory>
 #include <chrono>
+#include <optional>
 #include <wx/string.h>
 #include <wx/timer.h>
 #include "AsyncPluginValidator.h"
+#include "PluginDescriptor.h"
+#include "PluginScanQueue.h"
 #include "wxPanelWrapper.h"
 
 ///Helper class that passes plugins provided in constructor
-///to plugin validator, then "good" plugins are registered in
-///PluginManager. 
-class PluginStartupRegistration final :
-   public AsyncPluginValidator::Delegate
+///to plugin validators, then "good" plugins are registered in
+///PluginManager. Validators run in parallel, each in a host process
+///of its own, taking the next plugin from the shared list when done.
+///A validator error only affects the plugin and host of its worker.
+class PluginStartupRegistration final
 {
-   std::unique_ptr<AsyncPluginValidator> mValidator;
+   ///Validates one plugin at a time, trying each provider associated
+   ///with its path in turn
+   class Worker final : public AsyncPluginValidator::Delegate
+   {
+      PluginStartupRegistration& mOwner;
+      std::unique_ptr<AsyncPluginValidator> mValidator;
+      std::optional<size_t> mCurrentPluginIndex;
+      size_t mCurrentPluginProviderIndex{0};
+      bool mValidProviderFound{false};
+      bool mHostFailed{false};
+      std::vector<PluginDescriptor> mFailedPluginsCache;
+      std::chrono::system_clock::time_point mRequestStartTime{};
+
+   public:
+      explicit Worker(PluginStartupRegistration& owner);
+      ~Worker() override;
+
+      void Start(size_t pluginIndex);
+      void Skip();
+      void Stop();
+      ///Stops for good, giving up the current plugin without validating it
+      ///@return index of the plugin given up, if any
+      std::optional<size_t> Retire();
+
+      ///Whether the host process couldn't be started or talked to
+      bool IsHostFailed() const noexcept;
+      std::optional<size_t> GetCurrentPluginIndex() const noexcept;
+      std::chrono::system_clock::time_point GetRequestStartTime() const noexcept;
+      ///Whether the current request has received no response
+      ///since it was made, longer ago than the timeout
+      bool IsTimedOut(std::chrono::system_clock::duration timeout) const;
+
+      void OnInternalError(const wxString& error) override;
+      void OnPluginFound(const PluginDescriptor& desc) override;
+      void OnPluginValidationFailed(const wxString& providerId, const wxString& path) override;
+      void OnValidationFinished() override;
+
+   private:
+      void ValidateCurrent();
+   };
+
+   std::vector<std::unique_ptr<Worker>> mWorkers;
    std::vector<std::pair<wxString, std::vector<wxString>>> mPluginsToProcess;
-   size_t mCurrentPluginIndex{0};
-   size_t mCurrentPluginProviderIndex{0};
-   bool mValidProviderFound{false};
+   PluginScanQueue mQueue;
    std::vector<wxString> mFailedPluginsPaths;
-   std::vector<PluginDescriptor> mFailedPluginsCache;
    wxWeakRef<wxDialogWrapper> mScanDialog;
-   wxWeakRef<wxTimer> mTimeoutTimer;
    std::chrono::system_clock::duration mTimeout{};
-   std::chrono::system_clock::time_point mRequestStartTime{};
 public:
 
    PluginStartupRegistration(const std::map<wxString, std::vector<wxString>>& pluginsToProcess);
+   ~PluginStartupRegistration();
 
    ///Starts validation, showing dialog that blocks execution until
    ///process is complete or canceled
    ///@param timeout Time allowed to spend on a single plugin validation.
    ///Pass 0 to disable timeout.
-   void Run(std::chrono::seconds timeout = std::chrono::seconds(30));
+   ///@param workersCount Number of plugins validated at once.
+   ///Pass 0 to use the number of processor cores.
+   void Run(
+      std::chrono::seconds timeout = std::chrono::seconds(30),
+      size_t workersCount = 0);
 
    ///Returns list of paths of plugins that didn't pass validation for some reason
    const std::vector<wxString>& GetFailedPluginsPaths() const noexcept;
 
-   void OnInternalError(const wxString& error) override;
-   void OnPluginFound(const PluginDescriptor& desc) override;
-   void OnPluginValidationFailed(const wxString& providerId, const wxString& path) override;
-   void OnValidationFinished() override;
-
 private:
    
    void Stop();
    void Skip();
    void StopWithError(const wxString& msg);
-   void ProcessNext();
+   ///Gives the worker's plugin to another worker, stopping only when
+   ///no worker is left
+   void OnHostFailed(Worker& worker, const wxString& msg);
+   void ProcessNext(Worker& worker);
+   void OnPluginProcessed(Worker& worker, const std::vector<wxString>& failedPaths);
+   ///The worker that has been busy with its plugin for the longest time
+   Worker* FindOldestRequest() const;
+   void UpdateProgress();
+   void CheckTimeouts();
 };
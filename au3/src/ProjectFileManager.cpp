@@ -1383,27 +1383,28 @@ std::vector<std::shared_ptr<MIR::AnalyzedAudioClip>> RunTempoDetection(
    auto progress = MakeProgress(
       XO("Music Information Retrieval"), XO("Analyzing imported audio"),
       ProgressShowCancel);
-   auto count = 0;
    const auto reportProgress = [&](double progressFraction) {
-      const auto result = progress->Poll(
-         (count + progressFraction) / readers.size() * 1000, 1000);
+      const auto result = progress->Poll(progressFraction * 1000, 1000);
       if (result != ProgressResult::Success)
          throw UserException {};
    };
 
+   // The clips are analyzed in parallel; each reader is used by one thread
+   // only.
+   std::vector<MIR::ProjectSyncInfoInput> inputs;
+   inputs.reserve(readers.size());
+   for (const auto& reader : readers)
+      inputs.push_back({
+         *reader,      reader->filename, reader->tags,       {},
+         projectTempo, projectWasEmpty,  isBeatsAndMeasures,
+      });
+   const auto syncInfos = MIR::GetProjectSyncInfos(inputs, reportProgress);
+
    std::vector<std::shared_ptr<MIR::AnalyzedAudioClip>> analyzedClips;
    analyzedClips.reserve(readers.size());
-   std::transform(
-      readers.begin(), readers.end(), std::back_inserter(analyzedClips),
-      [&](const std::shared_ptr<ClipMirAudioReader>& reader) {
-         const MIR::ProjectSyncInfoInput input {
-            *reader,      reader->filename, reader->tags,       reportProgress,
-            projectTempo, projectWasEmpty,  isBeatsAndMeasures,
-         };
-         auto syncInfo = MIR::GetProjectSyncInfo(input);
-         ++count;
-         return std::make_shared<AnalyzedWaveClip>(reader, syncInfo);
-      });
+   for (size_t i = 0; i < readers.size(); ++i)
+      analyzedClips.push_back(
+         std::make_shared<AnalyzedWaveClip>(readers[i], syncInfos[i]));
    return analyzedClips;
 }
 } // namespace
@@ -20,6 +20,8 @@
 #include "CommandDirectory.h"
 #include "Project.h"
 
+#include <optional>
+
 static CommandDirectory::RegisterType sRegisterType{
    std::make_unique<BatchEvalCommandType>()
 };
@@ -53,7 +55,12 @@ bool BatchEvalCommand::Apply(const CommandContext & context)
    // The catalog though may change during a session, as it includes the 
    // names of macro commands - so the long-lived copy will need to 
    // be refreshed after macros are added/deleted.
-   MacroCommandsCatalog catalog(&context.project);
+   // Batches of scripted commands share one for the length of the batch.
+   std::optional<MacroCommandsCatalog> ownCatalog;
+   auto pCatalog = BatchEvalCatalogScope::Find(context.project);
+   if (!pCatalog)
+      pCatalog = &ownCatalog.emplace(&context.project);
+   auto &catalog = *pCatalog;
 
    wxString macroName = GetString(wxT("MacroName"));
    if (!macroName.empty())
@@ -82,3 +89,28 @@ bool BatchEvalCommand::Apply(const CommandContext & context)
 
 BatchEvalCommand::~BatchEvalCommand()
 { }
+
+// Scopes are only made and destroyed on the main thread, innermost first
+static BatchEvalCatalogScope *sCurrentScope = nullptr;
+
+BatchEvalCatalogScope::BatchEvalCatalogScope(AudacityProject &project)
+   : mProject{ project }
+   , mCatalog{ &project }
+   , mPrevious{ sCurrentScope }
+{
+   sCurrentScope = this;
+}
+
+BatchEvalCatalogScope::~BatchEvalCatalogScope()
+{
+   sCurrentScope = mPrevious;
+}
+
+const MacroCommandsCatalog *
+BatchEvalCatalogScope::Find(const AudacityProject &project)
+{
+   for (auto pScope = sCurrentScope; pScope; pScope = pScope->mPrevious)
+      if (&pScope->mProject == &project)
+         return &pScope->mCatalog;
+   return nullptr;
+}
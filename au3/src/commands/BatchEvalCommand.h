@@ -48,4 +48,23 @@ public:
    bool Apply(const CommandContext &context) override;
 };
 
+//! While one exists, BatchEvalCommands applied to its project look up names
+//! in its catalog, instead of each building a catalog of their own
+class BatchEvalCatalogScope final
+{
+public:
+   explicit BatchEvalCatalogScope(AudacityProject &project);
+   ~BatchEvalCatalogScope();
+   BatchEvalCatalogScope(const BatchEvalCatalogScope &) = delete;
+   BatchEvalCatalogScope &operator=(const BatchEvalCatalogScope &) = delete;
+
+   //! @return null if no scope exists for the project
+   static const MacroCommandsCatalog *Find(const AudacityProject &project);
+
+private:
+   const AudacityProject &mProject;
+   const MacroCommandsCatalog mCatalog;
+   BatchEvalCatalogScope *const mPrevious;
+};
+
 #endif /* End of include guard: __BATCHEVALCOMMAND__ */
@@ -25,34 +25,314 @@ code out of ModuleManager.
 #include "CommandBuilder.h"
 #include "ActiveProject.h"
 #include "AppCommandEvent.h"
+#include "BatchEvalCommand.h"
+#include "Command.h"
+#include "EffectAutomationParameters.h"
 #include "Project.h"
+#include "ProjectHistory.h"
 #include <wx/app.h>
+#include <rapidjson/document.h>
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
+#include <chrono>
+#include <optional>
 #include <thread>
+#include <vector>
 
-/// This is the function which actually obeys one command.
-static int ExecCommand(wxString *pIn, wxString *pOut, bool fromMain)
+namespace {
+
+/*
+ A batch is one message holding many commands, which are all applied in one
+ dispatch to the main thread, answered by one response.  It is either a JSON
+ array of command strings, or a JSON object such as
+    {"Commands": ["Select: Start=0 End=1", "Amplify: Ratio=0.5"],
+     "Undo": "Quieter start", "StopOnError": true}
+ or else commands on separate lines, of which the first may be a header such
+ as
+    BeginBatch: Undo="Quieter start" StopOnError=1
+
+ The response is one line of JSON, with the response of each command applied,
+ and the seconds that it took:
+    {"Results": [{"Command": "...", "OK": true, "Seconds": 0.0012,
+                  "Response": "..."}, ...], "OK": true, "Skipped": 0,
+     "Seconds": 0.0025}
+ */
+const wxString BeginBatch = wxT("BeginBatch:");
+
+struct BatchRequest
 {
-   if (auto pProject = ::GetActiveProject().lock()) {
-      CommandBuilder builder(*pProject, *pIn);
-      if (builder.WasValid())
-      {
-         OldStyleCommandPointer cmd = builder.GetCommand();
+   std::vector<wxString> commands;
+   //! If not empty, the undo states that the batch pushes are made one, with
+   //! this description
+   wxString undo;
+   //! If true, commands after the first that fails are not applied
+   bool stopOnError = false;
+};
+
+// No command name begins with a bracket
+bool IsJson(const wxString &message)
+{
+   const auto first = message.find_first_not_of(wxT(" \t"));
+   return first != wxString::npos &&
+      (message[first] == wxT('[') || message[first] == wxT('{'));
+}
+
+bool IsBatch(const wxString &message)
+{
+   return IsJson(message) || message.find(wxT('\n')) != wxString::npos ||
+      message.StartsWith(BeginBatch);
+}
 
-         AppCommandEvent ev;
-         ev.SetCommand(cmd);
+wxString FromJson(const rapidjson::Value &value)
+{
+   return wxString::FromUTF8(value.GetString(), value.GetStringLength());
+}
+
+bool ParseJson(const wxString &message, BatchRequest &request, wxString &error)
+{
+   rapidjson::Document document;
+   const auto utf8 = message.utf8_str();
+   document.Parse(utf8.data(), utf8.length());
+   if (document.HasParseError()) {
+      error = wxString::Format(
+         wxT("Batch is not valid JSON, at offset %zu"),
+         document.GetErrorOffset());
+      return false;
+   }
+
+   const rapidjson::Value *pCommands = &document;
+   if (document.IsObject()) {
+      const auto commands = document.FindMember("Commands");
+      if (commands == document.MemberEnd()) {
+         error = wxT("Batch has no Commands");
+         return false;
+      }
+      pCommands = &commands->value;
 
-         if (fromMain)
-         {
-            // Use SafelyProcessEvent, which stops exceptions, because this is
-            // expected to be reached from within the XLisp runtime
-            wxTheApp->SafelyProcessEvent(ev);
+      const auto undo = document.FindMember("Undo");
+      if (undo != document.MemberEnd()) {
+         if (!undo->value.IsString()) {
+            error = wxT("Batch Undo is not a string");
+            return false;
          }
-         else
-         {
-            // Send the event to the main thread
-            wxTheApp->AddPendingEvent(ev);
+         request.undo = FromJson(undo->value);
+      }
+
+      const auto stopOnError = document.FindMember("StopOnError");
+      if (stopOnError != document.MemberEnd()) {
+         if (!stopOnError->value.IsBool()) {
+            error = wxT("Batch StopOnError is not a boolean");
+            return false;
          }
+         request.stopOnError = stopOnError->value.GetBool();
+      }
+   }
+
+   if (!pCommands->IsArray()) {
+      error = wxT("Batch Commands are not an array");
+      return false;
+   }
+   request.commands.reserve(pCommands->Size());
+   for (const auto &command : pCommands->GetArray()) {
+      if (!command.IsString()) {
+         error = wxT("Batch command is not a string");
+         return false;
       }
+      request.commands.push_back(FromJson(command));
+   }
+   return true;
+}
+
+void ParseLines(const wxString &message, BatchRequest &request)
+{
+   auto lines = wxSplit(message, wxT('\n'), wxT('\0'));
+   auto iter = lines.begin();
+   wxString header;
+   if (iter != lines.end() && iter->StartsWith(BeginBatch, &header)) {
+      CommandParameters parameters{ header };
+      parameters.Read(wxT("Undo"), &request.undo);
+      parameters.Read(wxT("StopOnError"), &request.stopOnError, false);
+      ++iter;
+   }
+   request.commands.reserve(lines.end() - iter);
+   for (; iter != lines.end(); ++iter) {
+      auto &line = *iter;
+      line.Trim(true).Trim(false);
+      if (!line.empty())
+         request.commands.push_back(std::move(line));
+   }
+}
+
+void AddString(
+   rapidjson::Writer<rapidjson::StringBuffer> &writer, const wxString &string)
+{
+   const auto utf8 = string.utf8_str();
+   writer.String(utf8.data(), utf8.length());
+}
+
+wxString BatchError(const wxString &error)
+{
+   rapidjson::StringBuffer buffer;
+   rapidjson::Writer<rapidjson::StringBuffer> writer{ buffer };
+   writer.StartObject();
+   writer.Key("OK");
+   writer.Bool(false);
+   writer.Key("Error");
+   AddString(writer, error);
+   writer.EndObject();
+   return wxString::FromUTF8(buffer.GetString(), buffer.GetSize()) + wxT("\n");
+}
+
+//! Applies all commands of a batch, on the main thread, in one event
+class BatchOfCommands final : public OldStyleCommand
+{
+public:
+   BatchOfCommands(AudacityProject &project, BatchRequest request)
+      : OldStyleCommand{ project }
+      , mRequest{ std::move(request) }
+      , mResponse{ std::make_shared<ResponseTarget>() }
+   {}
+
+   ComponentInterfaceSymbol GetSymbol() override
+   {
+      return { wxT("Batch"), XO("Batch") };
+   }
+   CommandSignature &GetSignature() override { return mSignature; }
+
+   bool Apply(const CommandContext &) override { return Apply(); }
+   bool Apply() override;
+
+   //! Waits for the batch to be applied
+   wxString GetResponse() { return mResponse->GetResponse() + wxT("\n"); }
+
+private:
+   BatchRequest mRequest;
+   CommandSignature mSignature;
+   const std::shared_ptr<ResponseTarget> mResponse;
+};
+
+bool BatchOfCommands::Apply()
+{
+   using Clock = std::chrono::steady_clock;
+   const auto seconds = [](Clock::duration duration) {
+      return std::chrono::duration<double>(duration).count();
+   };
+
+   rapidjson::StringBuffer buffer;
+   rapidjson::Writer<rapidjson::StringBuffer> writer{ buffer };
+   writer.StartObject();
+   writer.Key("Results");
+   writer.StartArray();
+
+   const auto start = Clock::now();
+   bool result = true;
+   size_t nApplied = 0;
+   {
+      // Build the catalog of command names once, not once per command
+      BatchEvalCatalogScope scope{ mProject };
+      // What the commands push makes one undo state
+      std::optional<ProjectHistory::CombinedPushes> combinedPushes;
+      if (!mRequest.undo.empty())
+         combinedPushes.emplace(mProject, Verbatim(mRequest.undo));
+      for (const auto &command : mRequest.commands) {
+         if (!result && mRequest.stopOnError)
+            break;
+         const auto commandStart = Clock::now();
+         // The builder is made here, so that only one response buffer at a
+         // time is allocated, however long the batch
+         CommandBuilder builder{ mProject, command };
+         bool ok = false;
+         if (builder.WasValid()) {
+            const auto pCommand = builder.GetCommand();
+            ok = pCommand->Apply();
+         }
+         auto response = builder.GetResponse();
+         response.Trim(true).Trim(false);
+         const auto elapsed = Clock::now() - commandStart;
+
+         writer.StartObject();
+         writer.Key("Command");
+         AddString(writer, command);
+         writer.Key("OK");
+         writer.Bool(ok);
+         writer.Key("Seconds");
+         writer.Double(seconds(elapsed));
+         writer.Key("Response");
+         AddString(writer, response);
+         writer.EndObject();
+
+         result = result && ok;
+         ++nApplied;
+      }
+   }
+
+   writer.EndArray();
+   writer.Key("OK");
+   writer.Bool(result);
+   writer.Key("Skipped");
+   writer.Uint64(mRequest.commands.size() - nApplied);
+   writer.Key("Seconds");
+   writer.Double(seconds(Clock::now() - start));
+   writer.EndObject();
+
+   // The writer escapes line breaks within strings, so the response is one
+   // line, and cannot be mistaken for the blank line ending it
+   mResponse->Update(wxString::FromUTF8(buffer.GetString(), buffer.GetSize()));
+   mResponse->Flush();
+   return result;
+}
+
+} // namespace
+
+static void PostCommand(const OldStyleCommandPointer &cmd, bool fromMain)
+{
+   AppCommandEvent ev;
+   ev.SetCommand(cmd);
+
+   if (fromMain)
+   {
+      // Use SafelyProcessEvent, which stops exceptions, because this is
+      // expected to be reached from within the XLisp runtime
+      wxTheApp->SafelyProcessEvent(ev);
+   }
+   else
+   {
+      // Send the event to the main thread
+      wxTheApp->AddPendingEvent(ev);
+   }
+}
+
+/// This obeys all commands of a batch, in one dispatch to the main thread.
+static wxString ExecBatch(
+   AudacityProject &project, const wxString &message, bool fromMain)
+{
+   BatchRequest request;
+   wxString error;
+   if (!IsJson(message))
+      ParseLines(message, request);
+   else if (!ParseJson(message, request, error))
+      return BatchError(error);
+
+   const auto batch =
+      std::make_shared<BatchOfCommands>(project, std::move(request));
+   PostCommand(batch, fromMain);
+
+   // Wait for and retrieve the response
+   return batch->GetResponse();
+}
+
+/// This is the function which actually obeys one command.
+static int ExecCommand(wxString *pIn, wxString *pOut, bool fromMain)
+{
+   if (auto pProject = ::GetActiveProject().lock()) {
+      if (IsBatch(*pIn)) {
+         *pOut = ExecBatch(*pProject, *pIn, fromMain);
+         return 0;
+      }
+
+      CommandBuilder builder(*pProject, *pIn);
+      if (builder.WasValid())
+         PostCommand(builder.GetCommand(), fromMain);
 
       // Wait for and retrieve the response
       *pOut = builder.GetResponse();
@@ -19,6 +19,7 @@
 #include "widgets/LinearDBFormat.h"
 #include "widgets/LinearUpdater.h"
 #include "widgets/Ruler.h"
+#include <algorithm>
 #include <cassert>
 #include <cmath>
 #include <numeric>
@@ -501,9 +502,11 @@ void DynamicRangeProcessorHistoryPanel::OnSize(wxSizeEvent& evt)
 void DynamicRangeProcessorHistoryPanel::OnTimer(wxTimerEvent& evt)
 {
    mPacketBuffer.clear();
-   DynamicRangeProcessorOutputPacket packet;
-   while (mOutputQueue->Get(packet))
-      mPacketBuffer.push_back(packet);
+   // No use drawing more than one packet per pixel column.
+   const auto samplesPerPixel =
+      DynamicRangeProcessorHistory::maxTimeSeconds * mSampleRate /
+      std::max(GetSize().GetWidth(), 1);
+   mOutputQueue->Drain(mPacketBuffer, static_cast<int>(samplesPerPixel));
    mHistory->Push(mPacketBuffer);
 
    if (mHistory->IsEmpty())
@@ -533,6 +536,7 @@ void DynamicRangeProcessorHistoryPanel::InitializeForPlayback(
    CompressorInstance& instance, double sampleRate)
 {
    mSync.reset();
+   mSampleRate = sampleRate;
    mHistory.emplace(sampleRate);
    // We don't know for sure the least packet size (which is variable). 100
    // samples per packet at a rate of 8kHz is 12.5ms, which is quite low
@@ -540,7 +544,6 @@ void DynamicRangeProcessorHistoryPanel::InitializeForPlayback(
    constexpr auto leastPacketSize = 100;
    const size_t maxQueueSize = DynamicRangeProcessorHistory::maxTimeSeconds *
                                sampleRate / leastPacketSize;
-   mPacketBuffer.reserve(maxQueueSize);
    // Although `mOutputQueue` is a shared_ptr, we construct a unique_ptr and
    // invoke the shared_ptr ctor overload that takes a unique_ptr.
    // This way, we avoid the `error: aligned deallocation function of type
@@ -548,6 +551,7 @@ void DynamicRangeProcessorHistoryPanel::InitializeForPlayback(
    // macOS 10.13 or newer` compilation error.
    mOutputQueue =
       std::make_unique<DynamicRangeProcessorOutputPacketQueue>(maxQueueSize);
+   mPacketBuffer.reserve(mOutputQueue->GetCapacity());
    instance.SetOutputQueue(mOutputQueue);
    mTimer.Start(timerPeriodMs);
    mPlaybackAboutToStart = true;
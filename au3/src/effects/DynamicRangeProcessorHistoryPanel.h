@@ -12,6 +12,7 @@
 
 #include "DynamicRangeProcessorClock.h"
 #include "DynamicRangeProcessorHistory.h"
+#include "DynamicRangeProcessorOutputPacketQueue.h"
 #include "Observer.h"
 #include "wxPanelWrapper.h"
 #include <chrono>
@@ -62,6 +63,7 @@ private:
    std::shared_ptr<DynamicRangeProcessorOutputPacketQueue> mOutputQueue;
    std::vector<DynamicRangeProcessorOutputPacket> mPacketBuffer;
    std::optional<DynamicRangeProcessorHistory> mHistory;
+   double mSampleRate = 0;
    DynamicRangeProcessorClock mClock;
    const std::function<void(float)> mOnDbRangeChanged;
    const Observer::Subscription mInitializeProcessingSettingsSubscription;
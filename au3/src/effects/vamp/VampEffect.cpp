@@ -689,6 +689,8 @@ bool VampEffect::TransferDataFromWindow(EffectSettings &)
 void VampEffect::AddFeatures(LabelTrack *ltrack,
                              Vamp::Plugin::FeatureSet &features)
 {
+   LabelArray labels;
+   labels.reserve(features[mOutput].size());
    for (Vamp::Plugin::FeatureList::iterator fli = features[mOutput].begin();
         fli != features[mOutput].end(); ++fli)
    {
@@ -712,8 +714,9 @@ void VampEffect::AddFeatures(LabelTrack *ltrack,
          }
       }
 
-      ltrack->AddLabel(SelectedRegion(ltime0, ltime1), label);
+      labels.emplace_back(SelectedRegion(ltime0, ltime1), label);
    }
+   ltrack->AddLabels(std::move(labels));
 }
 
 void VampEffect::UpdateFromPlugin()
@@ -1,5 +1,6 @@
 #include "../CommonCommandFlags.h"
 #include "FileNames.h"
+#include "LabelFile.h"
 #include "LabelTrack.h"
 #include "MenuCreator.h"
 #include "PluginManager.h"
@@ -336,9 +337,7 @@ void OnExportLabels(const CommandContext &context)
 
    LabelFormat format = LabelTrack::FormatForFileName(fName);
 
-   // Move existing files out of the way.  Otherwise wxTextFile will
-   // append to (rather than replace) the current file.
-
+   // Keep the existing file as a backup
    if (wxFileExists(fName)) {
 #ifdef __WXGTK__
       wxString safetyFileName = fName + wxT("~");
@@ -352,20 +351,16 @@ void OnExportLabels(const CommandContext &context)
       wxRename(fName, safetyFileName);
    }
 
-   wxTextFile f(fName);
-   f.Create();
-   f.Open();
-   if (!f.IsOpened()) {
+   // Format all labels in memory, and write them at once
+   std::string text;
+   for (auto lt : trackRange)
+      lt->Export(text, format);
+
+   if (!LabelFile::Save(fName, text)) {
       AudacityMessageBox(
          XO( "Couldn't write to file: %s" ).Format( fName ) );
       return;
    }
-
-   for (auto lt : trackRange)
-      lt->Export(f, format);
-
-   f.Write();
-   f.Close();
 }
 
 void OnImport(const CommandContext &context)
@@ -392,10 +387,9 @@ void OnImportLabels(const CommandContext &context)
 
    if (!fileName.empty()) {
       LabelFormat format = LabelTrack::FormatForFileName(fileName);
-      wxTextFile f;
+      std::string text;
 
-      f.Open(fileName);
-      if (!f.IsOpened()) {
+      if (!LabelFile::Read(fileName, text)) {
          AudacityMessageBox(
             XO("Could not open file: %s").Format( fileName ) );
          return;
@@ -406,7 +400,7 @@ void OnImportLabels(const CommandContext &context)
       wxFileName::SplitPath(fileName, NULL, NULL, &sTrackName, NULL);
       newTrack->SetName(sTrackName);
 
-      newTrack->Import(f, format);
+      newTrack->Import(text, format);
 
       SelectUtilities::SelectNone( project );
       newTrack->SetSelected(true);
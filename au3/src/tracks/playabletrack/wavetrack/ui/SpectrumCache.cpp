@@ -11,16 +11,26 @@
 #include "SpectrumCache.h"
 
 #include "SpectrogramSettings.h"
+#include "SpectrogramTileCache.h"
+#include "SpectrogramTileDB.h"
 #include "RealFFTf.h"
 #include "Sequence.h"
 #include "Spectrum.h"
+#include "WaveClipSpectrogramTiles.h"
 #include "WaveClipUIUtilities.h"
 #include "WaveTrack.h"
 #include "WideSampleSequence.h"
+#include <algorithm>
 #include <cmath>
 
 namespace {
 
+// Columns come from the tiles when each pixel covers one to
+// 2^(maxTileLevel + 1) windows: zoomed out further, computing all the windows
+// would cost much more than one per pixel.
+constexpr auto maxTileLevel = 2;
+constexpr size_t maxTileBytes = 32 * 1024 * 1024;
+
 static void ComputeSpectrumUsingRealFFTf
    (float * __restrict buffer, const FFTParam *hFFT,
     const float * __restrict window, size_t len, float * __restrict out)
@@ -315,6 +325,67 @@ bool SpecCache::CalculateOneSpectrum(
    return result;
 }
 
+bool SpecCache::CopyFromTiles(
+   SpectrogramTileCache& tiles, int lowerBoundX, int upperBoundX,
+   size_t nBins, const std::vector<float>& gainFactors)
+{
+   if (lowerBoundX >= upperBoundX)
+      return true;
+
+   const auto level = tiles.GetLevel(spp);
+   const auto columnWidth =
+      static_cast<long long>(tiles.GetKey().hop) << level;
+   const auto numColumns = tiles.GetNumColumns(level);
+   const auto tileWidth =
+      static_cast<long long>(SpectrogramTileCache::tileWidth);
+   const auto getColumn = [&](int xx) {
+      const auto sample = where[xx].as_long_long();
+      return sample < 0 ? -1 : sample / columnWidth;
+   };
+
+   // The pool computes the tiles requested last first: request from the last,
+   // so that the view fills from the left.
+   const auto firstTile = std::max(getColumn(lowerBoundX), 0LL) / tileWidth;
+   const auto lastTile =
+      std::min(getColumn(upperBoundX - 1), numColumns - 1) / tileWidth;
+   for (auto index = lastTile; index >= firstTile; --index)
+      tiles.GetTile(level, index);
+
+   auto complete = true;
+   SpectrogramTileCache::TilePtr tile;
+   long long tileIndex = -1;
+   for (auto xx = lowerBoundX; xx < upperBoundX; ++xx)
+   {
+      float *const results = &freq[nBins * xx];
+      const auto column = getColumn(xx);
+      if (column < 0 || column >= numColumns) {
+         // Pixel column is out of bounds of the clip
+         std::fill(results, results + nBins, 0.0f);
+         continue;
+      }
+      const auto index = column / tileWidth;
+      if (index != tileIndex) {
+         // Doesn't wait for the tile to be computed
+         tile = tiles.GetTile(level, index);
+         tileIndex = index;
+      }
+      if (!tile) {
+         // Drawn as silence until the tile is ready
+         std::fill(results, results + nBins, -160.0f);
+         complete = false;
+         continue;
+      }
+      const auto values = tile->GetColumn(column % tileWidth);
+      std::copy(values, values + nBins, results);
+      if (!gainFactors.empty()) {
+         // Apply a frequency-dependent gain factor
+         for (size_t ii = 0; ii < nBins; ++ii)
+            results[ii] += gainFactors[ii];
+      }
+   }
+   return complete;
+}
+
 void SpecCache::Grow(
    size_t len_, SpectrogramSettings& settings, double samplesPerPixel,
    double start_)
@@ -339,9 +410,10 @@ void SpecCache::Grow(
    frequencyGain = settings.frequencyGain;
 }
 
-void SpecCache::Populate(
+bool SpecCache::Populate(
    const SpectrogramSettings& settings, const WaveChannelInterval& clip,
-   int copyBegin, int copyEnd, size_t numPixels, double pixelsPerSecond)
+   int copyBegin, int copyEnd, size_t numPixels, double pixelsPerSecond,
+   SpectrogramTileCache* tiles)
 {
    const auto sampleRate = clip.GetRate();
    const int &frequencyGainSetting = settings.frequencyGain;
@@ -366,12 +438,23 @@ void SpecCache::Populate(
       ComputeSpectrogramGainFactors(
          fftLen, sampleRate, frequencyGainSetting, gainFactors);
 
+   // Tiles requested for earlier views are no longer needed first
+   if (tiles)
+      tiles->CancelPending();
+
+   auto complete = true;
    // Loop over the ranges before and after the copied portion and compute anew.
    // One of the ranges may be empty.
    for (int jj = 0; jj < 2; ++jj) {
       const int lowerBoundX = jj == 0 ? 0 : copyEnd;
       const int upperBoundX = jj == 0 ? copyBegin : numPixels;
 
+      if (tiles) {
+         complete = CopyFromTiles(
+            *tiles, lowerBoundX, upperBoundX, nBins, gainFactors) && complete;
+         continue;
+      }
+
 // todo(mhodgkinson): I don't find an option to define _OPENMP anywhere. Is this
 // still of interest?
 #ifdef _OPENMP
@@ -456,13 +539,15 @@ void SpecCache::Populate(
          }
       }
    }
+   return complete;
 }
 
 bool WaveClipSpectrumCache::GetSpectrogram(
    const WaveChannelInterval &clip,
    const float*& spectrogram, SpectrogramSettings& settings,
    const sampleCount*& where, size_t numPixels, double t0,
-   double pixelsPerSecond)
+   double pixelsPerSecond, AudacityProject *pProject,
+   std::function<void()> requestRefresh)
 
 {
    auto &mSpecCache = mSpecCaches[clip.GetChannelIndex()];
@@ -562,19 +647,59 @@ bool WaveClipSpectrumCache::GetSpectrogram(
       mSpecCache->where, numPixels, addBias, correction, t0, sampleRate,
       stretchRatio, samplesPerPixel);
 
-   mSpecCache->Populate(
-      settings, clip, copyBegin, copyEnd, numPixels, pixelsPerSecond);
+   const auto complete = mSpecCache->Populate(
+      settings, clip, copyBegin, copyEnd, numPixels, pixelsPerSecond,
+      GetTileCache(
+         clip, settings, samplesPerPixel, pProject, move(requestRefresh)));
 
-   mSpecCache->dirty = mDirty;
+   // Columns of tiles still being computed are drawn again, when asked for
+   mSpecCache->dirty = complete ? mDirty : -1;
    spectrogram = &mSpecCache->freq[0];
    where = &mSpecCache->where[0];
 
    return true;
 }
 
+SpectrogramTileCache *WaveClipSpectrumCache::GetTileCache(
+   const WaveChannelInterval &clip, const SpectrogramSettings &settings,
+   double samplesPerPixel, AudacityProject *pProject,
+   std::function<void()> requestRefresh)
+{
+   if (settings.algorithm != SpectrogramSettings::algSTFT)
+      return nullptr;
+
+   SpectrogramTileKey key;
+   key.windowType = settings.windowType;
+   key.windowSize = settings.WindowSize();
+   key.fftSize = settings.GetFFTLength();
+   // Windows overlapping by half
+   key.hop = std::max<size_t>(key.windowSize / 2, 1);
+   if (samplesPerPixel < key.hop ||
+       samplesPerPixel >= static_cast<double>(key.hop << (maxTileLevel + 1)))
+      return nullptr;
+   // Changes with the samples, and with the trims that shift them
+   key.contentHash = GetSpectrogramContentHash(clip);
+
+   auto &pTiles = mTileCaches[clip.GetChannelIndex()];
+   if (!pTiles || pTiles->GetKey() != key) {
+      // Let the old tiles go first
+      pTiles.reset();
+      pTiles = std::make_unique<SpectrogramTileCache>(key,
+         std::make_shared<WaveClipTileSource>(clip),
+         SpectrogramTileDB::MakeStore(pProject, clip),
+         [requestRefresh = move(requestRefresh)](int, long long) {
+            if (requestRefresh)
+               requestRefresh();
+         },
+         maxTileBytes);
+   }
+   return pTiles.get();
+}
+
 WaveClipSpectrumCache::WaveClipSpectrumCache(size_t nChannels)
    : mSpecCaches(nChannels)
    , mSpecPxCaches(nChannels)
+   , mTileCaches(nChannels)
 {
    for (auto &pCache : mSpecCaches)
       pCache = std::make_unique<SpecCache>();
@@ -611,6 +736,8 @@ void WaveClipSpectrumCache::Invalidate()
    // Invalidate the spectrum display cache
    for (auto &pCache : mSpecCaches)
       pCache = std::make_unique<SpecCache>();
+   for (auto &pTiles : mTileCaches)
+      pTiles.reset();
 }
 
 void WaveClipSpectrumCache::MakeStereo(WaveClipListener &&other, bool)
@@ -619,6 +746,7 @@ void WaveClipSpectrumCache::MakeStereo(WaveClipListener &&other, bool)
    assert(pOther); // precondition
    mSpecCaches.push_back(move(pOther->mSpecCaches[0]));
    mSpecPxCaches.push_back(move(pOther->mSpecPxCaches[0]));
+   mTileCaches.push_back(move(pOther->mTileCaches[0]));
 }
 
 void WaveClipSpectrumCache::SwapChannels()
@@ -627,6 +755,8 @@ void WaveClipSpectrumCache::SwapChannels()
    std::swap(mSpecCaches[0], mSpecCaches[1]);
    mSpecPxCaches.resize(2);
    std::swap(mSpecPxCaches[0], mSpecPxCaches[1]);
+   mTileCaches.resize(2);
+   std::swap(mTileCaches[0], mTileCaches[1]);
 }
 
 void WaveClipSpectrumCache::Erase(size_t index)
@@ -635,4 +765,6 @@ void WaveClipSpectrumCache::Erase(size_t index)
       mSpecCaches.erase(mSpecCaches.begin() + index);
    if (index < mSpecPxCaches.size())
       mSpecPxCaches.erase(mSpecPxCaches.begin() + index);
+   if (index < mTileCaches.size())
+      mTileCaches.erase(mTileCaches.begin() + index);
 }
@@ -11,12 +11,15 @@
 #ifndef __AUDACITY_WAVECLIP_SPECTRUM_CACHE__
 #define __AUDACITY_WAVECLIP_SPECTRUM_CACHE__
 
+class AudacityProject;
 class sampleCount;
 class SpectrogramSettings;
+class SpectrogramTileCache;
 class WaveClipChannel;
 using WaveChannelInterval = WaveClipChannel;
 class WideSampleSequence;
 
+#include <functional>
 #include <vector>
 #include "MemoryX.h"
 #include "WaveClip.h" // to inherit WaveClipListener
@@ -50,10 +53,13 @@ public:
       size_t len_, SpectrogramSettings& settings, double samplesPerPixel,
       double start /*relative to clip play start time*/);
 
-   // Calculate the dirty columns at the begin and end of the cache
-   void Populate(
+   // Calculate the dirty columns at the begin and end of the cache,
+   // taking them from the tiles if given, without waiting for tiles still
+   // being computed; returns false if any column is missing
+   bool Populate(
       const SpectrogramSettings& settings, const WaveChannelInterval& clip,
-      int copyBegin, int copyEnd, size_t numPixels, double pixelsPerSecond);
+      int copyBegin, int copyEnd, size_t numPixels, double pixelsPerSecond,
+      SpectrogramTileCache* tiles = nullptr);
 
    size_t       len { 0 }; // counts pixels, not samples
    int          algorithm;
@@ -78,6 +84,12 @@ private:
       const std::vector<float>& gainFactors, float* __restrict scratch,
       float* __restrict out) const;
 
+   // Copy the column of the tiles under each pixel in [lowerBoundX, upperBoundX)
+   // that are ready; returns false if any column is missing
+   bool CopyFromTiles(
+      SpectrogramTileCache& tiles, int lowerBoundX, int upperBoundX,
+      size_t nBins, const std::vector<float>& gainFactors);
+
    mutable std::optional<AudioSegmentSampleView> mSampleCacheHolder;
 };
 
@@ -112,6 +124,8 @@ struct WaveClipSpectrumCache final : WaveClipListener
    // Cache of values to colour pixels of Spectrogram - used by TrackArtist
    std::vector<std::unique_ptr<SpecPxCache>> mSpecPxCaches;
    std::vector<std::unique_ptr<SpecCache>> mSpecCaches;
+   // Spectra at several resolutions, kept across zooming and scrolling
+   std::vector<std::unique_ptr<SpectrogramTileCache>> mTileCaches;
    int mDirty { 0 };
 
    static WaveClipSpectrumCache &Get(const WaveChannelInterval &clip);
@@ -124,11 +138,23 @@ struct WaveClipSpectrumCache final : WaveClipListener
    // > only the 0th channel of sequence is really used
    // > In the interim, this still works correctly for WideSampleSequence backed
    // > by a right channel track, which always ignores its partner.
+   //! @param pProject if not null, may keep tiles of the spectrogram in its
+   //! file
+   //! @param requestRefresh called from a worker thread, when more of the
+   //! spectrogram can be drawn than was given
    bool GetSpectrogram(const WaveChannelInterval &clip,
       const float *&spectrogram,
       SpectrogramSettings &spectrogramSettings,
       const sampleCount *&where, size_t numPixels,
-      double t0 /*absolute time*/, double pixelsPerSecond);
+      double t0 /*absolute time*/, double pixelsPerSecond,
+      AudacityProject *pProject = nullptr,
+      std::function<void()> requestRefresh = {});
+
+   //! The tiles for the spectrogram zoomed out to `samplesPerPixel`, or null
+   //! if they can't replace computing the columns of the pixels
+   SpectrogramTileCache *GetTileCache(const WaveChannelInterval &clip,
+      const SpectrogramSettings &settings, double samplesPerPixel,
+      AudacityProject *pProject, std::function<void()> requestRefresh);
 
    void MakeStereo(WaveClipListener &&other, bool aligned) override;
    void SwapChannels() override;
@@ -24,11 +24,13 @@ Paul Licameli split from WaveChannelView.cpp
 #include "../../../ui/BrushHandle.h"
 
 #include "AColor.h"
+#include "BasicUI.h"
 #include "PendingTracks.h"
 #include "Prefs.h"
 #include "NumberScale.h"
 #include "../../../../TrackArt.h"
 #include "../../../../TrackArtist.h"
+#include "../../../../TrackPanel.h"
 #include "../../../../TrackPanelDrawingContext.h"
 #include "ViewInfo.h"
 #include "WaveClip.h"
@@ -39,6 +41,7 @@ Paul Licameli split from WaveChannelView.cpp
 
 #include <wx/dcmemory.h>
 #include <wx/graphics.h>
+#include <wx/weakref.h>
 
 #include "float_cast.h"
 
@@ -416,7 +419,14 @@ void DrawClipSpectrum(TrackPanelDrawingContext &context,
    const sampleCount *where = 0;
    bool updated = WaveClipSpectrumCache::Get(clip).GetSpectrogram(
       clip, freq, settings, where, (size_t)hiddenMid.width, t0,
-      averagePixelsPerSecond);
+      averagePixelsPerSecond, artist->parent->GetProject(),
+      // The weak reference is made and used on the main thread only
+      [pPanel = std::make_shared<wxWeakRef<TrackPanel>>(artist->parent)]{
+         BasicUI::CallAfter([pPanel]{
+            if (*pPanel)
+               (*pPanel)->Refresh(false);
+         });
+      });
    auto nBins = settings.NBins();
 
    float minFreq, maxFreq;
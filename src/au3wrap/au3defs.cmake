@@ -39,6 +39,7 @@ set(AU3_DEF
     -DTRACK_API=
     -DCHANNEL_API=
     -DTIME_AND_PITCH_API=
+    -DCONCURRENCY_API=
     -DPROJECT_RATE_API=
     -DTRACK_SELECTION_API=
     -DAUDIO_DEVICES_API=
@@ -57,6 +58,8 @@ set(AU3_DEF
 
     -DGRAPHICS_API=
     -DWAVE_TRACK_PAINT_API=
+    -DFFT_API=
+    -DWAVE_TRACK_FFT_API=
 
     -DEXPERIMENTAL_SPECTRAL_EDITING
 
@@ -108,6 +111,7 @@ set(AU3_INCLUDE
     ${AU3_LIBRARIES}/lib-track
     ${AU3_LIBRARIES}/lib-channel
     ${AU3_LIBRARIES}/lib-time-and-pitch
+    ${AU3_LIBRARIES}/lib-concurrency
     ${AU3_LIBRARIES}/lib-project-rate
     ${AU3_LIBRARIES}/lib-track-selection
     ${AU3_LIBRARIES}/lib-audio-devices
@@ -129,6 +133,8 @@ set(AU3_INCLUDE
     ${AU3_LIBRARIES}/lib-time-frequency-selection
     ${AU3_LIBRARIES}/lib-graphics
     ${AU3_LIBRARIES}/lib-wave-track-paint
+    ${AU3_LIBRARIES}/lib-fft
+    ${AU3_LIBRARIES}/lib-wave-track-fft
 
     # effects
     ${AU3_LIBRARIES}/lib-effects
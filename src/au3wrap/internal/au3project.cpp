@@ -3,12 +3,16 @@
 */
 #include "au3project.h"
 
-#include "global/defer.h"
+#include <algorithm>
+#include <chrono>
 
+#include "libraries/lib-basic-ui/BasicUI.h"
+#include "libraries/lib-exceptions/UserException.h"
 #include "libraries/lib-project/Project.h"
 #include "libraries/lib-project-file-io/ProjectFileIO.h"
 #include "libraries/lib-wave-track/WaveTrack.h"
 #include "libraries/lib-wave-track/WaveClip.h"
+#include "libraries/lib-wave-track/WaveTrackUtilities.h"
 #include "libraries/lib-numeric-formats/ProjectTimeSignature.h"
 #include "domconverter.h"
 #include "TempoChange.h"
@@ -65,33 +69,89 @@ bool Au3ProjectAccessor::load(const muse::io::path_t& filePath)
     std::string sstr = filePath.toStdString();
     FilePath fileName = wxString::FromUTF8(sstr.c_str(), sstr.size());
 
+    using namespace std::chrono;
+    const auto start = steady_clock::now();
+
+    //! NOTE The dialog only appears once the load has lasted long enough to notice,
+    //! so that small projects open without it flashing. Polling it runs the event loop,
+    //! so the caller must keep the UI from acting on projects until the load returns.
+    //! Cancelling throws UserException.
+    std::unique_ptr<BasicUI::ProgressDialog> progress;
+    const auto reportProgress = [&](double fraction) {
+        if (!progress) {
+            if (steady_clock::now() - start < milliseconds(500)) {
+                return;
+            }
+            progress = BasicUI::MakeProgress(XO("Opening project"), XO("Loading project data..."),
+                                             BasicUI::ProgressShowCancel);
+            if (!progress) {
+                return;
+            }
+        }
+        if (progress->Poll(fraction * 1000, 1000) != BasicUI::ProgressResult::Success) {
+            throw UserException {};
+        }
+    };
+
+    //! NOTE Decoding the document takes most of the load
+    constexpr double decodeShare = 0.9;
+    const auto reportDecodeProgress = [&](double fraction) {
+        reportProgress(fraction * decodeShare);
+    };
+
+    Au3TrackList& tracks = Au3TrackList::Get(m_data->projectRef());
     std::optional<ProjectFileIO::TentativeConnection> conn;
+    steady_clock::time_point loaded;
 
     try {
-        conn.emplace(projectFileIO.LoadProject(fileName, false /*ignoreAutosave*/).value());
+        conn = projectFileIO.LoadProject(fileName, false /*ignoreAutosave*/, reportDecodeProgress);
+        if (!conn) {
+            LOGE() << "failed load project: " << filePath;
+            discardLoadedTracks();
+            return false;
+        }
+
+        loaded = steady_clock::now();
+
+        //! TODO Look like, need doing all from method  ProjectFileManager::FixTracks
+        //! and maybe what is done before this method (ProjectFileManager::ReadProjectFile)
+        const double trackCount = std::max<size_t>(tracks.Size(), 1);
+        size_t fixed = 0;
+        for (auto pTrack : tracks) {
+            pTrack->LinkConsistencyFix();
+            reportProgress(decodeShare + (1.0 - decodeShare) * ++fixed / trackCount);
+        }
+    } catch (UserException&) {
+        LOGI() << "cancelled load project: " << filePath;
+        discardLoadedTracks();
+        conn.reset();
+        return false;
     } catch (AudacityException&) {
         LOGE() << "failed load project: " << filePath << ", exception received";
+        discardLoadedTracks();
+        conn.reset();
         return false;
     }
+    progress.reset();
 
-    muse::Defer([&conn]() {
-        conn->Commit();
-    });
+    conn->Commit();
 
-    const bool bParseSuccess = conn.has_value();
-    if (!bParseSuccess) {
-        LOGE() << "failed load project: " << filePath;
-        return false;
-    }
+    const auto ms = [](auto duration) { return duration_cast<milliseconds>(duration).count(); };
+    LOGI() << "loaded project: " << filePath << " in " << ms(steady_clock::now() - start) << " ms"
+           << " (file " << ms(loaded - start) << " ms, tracks " << ms(steady_clock::now() - loaded) << " ms)";
+
+    return true;
+}
 
-    //! TODO Look like, need doing all from method  ProjectFileManager::FixTracks
-    //! and maybe what is done before this method (ProjectFileManager::ReadProjectFile)
+void Au3ProjectAccessor::discardLoadedTracks()
+{
+    //! NOTE The sample blocks of the tracks stay in the file: lock them first,
+    //! or they delete themselves from it when the tracks go
     Au3TrackList& tracks = Au3TrackList::Get(m_data->projectRef());
-    for (auto pTrack : tracks) {
-        pTrack->LinkConsistencyFix();
+    for (auto pTrack : tracks.Any<Au3WaveTrack>()) {
+        WaveTrackUtilities::CloseLock(*pTrack);
     }
-
-    return true;
+    tracks.Clear();
 }
 
 bool Au3ProjectAccessor::save(const muse::io::path_t& filePath)
@@ -28,6 +28,9 @@ public:
 
 private:
 
+    //! Drops the tracks of a load that failed or was cancelled, keeping their samples in the file
+    void discardLoadedTracks();
+
     const std::shared_ptr<Au3ProjectData> m_data;
     Observer::Subscription mTrackListSubstription;
 };
@@ -1,5 +1,7 @@
 #include "domaccessor.h"
 
+#include "domindex.h"
+
 #include "containers.h"
 
 #include "log.h"
@@ -14,16 +16,7 @@ Au3Track* DomAccessor::findTrack(Au3Project& prj, const Au3TrackId& au3trackId)
 
 const Au3Track* DomAccessor::findTrack(const Au3Project& prj, const Au3TrackId& au3trackId)
 {
-    const Au3Track* track = nullptr;
-    const Au3TrackList& tracks = Au3TrackList::Get(prj);
-    for (const Au3Track* t : tracks) {
-        if (t->GetId() == au3trackId) {
-            track = t;
-            break;
-        }
-    }
-
-    return track;
+    return DomIndex::Get(prj).findTrack(au3trackId);
 }
 
 Au3WaveTrack* DomAccessor::findWaveTrack(Au3Project& prj, const Au3TrackId& au3trackId)
@@ -38,6 +31,11 @@ const Au3WaveTrack* DomAccessor::findWaveTrack(const Au3Project& prj, const Au3T
 
 std::shared_ptr<Au3WaveClip> DomAccessor::findWaveClip(Au3WaveTrack* track, int64_t au3ClipId)
 {
+    if (const DomIndex* index = DomIndex::Find(*track)) {
+        return index->findWaveClip(*track, au3ClipId);
+    }
+
+    //! NOTE the track is not in a project (e.g. clipboard), search it directly
     for (const std::shared_ptr<Au3WaveClip>& interval : track->Intervals()) {
         if (interval->GetId() == au3ClipId) {
             return interval;
@@ -59,8 +57,7 @@ std::shared_ptr<Au3WaveClip> DomAccessor::findWaveClip(Au3Project& prj, const Au
 
 std::shared_ptr<WaveClip> DomAccessor::findWaveClip(Au3Project& prj, const trackedit::TrackId& trackId, trackedit::secs_t time)
 {
-    TrackList& tracks = TrackList::Get(prj);
-    WaveTrack* au3Track = dynamic_cast<WaveTrack*>(tracks.FindById(::TrackId(trackId)));
+    WaveTrack* au3Track = findWaveTrack(prj, Au3TrackId(trackId));
 
     for (const std::shared_ptr<WaveClip>& clip : au3Track->Intervals()) {
         if (clip->Start() <= time && clip->End() >= time) {
@@ -0,0 +1,197 @@
+/*
+* Audacity: A Digital Audio Editor
+*/
+#include "domindex.h"
+
+#include "libraries/lib-project/Project.h"
+#include "libraries/lib-track/Track.h"
+#include "libraries/lib-wave-track/WaveTrack.h"
+#include "libraries/lib-wave-track/WaveClip.h"
+
+using namespace au::au3;
+
+static const Au3Project::AttachedObjects::RegisteredFactory sDomIndexKey {
+    [](Au3Project& prj) {
+        return std::make_shared<DomIndex>(prj);
+    }
+};
+
+DomIndex& DomIndex::Get(Au3Project& prj)
+{
+    return prj.AttachedObjects::Get<DomIndex>(sDomIndexKey);
+}
+
+const DomIndex& DomIndex::Get(const Au3Project& prj)
+{
+    return Get(const_cast<Au3Project&>(prj));
+}
+
+DomIndex* DomIndex::Find(const Au3WaveTrack& track)
+{
+    std::shared_ptr<Au3TrackList> list = track.GetOwner();
+    if (!list || !list->GetOwner()) {
+        return nullptr;
+    }
+
+    return &Get(*list->GetOwner());
+}
+
+DomIndex::DomIndex(Au3Project& prj)
+    : m_prj(prj)
+{
+    m_tracksSubc = Au3TrackList::Get(m_prj).Subscribe([this](const TrackListEvent& e) {
+        onTrackListEvent(e);
+    });
+}
+
+DomIndex::~DomIndex() = default;
+
+void DomIndex::onTrackListEvent(const TrackListEvent& e)
+{
+    switch (e.mType) {
+    case TrackListEvent::ADDITION: {
+        //! NOTE the index is built lazily, don't start it here
+        if (!m_tracksValid) {
+            break;
+        }
+        if (auto track = e.mpTrack.lock()) {
+            m_tracks[track->GetId()] = track;
+        }
+    } break;
+    case TrackListEvent::DELETION: {
+        //! NOTE the track is still valid during the event, also when it is being replaced
+        if (auto track = e.mpTrack.lock()) {
+            m_tracks.erase(track->GetId());
+            m_clips.erase(track->GetId());
+        } else {
+            m_tracksValid = false;
+            m_tracks.clear();
+            m_clips.clear();
+        }
+    } break;
+    default:
+        break;
+    }
+}
+
+void DomIndex::onWaveTrackMessage(Au3TrackId trackId, const WaveTrackMessage& msg)
+{
+    auto it = m_clips.find(trackId);
+    if (it == m_clips.end() || !msg.pClip) {
+        return;
+    }
+
+    //! NOTE copies of a clip keep its id, so a track may briefly hold two clips with the same id;
+    //! like the linear search, the index resolves the id to the earliest of them
+    ClipEntry& entry = it->second.clips[msg.pClip->GetId()];
+    if (msg.type == WaveTrackMessage::Removed) {
+        if (entry.clip.lock() == msg.pClip) {
+            it->second.clips.erase(msg.pClip->GetId());
+        }
+    } else if (entry.clip.expired()) {
+        //! NOTE the position is found on the first lookup
+        entry = { msg.pClip };
+    }
+}
+
+void DomIndex::rebuildTracks() const
+{
+    m_tracks.clear();
+    for (Au3Track* t : Au3TrackList::Get(m_prj)) {
+        m_tracks.emplace(t->GetId(), t->SharedPointer());
+    }
+    m_tracksValid = true;
+}
+
+Au3Track* DomIndex::findTrack(const Au3TrackId& au3trackId) const
+{
+    if (!m_tracksValid) {
+        rebuildTracks();
+    }
+
+    Au3TrackList& tracks = Au3TrackList::Get(m_prj);
+
+    auto it = m_tracks.find(au3trackId);
+    if (it != m_tracks.end()) {
+        std::shared_ptr<Au3Track> track = it->second.lock();
+        if (track && track->GetId() == au3trackId && track->GetOwner().get() == &tracks) {
+            return track.get();
+        }
+        m_tracks.erase(it);
+    }
+
+    //! NOTE id may have been reassigned without an event, repair the index from the list
+    Au3Track* track = tracks.FindById(au3trackId);
+    if (track) {
+        m_tracks[au3trackId] = track->SharedPointer();
+    }
+
+    return track;
+}
+
+DomIndex::ClipIndex& DomIndex::clipIndex(const Au3WaveTrack& track) const
+{
+    auto it = m_clips.find(track.GetId());
+    if (it != m_clips.end() && it->second.track.lock().get() == &track) {
+        return it->second;
+    }
+
+    ClipIndex& index = m_clips[track.GetId()];
+    const Au3TrackId trackId = track.GetId();
+    index.track = track.SharedPointer<const Au3Track>();
+    index.clipsSubc = const_cast<Au3WaveTrack&>(track).Subscribe(
+        [this, trackId](const WaveTrackMessage& msg) {
+        const_cast<DomIndex*>(this)->onWaveTrackMessage(trackId, msg);
+    });
+    rebuildClips(track, index);
+
+    return index;
+}
+
+void DomIndex::rebuildClips(const Au3WaveTrack& track, ClipIndex& index) const
+{
+    index.clips.clear();
+    size_t position = 0;
+    for (const std::shared_ptr<const Au3WaveClip>& interval : track.Intervals()) {
+        index.clips.emplace(interval->GetId(), ClipEntry { std::const_pointer_cast<Au3WaveClip>(interval), position++ });
+    }
+}
+
+bool DomIndex::isInTrack(const Au3WaveTrack& track, const Au3WaveClip& clip, ClipEntry& entry)
+{
+    //! NOTE a clip taken out of the track may still be alive elsewhere, e.g. in an undo state
+    if (entry.position < track.NIntervals() && track.GetClip(entry.position).get() == &clip) {
+        return true;
+    }
+
+    //! NOTE clips before it were added or removed: find where it went, if still there
+    const auto position = static_cast<size_t>(track.GetClipIndex(clip));
+    if (position < track.NIntervals()) {
+        entry.position = position;
+        return true;
+    }
+    return false;
+}
+
+std::shared_ptr<Au3WaveClip> DomIndex::findWaveClip(const Au3WaveTrack& track, Au3ClipId au3ClipId) const
+{
+    ClipIndex& index = clipIndex(track);
+
+    auto it = index.clips.find(au3ClipId);
+    if (it != index.clips.end()) {
+        std::shared_ptr<Au3WaveClip> clip = it->second.clip.lock();
+        if (clip && clip->GetId() == au3ClipId && isInTrack(track, *clip, it->second)) {
+            return clip;
+        }
+    }
+
+    //! NOTE clips may have been added or removed without an event (e.g. when zipping channels)
+    rebuildClips(track, index);
+
+    it = index.clips.find(au3ClipId);
+    if (it != index.clips.end()) {
+        return it->second.clip.lock();
+    }
+
+    return nullptr;
+}
@@ -0,0 +1,74 @@
+/*
+* Audacity: A Digital Audio Editor
+*/
+#pragma once
+
+#include <limits>
+#include <memory>
+#include <unordered_map>
+
+#include "libraries/lib-registries/ClientData.h"
+#include "libraries/lib-utility/Observer.h"
+
+#include "../au3types.h"
+
+struct TrackListEvent;
+struct WaveTrackMessage;
+
+namespace au::au3 {
+//! Hash index from track and clip ids to the live au3 objects of a project
+/*!
+ Maintained from TrackList and WaveTrack events, so that id lookups done on
+ every edit (and on every mouse move while dragging) do not scan the project.
+ Every hit is verified against the object it points to, and every miss falls
+ back to a linear scan that repairs the index, so an event that is not
+ published can cost time but never correctness.
+ */
+class DomIndex final : public ClientData::Base
+{
+public:
+    static DomIndex& Get(Au3Project& prj);
+    static const DomIndex& Get(const Au3Project& prj);
+
+    //! Index of the project the track belongs to, or nullptr for a track that is not in a project
+    static DomIndex* Find(const Au3WaveTrack& track);
+
+    explicit DomIndex(Au3Project& prj);
+    DomIndex(const DomIndex&) = delete;
+    DomIndex& operator=(const DomIndex&) = delete;
+    ~DomIndex() override;
+
+    Au3Track* findTrack(const Au3TrackId& au3trackId) const;
+    std::shared_ptr<Au3WaveClip> findWaveClip(const Au3WaveTrack& track, Au3ClipId au3ClipId) const;
+
+private:
+    struct ClipEntry
+    {
+        std::weak_ptr<Au3WaveClip> clip;
+        //! Where the clip last was in the track, to verify a hit without a scan
+        size_t position = std::numeric_limits<size_t>::max();
+    };
+
+    struct ClipIndex
+    {
+        std::weak_ptr<const Au3Track> track;
+        std::unordered_map<Au3ClipId, ClipEntry> clips;
+        Observer::Subscription clipsSubc;
+    };
+
+    void onTrackListEvent(const TrackListEvent& e);
+    void onWaveTrackMessage(Au3TrackId trackId, const WaveTrackMessage& msg);
+
+    void rebuildTracks() const;
+    ClipIndex& clipIndex(const Au3WaveTrack& track) const;
+    void rebuildClips(const Au3WaveTrack& track, ClipIndex& index) const;
+    static bool isInTrack(const Au3WaveTrack& track, const Au3WaveClip& clip, ClipEntry& entry);
+
+    Au3Project& m_prj;
+    Observer::Subscription m_tracksSubc;
+
+    mutable bool m_tracksValid = false;
+    mutable std::unordered_map<int64_t, std::weak_ptr<Au3Track> > m_tracks;
+    mutable std::unordered_map<int64_t, ClipIndex> m_clips;
+};
+}
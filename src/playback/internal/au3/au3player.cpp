@@ -398,6 +398,10 @@ TransportSequences Au3Player::makeTransportTracks(Au3TrackList& trackList, bool
         const auto range = trackList.Any<Au3WaveTrack>()
                            + (selectedOnly ? &Au3Track::IsSelected : &Au3Track::Any);
         for (auto pTrack : range) {
+            //! NOTE playback stretches in real time until the render is ready
+            for (const auto& clip : pTrack->Intervals()) {
+                clip->PrerenderPitchAndSpeed();
+            }
             result.playbackSequences.push_back(
                 StretchingSequence::Create(*pTrack, pTrack->GetClipInterfaces()));
         }
@@ -50,6 +50,11 @@ void ProjectActionsController::init()
 
 bool ProjectActionsController::canReceiveAction(const muse::actions::ActionCode& code) const
 {
+    //! NOTE Opening a project may run the event loop, e.g. to show its progress
+    if (m_isProjectProcessing) {
+        return false;
+    }
+
     if (!currentProject()) {
         static const std::unordered_set<actions::ActionCode> DONT_REQUIRE_OPEN_PROJECT {
             "file-new",
@@ -168,7 +173,8 @@ bool ProjectActionsController::isFileSupported(const muse::io::path_t& path) con
 
 bool ProjectActionsController::closeOpenedProject(bool quitApp)
 {
-    if (m_isProjectClosing) {
+    //! NOTE Don't quit while a project is being opened, it isn't current yet
+    if (m_isProjectClosing || m_isProjectProcessing) {
         return false;
     }
 
@@ -19,6 +19,7 @@ Rectangle {
     property int speedPercentage: 0.0
     property alias showChannelSplitter: channelSplitter.visible
     property alias channelHeightRatio: channelSplitter.channelHeightRatio
+    property alias showSpectrogram: waveView.showSpectrogram
     property var canvas: null
     property color clipColor: "#677CE4"
     property bool clipSelected: false
@@ -1,6 +1,8 @@
 #include "au3wavepainter.h"
 
 #include <QColor>
+#include <QCoreApplication>
+#include <QImage>
 #include <QPainter>
 #include <QPen>
 
@@ -14,7 +16,11 @@
 #include "WaveTrack.h"
 #include "ZoomInfo.h"
 #include "Envelope.h"
+#include "FFT.h"
 #include "FrameStatistics.h"
+#include "SpectrogramTileCache.h"
+#include "SpectrogramTileDB.h"
+#include "WaveClipSpectrogramTiles.h"
 #include "WaveformScale.h"
 #include "graphics/Color.h"
 
@@ -31,6 +37,12 @@ using namespace au::au3;
 
 constexpr double CLIPVIEW_WIDTH_MIN = 4; // px
 
+//! NOTE The defaults of the spectrogram settings of au3
+constexpr size_t SPECTROGRAM_WINDOW_SIZE = 2048;
+constexpr float SPECTROGRAM_RANGE = 80.0f; // dB
+constexpr float SPECTROGRAM_GAIN = 20.0f; // dB
+constexpr size_t SPECTROGRAM_MAX_BYTES = 32 * 1024 * 1024;
+
 using Style = au::projectscene::Au3WavePainter::Style;
 
 namespace WaveChannelViewConstants {
@@ -218,6 +230,59 @@ private:
     std::vector<ChannelCaches> mChannelCaches;
     std::atomic<bool> mChanged = false;
 };
+
+//! Tiles of the spectrograms of the channels of a clip, computed in the background
+class SpectrogramPainter final : public WaveClipListener
+{
+public:
+
+    static SpectrogramPainter& Get(const Au3WaveClip& clip);
+
+    //! The tiles of the samples of the channel as they are now
+    SpectrogramTileCache& Tiles(Au3Project& project, const WaveClipChannel& channel,
+                                SpectrogramTileCache::TileReadyCallback onTileReady)
+    {
+        SpectrogramTileKey key;
+        key.contentHash = GetSpectrogramContentHash(channel);
+        key.windowType = eWinFuncHann;
+        key.windowSize = SPECTROGRAM_WINDOW_SIZE;
+        key.fftSize = SPECTROGRAM_WINDOW_SIZE;
+        key.hop = SPECTROGRAM_WINDOW_SIZE / 2;
+
+        const auto channelIndex = channel.GetChannelIndex();
+        if (mTiles.size() <= channelIndex) {
+            mTiles.resize(channelIndex + 1);
+        }
+
+        auto& tiles = mTiles[channelIndex];
+        if (!tiles || tiles->GetKey() != key) {
+            //! NOTE Let the old tiles go first
+            tiles.reset();
+            tiles = std::make_unique<SpectrogramTileCache>(key,
+                                                           std::make_shared<WaveClipTileSource>(channel),
+                                                           SpectrogramTileDB::MakeStore(&project, channel),
+                                                           std::move(onTileReady), SPECTROGRAM_MAX_BYTES);
+        }
+        return *tiles;
+    }
+
+    void MarkChanged() noexcept override
+    {
+        //! NOTE The key of the tiles changes with the samples
+    }
+
+    void Invalidate() override
+    {
+    }
+
+    std::unique_ptr<WaveClipListener> Clone() const override
+    {
+        return std::make_unique<SpectrogramPainter>();
+    }
+
+private:
+    std::vector<std::unique_ptr<SpectrogramTileCache> > mTiles;
+};
 }
 
 static const ChannelGroup::Attachments::RegisteredFactory
@@ -252,6 +317,16 @@ WaveformPainter& WaveformPainter::Get(const Au3WaveClip& clip)
            .Attachments::Get<WaveformPainter>(sKeyW).EnsureClip(clip);
 }
 
+static Au3WaveClip::Attachments::RegisteredFactory sKeyS{ [](Au3WaveClip&) {
+        return std::make_unique<SpectrogramPainter>();
+    } };
+
+SpectrogramPainter& SpectrogramPainter::Get(const Au3WaveClip& clip)
+{
+    return const_cast< Au3WaveClip& >(clip)   // Consider it mutable data
+           .Attachments::Get<SpectrogramPainter>(sKeyS);
+}
+
 bool ShowIndividualSamples(
     int sampleRate, double stretchRatio, double pixelsPerSecond)
 {
@@ -299,12 +374,14 @@ void GetEnvelopeValues(const Envelope& env,
     // Getting many envelope values, corresponding to pixel columns, which may
     // not be uniformly spaced in time when there is a fisheye.
 
+    //! NOTE the columns are in increasing time, so the search for each resumes from the previous one
+    Envelope::Cursor cursor;
     double prevDiscreteTime=0.0, prevSampleVal=0.0, nextSampleVal=0.0;
     for (int xx = 0; xx < bufferLen; ++xx) {
         auto time = zoomInfo.PositionToTime(xx, -leftOffset);
         if (sampleDur <= 0) {
             // Sample interval not defined (as for time track)
-            buffer[xx] = env.GetValue(time);
+            buffer[xx] = env.GetValue(cursor, time);
         } else {
             // The level of zoom-in may resolve individual samples.
             // If so, then instead of evaluating the envelope directly,
@@ -316,9 +393,9 @@ void GetEnvelopeValues(const Envelope& env,
             if (xx == 0 || leftDiscreteTime != prevDiscreteTime) {
                 prevDiscreteTime = leftDiscreteTime;
                 prevSampleVal
-                    =env.GetValue(prevDiscreteTime, sampleDur);
+                    =env.GetValue(cursor, prevDiscreteTime, sampleDur);
                 nextSampleVal
-                    =env.GetValue(prevDiscreteTime + sampleDur, sampleDur);
+                    =env.GetValue(cursor, prevDiscreteTime + sampleDur, sampleDur);
             }
             auto ratio = (time - leftDiscreteTime) / sampleDur;
             if (env.GetExponential()) {
@@ -428,6 +505,7 @@ void DrawIndividualSamples(int channelIndex, QPainter& painter, const QRect& rec
 
     painter.setPen(highlight ? style.highlight : style.samplePen);
 
+    Envelope::Cursor cursor;
     for (decltype(slen) s = 0; s < slen; s++) {
         const double time = toffset + (s + s0).as_double() / rate;
         const int xx   // An offset into the rectangle rect
@@ -437,7 +515,7 @@ void DrawIndividualSamples(int channelIndex, QPainter& painter, const QRect& rec
 
         // Calculate sample as it would be rendered, so quantize time
         double value
-            =clip.GetEnvelope().GetValue(time, 1.0 / clip.GetRate());
+            =clip.GetEnvelope().GetValue(cursor, time, 1.0 / clip.GetRate());
         const double tt = buffer[s] * value;
 
         if (clipped && bShowClipping && ((tt <= -MAX_AUDIO) || (tt >= MAX_AUDIO))) {
@@ -610,6 +688,93 @@ static void DrawWaveform(int channelIndex,
     }
 }
 
+//! Doesn't wait for the tiles: the columns of those still being computed stay blank,
+//! and `onTileReady` is called from a worker thread when one is ready
+static void DrawSpectrogram(int channelIndex,
+                            QPainter& painter,
+                            Au3Project& project,
+                            const Au3WaveClip& clip,
+                            const WaveMetrics& metrics,
+                            const Style& style,
+                            SpectrogramTileCache::TileReadyCallback onTileReady)
+{
+    const int width = static_cast<int>(metrics.width);
+    const int height = static_cast<int>(metrics.height);
+    if (width <= 0 || height <= 0 || metrics.zoom <= 0.0) {
+        return;
+    }
+
+    const auto channel = clip.GetChannel<const WaveClipChannel>(channelIndex);
+    auto& tiles = SpectrogramPainter::Get(clip).Tiles(project, *channel, std::move(onTileReady));
+    if (tiles.GetNumTiles(0) == 0) {
+        return;
+    }
+
+    const double samplesPerSecond = clip.GetRate() / clip.GetStretchRatio();
+    const int level = tiles.GetLevel(samplesPerSecond / metrics.zoom);
+    const double samplesPerColumn = static_cast<double>(tiles.GetKey().hop << level);
+    const long long numColumns = tiles.GetNumColumns(level);
+    const long long tileWidth = SpectrogramTileCache::tileWidth;
+    const auto columnAt = [&](int x) {
+        const double time = metrics.fromTime + (x + 0.5) / metrics.zoom;
+        return static_cast<long long>(std::floor(time * samplesPerSecond / samplesPerColumn));
+    };
+
+    //! NOTE The tiles of the view before are no longer needed first
+    tiles.CancelPending();
+
+    //! NOTE The tiles requested last are computed first, so request from the right,
+    //! so that the view fills from the left
+    const long long firstColumn = std::clamp(columnAt(0), 0LL, numColumns - 1);
+    const long long lastColumn = std::clamp(columnAt(width - 1), 0LL, numColumns - 1);
+    for (long long index = lastColumn / tileWidth; index >= firstColumn / tileWidth; --index) {
+        tiles.GetTile(level, index);
+    }
+
+    const size_t numBins = tiles.GetNumBins();
+    std::vector<size_t> rowBins(height);
+    for (int y = 0; y < height; ++y) {
+        rowBins[y] = std::min(numBins - 1, static_cast<size_t>((height - 1 - y) * numBins / height));
+    }
+
+    const QColor& background = style.normalBackground;
+    const QColor& foreground = style.samplePen;
+    const auto colorAt = [&](float value) {
+        const float t = std::clamp((value + SPECTROGRAM_GAIN + SPECTROGRAM_RANGE) / SPECTROGRAM_RANGE, 0.0f, 1.0f);
+        return qRgb(background.red() + t * (foreground.red() - background.red()),
+                    background.green() + t * (foreground.green() - background.green()),
+                    background.blue() + t * (foreground.blue() - background.blue()));
+    };
+
+    QImage image(width, height, QImage::Format_RGB32);
+    image.fill(style.blankBrush);
+
+    SpectrogramTileCache::TilePtr tile;
+    long long tileIndex = -1;
+    for (int x = 0; x < width; ++x) {
+        const long long column = columnAt(x);
+        if (column < 0 || column >= numColumns) {
+            continue;
+        }
+
+        const long long index = column / tileWidth;
+        if (index != tileIndex) {
+            tile = tiles.GetTile(level, index);
+            tileIndex = index;
+        }
+        if (!tile) {
+            continue;
+        }
+
+        const float* values = tile->GetColumn(column % tileWidth);
+        for (int y = 0; y < height; ++y) {
+            reinterpret_cast<QRgb*>(image.scanLine(y))[x] = colorAt(values[rowBins[y]]);
+        }
+    }
+
+    painter.drawImage(QPointF(metrics.left, metrics.top), image);
+}
+
 using namespace au::projectscene;
 using namespace au::au3;
 
@@ -636,10 +801,16 @@ void Au3WavePainter::paint(QPainter& painter, const trackedit::ClipKey& clipKey,
         return;
     }
 
-    doPaint(painter, track, clip.get(), params);
+    doPaint(painter, clipKey, track, clip.get(), params);
+}
+
+muse::async::Channel<au::trackedit::ClipKey> Au3WavePainter::spectrogramChanged() const
+{
+    return m_spectrogramChanged;
 }
 
-void Au3WavePainter::doPaint(QPainter& painter, const Au3WaveTrack* _track, const Au3WaveClip* clip, const Params& params)
+void Au3WavePainter::doPaint(QPainter& painter, const trackedit::ClipKey& clipKey, const Au3WaveTrack* _track,
+                             const Au3WaveClip* clip, const Params& params)
 {
     auto sw = FrameStatistics::CreateStopwatch(FrameStatistics::SectionID::WaveformView);
 
@@ -670,7 +841,17 @@ void Au3WavePainter::doPaint(QPainter& painter, const Au3WaveTrack* _track, cons
     wm.top = 0.0;
     for (unsigned i = 0; i < clip->NChannels(); ++i) {
         wm.height = channelHeight[i];
-        DrawWaveform(i, painter, *track, *clip, wm, params.zoom, params.style, dB);
+        if (params.showSpectrogram) {
+            //! NOTE Called from a worker thread, so the notification is posted to the main thread
+            auto onTileReady = [changed = m_spectrogramChanged, clipKey](int, long long) {
+                QMetaObject::invokeMethod(QCoreApplication::instance(), [changed, clipKey]() mutable {
+                    changed.send(clipKey);
+                }, Qt::QueuedConnection);
+            };
+            DrawSpectrogram(i, painter, projectRef(), *clip, wm, params.style, std::move(onTileReady));
+        } else {
+            DrawWaveform(i, painter, *track, *clip, wm, params.zoom, params.style, dB);
+        }
         wm.top += wm.height;
     }
 }
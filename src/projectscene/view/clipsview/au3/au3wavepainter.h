@@ -20,8 +20,13 @@ public:
 
     void paint(QPainter& painter, const trackedit::ClipKey& clipKey, const Params& params) override;
 
+    muse::async::Channel<trackedit::ClipKey> spectrogramChanged() const override;
+
 private:
     au3::Au3Project& projectRef() const;
-    void doPaint(QPainter& painter, const au3::Au3WaveTrack* track, const au3::Au3WaveClip* clip, const Params& params);
+    void doPaint(QPainter& painter, const trackedit::ClipKey& clipKey, const au3::Au3WaveTrack* track, const au3::Au3WaveClip* clip,
+                 const Params& params);
+
+    muse::async::Channel<trackedit::ClipKey> m_spectrogramChanged;
 };
 }
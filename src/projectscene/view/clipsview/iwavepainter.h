@@ -4,6 +4,7 @@
 #include <QRect>
 
 #include "modularity/imoduleinterface.h"
+#include "global/async/channel.h"
 #include "trackedit/trackedittypes.h"
 
 namespace au::projectscene {
@@ -39,9 +40,13 @@ public:
         double selectionStartTime = 0.0;
         double selectionEndTime = 0.0;
         double channelHeightRatio = 0.5;
+        bool showSpectrogram = false;
         Style style;
     };
 
     virtual void paint(QPainter& painter, const trackedit::ClipKey& clipKey, const Params& params) = 0;
+
+    //! More of the spectrogram of the clip can be painted than was
+    virtual muse::async::Channel<trackedit::ClipKey> spectrogramChanged() const = 0;
 };
 }
@@ -22,6 +22,11 @@ static const QColor RMS_BASE_COLOR = QColor(255, 255, 255);
 WaveView::WaveView(QQuickItem* parent)
     : QQuickPaintedItem(parent)
 {
+    wavePainter()->spectrogramChanged().onReceive(this, [this](const trackedit::ClipKey& clipKey) {
+        if (m_showSpectrogram && clipKey == m_clipKey.key) {
+            update();
+        }
+    });
 }
 
 WaveView::~WaveView()
@@ -52,6 +57,7 @@ void WaveView::paint(QPainter* painter)
     params.selectionStartTime = m_clipTime.selectionStartTime;
     params.selectionEndTime = m_clipTime.selectionEndTime;
     params.channelHeightRatio = m_channelHeightRatio;
+    params.showSpectrogram = m_showSpectrogram;
 
     // LOGDA() << " geometry.height: " << params.geometry.height
     //         << " geometry.width: " << params.geometry.width
@@ -177,6 +183,22 @@ void WaveView::setChannelHeightRatio(double channelHeightRatio)
     update();
 }
 
+bool WaveView::showSpectrogram() const
+{
+    return m_showSpectrogram;
+}
+
+void WaveView::setShowSpectrogram(bool showSpectrogram)
+{
+    if (m_showSpectrogram == showSpectrogram) {
+        return;
+    }
+    m_showSpectrogram = showSpectrogram;
+    emit showSpectrogramChanged();
+
+    update();
+}
+
 QColor WaveView::transformColor(const QColor &originalColor) const
 {
     int r = originalColor.red();
@@ -6,6 +6,7 @@
 #include <QQuickPaintedItem>
 
 #include "modularity/ioc.h"
+#include "global/async/asyncable.h"
 #include "iwavepainter.h"
 
 #include "types/projectscenetypes.h"
@@ -13,7 +14,7 @@
 
 class WaveClipItem;
 namespace au::projectscene {
-class WaveView : public QQuickPaintedItem
+class WaveView : public QQuickPaintedItem, public muse::async::Asyncable
 {
     Q_OBJECT
     Q_PROPERTY(TimelineContext * context READ timelineContext WRITE setTimelineContext NOTIFY timelineContextChanged FINAL)
@@ -21,6 +22,7 @@ class WaveView : public QQuickPaintedItem
     Q_PROPERTY(QColor clipColor READ clipColor WRITE setClipColor NOTIFY clipColorChanged FINAL)
     Q_PROPERTY(bool clipSelected READ clipSelected WRITE setClipSelected NOTIFY clipSelectedChanged FINAL)
     Q_PROPERTY(double channelHeightRatio READ channelHeightRatio WRITE setChannelHeightRatio NOTIFY channelHeightRatioChanged FINAL)
+    Q_PROPERTY(bool showSpectrogram READ showSpectrogram WRITE setShowSpectrogram NOTIFY showSpectrogramChanged FINAL)
 
     Q_PROPERTY(ClipTime clipTime READ clipTime WRITE setClipTime NOTIFY clipTimeChanged FINAL)
 
@@ -42,6 +44,8 @@ public:
     void setClipTime(const ClipTime& newClipTime);
     double channelHeightRatio() const;
     void setChannelHeightRatio(double channelHeightRatio);
+    bool showSpectrogram() const;
+    void setShowSpectrogram(bool showSpectrogram);
 
     Q_INVOKABLE QColor transformColor(const QColor& originalColor) const;
 
@@ -54,6 +58,7 @@ signals:
     void clipTimeChanged();
     void clipSelectedChanged();
     void channelHeightRatioChanged();
+    void showSpectrogramChanged();
 
 private:
 
@@ -65,6 +70,7 @@ private:
     double m_clipLeft = 0;
     double m_channelHeightRatio = 0.5;
     bool m_clipSelected = false;
+    bool m_showSpectrogram = false;
     ClipTime m_clipTime;
 };
 }
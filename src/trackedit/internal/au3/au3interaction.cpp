@@ -194,6 +194,13 @@ muse::Ret Au3Interaction::makeRoomForClip(const ClipKey& clipKey)
 muse::Ret Au3Interaction::makeRoomForDataOnTracks(const std::vector<TrackId>& tracksIds, const std::vector<TrackData>& trackData,
                                                   secs_t begin)
 {
+    //! NOTE notify about every changed track and clip once, not once per step
+    trackedit::ITrackeditProjectPtr trackeditProject = globalContext()->currentTrackeditProject();
+    trackeditProject->beginChangesBatch();
+    DEFER {
+        trackeditProject->endChangesBatch();
+    };
+
     IF_ASSERT_FAILED(tracksIds.size() <= trackData.size()) {
         return make_ret(trackedit::Err::NotEnoughDataInClipboard);
     }
@@ -246,7 +253,7 @@ void Au3Interaction::trimOrDeleteOverlapping(WaveTrack* waveTrack, secs_t begin,
     if (muse::RealIsEqualOrLess(begin, otherClip->GetPlayStartTime())
         && muse::RealIsEqualOrMore(end, otherClip->GetPlayEndTime())) {
         waveTrack->RemoveInterval(otherClip);
-        prj->notifyAboutTrackChanged(DomConverter::track(waveTrack));
+        prj->notifyAboutTrackChanged(waveTrack->GetId());
 
         return;
     }
@@ -259,18 +266,18 @@ void Au3Interaction::trimOrDeleteOverlapping(WaveTrack* waveTrack, secs_t begin,
 
         auto leftClip = waveTrack->CopyClip(*otherClip, true);
         waveTrack->InsertInterval(std::move(leftClip), false);
-        prj->notifyAboutTrackChanged(DomConverter::track(waveTrack));
+        prj->notifyAboutTrackChanged(waveTrack->GetId());
 
         secs_t rightClipOverlap = (end - otherClip->GetPlayStartTime());
         otherClip->TrimLeft(rightClipOverlap);
-        prj->notifyAboutClipChanged(DomConverter::clip(waveTrack, otherClip.get()));
+        prj->notifyAboutClipChanged(ClipKey(waveTrack->GetId(), otherClip->GetId()));
 
         leftClip->SetPlayStartTime(otherClipStartTime);
         secs_t leftClipOverlap = (otherClipEndTime - begin);
         leftClip->TrimRight(leftClipOverlap);
-        prj->notifyAboutClipChanged(DomConverter::clip(waveTrack, leftClip.get()));
+        prj->notifyAboutClipChanged(ClipKey(waveTrack->GetId(), leftClip->GetId()));
 
-        prj->notifyAboutTrackChanged(DomConverter::track(waveTrack));
+        prj->notifyAboutTrackChanged(waveTrack->GetId());
 
         return;
     }
@@ -281,7 +288,7 @@ void Au3Interaction::trimOrDeleteOverlapping(WaveTrack* waveTrack, secs_t begin,
         && muse::RealIsEqualOrMore(end, otherClip->GetPlayStartTime())) {
         secs_t overlap = (end - otherClip->GetPlayStartTime());
         otherClip->TrimLeft(overlap);
-        prj->notifyAboutClipChanged(DomConverter::clip(waveTrack, otherClip.get()));
+        prj->notifyAboutClipChanged(ClipKey(waveTrack->GetId(), otherClip->GetId()));
 
         return;
     }
@@ -292,7 +299,7 @@ void Au3Interaction::trimOrDeleteOverlapping(WaveTrack* waveTrack, secs_t begin,
         && muse::RealIsEqualOrMore(end, otherClip->GetPlayEndTime())) {
         secs_t overlap = (otherClip->GetPlayEndTime() - begin);
         otherClip->TrimRight(overlap);
-        prj->notifyAboutClipChanged(DomConverter::clip(waveTrack, otherClip.get()));
+        prj->notifyAboutClipChanged(ClipKey(waveTrack->GetId(), otherClip->GetId()));
 
         return;
     }
@@ -343,9 +350,12 @@ bool Au3Interaction::changeClipStartTime(const trackedit::ClipKey& clipKey, secs
     //        << " new PlayStartTime: " << newStartTime;
 
     trackedit::ITrackeditProjectPtr prj = globalContext()->currentTrackeditProject();
-    prj->notifyAboutClipChanged(DomConverter::clip(waveTrack, clip.get()));
+    prj->notifyAboutClipChanged(ClipKey(waveTrack->GetId(), clip->GetId()));
 
-    m_clipStartTimeChanged.send(clipKey, newStartTime, completed);
+    //! NOTE Listeners expect the clip to have changed already
+    prj->callAfterChangesPublished([this, clipKey, newStartTime, completed]() {
+        m_clipStartTimeChanged.send(clipKey, newStartTime, completed);
+    });
 
     if (completed) {
         //! TODO AU4: later when having keyboard arrow shortcut for moving clips
@@ -364,6 +374,13 @@ Au3Interaction::clipStartTimeChanged() const
 
 bool Au3Interaction::trimTracksData(const std::vector<TrackId>& tracksIds, secs_t begin, secs_t end)
 {
+    //! NOTE notify about every changed track and clip once, not once per step
+    trackedit::ITrackeditProjectPtr trackeditProject = globalContext()->currentTrackeditProject();
+    trackeditProject->beginChangesBatch();
+    DEFER {
+        trackeditProject->endChangesBatch();
+    };
+
     for (TrackId trackId : tracksIds) {
         Au3WaveTrack* waveTrack = DomAccessor::findWaveTrack(projectRef(), Au3TrackId(trackId));
         IF_ASSERT_FAILED(waveTrack) {
@@ -373,7 +390,7 @@ bool Au3Interaction::trimTracksData(const std::vector<TrackId>& tracksIds, secs_
         waveTrack->Trim(begin, end);
 
         trackedit::ITrackeditProjectPtr prj = globalContext()->currentTrackeditProject();
-        prj->notifyAboutTrackChanged(DomConverter::track(waveTrack));
+        prj->notifyAboutTrackChanged(waveTrack->GetId());
     }
 
     pushProjectHistoryTracksTrimState(begin, end);
@@ -383,6 +400,13 @@ bool Au3Interaction::trimTracksData(const std::vector<TrackId>& tracksIds, secs_
 
 bool Au3Interaction::silenceTracksData(const std::vector<trackedit::TrackId>& tracksIds, secs_t begin, secs_t end)
 {
+    //! NOTE notify about every changed track and clip once, not once per step
+    trackedit::ITrackeditProjectPtr trackeditProject = globalContext()->currentTrackeditProject();
+    trackeditProject->beginChangesBatch();
+    DEFER {
+        trackeditProject->endChangesBatch();
+    };
+
     for (TrackId trackId : tracksIds) {
         Au3WaveTrack* waveTrack = DomAccessor::findWaveTrack(projectRef(), Au3TrackId(trackId));
         IF_ASSERT_FAILED(waveTrack) {
@@ -392,7 +416,7 @@ bool Au3Interaction::silenceTracksData(const std::vector<trackedit::TrackId>& tr
         waveTrack->Silence(begin, end, {});
 
         trackedit::ITrackeditProjectPtr prj = globalContext()->currentTrackeditProject();
-        prj->notifyAboutTrackChanged(DomConverter::track(waveTrack));
+        prj->notifyAboutTrackChanged(waveTrack->GetId());
     }
 
     pushProjectHistoryTrackSilenceState(begin, end);
@@ -411,7 +435,7 @@ bool Au3Interaction::changeTrackTitle(const TrackId trackId, const muse::String&
     LOGD() << "changed name of track: " << trackId;
 
     trackedit::ITrackeditProjectPtr prj = globalContext()->currentTrackeditProject();
-    prj->notifyAboutTrackChanged(DomConverter::track(track));
+    prj->notifyAboutTrackChanged(track->GetId());
 
     return true;
 }
@@ -432,7 +456,7 @@ bool Au3Interaction::changeClipTitle(const trackedit::ClipKey& clipKey, const mu
     LOGD() << "changed name of clip: " << clipKey.clipId << ", track: " << clipKey.trackId;
 
     trackedit::ITrackeditProjectPtr prj = globalContext()->currentTrackeditProject();
-    prj->notifyAboutClipChanged(DomConverter::clip(waveTrack, clip.get()));
+    prj->notifyAboutClipChanged(ClipKey(waveTrack->GetId(), clip->GetId()));
 
     return true;
 }
@@ -450,10 +474,11 @@ bool Au3Interaction::changeClipPitch(const ClipKey& clipKey, int pitch)
     }
 
     clip->SetCentShift(pitch);
+    clip->PrerenderPitchAndSpeed();
     LOGD() << "changed pitch of clip: " << clipKey.clipId << ", track: " << clipKey.trackId << ", pitch: " << pitch;
 
     trackedit::ITrackeditProjectPtr prj = globalContext()->currentTrackeditProject();
-    prj->notifyAboutClipChanged(DomConverter::clip(waveTrack, clip.get()));
+    prj->notifyAboutClipChanged(ClipKey(waveTrack->GetId(), clip->GetId()));
 
     pushProjectHistoryChangeClipPitchState();
 
@@ -476,7 +501,7 @@ bool Au3Interaction::resetClipPitch(const ClipKey& clipKey)
     LOGD() << "reseted pitch of clip: " << clipKey.clipId << ", track: " << clipKey.trackId;
 
     trackedit::ITrackeditProjectPtr prj = globalContext()->currentTrackeditProject();
-    prj->notifyAboutClipChanged(DomConverter::clip(waveTrack, clip.get()));
+    prj->notifyAboutClipChanged(ClipKey(waveTrack->GetId(), clip->GetId()));
 
     pushProjectHistoryResetClipPitchState();
 
@@ -496,10 +521,11 @@ bool Au3Interaction::changeClipSpeed(const ClipKey& clipKey, double speed)
     }
 
     TimeStretching::SetClipStretchRatio(*waveTrack, *clip, speed);
+    clip->PrerenderPitchAndSpeed();
     LOGD() << "changed speed of clip: " << clipKey.clipId << ", track: " << clipKey.trackId << ", speed: " << speed;
 
     trackedit::ITrackeditProjectPtr prj = globalContext()->currentTrackeditProject();
-    prj->notifyAboutClipChanged(DomConverter::clip(waveTrack, clip.get()));
+    prj->notifyAboutClipChanged(ClipKey(waveTrack->GetId(), clip->GetId()));
 
     pushProjectHistoryChangeClipSpeedState();
 
@@ -522,7 +548,7 @@ bool Au3Interaction::resetClipSpeed(const ClipKey& clipKey)
     LOGD() << "reseted speed of clip: " << clipKey.clipId << ", track: " << clipKey.trackId;
 
     trackedit::ITrackeditProjectPtr prj = globalContext()->currentTrackeditProject();
-    prj->notifyAboutClipChanged(DomConverter::clip(waveTrack, clip.get()));
+    prj->notifyAboutClipChanged(ClipKey(waveTrack->GetId(), clip->GetId()));
 
     pushProjectHistoryResetClipSpeedState();
 
@@ -542,10 +568,11 @@ bool Au3Interaction::changeClipOptimizeForVoice(const ClipKey& clipKey, bool opt
     }
 
     clip->SetPitchAndSpeedPreset(optimize ? PitchAndSpeedPreset::OptimizeForVoice : PitchAndSpeedPreset::Default);
+    clip->PrerenderPitchAndSpeed();
     LOGD() << "changed optimize for voice of clip: " << clipKey.clipId << ", track: " << clipKey.trackId << ", optimize: " << optimize;
 
     trackedit::ITrackeditProjectPtr prj = globalContext()->currentTrackeditProject();
-    prj->notifyAboutClipChanged(DomConverter::clip(waveTrack, clip.get()));
+    prj->notifyAboutClipChanged(ClipKey(waveTrack->GetId(), clip->GetId()));
 
     return true;
 }
@@ -730,7 +757,7 @@ bool Au3Interaction::cutTrackDataIntoClipboard(const TrackId trackId, secs_t beg
     clipboard()->addTrackData(TrackData { track, dummyClipKey });
 
     trackedit::ITrackeditProjectPtr prj = globalContext()->currentTrackeditProject();
-    prj->notifyAboutTrackChanged(DomConverter::track(waveTrack));
+    prj->notifyAboutTrackChanged(waveTrack->GetId());
 
     return true;
 }
@@ -804,7 +831,7 @@ bool Au3Interaction::removeClip(const trackedit::ClipKey& clipKey)
     waveTrack->Clear(clip->Start(), clip->End());
 
     trackedit::ITrackeditProjectPtr prj = globalContext()->currentTrackeditProject();
-    prj->notifyAboutTrackChanged(DomConverter::track(waveTrack));
+    prj->notifyAboutTrackChanged(waveTrack->GetId());
 
     pushProjectHistoryDeleteState(start, duration);
 
@@ -813,6 +840,13 @@ bool Au3Interaction::removeClip(const trackedit::ClipKey& clipKey)
 
 bool Au3Interaction::removeTracksData(const TrackIdList& tracksIds, secs_t begin, secs_t end)
 {
+    //! NOTE notify about every changed track and clip once, not once per step
+    trackedit::ITrackeditProjectPtr trackeditProject = globalContext()->currentTrackeditProject();
+    trackeditProject->beginChangesBatch();
+    DEFER {
+        trackeditProject->endChangesBatch();
+    };
+
     secs_t duration = end - begin;
     secs_t start = begin;
 
@@ -825,7 +859,7 @@ bool Au3Interaction::removeTracksData(const TrackIdList& tracksIds, secs_t begin
         waveTrack->Clear(begin, end);
 
         trackedit::ITrackeditProjectPtr prj = globalContext()->currentTrackeditProject();
-        prj->notifyAboutTrackChanged(DomConverter::track(waveTrack));
+        prj->notifyAboutTrackChanged(waveTrack->GetId());
     }
 
     pushProjectHistoryDeleteState(start, duration);
@@ -835,6 +869,13 @@ bool Au3Interaction::removeTracksData(const TrackIdList& tracksIds, secs_t begin
 
 bool Au3Interaction::moveClips(secs_t offset, bool completed)
 {
+    //! NOTE notify about every changed track and clip once, not once per step
+    trackedit::ITrackeditProjectPtr trackeditProject = globalContext()->currentTrackeditProject();
+    trackeditProject->beginChangesBatch();
+    DEFER {
+        trackeditProject->endChangesBatch();
+    };
+
     //! NOTE: check if offset is applicable to every clip and recalculate if needed
     std::optional<secs_t> mostLeftClipStartTime;
     for (const auto& selectedClip : selectionController()->selectedClips()) {
@@ -878,6 +919,13 @@ bool Au3Interaction::moveClips(secs_t offset, bool completed)
 
 bool Au3Interaction::splitTracksAt(const TrackIdList& tracksIds, secs_t pivot)
 {
+    //! NOTE notify about every changed track and clip once, not once per step
+    trackedit::ITrackeditProjectPtr trackeditProject = globalContext()->currentTrackeditProject();
+    trackeditProject->beginChangesBatch();
+    DEFER {
+        trackeditProject->endChangesBatch();
+    };
+
     for (const auto& trackId : tracksIds) {
         Au3WaveTrack* waveTrack = DomAccessor::findWaveTrack(projectRef(), Au3TrackId(trackId));
         IF_ASSERT_FAILED(waveTrack) {
@@ -887,7 +935,7 @@ bool Au3Interaction::splitTracksAt(const TrackIdList& tracksIds, secs_t pivot)
         waveTrack->SplitAt(pivot);
 
         trackedit::ITrackeditProjectPtr prj = globalContext()->currentTrackeditProject();
-        prj->notifyAboutTrackChanged(DomConverter::track(waveTrack));
+        prj->notifyAboutTrackChanged(waveTrack->GetId());
     }
 
     projectHistory()->pushHistoryState("Split", "Split");
@@ -908,7 +956,7 @@ bool Au3Interaction::mergeSelectedOnTrack(const TrackId trackId, secs_t begin, s
     waveTrack->Join(begin, end, dummyProgressReporter);
 
     trackedit::ITrackeditProjectPtr prj = globalContext()->currentTrackeditProject();
-    prj->notifyAboutTrackChanged(DomConverter::track(waveTrack));
+    prj->notifyAboutTrackChanged(waveTrack->GetId());
 
     return true;
 }
@@ -943,7 +991,7 @@ bool Au3Interaction::splitCutSelectedOnTrack(const TrackId trackId, secs_t begin
     clipboard()->addTrackData(TrackData { track, dummyClipKey });
 
     trackedit::ITrackeditProjectPtr prj = globalContext()->currentTrackeditProject();
-    prj->notifyAboutTrackChanged(DomConverter::track(waveTrack));
+    prj->notifyAboutTrackChanged(waveTrack->GetId());
 
     return true;
 }
@@ -958,7 +1006,7 @@ bool Au3Interaction::splitDeleteSelectedOnTrack(const TrackId trackId, secs_t be
     waveTrack->SplitDelete(begin, end);
 
     trackedit::ITrackeditProjectPtr prj = globalContext()->currentTrackeditProject();
-    prj->notifyAboutTrackChanged(DomConverter::track(waveTrack));
+    prj->notifyAboutTrackChanged(waveTrack->GetId());
 
     return true;
 }
@@ -1035,7 +1083,7 @@ bool Au3Interaction::clipSplitCut(const ClipKey& clipKey)
     clipboard()->addTrackData(TrackData { track, dummyClipKey });
 
     trackedit::ITrackeditProjectPtr prj = globalContext()->currentTrackeditProject();
-    prj->notifyAboutTrackChanged(DomConverter::track(waveTrack));
+    prj->notifyAboutTrackChanged(waveTrack->GetId());
 
     projectHistory()->pushHistoryState("Split-cut to the clipboard", "Split cut");
 
@@ -1057,7 +1105,7 @@ bool Au3Interaction::clipSplitDelete(const ClipKey& clipKey)
     waveTrack->SplitDelete(clip->Start(), clip->End());
 
     trackedit::ITrackeditProjectPtr prj = globalContext()->currentTrackeditProject();
-    prj->notifyAboutTrackChanged(DomConverter::track(waveTrack));
+    prj->notifyAboutTrackChanged(waveTrack->GetId());
 
     pushProjectHistorySplitDeleteState(clip->Start(), clip->End() - clip->Start());
 
@@ -1117,7 +1165,7 @@ bool Au3Interaction::trimClipLeft(const ClipKey& clipKey, secs_t deltaSec, bool
     clip->TrimLeft(deltaSec);
 
     trackedit::ITrackeditProjectPtr prj = globalContext()->currentTrackeditProject();
-    prj->notifyAboutClipChanged(DomConverter::clip(waveTrack, clip.get()));
+    prj->notifyAboutClipChanged(ClipKey(waveTrack->GetId(), clip->GetId()));
 
     if (completed) {
         projectHistory()->pushHistoryState("Clip trimmed", "Trim clip");
@@ -1148,7 +1196,7 @@ bool Au3Interaction::trimClipRight(const ClipKey& clipKey, secs_t deltaSec, bool
     clip->TrimRight(deltaSec);
 
     trackedit::ITrackeditProjectPtr prj = globalContext()->currentTrackeditProject();
-    prj->notifyAboutClipChanged(DomConverter::clip(waveTrack, clip.get()));
+    prj->notifyAboutClipChanged(ClipKey(waveTrack->GetId(), clip->GetId()));
 
     if (completed) {
         projectHistory()->pushHistoryState("Clip trimmed", "Trim clip");
@@ -1513,7 +1561,7 @@ void Au3Interaction::toggleStretchToMatchProjectTempo(const ClipKey &clipKey)
         double projectTempo = prj->timeSignature().tempo;
         clip->SetClipTempo(projectTempo);
         clip->StretchRightTo(expectedEndTime);
-        prj->notifyAboutClipChanged(DomConverter::clip(waveTrack, clip.get()));
+        prj->notifyAboutClipChanged(ClipKey(waveTrack->GetId(), clip->GetId()));
     }
 }
 
@@ -10,6 +10,8 @@
 #include "au3wrap/internal/domaccessor.h"
 #include "au3wrap/internal/wxtypes_convert.h"
 
+#include "global/async/async.h"
+
 #include "log.h"
 #include "UndoManager.h"
 
@@ -155,6 +157,100 @@ void Au3TrackeditProject::reload()
     m_tracksChanged.send(trackList());
 }
 
+void Au3TrackeditProject::beginChangesBatch()
+{
+    ++m_changesBatchDepth;
+}
+
+void Au3TrackeditProject::endChangesBatch()
+{
+    IF_ASSERT_FAILED(m_changesBatchDepth > 0) {
+        return;
+    }
+
+    if (--m_changesBatchDepth > 0 || m_changesPublishScheduled || m_pendingChanges.empty()) {
+        return;
+    }
+
+    //! NOTE Several batches may end within one frame (e.g. a drag gets several mouse moves per frame),
+    //! they are all published together
+    m_changesPublishScheduled = true;
+    muse::async::Async::call(this, [this]() {
+        publishPendingChanges();
+    });
+}
+
+void Au3TrackeditProject::callAfterChangesPublished(const std::function<void()>& f)
+{
+    if (changesDeferred()) {
+        m_pendingChanges.calls.push_back(f);
+        return;
+    }
+
+    f();
+}
+
+bool Au3TrackeditProject::changesDeferred() const
+{
+    //! NOTE While a publication is scheduled, changes made outside a batch wait for it too,
+    //! so that they don't overtake the earlier ones
+    return m_changesBatchDepth > 0 || m_changesPublishScheduled;
+}
+
+void Au3TrackeditProject::publishPendingChanges()
+{
+    m_changesPublishScheduled = false;
+    if (m_changesBatchDepth > 0) {
+        //! NOTE A new batch has been opened meanwhile, it will publish everything when it ends
+        return;
+    }
+
+    PendingChanges changes = std::move(m_pendingChanges);
+    m_pendingChanges = PendingChanges();
+
+    for (const auto& trackClips : changes.clips) {
+        for (const ClipId& clipId : trackClips.second) {
+            sendClipChanged(ClipKey(trackClips.first, clipId));
+        }
+    }
+
+    for (const TrackId& trackId : changes.tracks) {
+        sendTrackChanged(trackId);
+    }
+
+    for (const auto& call : changes.calls) {
+        call();
+    }
+}
+
+void Au3TrackeditProject::sendTrackChanged(const TrackId& trackId)
+{
+    const Au3Track* track = DomAccessor::findTrack(*m_impl->prj, Au3TrackId(trackId));
+    if (!track) {
+        //! NOTE The track has been removed meanwhile, its removal is notified separately
+        return;
+    }
+
+    m_trackChanged.send(DomConverter::track(track));
+}
+
+void Au3TrackeditProject::sendClipChanged(const ClipKey& clipKey)
+{
+    Au3WaveTrack* waveTrack = DomAccessor::findWaveTrack(*m_impl->prj, Au3TrackId(clipKey.trackId));
+    if (!waveTrack) {
+        return;
+    }
+
+    std::shared_ptr<Au3WaveClip> au3Clip = DomAccessor::findWaveClip(waveTrack, clipKey.clipId);
+    if (!au3Clip) {
+        //! NOTE The clip has been removed meanwhile, its removal is notified separately
+        return;
+    }
+
+    async::ChangedNotifier<Clip>& notifier = m_clipsChanged[clipKey.trackId];
+    notifier.itemChanged(DomConverter::clip(waveTrack, au3Clip.get()));
+}
+
 void Au3TrackeditProject::notifyAboutTrackAdded(const Track& track)
 {
     m_trackAdded.send(track);
@@ -162,9 +258,24 @@ void Au3TrackeditProject::notifyAboutTrackAdded(const Track& track)
 
 void Au3TrackeditProject::notifyAboutTrackChanged(const Track& track)
 {
+    if (changesDeferred()) {
+        m_pendingChanges.tracks.insert(track.id);
+        return;
+    }
+
     m_trackChanged.send(track);
 }
 
+void Au3TrackeditProject::notifyAboutTrackChanged(const TrackId& trackId)
+{
+    if (changesDeferred()) {
+        m_pendingChanges.tracks.insert(trackId);
+        return;
+    }
+
+    sendTrackChanged(trackId);
+}
+
 void Au3TrackeditProject::notifyAboutTrackRemoved(const Track& track)
 {
     m_trackRemoved.send(track);
@@ -197,12 +308,32 @@ au::trackedit::Clip Au3TrackeditProject::clip(const ClipKey& key) const
 
 void Au3TrackeditProject::notifyAboutClipChanged(const Clip& clip)
 {
+    if (changesDeferred()) {
+        m_pendingChanges.clips[clip.key.trackId].insert(clip.key.clipId);
+        return;
+    }
+
     async::ChangedNotifier<Clip>& notifier = m_clipsChanged[clip.key.trackId];
     notifier.itemChanged(clip);
 }
 
+void Au3TrackeditProject::notifyAboutClipChanged(const ClipKey& clipKey)
+{
+    if (changesDeferred()) {
+        m_pendingChanges.clips[clipKey.trackId].insert(clipKey.clipId);
+        return;
+    }
+
+    sendClipChanged(clipKey);
+}
+
 void Au3TrackeditProject::notifyAboutClipRemoved(const Clip& clip)
 {
+    auto pending = m_pendingChanges.clips.find(clip.key.trackId);
+    if (pending != m_pendingChanges.clips.end()) {
+        pending->second.erase(clip.key.clipId);
+    }
+
     async::ChangedNotifier<Clip>& notifier = m_clipsChanged[clip.key.trackId];
     notifier.itemRemoved(clip);
 }
@@ -3,11 +3,17 @@
 */
 #pragma once
 
+#include <map>
+#include <set>
+#include <vector>
+
+#include "global/async/asyncable.h"
+
 #include "../../itrackeditproject.h"
 
 struct TrackListEvent;
 namespace au::trackedit {
-class Au3TrackeditProject : public ITrackeditProject
+class Au3TrackeditProject : public ITrackeditProject, public muse::async::Asyncable
 {
 public:
     Au3TrackeditProject(const std::shared_ptr<au::au3::IAu3Project>& au3project);
@@ -21,13 +27,19 @@ public:
 
     void reload() override;
 
+    void beginChangesBatch() override;
+    void endChangesBatch() override;
+    void callAfterChangesPublished(const std::function<void()>& f) override;
+
     void notifyAboutTrackAdded(const Track& track) override;
     void notifyAboutTrackChanged(const Track& track) override;
+    void notifyAboutTrackChanged(const TrackId& trackId) override;
     void notifyAboutTrackRemoved(const Track& track) override;
     void notifyAboutTrackInserted(const Track& track, int pos) override;
     void notifyAboutTrackMoved(const Track& track, int pos) override;
 
     void notifyAboutClipChanged(const Clip& clip) override;
+    void notifyAboutClipChanged(const ClipKey& clipKey) override;
     void notifyAboutClipAdded(const Clip& clip) override;
     void notifyAboutClipRemoved(const Clip& clip) override;
 
@@ -50,9 +62,27 @@ private:
     void onTrackDataChanged(const TrackId& trackId);
     void onProjectTempoChange(double newTempo);
 
+    void sendTrackChanged(const TrackId& trackId);
+    void sendClipChanged(const ClipKey& clipKey);
+    bool changesDeferred() const;
+    void publishPendingChanges();
+
     struct Au3Impl;
     std::shared_ptr<Au3Impl> m_impl;
 
+    struct PendingChanges
+    {
+        std::set<TrackId> tracks;
+        std::map<TrackId, std::set<ClipId> > clips;
+        std::vector<std::function<void()> > calls;
+
+        bool empty() const { return tracks.empty() && clips.empty() && calls.empty(); }
+    };
+
+    int m_changesBatchDepth = 0;
+    bool m_changesPublishScheduled = false;
+    PendingChanges m_pendingChanges;
+
     mutable std::map<TrackId, muse::async::ChangedNotifier<Clip> > m_clipsChanged;
     mutable muse::async::Channel<au::trackedit::TimeSignature> m_timeSignatureChanged;
 
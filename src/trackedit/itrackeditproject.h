@@ -3,6 +3,7 @@
 */
 #pragma once
 
+#include <functional>
 #include <memory>
 
 #include "modularity/imoduleinterface.h"
@@ -31,13 +32,26 @@ public:
 
     virtual void reload() = 0;
 
+    //! NOTE Change notifications sent between begin and end are not published immediately,
+    //! they are coalesced per track and clip and published once, on the next UI frame.
+    //! Batches may be nested, the outermost end schedules the publication
+    virtual void beginChangesBatch() = 0;
+    virtual void endChangesBatch() = 0;
+    //! NOTE Calls `f` after the change notifications sent so far have been published,
+    //! so that other notifications keep their order relative to them. Immediately if there are none pending
+    virtual void callAfterChangesPublished(const std::function<void()>& f) = 0;
+
     virtual void notifyAboutTrackAdded(const Track& track) = 0;
     virtual void notifyAboutTrackChanged(const Track& track) = 0;
+    //! NOTE The track is converted when the notification is published, only once per batch
+    virtual void notifyAboutTrackChanged(const TrackId& trackId) = 0;
     virtual void notifyAboutTrackRemoved(const Track& track) = 0;
     virtual void notifyAboutTrackInserted(const Track& track, int pos) = 0;
     virtual void notifyAboutTrackMoved(const Track& track, int pos) = 0;
 
     virtual void notifyAboutClipChanged(const Clip& clip) = 0;
+    //! NOTE The clip is converted when the notification is published, only once per batch
+    virtual void notifyAboutClipChanged(const ClipKey& clipKey) = 0;
     virtual void notifyAboutClipAdded(const Clip& clip) = 0;
     virtual void notifyAboutClipRemoved(const Clip& clip) = 0;
 
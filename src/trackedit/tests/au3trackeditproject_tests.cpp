@@ -0,0 +1,137 @@
+/*
+ * Audacity: A Digital Audio Editor
+ */
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "libraries/lib-project/Project.h"
+#include "libraries/lib-track/Track.h"
+#include "libraries/lib-wave-track/WaveTrack.h"
+#include "libraries/lib-wave-track/WaveClip.h"
+
+#include "global/async/asyncable.h"
+#include "global/async/processevents.h"
+
+#include "au3wrap/au3types.h"
+#include "au3wrap/iau3project.h"
+
+#include "trackedit/internal/au3/au3trackeditproject.h"
+
+using namespace au::au3;
+
+namespace au::trackedit {
+class Au3ProjectStub : public IAu3Project
+{
+public:
+    Au3ProjectStub()
+        : m_project(Au3Project::Create()) {}
+
+    void open() override {}
+    bool load(const muse::io::path_t&) override { return false; }
+    bool save(const muse::io::path_t&) override { return false; }
+    void close() override {}
+
+    std::string title() const override { return std::string(); }
+
+    uintptr_t au3ProjectPtr() const override { return reinterpret_cast<uintptr_t>(m_project.get()); }
+
+    Au3Project& project() const { return *m_project; }
+
+private:
+    std::shared_ptr<Au3Project> m_project;
+};
+
+class Au3TrackeditProjectTests : public ::testing::Test, public muse::async::Asyncable
+{
+public:
+    void SetUp() override
+    {
+        m_au3Project = std::make_shared<Au3ProjectStub>();
+
+        //! NOTE the clips stay empty, so no sample block factory is needed
+        auto track = Au3WaveTrack::Create(nullptr, floatSample, 44100);
+        for (double start : { 0.0, 1.0 }) {
+            auto clip = track->CreateClip(start);
+            track->InsertInterval(clip, true, true);
+            m_clips.push_back(ClipKey(track->GetId(), clip->GetId()));
+        }
+        Au3TrackList::Get(m_au3Project->project()).Add(track);
+
+        m_project = std::make_shared<Au3TrackeditProject>(m_au3Project);
+        m_project->clipList(m_clips.front().trackId).onItemChanged(this, [this](const Clip& clip) {
+            m_log.push_back("clip " + std::to_string(clip.key.clipId));
+        });
+    }
+
+    void TearDown() override
+    {
+        m_project.reset();
+        m_au3Project.reset();
+        m_clips.clear();
+        m_log.clear();
+    }
+
+protected:
+    std::function<void()> logCall(const std::string& name)
+    {
+        return [this, name]() {
+            m_log.push_back(name);
+        };
+    }
+
+    std::string clipEntry(size_t i) const
+    {
+        return "clip " + std::to_string(m_clips.at(i).clipId);
+    }
+
+    std::shared_ptr<Au3ProjectStub> m_au3Project;
+    std::shared_ptr<Au3TrackeditProject> m_project;
+    std::vector<ClipKey> m_clips;
+    std::vector<std::string> m_log;
+};
+
+TEST_F(Au3TrackeditProjectTests, CallsRightAwayWithoutPendingChanges)
+{
+    m_project->notifyAboutClipChanged(m_clips[0]);
+    m_project->callAfterChangesPublished(logCall("call"));
+
+    EXPECT_EQ(m_log, std::vector<std::string>({ clipEntry(0), "call" }));
+}
+
+TEST_F(Au3TrackeditProjectTests, CallsAfterTheBatchIsPublished)
+{
+    m_project->beginChangesBatch();
+    m_project->notifyAboutClipChanged(m_clips[0]);
+    m_project->callAfterChangesPublished(logCall("call"));
+    m_project->endChangesBatch();
+
+    EXPECT_TRUE(m_log.empty());
+
+    muse::async::processEvents();
+
+    EXPECT_EQ(m_log, std::vector<std::string>({ clipEntry(0), "call" }));
+}
+
+TEST_F(Au3TrackeditProjectTests, ChangesOutsideABatchDontOvertakeAScheduledPublication)
+{
+    //! NOTE as when a drag moves a clip and then its end is notified within the same frame
+    m_project->beginChangesBatch();
+    m_project->notifyAboutClipChanged(m_clips[0]);
+    m_project->callAfterChangesPublished(logCall("first call"));
+    m_project->endChangesBatch();
+
+    m_project->notifyAboutClipChanged(m_clips[1]);
+    m_project->callAfterChangesPublished(logCall("second call"));
+
+    EXPECT_TRUE(m_log.empty());
+
+    muse::async::processEvents();
+
+    EXPECT_EQ(m_log, std::vector<std::string>({ clipEntry(0), clipEntry(1), "first call", "second call" }));
+
+    m_project->callAfterChangesPublished(logCall("third call"));
+    EXPECT_EQ(m_log.back(), "third call");
+}
+}
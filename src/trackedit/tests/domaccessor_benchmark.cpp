@@ -0,0 +1,128 @@
+/*
+ * Audacity: A Digital Audio Editor
+ */
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <iostream>
+
+#include "libraries/lib-project/Project.h"
+#include "libraries/lib-track/Track.h"
+#include "libraries/lib-wave-track/WaveTrack.h"
+#include "libraries/lib-wave-track/WaveClip.h"
+
+#include "au3wrap/internal/domaccessor.h"
+
+using namespace au::au3;
+
+namespace au::trackedit {
+//! Measures the id lookups that `Au3Interaction::moveClips` does on every mouse-move tick of a drag.
+//! Disabled by default, run with `--gtest_also_run_disabled_tests --gtest_filter=*DomAccessorBenchmark*`
+class DomAccessorBenchmark : public ::testing::Test
+{
+public:
+    static constexpr size_t numTracks = 200;
+    static constexpr size_t numClipsPerTrack = 500;
+    static constexpr size_t numDragTicks = 100;
+
+    void SetUp() override
+    {
+        m_project = Au3Project::Create();
+        Au3TrackList& tracks = Au3TrackList::Get(*m_project);
+
+        for (size_t t = 0; t < numTracks; ++t) {
+            //! NOTE the clips stay empty, so no sample block factory is needed
+            auto track = Au3WaveTrack::Create(nullptr, floatSample, 44100);
+            Au3ClipId lastClipId = -1;
+            for (size_t c = 0; c < numClipsPerTrack; ++c) {
+                auto clip = track->CreateClip(static_cast<double>(c));
+                track->InsertInterval(clip, true, true);
+                lastClipId = clip->GetId();
+            }
+            tracks.Add(track);
+
+            //! NOTE the dragged clips are the last one of every track, the worst case for a linear search
+            m_selectedClips.push_back({ track->GetId(), lastClipId });
+        }
+    }
+
+    void TearDown() override
+    {
+        m_selectedClips.clear();
+        m_project.reset();
+    }
+
+protected:
+    static std::shared_ptr<Au3WaveClip> linearFindWaveClip(Au3Project& prj, const ClipKey& key)
+    {
+        for (Au3Track* t : Au3TrackList::Get(prj)) {
+            if (t->GetId() != Au3TrackId(key.trackId)) {
+                continue;
+            }
+            for (const std::shared_ptr<Au3WaveClip>& interval : static_cast<Au3WaveTrack*>(t)->Intervals()) {
+                if (interval->GetId() == key.clipId) {
+                    return interval;
+                }
+            }
+        }
+        return nullptr;
+    }
+
+    static std::shared_ptr<Au3WaveClip> indexedFindWaveClip(Au3Project& prj, const ClipKey& key)
+    {
+        Au3WaveTrack* waveTrack = DomAccessor::findWaveTrack(prj, Au3TrackId(key.trackId));
+        return waveTrack ? DomAccessor::findWaveClip(waveTrack, key.clipId) : nullptr;
+    }
+
+    template<typename Find>
+    std::chrono::microseconds drag(Find find)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        for (size_t tick = 0; tick < numDragTicks; ++tick) {
+            //! NOTE moveClips looks every clip up twice, changeClipStartTime once more
+            for (int pass = 0; pass < 3; ++pass) {
+                for (const ClipKey& key : m_selectedClips) {
+                    EXPECT_TRUE(find(*m_project, key));
+                }
+            }
+        }
+        return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+    }
+
+    std::shared_ptr<Au3Project> m_project;
+    std::vector<ClipKey> m_selectedClips;
+};
+
+TEST_F(DomAccessorBenchmark, DISABLED_DragLatency)
+{
+    const auto linear = drag(linearFindWaveClip);
+    const auto indexed = drag(indexedFindWaveClip);
+
+    std::cout << numTracks << " tracks x " << numClipsPerTrack << " clips, "
+              << m_selectedClips.size() << " dragged clips, per mouse-move tick:\n"
+              << "  linear:  " << linear.count() / numDragTicks << " us\n"
+              << "  indexed: " << indexed.count() / numDragTicks << " us\n";
+
+    EXPECT_LT(indexed, linear);
+}
+
+TEST_F(DomAccessorBenchmark, IndexFollowsEdits)
+{
+    Au3TrackList& tracks = Au3TrackList::Get(*m_project);
+    auto* waveTrack = dynamic_cast<Au3WaveTrack*>(*tracks.begin());
+    const ClipKey key = m_selectedClips.front();
+
+    std::shared_ptr<Au3WaveClip> clip = DomAccessor::findWaveClip(waveTrack, key.clipId);
+    ASSERT_TRUE(clip);
+
+    //! NOTE a removed clip that is still alive elsewhere must not be found anymore
+    waveTrack->RemoveInterval(clip);
+    EXPECT_FALSE(DomAccessor::findWaveClip(waveTrack, key.clipId));
+
+    waveTrack->InsertInterval(clip, false, true);
+    EXPECT_EQ(DomAccessor::findWaveClip(waveTrack, key.clipId), clip);
+
+    const auto removed = tracks.Remove(*waveTrack);
+    EXPECT_FALSE(DomAccessor::findWaveTrack(*m_project, Au3TrackId(key.trackId)));
+}
+}
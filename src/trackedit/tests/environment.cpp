@@ -0,0 +1,13 @@
+/*
+* Audacity: A Digital Audio Editor
+*/
+
+#include "testing/environment.h"
+
+static muse::testing::SuiteEnvironment trackedit_se(
+{
+},
+    nullptr,
+    []() {
+}
+    );
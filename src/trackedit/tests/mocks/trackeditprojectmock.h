@@ -19,13 +19,19 @@ public:
 
     MOCK_METHOD(void, reload, (), (override));
 
+    MOCK_METHOD(void, beginChangesBatch, (), (override));
+    MOCK_METHOD(void, endChangesBatch, (), (override));
+    MOCK_METHOD(void, callAfterChangesPublished, (const std::function<void()>& f), (override));
+
     MOCK_METHOD(void, notifyAboutTrackAdded, (const Track& track), (override));
     MOCK_METHOD(void, notifyAboutTrackChanged, (const Track& track), (override));
+    MOCK_METHOD(void, notifyAboutTrackChanged, (const TrackId& trackId), (override));
     MOCK_METHOD(void, notifyAboutTrackRemoved, (const Track& track), (override));
     MOCK_METHOD(void, notifyAboutTrackInserted, (const Track& track, int pos), (override));
     MOCK_METHOD(void, notifyAboutTrackMoved, (const Track& track, int pos), (override));
 
     MOCK_METHOD(void, notifyAboutClipChanged, (const Clip& clip), (override));
+    MOCK_METHOD(void, notifyAboutClipChanged, (const ClipKey& clipKey), (override));
     MOCK_METHOD(void, notifyAboutClipAdded, (const Clip& clip), (override));
     MOCK_METHOD(void, notifyAboutClipRemoved, (const Clip& clip), (override));
 